@@ -0,0 +1,721 @@
+/*
+simulation_bench measures how fast the simulation runs on a synthetic fleet,
+and writes the results as JSON so that runs can be compared over time.
+
+The fleet is made from a seed: the Islands of a Model, and as many more as
+asked for, are scattered over a square that grows with their number, and
+there are as many Ships of each type that create_ship makes, each placed near
+a random Island and given a first command - the Tankers carry fuel between
+two Islands, the Cruise_ships go on cruises, the Chain_ships chain another
+Ship, and half of the Warships attack another Ship while the rest sail to an
+Island. Every measurement starts from a world of its own, made the same way:
+
+update: the ticks per second of Model::update, one tick per call and all the
+ticks in one call, in each update mode.
+draw: the time a Map_view, a Twod_view, takes to draw, on the Views' thread,
+after each tick.
+group: the time to give each of several commands to a group of every Ship, and
+how many Ships carried it out.
+create: the Ships made and added per second, with the heap allocations that
+takes, and the time to tear the whole world down again.
+cpa: the time Model::screen_cpa takes to find the pairs of Ships that come
+within 1 nm of each other in the next hour, over all the Ships and from one
+Ship at a time.
+pursuit: in a world of its own, how many ticks Torpedo_boats take to come
+within firing range of a Tanker under way 20 to 40 nm off, and the fuel they
+burn on the way; a pursuit that does not get there is not counted.
+cruise: the length of the tour that the cruises go round the Islands by, and
+of the greedy tour, from one Island to the nearest not yet visited, that the
+Tour_planner improves on, and the time planning takes.
+memory: the heap bytes taken by each Ship, counted by this program's operator
+new and operator delete; most of them are the Model's Object_arena chunks.
+
+The Logger is switched off, as in the Monte Carlo driver.
+*/
+
+#include "Island.h"
+#include "Logger.h"
+#include "Map_view.h"
+#include "Model.h"
+#include "Navigation.h"
+#include "Profiler.h"
+#include "Ship.h"
+#include "Ship_component_factory.h"
+#include "Ship_composite.h"
+#include "Thread_pool.h"
+#include "Tour_planner.h"
+#include "Utility.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+/*** Heap accounting ***/
+
+// The bytes given out by operator new and not yet deleted, and the number of calls
+static atomic<long long> live_heap_bytes(0);
+static atomic<long long> num_heap_allocations(0);
+
+// The size of a block is kept in front of it, in room that keeps the block aligned
+const size_t heap_header_size = alignof(max_align_t);
+
+// Every form of operator new and delete goes through these, so that none
+// frees a block that another form gave out
+static void* allocate_counted(size_t size) noexcept
+{
+    char* block = static_cast<char*>(malloc(size + heap_header_size));
+    if (!block)
+        return nullptr;
+    *reinterpret_cast<size_t*>(block) = size;
+    live_heap_bytes += static_cast<long long>(size);
+    ++num_heap_allocations;
+    PROFILE_COUNT_ALLOCATION();
+    return block + heap_header_size;
+}
+
+static void free_counted(void* ptr) noexcept
+{
+    if (!ptr)
+        return;
+    char* block = static_cast<char*>(ptr) - heap_header_size;
+    live_heap_bytes -= static_cast<long long>(*reinterpret_cast<size_t*>(block));
+    free(block);
+}
+
+void* operator new(size_t size)
+{
+    if (void* ptr = allocate_counted(size))
+        return ptr;
+    throw bad_alloc();
+}
+
+void* operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void* operator new(size_t size, const nothrow_t&) noexcept
+{
+    return allocate_counted(size);
+}
+
+void* operator new[](size_t size, const nothrow_t&) noexcept
+{
+    return allocate_counted(size);
+}
+
+void operator delete(void* ptr) noexcept
+{
+    free_counted(ptr);
+}
+
+void operator delete[](void* ptr) noexcept
+{
+    free_counted(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept
+{
+    free_counted(ptr);
+}
+
+void operator delete[](void* ptr, size_t) noexcept
+{
+    free_counted(ptr);
+}
+
+void operator delete(void* ptr, const nothrow_t&) noexcept
+{
+    free_counted(ptr);
+}
+
+void operator delete[](void* ptr, const nothrow_t&) noexcept
+{
+    free_counted(ptr);
+}
+
+/*** The synthetic fleet ***/
+
+struct Bench_settings
+{
+    int num_islands;  // added to those of a new Model
+    int ships_per_type;
+    int num_ticks;  // for each update measurement
+    int num_draws;
+    int group_repeats;  // times each group command is given
+    unsigned int seed;
+    const char* output;  // file to write the results to, or nullptr for cout
+};
+
+// The types create_ship makes
+const char* const ship_types[] = {"Tanker", "Cruiser", "Cruise_ship", "Torpedo_boat", "Chain_ship"};
+
+// How far from an Island the Ships are placed, in nm
+const double ship_spread = 15.;
+
+// The length of a side of the square the Islands are scattered over, in nm
+static double get_world_size(const Bench_settings& settings)
+{
+    return max(100., 40. * sqrt(double(settings.num_islands)));
+}
+
+// Add the Islands, at random in the square with the lower-left corner at the origin
+static void add_islands(Model& model, const Bench_settings& settings, mt19937& generator)
+{
+    uniform_real_distribution<double> coordinate(0., get_world_size(settings));
+    uniform_real_distribution<double> fuel(500., 2000.);
+    uniform_real_distribution<double> production(0., 20.);
+    for (int i = 0; i < settings.num_islands; ++i) {
+        double x = coordinate(generator);
+        double y = coordinate(generator);
+        double island_fuel = fuel(generator);
+        double island_production = production(generator);
+        model.add_island(create_island(model, "I" + to_string(i), Point(x, y), island_fuel, island_production));
+    }
+}
+
+// Add ships_per_type Ships of each type, each near a random Island, and return them
+static vector<shared_ptr<Ship>> add_ships(Model& model, const Bench_settings& settings, mt19937& generator)
+{
+    vector<shared_ptr<Island>> islands = model.get_islands();
+    uniform_int_distribution<size_t> pick_island(0, islands.size() - 1);
+    uniform_real_distribution<double> offset(-ship_spread, ship_spread);
+
+    vector<shared_ptr<Ship>> ships;
+    for (const char* type : ship_types) {
+        for (int i = 0; i < settings.ships_per_type; ++i) {
+            Point location = islands[pick_island(generator)]->get_location();
+            double x = location.x + offset(generator);
+            double y = location.y + offset(generator);
+            string name = "S" + to_string(ships.size());
+            shared_ptr<Ship> ship_ptr = create_ship(model, name, type, Point(x, y));
+            model.add_ship(ship_ptr);
+            ships.push_back(ship_ptr);
+        }
+    }
+    return ships;
+}
+
+// Give each of the Ships that add_ships returned its first command
+static void give_first_commands(Model& model, const vector<shared_ptr<Ship>>& ships, mt19937& generator)
+{
+    vector<shared_ptr<Island>> islands = model.get_islands();
+    uniform_int_distribution<size_t> pick_island(0, islands.size() - 1);
+    uniform_int_distribution<size_t> pick_ship(0, ships.size() - 1);
+    uniform_real_distribution<double> speed(5., 10.);
+    bernoulli_distribution attack(0.5);
+
+    // Another Ship than ship_ptr
+    auto pick_other_ship = [&](const shared_ptr<Ship>& ship_ptr) {
+        shared_ptr<Ship> other;
+        do
+            other = ships[pick_ship(generator)];
+        while (other == ship_ptr);
+        return other;
+    };
+
+    for (const auto& ship_ptr : ships) {
+        unsigned int capabilities = ship_ptr->get_capabilities();
+        if (capabilities & Ship::can_load) {
+            size_t load = pick_island(generator);
+            size_t unload = (load + 1 + pick_island(generator) % (islands.size() - 1)) % islands.size();
+            ship_ptr->try_set_load_destination(islands[load]);
+            ship_ptr->try_set_unload_destination(islands[unload]);
+        } else if (capabilities & Ship::can_chain) {
+            ship_ptr->try_chain_ship(pick_other_ship(ship_ptr));
+        } else if ((capabilities & Ship::can_attack) && attack(generator)) {
+            ship_ptr->try_attack(pick_other_ship(ship_ptr));
+        } else {
+            // a Cruise_ship sent to an Island goes on a cruise
+            shared_ptr<Island> island_ptr = islands[pick_island(generator)];
+            ship_ptr->try_set_destination_island_and_speed(island_ptr, speed(generator));
+        }
+    }
+}
+
+// Make the whole synthetic fleet in model; return the Ships added
+static vector<shared_ptr<Ship>> build_world(Model& model, const Bench_settings& settings)
+{
+    mt19937 generator(settings.seed);
+    add_islands(model, settings, generator);
+    vector<shared_ptr<Ship>> ships = add_ships(model, settings, generator);
+    give_first_commands(model, ships, generator);
+    return ships;
+}
+
+/*** Measurements ***/
+
+using Clock = chrono::steady_clock;
+
+// Return the seconds from start until now
+static double seconds_since(Clock::time_point start)
+{
+    return chrono::duration<double>(Clock::now() - start).count();
+}
+
+// Return the value below which the fraction q of the sorted values lie
+static double get_percentile(const vector<double>& sorted_values, double q)
+{
+    if (sorted_values.empty())
+        return 0.;
+    size_t index = min(sorted_values.size() - 1, static_cast<size_t>(q * sorted_values.size()));
+    return sorted_values[index];
+}
+
+// Write "name": value, with a comma first unless it is the first of its object
+static void write_field(ostream& os, bool& first, const char* name, double value)
+{
+    os << (first ? "" : ",") << "\n      \"" << name << "\": " << value;
+    first = false;
+}
+
+// Measure Model::update in each update mode, one tick per call and all the ticks in one call
+static void measure_update(ostream& os, const Bench_settings& settings)
+{
+    const pair<const char*, Model::Update_mode> modes[] = {
+        {"serial", Model::Update_mode::serial},
+        {"parallel", Model::Update_mode::parallel},
+        {"event", Model::Update_mode::event},
+    };
+
+    os << "  \"update\": [";
+    bool first_mode = true;
+    for (const auto& mode : modes) {
+        for (bool one_call : {false, true}) {
+            Model model;
+            build_world(model, settings);
+            model.set_update_mode(mode.second);
+
+            Clock::time_point start = Clock::now();
+            if (one_call) {
+                model.update(settings.num_ticks);
+            } else {
+                for (int tick = 0; tick < settings.num_ticks; ++tick)
+                    model.update();
+            }
+            double seconds = seconds_since(start);
+
+            os << (first_mode ? "" : ",") << "\n    {\n      \"mode\": \"" << mode.first << "\",\n      \"calls\": \""
+               << (one_call ? "all_ticks" : "per_tick") << "\"";
+            bool first = false;
+            write_field(os, first, "ticks", settings.num_ticks);
+            write_field(os, first, "seconds", seconds);
+            write_field(os, first, "ticks_per_second", seconds > 0. ? settings.num_ticks / seconds : 0.);
+            write_field(os, first, "ships_afloat", model.get_num_ships());
+            os << "\n    }";
+            first_mode = false;
+        }
+    }
+    os << "\n  ],\n";
+}
+
+// Measure how long a Map_view covering the whole fleet takes to draw after each tick
+static void measure_draw(ostream& os, const Bench_settings& settings)
+{
+    const int map_size = 30;
+
+    Model model;
+    build_world(model, settings);
+
+    shared_ptr<Map_view> map_view = make_shared<Map_view>();
+    map_view->set_size(map_size);
+    map_view->set_scale((get_world_size(settings) + 4. * ship_spread) / map_size);
+    map_view->set_origin(Point(-2. * ship_spread, -2. * ship_spread));
+    model.attach(map_view);
+
+    // Written on the Views' thread; write_frames waits for it before they are read
+    vector<double> latencies;
+    ostream discard(nullptr);
+    for (int draw = 0; draw < settings.num_draws; ++draw) {
+        model.update();
+        model.post_view_command([map_view, &latencies](ostream& frame) {
+            Clock::time_point start = Clock::now();
+            map_view->draw(frame);
+            latencies.push_back(seconds_since(start) * 1e6);
+        });
+        model.get_view_renderer().write_frames(discard, true);
+    }
+    model.detach(map_view);
+
+    double sum = 0.;
+    for (double latency : latencies)
+        sum += latency;
+    sort(latencies.begin(), latencies.end());
+
+    os << "  \"draw\": {";
+    bool first = true;
+    write_field(os, first, "draws", latencies.size());
+    write_field(os, first, "map_size", map_size);
+    write_field(os, first, "mean_us", latencies.empty() ? 0. : sum / latencies.size());
+    write_field(os, first, "p50_us", get_percentile(latencies, 0.5));
+    write_field(os, first, "p99_us", get_percentile(latencies, 0.99));
+    write_field(os, first, "max_us", latencies.empty() ? 0. : latencies.back());
+    os << "\n  },\n";
+}
+
+// Measure giving commands to a group of every Ship
+static void measure_group(ostream& os, const Bench_settings& settings)
+{
+    Model model;
+    vector<shared_ptr<Ship>> ships = build_world(model, settings);
+
+    shared_ptr<Ship_composite> group = static_pointer_cast<Ship_composite>(create_composite(model, "Fleet"));
+    model.add_composite(group);
+    for (const auto& ship_ptr : ships)
+        model.add_ship_to_composite("Fleet", ship_ptr);
+
+    shared_ptr<Ship> target = ships.front();
+    shared_ptr<Island> island_ptr = model.get_islands().front();
+    const pair<const char*, function<void()>> commands[] = {
+        {"course", [&] { group->set_course_and_speed(90., 5.); }},
+        {"stop", [&] { group->stop(); }},
+        {"attack", [&] { group->attack(target); }},
+        {"load_at", [&] { group->set_load_destination(island_ptr); }},
+        {"unchain", [&] { group->unchain_ship(target); }},
+    };
+    const size_t num_commands = sizeof(commands) / sizeof(commands[0]);
+
+    // the commands are given in turn, so that each finds the Ships as the others left them
+    vector<double> seconds(num_commands, 0.);
+    vector<long> carried_out(num_commands, 0);
+    for (int repeat = 0; repeat < settings.group_repeats; ++repeat) {
+        for (size_t i = 0; i < num_commands; ++i) {
+            Clock::time_point start = Clock::now();
+            commands[i].second();
+            seconds[i] += seconds_since(start);
+            carried_out[i] += group->get_last_status().num_carried_out;
+        }
+    }
+
+    int num_ships = group->get_last_status().num_ships;
+    int repeats = max(settings.group_repeats, 1);
+    os << "  \"group\": [";
+    for (size_t i = 0; i < num_commands; ++i) {
+        os << (i == 0 ? "" : ",") << "\n    {\n      \"command\": \"" << commands[i].first << "\"";
+        bool first = false;
+        write_field(os, first, "ships", num_ships);
+        write_field(os, first, "repeats", settings.group_repeats);
+        write_field(os, first, "mean_us", seconds[i] / repeats * 1e6);
+        write_field(os, first, "ns_per_ship", num_ships > 0 ? seconds[i] / repeats / num_ships * 1e9 : 0.);
+        write_field(os, first, "mean_carried_out", double(carried_out[i]) / repeats);
+        os << "\n    }";
+    }
+    os << "\n  ],\n";
+}
+
+// Measure how fast the Ships are made and added to a world, and the world torn down
+static void measure_create(ostream& os, const Bench_settings& settings)
+{
+    unique_ptr<Model> model_ptr(new Model);
+    mt19937 generator(settings.seed);
+    add_islands(*model_ptr, settings, generator);
+
+    long long allocations_before = num_heap_allocations;
+    Clock::time_point start = Clock::now();
+    size_t num_ships = add_ships(*model_ptr, settings, generator).size();
+    double create_seconds = seconds_since(start);
+    long long allocations = num_heap_allocations - allocations_before;
+
+    start = Clock::now();
+    model_ptr.reset();
+    double teardown_seconds = seconds_since(start);
+
+    os << "  \"create\": {";
+    bool first = true;
+    write_field(os, first, "ships", num_ships);
+    write_field(os, first, "seconds", create_seconds);
+    write_field(os, first, "ships_per_second", create_seconds > 0. ? num_ships / create_seconds : 0.);
+    write_field(os, first, "heap_allocations_per_ship", num_ships > 0 ? double(allocations) / num_ships : 0.);
+    write_field(os, first, "teardown_seconds", teardown_seconds);
+    os << "\n  },\n";
+}
+
+// Measure the CPA screen of every Ship, and of single Ships against the rest
+static void measure_cpa(ostream& os, const Bench_settings& settings)
+{
+    const double range = 1.;
+    const double hours = 1.;
+    const int num_screens = 20;
+    const int max_single_ships = 1000;
+
+    Model model;
+    vector<shared_ptr<Ship>> ships = build_world(model, settings);
+    int num_moving = 0;
+    for (const auto& ship_ptr : ships)
+        if (ship_ptr->is_moving())
+            ++num_moving;
+
+    vector<double> latencies;
+    size_t num_pairs = 0;
+    for (int screen = 0; screen < num_screens; ++screen) {
+        Clock::time_point start = Clock::now();
+        num_pairs = model.screen_cpa(range, hours).size();
+        latencies.push_back(seconds_since(start) * 1e3);
+    }
+    double sum = 0.;
+    for (double latency : latencies)
+        sum += latency;
+    sort(latencies.begin(), latencies.end());
+
+    int num_single_ships = min(int(ships.size()), max_single_ships);
+    size_t num_single_pairs = 0;
+    Clock::time_point start = Clock::now();
+    for (int i = 0; i < num_single_ships; ++i)
+        num_single_pairs += model.screen_cpa(*ships[i], range, hours).size();
+    double single_seconds = seconds_since(start);
+
+    os << "  \"cpa\": {";
+    bool first = true;
+    write_field(os, first, "tracks", ships.size());
+    write_field(os, first, "moving", num_moving);
+    write_field(os, first, "range_nm", range);
+    write_field(os, first, "hours", hours);
+    write_field(os, first, "pairs", num_pairs);
+    write_field(os, first, "mean_ms", sum / num_screens);
+    write_field(os, first, "p50_ms", get_percentile(latencies, 0.5));
+    write_field(os, first, "max_ms", latencies.back());
+    write_field(os, first, "single_ships", num_single_ships);
+    write_field(os, first, "single_pairs", num_single_pairs);
+    write_field(os, first, "single_mean_us", num_single_ships > 0 ? single_seconds / num_single_ships * 1e6 : 0.);
+    os << "\n  },\n";
+}
+
+// Measure how quickly and cheaply Torpedo_boats close with moving targets
+static void measure_pursuit(ostream& os, const Bench_settings& settings)
+{
+    const int max_boats = 1000;
+    const int max_ticks = 100;
+    const double firing_range = 5.;  // a Torpedo_boat's
+    const double pair_spacing = 500.;  // far enough apart that no pursuit meets another
+
+    // Each Torpedo_boat attacks a Tanker of its own, 20 to 40 nm away, under way
+    // on a random course at 3 to 10 knots; a Tanker is slower than a Torpedo_boat
+    struct Pursuit
+    {
+        shared_ptr<Ship> boat;
+        shared_ptr<Ship> target;
+        double starting_fuel;
+        int ticks;  // to come within range, or -1 until then
+        double fuel_burned;  // by then
+    };
+    Model model;
+    mt19937 generator(settings.seed);
+    uniform_real_distribution<double> bearing(0., 360.);
+    uniform_real_distribution<double> range(20., 40.);
+    uniform_real_distribution<double> speed(3., 10.);
+    int num_boats = min(settings.ships_per_type, max_boats);
+    int pairs_per_row = max(1, int(sqrt(double(num_boats))));
+    vector<Pursuit> pursuits;
+    for (int i = 0; i < num_boats; ++i) {
+        Point boat_location((i % pairs_per_row) * pair_spacing, (i / pairs_per_row) * pair_spacing);
+        Point target_location = boat_location + Compass_position(bearing(generator), range(generator));
+        shared_ptr<Ship> boat = create_ship(model, "B" + to_string(i), "Torpedo_boat", boat_location);
+        shared_ptr<Ship> target = create_ship(model, "T" + to_string(i), "Tanker", target_location);
+        model.add_ship(boat);
+        model.add_ship(target);
+        target->try_set_course_and_speed(bearing(generator), speed(generator));
+        if (!boat->try_attack(target))
+            pursuits.push_back(Pursuit{boat, target, boat->get_fuel(), -1, 0.});
+    }
+
+    // A Torpedo_boat fires as soon as it is in range, and may sink its target at once
+    for (int tick = 1; tick <= max_ticks; ++tick) {
+        model.update();
+        for (auto& pursuit : pursuits) {
+            if (pursuit.ticks < 0 && pursuit.boat->is_afloat()
+                && cartesian_distance(pursuit.boat->get_location(), pursuit.target->get_location()) <= firing_range) {
+                pursuit.ticks = tick;
+                pursuit.fuel_burned = pursuit.starting_fuel - pursuit.boat->get_fuel();
+            }
+        }
+    }
+
+    vector<double> ticks;
+    double total_ticks = 0.;
+    double total_fuel = 0.;
+    for (const auto& pursuit : pursuits) {
+        if (pursuit.ticks < 0)
+            continue;
+        ticks.push_back(pursuit.ticks);
+        total_ticks += pursuit.ticks;
+        total_fuel += pursuit.fuel_burned;
+    }
+    sort(ticks.begin(), ticks.end());
+    int num_engaged = int(ticks.size());
+
+    os << "  \"pursuit\": {";
+    bool first = true;
+    write_field(os, first, "torpedo_boats", pursuits.size());
+    write_field(os, first, "engaged", num_engaged);
+    write_field(os, first, "mean_ticks", num_engaged > 0 ? total_ticks / num_engaged : 0.);
+    write_field(os, first, "p50_ticks", get_percentile(ticks, 0.5));
+    write_field(os, first, "max_ticks", num_engaged > 0 ? ticks.back() : 0.);
+    write_field(os, first, "mean_fuel_tons", num_engaged > 0 ? total_fuel / num_engaged : 0.);
+    os << "\n  },\n";
+}
+
+// Measure the Island tour that the cruises go round
+static void measure_cruise(ostream& os, const Bench_settings& settings)
+{
+    const int num_plans = 10;
+
+    Model model;
+    mt19937 generator(settings.seed);
+    add_islands(model, settings, generator);
+    vector<Point> locations;
+    for (const auto& island_ptr : model.get_islands())
+        locations.push_back(island_ptr->get_location());
+
+    Tour_planner planner;
+    Clock::time_point start = Clock::now();
+    for (int plan = 0; plan < num_plans; ++plan)
+        planner.plan(locations);
+    double seconds = seconds_since(start);
+
+    double greedy_length = planner.get_greedy_length();
+    double shorter = greedy_length > 0. ? 100. * (1. - planner.get_length() / greedy_length) : 0.;
+    os << "  \"cruise\": {";
+    bool first = true;
+    write_field(os, first, "islands", locations.size());
+    write_field(os, first, "greedy_nm", greedy_length);
+    write_field(os, first, "planned_nm", planner.get_length());
+    write_field(os, first, "shorter_percent", shorter);
+    write_field(os, first, "plan_ms", seconds / num_plans * 1e3);
+    os << "\n  },\n";
+}
+
+// Measure the heap bytes the Ships take, with everything they need in the Model
+static void measure_memory(ostream& os, const Bench_settings& settings)
+{
+    Model model;
+    mt19937 generator(settings.seed);
+    add_islands(model, settings, generator);
+
+    long long bytes_before = live_heap_bytes;
+    vector<shared_ptr<Ship>> ships = add_ships(model, settings, generator);
+    long long bytes = live_heap_bytes - bytes_before;
+
+    os << "  \"memory\": {";
+    bool first = true;
+    write_field(os, first, "ships", ships.size());
+    write_field(os, first, "heap_bytes", bytes);
+    write_field(os, first, "heap_bytes_per_ship", ships.empty() ? 0. : double(bytes) / ships.size());
+    os << "\n  }\n";
+}
+
+// Run every measurement and write the results as a JSON object to os
+static void run_bench(ostream& os, const Bench_settings& settings)
+{
+    for (int category = 0; category < num_log_categories; ++category)
+        Logger::get_instance().set_category_enabled(static_cast<Log_category>(category), false);
+
+    os.precision(6);
+    os << "{\n  \"settings\": {";
+    bool first = true;
+    write_field(os, first, "islands", settings.num_islands);
+    write_field(os, first, "ships_per_type", settings.ships_per_type);
+    write_field(os, first, "ticks", settings.num_ticks);
+    write_field(os, first, "draws", settings.num_draws);
+    write_field(os, first, "group_repeats", settings.group_repeats);
+    write_field(os, first, "seed", settings.seed);
+    write_field(os, first, "threads", Thread_pool::get_instance().get_num_threads());
+    os << "\n  },\n";
+
+    measure_update(os, settings);
+    measure_draw(os, settings);
+    measure_group(os, settings);
+    measure_create(os, settings);
+    measure_cpa(os, settings);
+    measure_pursuit(os, settings);
+    measure_cruise(os, settings);
+    measure_memory(os, settings);
+    os << "}" << endl;
+}
+
+/*** Arguments ***/
+
+// Read a whole non-negative number from arg into value; return false if arg is not one
+static bool read_count(const char* arg, long& value)
+{
+    char* end;
+    value = strtol(arg, &end, 10);
+    return *arg != '\0' && *end == '\0' && value >= 0 && value <= 1000000000;
+}
+
+// Read the options into settings; return false if they are not valid
+static bool read_arguments(int argc, char* argv[], Bench_settings& settings)
+{
+    const pair<const char*, int*> counts[] = {
+        {"--islands", &settings.num_islands},
+        {"--ships", &settings.ships_per_type},
+        {"--ticks", &settings.num_ticks},
+        {"--draws", &settings.num_draws},
+        {"--group-repeats", &settings.group_repeats},
+    };
+
+    for (int i = 1; i < argc; i += 2) {
+        if (i + 1 == argc)
+            return false;
+        if (strcmp(argv[i], "--output") == 0) {
+            settings.output = argv[i + 1];
+            continue;
+        }
+
+        long value;
+        if (!read_count(argv[i + 1], value))
+            return false;
+        if (strcmp(argv[i], "--seed") == 0) {
+            settings.seed = static_cast<unsigned int>(value);
+            continue;
+        }
+        auto count
+            = find_if(begin(counts), end(counts), [&](const auto& pair) { return strcmp(argv[i], pair.first) == 0; });
+        if (count == end(counts))
+            return false;
+        *count->second = static_cast<int>(value);
+    }
+    return settings.ships_per_type > 0;
+}
+
+int main(int argc, char* argv[])
+{
+    Bench_settings settings{50, 200, 500, 100, 20, 1, nullptr};
+    if (!read_arguments(argc, argv, settings)) {
+        cout << "Usage: " << argv[0]
+             << " [--islands <islands>] [--ships <ships per type>] [--ticks <ticks>] [--draws <draws>]" << endl;
+        cout << "       [--group-repeats <repeats>] [--seed <seed>] [--output <file>]" << endl;
+        return 1;
+    }
+
+    try {
+        if (!settings.output) {
+            run_bench(cout, settings);
+            return 0;
+        }
+
+        ofstream file(settings.output);
+        if (!file)
+            throw Error("Cannot open output file!");
+        run_bench(file, settings);
+        if (!file)
+            throw Error("Cannot write output file!");
+    } catch (std::exception& error) {
+        cout << error.what() << endl;
+        return 1;
+    }
+    return 0;
+}
@@ -17,10 +17,18 @@ fuel consumption 4.tons/nm, resistance 1.
 #include <memory>
 #include <string>
 
+struct Chain_ship_record;
+
 class Chain_ship : public Ship
 {
 public:
-    Chain_ship(const std::string& name_, Point position_);
+    Chain_ship(Model& model_, const std::string& name_, Point position_);
+
+    // Chain_ships can chain other Ships
+    unsigned int get_capabilities() const override
+    {
+        return can_chain;
+    }
 
     // Chain every other Ship in the simulation world.
     void chain_all_ship() override;
@@ -33,9 +41,19 @@ public:
     // Throws an Error ship_to_unchain is not chained to this Ship.
     void unchain_ship(std::shared_ptr<Ship> ship_to_unchain) override;
 
+    // A Ship can be chained only once, and unchained only if it was chained
+    const char* check_chain(std::shared_ptr<Ship> target_to_chain) const override;
+    const char* check_unchain(std::shared_ptr<Ship> ship_to_unchain) const override;
+
     // Update the state of Chain_ship
     void update() override;
 
+    // A Chain_ship that is chasing a Ship, or has a chained Ship to drop,
+    // must be updated; otherwise it can be advanced like any Ship until
+    // one of its chained Ships has an event that might stop it.
+    int ticks_until_event() const override;
+    Event_type get_event_type() const override;
+
     // Output a description of current state to cout
     void describe() const override;
 
@@ -54,10 +72,18 @@ public:
     // This Ship's chained Ships also take hit
     void receive_hit(int hit_force, std::shared_ptr<Ship> attacker_ptr) override;
 
+    // Add this Chain_ship's record to a checkpoint
+    void save(Checkpoint_writer& writer) const override;
+    // Set this Chain_ship's chained Ships and chasing from a checkpoint record
+    // Throws Error if the record is not valid.
+    void restore(const Chain_ship_record& record, const Checkpoint_reader& reader);
+
 private:
-    std::map<std::string, std::shared_ptr<Ship>> chained_ship;
-    std::map<std::string, std::shared_ptr<Ship>> map_of_ship_to_chain;
-    std::shared_ptr<Ship> ship_to_chain;
+    // Keyed by the Ships' ids, in name order. A Ship that has sunk resolves
+    // to nullptr, and is dropped on the next update.
+    std::map<Object_id, Object_handle, Name_order> chained_ship;
+    std::map<Object_id, Object_handle, Name_order> map_of_ship_to_chain;
+    Object_handle ship_to_chain;
 
     Point location_of_ship_to_chain;
     int num_of_ship_needed_to_chain, num_of_ship_chained;
@@ -0,0 +1,288 @@
+/*
+A checkpoint is a snapshot of the whole simulated world - the time, the
+Islands, every Ship with its movement and the state of its kind of Ship, and
+the groups - that the save command writes to a file and the load command
+reads back, so that a long run can be resumed or several runs started from
+the same point.
+
+Each object writes itself into a Checkpoint_writer with Sim_object::save and
+is rebuilt from its record by a Checkpoint_reader. Every name is written once,
+in a string table. Instead of by pointer, records refer to an Island by the
+index of its name in that table and to a Ship by its number, the order in
+which the writer first came across it; -1 means none. A Ship that has sunk is
+no longer in the world, but a group may still hold on to it, so every such
+Ship is written too, and is read back sunk and outside the world; a handle
+to it, as a Warship's target, is written as none. (A new Ship may since have been given its name, which is why Ships
+are not referred to by name.) The types of Ship are told apart by table, so
+only the state is saved; what every Ship of a type has in common - capacity,
+speed, firepower and so on - comes from its constructor.
+
+The file is the header below followed by these sections, with no padding
+between them, all in little-endian byte order:
+    string offsets  uint32 x (num_strings + 1), the last one being the total length
+    string bytes    the names, one after the other, without terminators
+    Island_record x num_islands, then Warship_record x num_cruisers,
+    Torpedo_boat_record x num_torpedo_boats, Tanker_record x num_tankers,
+    Cruise_ship_record x num_cruise_ships, Chain_ship_record x num_chain_ships,
+    Group_record x num_groups
+    links           uint32 x num_links: the lists of Island names and Ship numbers
+                    that records refer to by first index and count; the
+                    cruises that go round the same Island tour share its list
+The records have a fixed size, so each table is read with a single copy.
+*/
+
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include "Sim_object.h"
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class Island;
+class Model;
+class Ship;
+class Ship_component;
+
+const std::uint32_t checkpoint_version = 3;
+
+struct Checkpoint_header
+{
+    char magic[8];  // "SHIPSIM" and a terminating zero
+    std::uint32_t version;
+    std::int32_t time;
+    std::uint32_t num_strings;
+    std::uint32_t string_bytes;
+    std::uint32_t num_islands;
+    std::uint32_t num_cruisers;
+    std::uint32_t num_torpedo_boats;
+    std::uint32_t num_tankers;
+    std::uint32_t num_cruise_ships;
+    std::uint32_t num_chain_ships;
+    std::uint32_t num_groups;
+    std::uint32_t num_links;
+};
+
+struct Island_record
+{
+    double x, y;
+    double fuel, production_rate;
+    std::uint32_t name;
+    std::uint8_t padding[4];
+};
+
+struct Ship_record
+{
+    double x, y;
+    double course, speed;
+    double fuel;
+    double destination_x, destination_y;
+    std::uint32_t name;
+    std::uint32_t number;
+    std::int32_t resistance;
+    std::int32_t destination_island;
+    std::int32_t docked_island;
+    std::uint8_t state;  // Ship_state
+    std::uint8_t padding[3];
+};
+
+// Cruisers, and the Warship part of Torpedo_boats
+struct Warship_record
+{
+    Ship_record ship;
+    std::int32_t target;
+    std::uint8_t attacking;
+    std::uint8_t padding[3];
+};
+
+struct Torpedo_boat_record
+{
+    Warship_record warship;
+    double planned_course;
+    double planned_target_course, planned_target_speed;
+    std::uint8_t intercepting;
+    std::uint8_t padding[7];
+};
+
+struct Tanker_record
+{
+    Ship_record ship;
+    double cargo;
+    std::int32_t load_destination;
+    std::int32_t unload_destination;
+    std::uint8_t tanker_state;
+    std::uint8_t padding[7];
+};
+
+struct Cruise_ship_record
+{
+    Ship_record ship;
+    double starting_speed;
+    std::int32_t island_to_visit;
+    std::int32_t starting_island;
+    std::int32_t island_visited;  // the number of Islands docked at so far
+    std::uint32_t first_itinerary_island;  // the names of the Islands of the cruise's tour, in order, are links
+    std::uint32_t num_itinerary_islands;
+    std::uint8_t cruise_state;
+    std::uint8_t padding[3];
+};
+
+struct Chain_ship_record
+{
+    Ship_record ship;
+    double location_of_ship_to_chain_x, location_of_ship_to_chain_y;
+    std::int32_t ship_to_chain;
+    std::int32_t num_of_ship_needed_to_chain;
+    std::int32_t num_of_ship_chained;
+    std::uint32_t first_chained_ship;  // the chained Ships are links
+    std::uint32_t num_chained_ships;
+    std::uint32_t first_ship_to_chain;  // so are the Ships still to chain
+    std::uint32_t num_ships_to_chain;
+    std::uint8_t chain_state;
+    std::uint8_t padding[3];
+};
+
+// Groups come in preorder, so a group's parent always comes before it
+struct Group_record
+{
+    std::uint32_t name;
+    std::int32_t parent;  // index of the parent group, -1 for a top group
+    std::uint32_t first_member;  // the numbers of the Ships in the group are links
+    std::uint32_t num_members;
+};
+
+class Checkpoint_writer
+{
+public:
+    // Return the index of name in the string table, adding it if needed
+    std::uint32_t get_id(const std::string& name);
+
+    // Return the index of the Island's name, or -1 for nullptr
+    std::int32_t get_island_id(const Island* island);
+
+    // Return the Ship's number, giving it the next one if it has none yet; -1 for nullptr
+    std::int32_t get_ship_id(const Ship* ship);
+
+    // Return the number of a Ship that is writing its own record now
+    std::uint32_t add_ship(const Ship* ship);
+
+    // Have every Ship that has been given a number but has not written its
+    // record - a sunk Ship something still refers to - write it
+    void add_referenced_ships();
+
+    // Add a list of names or Ship numbers to the links and return the index of the first
+    std::uint32_t add_links(const std::vector<std::uint32_t>& ids);
+
+    // Add the list that get_ids returns to the links the first time it is added
+    // for key, and return the index of its first link, then and every time after
+    std::uint32_t add_shared_links(const void* key, const std::function<std::vector<std::uint32_t>()>& get_ids);
+
+    // Add a group under the group at index parent (-1 for none) and return its index
+    int add_group(const std::string& name, int parent);
+
+    // Add a Ship to the group at index group
+    void add_group_member(int group, const Ship* ship);
+
+    std::vector<Island_record> islands;
+    std::vector<Warship_record> cruisers;
+    std::vector<Torpedo_boat_record> torpedo_boats;
+    std::vector<Tanker_record> tankers;
+    std::vector<Cruise_ship_record> cruise_ships;
+    std::vector<Chain_ship_record> chain_ships;
+
+    // Write everything added, with the given time, to the file.
+    // Throws Error if the file cannot be written.
+    void write(const std::string& filename, int time) const;
+
+private:
+    std::vector<std::string> strings;
+    std::unordered_map<std::string, std::uint32_t> string_ids;
+    std::unordered_map<const Ship*, std::int32_t> ship_ids;
+    std::vector<const Ship*> ships;  // by number
+    std::vector<bool> ship_added;  // by number
+    std::vector<Group_record> groups;
+    std::vector<std::vector<std::uint32_t>> group_members;
+    std::vector<std::uint32_t> links;
+    std::unordered_map<const void*, std::uint32_t> shared_links;  // by key, the first link
+};
+
+class Checkpoint_reader
+{
+public:
+    // Read and check a checkpoint file.
+    // Throws Error if it cannot be read or is not a valid checkpoint.
+    explicit Checkpoint_reader(const std::string& filename);
+
+    int get_time() const
+    {
+        return time;
+    }
+
+    // Build the objects in the checkpoint, in model, into the given containers,
+    // which must be empty. Sunk Ships are made but not put in the containers.
+    // Throws Error if the records are not consistent.
+    void create_objects(Model& model,
+        std::map<std::string, std::shared_ptr<Island>>& islands,
+        std::map<std::string, std::shared_ptr<Ship>>& ships,
+        std::map<std::string, std::shared_ptr<Ship_component>>& groups,
+        std::set<std::string>& group_names);
+
+    /* Used by the objects to restore their links */
+    // Return the Island whose name has this index, or the Ship with this number;
+    // nullptr for -1. Throws Error if there is no such Island or Ship.
+    std::shared_ptr<Island> get_island(std::int32_t id) const;
+    std::shared_ptr<Ship> get_ship(std::int32_t id) const;
+
+    // Return a handle to the Island or Ship, as above; the default handle for -1
+    // and for a sunk Ship, which will not be in the world
+    Object_handle get_island_handle(std::int32_t id) const;
+    Object_handle get_ship_handle(std::int32_t id) const;
+
+    // Return the names of a list in the links.
+    // Throws Error if the list is not in the links.
+    std::vector<std::string> get_link_names(std::uint32_t first, std::uint32_t count) const;
+
+    // Return the Ships of a list of Ship numbers in the links.
+    // Throws Error if the list is not in the links or a number is not a Ship's.
+    std::vector<std::shared_ptr<Ship>> get_link_ships(std::uint32_t first, std::uint32_t count) const;
+
+    // Return the Islands of a list of Island names in the links, as handles; a
+    // list is made once, and shared by every record that refers to it.
+    // Throws Error if the list is not in the links or a name is not an Island's.
+    std::shared_ptr<const std::vector<Object_handle>> get_link_island_handles(std::uint32_t first,
+        std::uint32_t count) const;
+
+    // Return the name with this index.
+    // Throws Error if there is none.
+    const std::string& get_name(std::uint32_t id) const;
+
+private:
+    int time;
+    std::vector<std::string> strings;
+    std::vector<Island_record> island_records;
+    std::vector<Warship_record> cruiser_records;
+    std::vector<Torpedo_boat_record> torpedo_boat_records;
+    std::vector<Tanker_record> tanker_records;
+    std::vector<Cruise_ship_record> cruise_ship_records;
+    std::vector<Chain_ship_record> chain_ship_records;
+    std::vector<Group_record> group_records;
+    std::vector<std::uint32_t> links;
+
+    // The objects created, the Islands by the index of their name and the Ships by number
+    std::vector<std::shared_ptr<Island>> islands_by_id;
+    std::vector<std::shared_ptr<Ship>> ships_by_id;
+
+    // The lists made by get_link_island_handles, by first link and count
+    mutable std::map<std::pair<std::uint32_t, std::uint32_t>, std::shared_ptr<const std::vector<Object_handle>>>
+        island_handle_lists;
+
+    // Check that a list is in the links
+    void check_links(std::uint32_t first, std::uint32_t count) const;
+};
+
+#endif
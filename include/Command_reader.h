@@ -0,0 +1,96 @@
+/*
+A Command_reader supplies the words and numbers that make up Controller's
+commands, so that Controller can take its commands either interactively from
+a stream or in a batch from a script.
+
+Stream_reader reads from an istream with operator>>, exactly the way the
+interactive Controller always has.
+
+Mapped_reader reads a whole script at once. A script file is memory-mapped
+(standard input is read into a buffer if it cannot be mapped) and split into
+words in place: read_word returns a string_view into the mapped text, and
+numbers are parsed directly from it without going through a stream. A number
+is recognized the same way operator>> recognizes it, and has the same value.
+*/
+
+#ifndef COMMAND_READER_H
+#define COMMAND_READER_H
+
+#include <cstddef>
+#include <iosfwd>
+#include <string>
+#include <string_view>
+
+class Command_reader
+{
+public:
+    virtual ~Command_reader()
+    { }
+
+    // Return the next whitespace-delimited word, or an empty string_view at the end
+    // of the input. The word is only valid until the next call to the reader.
+    virtual std::string_view read_word() = 0;
+
+    // Read an int or a double into value; return false if the input does not
+    // start with one.
+    virtual bool read_int(int& value) = 0;
+    virtual bool read_double(double& value) = 0;
+
+    // Return true if nothing but spaces and tabs is left on the current line,
+    // so that a command can tell whether an optional argument was given.
+    virtual bool at_end_of_line() = 0;
+
+    // Discard the rest of the current line
+    virtual void skip_line() = 0;
+};
+
+class Stream_reader : public Command_reader
+{
+public:
+    explicit Stream_reader(std::istream& is_)
+        : is(is_)
+    { }
+
+    std::string_view read_word() override;
+    bool read_int(int& value) override;
+    bool read_double(double& value) override;
+    bool at_end_of_line() override;
+    void skip_line() override;
+
+private:
+    std::istream& is;
+    std::string word;
+};
+
+class Mapped_reader : public Command_reader
+{
+public:
+    // Map the named file, or standard input if filename is "-".
+    // Throws Error if the file cannot be read.
+    explicit Mapped_reader(const std::string& filename);
+    ~Mapped_reader();
+
+    std::string_view read_word() override;
+    bool read_int(int& value) override;
+    bool read_double(double& value) override;
+    bool at_end_of_line() override;
+    void skip_line() override;
+
+    // disallow copy/move construction or assignment
+    Mapped_reader(Mapped_reader& obj) = delete;
+    Mapped_reader(Mapped_reader&& obj) = delete;
+    Mapped_reader& operator=(Mapped_reader& obj) = delete;
+    Mapped_reader& operator=(Mapped_reader&& obj) = delete;
+
+private:
+    const char* pos;  // next character to read
+    const char* end;
+
+    void* mapping;  // nullptr if the text is in buffer instead
+    std::size_t mapping_size;
+    std::string buffer;
+
+    void skip_whitespace();
+};
+
+#endif
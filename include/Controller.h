@@ -10,22 +10,53 @@ with the user.
 #include <memory>
 #include <set>
 #include <functional>
+#include <string>
 #include <vector>
 
+class Command_reader;
+class Map_view;
+class Model;
+class Ship;
 class Ship_component;
 class View;
 
 class Controller
 {
 public:
-    // Initialize command maps
+    // Initialize command maps; the commands work on Model::get_instance()
     Controller();
 
+    // Initialize command maps for commands that work on the given Model.
+    // A quiet Controller writes nothing, so that several can run at once: the
+    // commands that write - status, describe_groups, stats, and the View commands - are
+    // skipped, and so are the log commands, which set up the Logger of the whole
+    // program; and failed commands are only counted.
+    Controller(Model& model_, bool quiet_);
+
     // Run the program by acccepting user commands
     void run();
 
+    // Run the commands in a script file ("-" for standard input) without prompting,
+    // then report how many commands and ticks were run and how fast.
+    // Throws Error if the script cannot be read.
+    void run_script(const std::string& filename);
+
+    // Run the commands from a reader without prompting or reporting on them.
+    // Return the number of commands that failed.
+    int run_batch(Command_reader& reader_);
+
 private:
-    std::shared_ptr<View> map_view_ptr;
+    Model& model;
+    bool quiet;
+
+    // Where commands are read from while running
+    Command_reader* reader;
+    int num_failed_commands;
+
+    // A View command has run since the frames were last written out
+    bool frames_pending;
+
+    std::shared_ptr<Map_view> map_view_ptr;
     std::shared_ptr<View> sailing_view_ptr;
     std::map<std::string, std::shared_ptr<View>> local_view_ptr_map;
     std::vector<std::shared_ptr<View>> view_vec;
@@ -83,20 +114,61 @@ private:
     // If the View is not open, throw an Error.
     void view_pan() const;
 
+    // read "on" or "off" to turn live mode of the map on or off: the map is then
+    // drawn with terminal escape sequences, and after the first time only its
+    // changed rows are. If the View is not open, throw an Error.
+    void view_live() const;
+
     // tell the View to draw the map ? note that the Model and the objects
     // should have kept the View up to date by calling the relevant update
     // functions.If the View is not open, throw an Error.
     void view_show() const;
 
+    // read "block" or "drop", and the number of drawn frames that may wait to
+    // be written out (see View_renderer.h)
+    void view_render_policy() const;
+
     // Model commands
 
     // have all the objects describe themselves; the output should be in
     // alphabetical order by name of all of the objects.
     void model_status() const;
 
-    // call the Model::update() function
+    // call the Model::update() function, or if a number of ticks follows
+    // on the same line, update that many times
     void model_go() const;
 
+    // read a time and update until the Model reaches it
+    void model_run_until() const;
+
+    // read "serial", "parallel" or "event" to choose how Model::update() runs
+    void model_update_mode() const;
+
+    // read "debug", "info", "warning" or "error"; keep log messages of that level and above
+    void model_log_level() const;
+
+    // read a category ("movement", "fuel", "combat", "docking", "general" or "all")
+    // and "on" or "off" to keep or drop its log messages
+    void model_log_category() const;
+
+    // read a file name to also write the log to in binary, or "off" to stop
+    void model_log_binary() const;
+
+    // write how long each part of a tick takes, and the counts per tick (see Profiler.h).
+    // If the profiler is not built in, throw an Error.
+    void model_stats() const;
+
+    // read a range in nm and a time in hours, and write every pair of Ships that
+    // will come within that range of each other in that time, soonest first, if
+    // they hold their course and speed (see Model::screen_cpa)
+    void model_cpa_report() const;
+
+    // read a file name and write a checkpoint of the world to it
+    void model_save() const;
+
+    // read a file name and replace the world with the checkpoint in it
+    void model_load() const;
+
     // create a new Ship using the supplied name, type name, and initial position.
     void model_create() const;
 
@@ -123,60 +195,90 @@ private:
     // read a compass heading and a speed (both doubles) for the
     // Ship to set course and speed. basic validity check:
     // 0.0 <= compass heading < 360.0, speed >= 0.0
-    void ship_course(std::shared_ptr<Ship_component> const ship_ptr) const;
+    void ship_course(std::shared_ptr<Ship_component> const ship_ptr);
 
     // read an (x, y) position and then a speed (all doubles) for
     // the Ship to set destination position and speed to go to.
     // basic validity check : x, y can have any value, speed >= 0.0
-    void ship_position(std::shared_ptr<Ship_component> const ship_ptr) const;
+    void ship_position(std::shared_ptr<Ship_component> const ship_ptr);
 
     // read an Island name and a speed (a double) for the ship
     // to set destination Island and speed. basic validity check
     // : Island must exist, speed >= 0.0
-    void ship_destination(std::shared_ptr<Ship_component> const ship_ptr) const;
+    void ship_destination(std::shared_ptr<Ship_component> const ship_ptr);
 
     // read an Island name to load at.
     // basic validity check : Island must exist
-    void ship_load_at(std::shared_ptr<Ship_component> const ship_ptr) const;
+    void ship_load_at(std::shared_ptr<Ship_component> const ship_ptr);
 
     // read an Island name to unload at.
     // basic validity check : Island must exist
-    void ship_unload_at(std::shared_ptr<Ship_component> const ship_ptr) const;
+    void ship_unload_at(std::shared_ptr<Ship_component> const ship_ptr);
 
     // Chain other Ships in the simulation world
-    void ship_chain_all_ship(std::shared_ptr<Ship_component> const ship_ptr) const;
+    void ship_chain_all_ship(std::shared_ptr<Ship_component> const ship_ptr);
 
     // Chain a Ship to a Chain_ship so that when Chain_ship sets its destination or course,
     // its chained Ships do the same.
     // check : ship_ptr exists
-    void ship_chain_ship(std::shared_ptr<Ship_component> const ship_ptr) const;
+    void ship_chain_ship(std::shared_ptr<Ship_component> const ship_ptr);
 
     // Unchain a Ship from a Chain_ship.
     // check: ship_ptr exists
-    void ship_unchain_ship(std::shared_ptr<Ship_component> const ship_ptr) const;
+    void ship_unchain_ship(std::shared_ptr<Ship_component> const ship_ptr);
 
     // read an Island name to dock at.
     // basic validity check : Island must exist
-    void ship_dock_at(std::shared_ptr<Ship_component> const ship_ptr) const;
+    void ship_dock_at(std::shared_ptr<Ship_component> const ship_ptr);
 
     // read a Ship name to attack.
     // basic validity check : Ship must exist
-    void ship_attack(std::shared_ptr<Ship_component> const ship_ptr) const;
+    void ship_attack(std::shared_ptr<Ship_component> const ship_ptr);
 
     // refuel a Ship
-    void ship_refuel(std::shared_ptr<Ship_component> const ship_ptr) const;
+    void ship_refuel(std::shared_ptr<Ship_component> const ship_ptr);
 
     // stop a Ship
-    void ship_stop(std::shared_ptr<Ship_component> const ship_ptr) const;
+    void ship_stop(std::shared_ptr<Ship_component> const ship_ptr);
 
     // stop a Ship from attacking
-    void ship_stop_attack(std::shared_ptr<Ship_component> const ship_ptr) const;
+    void ship_stop_attack(std::shared_ptr<Ship_component> const ship_ptr);
 
     /*** Helper Functions ***/
 
+    // Read and run commands until "quit" or the end of the input, prompting
+    // for each one if prompt is true. Return the number of commands read.
+    int run_commands(bool prompt);
+
+    // Skip the rest of a command that a quiet Controller does not run
+    void skip_command();
+
+    // Flush the Logger and write out the frames the Views have drawn, so that
+    // what is written next comes after them; wait for every frame if wait_all
+    // is true (see View_renderer::write_frames)
+    void flush_output(bool wait_all) const;
+
+    // Read the next word of a command
+    std::string read_word() const;
+
+    // Read an integer; throw Error("Expected an integer!") if there is none
+    int read_int() const;
+
+    // Read a double; throw Error("Expected a double!") if there is none
+    double read_double() const;
+
     void check_if_name_valid(const std::string& name) const;
 
     void process_ship_command(std::shared_ptr<Ship_component> const ptr);
+
+    // Give a command to a Ship or a group. A quiet Controller gives it to a Ship with the
+    // try_ form of the command, and counts a failure without an Error being thrown;
+    // otherwise the command is called, and a Ship that cannot carry it out throws Error.
+    template <typename... Params, typename... Args>
+    void give_ship_command(Ship_component& target,
+        const char* (Ship::*try_command)(Params...),
+        void (Ship_component::*command)(Params...),
+        const Args&... args);
 };
 
 #endif
\ No newline at end of file
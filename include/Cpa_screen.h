@@ -0,0 +1,143 @@
+/*
+Cpa_screen finds, among many tracks, the pairs whose closest point of approach
+(CPA) within a time horizon is nearer than a range, if every track holds its
+course and speed. A track is an object's position and its velocity in nm per
+hour; the screen is given the tracks, and then screens them against each
+other, or one more track against them.
+
+Screening all the pairs is done in two phases. The broad phase puts the box
+that each track sweeps over the horizon, grown by half the range on every
+side, into a uniform grid, and keeps only the pairs whose boxes overlap: two
+tracks that come within the range of each other must both be inside the
+boxes' overlap at that moment. The grid is made again for each screen, as
+arrays indexed by cell (the tracks of each cell following one another in one
+array), with a cell about the size of an average box, so that a box covers
+only a few cells. A pair whose boxes share more than one cell is taken only
+in the cell that holds the low corner of their overlap, so each pair is found
+once. Pairs of tracks that are both stationary are never taken: they stay as
+far apart as they are. The grid works on a copy of the tracks sorted by the
+cell their box starts in, so that the tracks looked at together are mostly
+near each other in memory rather than in the order they were added.
+
+The narrow phase computes the CPA of the pairs that are left in batches, with
+the vectorized closest_approaches kernel (see Kinematics.h), and keeps those
+whose CPA range is less than the range.
+
+A Cpa_screen keeps its arrays from one screen to the next, so a screen that
+is no larger than the ones before it allocates nothing but its results.
+*/
+
+#ifndef CPA_SCREEN_H
+#define CPA_SCREEN_H
+
+#include "Geometry.h"
+#include "Name_table.h"
+#include <vector>
+
+// Two tracks that come within range of each other: they are closest time
+// hours from now, range nm apart
+struct Cpa_pair
+{
+    Object_id id1;
+    Object_id id2;
+    double time;
+    double range;
+};
+
+class Cpa_screen
+{
+public:
+    Cpa_screen();
+
+    // Remove every track
+    void clear();
+
+    // Add the track of an object at position with velocity in nm per hour
+    void add_track(Object_id id, Point position, Cartesian_vector velocity);
+
+    int get_num_tracks() const
+    {
+        return static_cast<int>(ids.size());
+    }
+
+    // Add to pairs every pair of the tracks that come within range of each
+    // other in the next hours, in no particular order; a pair's id1 is that of
+    // the track added first. range must be positive and hours not negative.
+    void screen(double range, double hours, std::vector<Cpa_pair>& pairs);
+
+    // Add to pairs every track that comes within range in the next hours of the
+    // object id at position with velocity, in the order they were added, as a
+    // pair whose id1 is id. A track that has id itself is passed over.
+    void screen_track(Object_id id,
+        Point position,
+        Cartesian_vector velocity,
+        double range,
+        double hours,
+        std::vector<Cpa_pair>& pairs);
+
+    // disallow copy/move construction or assignment
+    Cpa_screen(Cpa_screen& obj) = delete;
+    Cpa_screen(Cpa_screen&& obj) = delete;
+    Cpa_screen& operator=(Cpa_screen& obj) = delete;
+    Cpa_screen& operator=(Cpa_screen&& obj) = delete;
+
+private:
+    // How many pairs go through the narrow phase at once
+    static constexpr int batch_size = 512;
+
+    // The tracks
+    std::vector<Object_id> ids;
+    std::vector<double> x, y, velocity_x, velocity_y;
+
+    // The grid: the tracks whose boxes cover cell c are cell_tracks[cell_starts[c]]
+    // up to cell_tracks[cell_starts[c + 1]], the moving ones first
+    double grid_x, grid_y;  // the low corner of the grid
+    double cell_scale;  // cells per nm
+    int num_cells_x, num_cells_y;
+    std::vector<int> cell_starts;
+    std::vector<int> cell_num_moving;
+    std::vector<int> cell_tracks;
+    std::vector<int> cell_next;  // while filling, where the next track of each cell goes
+
+    // The tracks sorted by the cell their box starts in, which cell_tracks refers to:
+    // where each was added, its position and velocity, and the box it sweeps, grown by half the range
+    std::vector<int> sorted_tracks;
+    std::vector<double> sorted_x, sorted_y, sorted_velocity_x, sorted_velocity_y;
+    std::vector<double> box_min_x, box_min_y, box_max_x, box_max_y;
+
+    // The batch of pairs waiting for the narrow phase, as their ids and their
+    // relative position and velocity, and the kernel's results for them
+    std::vector<Object_id> candidate_id1, candidate_id2;
+    std::vector<double> candidate_dx, candidate_dy, candidate_dvx, candidate_dvy;
+    std::vector<double> candidate_time, candidate_range_squared;
+    int num_candidates;
+
+    bool is_moving(int track) const
+    {
+        return velocity_x[track] != 0. || velocity_y[track] != 0.;
+    }
+
+    // Sort the tracks, compute their boxes, and fill the grid with them
+    void build_grid(double range, double hours);
+
+    // Return the column or row of the grid that holds a coordinate of a box
+    int to_cell_x(double coordinate) const;
+    int to_cell_y(double coordinate) const;
+
+    // Add the pair of a track at position1 with velocity1 and one at position2
+    // with velocity2 to the batch, and check the batch if it is full
+    void add_candidate(Object_id id1,
+        Point position1,
+        Cartesian_vector velocity1,
+        Object_id id2,
+        Point position2,
+        Cartesian_vector velocity2,
+        double range_squared,
+        double hours,
+        std::vector<Cpa_pair>& pairs);
+
+    // Run the narrow phase on the batch, add the pairs that come within range to pairs, and empty it
+    void check_candidates(double range_squared, double hours, std::vector<Cpa_pair>& pairs);
+};
+
+#endif
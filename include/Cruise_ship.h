@@ -3,6 +3,12 @@ A Cruise_ship can automatically visit all of the islands in a
 leisurely fashion. It behaves like a normal ship until you
 tell it to go to an island with the "destination" command.
 
+The itinerary is settled when the cruise is: the Islands in the order of the
+Model's Island tour, starting from the Island the Cruise_ship was sent to (see
+Model::get_island_tour). It is shared with the other cruises, so the
+Cruise_ship keeps only where its starting Island is in it and how many
+Islands it has docked at. Islands added during the cruise are not on it.
+
 Initial values:
 fuel capacity and initial amount 500 tons, maximum speed 15.,
 fuel consumption 2.tons/nm, resistance 0.
@@ -16,17 +22,30 @@ fuel consumption 2.tons/nm, resistance 0.
 #include <string>
 #include <vector>
 
+struct Cruise_ship_record;
+
 class Cruise_ship : public Ship
 {
 public:
-    Cruise_ship(const std::string& name_, Point position_);
+    Cruise_ship(Model& model_, const std::string& name_, Point position_);
 
     // Update the state of Cruise_ship
     void update() override;
 
+    // A Cruise_ship that is docking, refueling, or choosing its next Island
+    // must be updated; otherwise it can be advanced like any Ship.
+    int ticks_until_event() const override;
+    Event_type get_event_type() const override;
+
     // Output a description of current state to cout
     void describe() const override;
 
+    // Add this Cruise_ship's record to a checkpoint
+    void save(Checkpoint_writer& writer) const override;
+    // Set this Cruise_ship's cruise from a checkpoint record
+    // Throws Error if the record is not valid.
+    void restore(const Cruise_ship_record& record, const Checkpoint_reader& reader);
+
     // When Cruise_ship is cruising, cancel it.
     void set_destination_position_and_speed(Point destination_point, double speed) override;
 
@@ -41,12 +60,18 @@ public:
     // Cancel cruise if Cruise_ship was cruising.
     void stop() override;
 
+    // A cruising Cruise_ship cancels its cruise even if it then refuses the
+    // command, so it is never known in advance to refuse.
+    const char* check_move(double speed) const override;
+    const char* check_stop() const override;
+
 private:
-    // Bool vector to indicate which islands have been visited.
-    std::vector<bool> visited_vec;
+    // The Islands of the cruise, and where the starting Island is in it
+    std::shared_ptr<const std::vector<Object_handle>> itinerary;
+    int itinerary_start;
 
     // Indicates which Island to visit during the cruise.
-    std::shared_ptr<Island> island_to_visit;
+    Object_handle island_to_visit;
 
     // An Island pointer to remember where the cruise started
     std::shared_ptr<Island> starting_island;
@@ -62,7 +87,7 @@ private:
     };
 
     Cruise_ship_state state;
-    int island_visited;
+    int island_visited;  // the number of Islands docked at so far
     double starting_speed;
 
     void cancel_cruise_and_print();
@@ -29,7 +29,7 @@ class Cruiser : public Warship
 {
 public:
     // initialize, then output constructor message
-    Cruiser(const std::string& name_, Point position_);
+    Cruiser(Model& model_, const std::string& name_, Point position_);
 
     // perform Cruiser-specific behavior
     void update() override;
@@ -39,6 +39,9 @@ public:
 
     // respond to an attack
     void receive_hit(int hit_force, std::shared_ptr<Ship> attacker_ptr) override;
+
+    // Add this Cruiser's record to a checkpoint
+    void save(Checkpoint_writer& writer) const override;
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,79 @@
+/*
+An Event_queue holds the next event for each of a set of objects, identified
+by Object_id, in order of the time it is due. Model uses it to run the simulation
+event by event: instead of updating every object on every tick, it jumps to
+the next time at which some object has something to do.
+
+An object has at most one event at a time. Scheduling a new one for it
+replaces the old one, and cancel drops it. Neither searches the heap: each
+object's events carry a generation number, which is bumped whenever its event
+is replaced or canceled, and an entry whose generation is out of date is
+simply discarded when it reaches the top of the heap.
+*/
+
+#ifndef EVENT_QUEUE_H
+#define EVENT_QUEUE_H
+
+#include "Name_table.h"
+#include "Sim_object.h"
+#include <functional>
+#include <queue>
+#include <vector>
+
+class Event_queue
+{
+public:
+    Event_queue();
+
+    // Give the object an event of this type at time, replacing any it had
+    void schedule(Object_id id, int time, Event_type type);
+
+    // Drop the object's event, if it has one
+    void cancel(Object_id id);
+
+    // Drop every event
+    void clear();
+
+    // Return the time of the earliest event, or Sim_object::no_event if there is none
+    int get_next_time();
+
+    // Return true if the object has an event at or before time
+    bool is_due(Object_id id, int time) const;
+
+    // Return the type of the object's event; it must have one
+    Event_type get_type(Object_id id) const
+    {
+        return scheduled[id].type;
+    }
+
+private:
+    struct Scheduled
+    {
+        int time;
+        Event_type type;
+        unsigned int generation;
+        bool active;
+    };
+
+    struct Entry
+    {
+        int time;
+        unsigned long sequence;  // entries due at the same time come out in the order scheduled
+        Object_id id;
+        unsigned int generation;
+
+        bool operator>(const Entry& rhs) const
+        {
+            return time != rhs.time ? time > rhs.time : sequence > rhs.sequence;
+        }
+    };
+
+    std::vector<Scheduled> scheduled;  // by id
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> heap;
+    unsigned long next_sequence;
+};
+
+// Return the name of an event type, e.g. "arrive_at"
+const char* get_event_type_name(Event_type type);
+
+#endif
@@ -14,22 +14,40 @@ class Island : public Sim_object
 {
 public:
     // initialize then output constructor message
-    Island(const std::string& name_, Point position_, double fuel_ = 0., double production_rate_ = 0.);
+    Island(Model& model_, const std::string& name_, Point position_, double fuel_ = 0., double production_rate_ = 0.);
 
     Point get_location() const override
     {
         return position;
     }
 
+    // return the fuel on hand, in tons
+    double get_fuel() const
+    {
+        return fuel;
+    }
+
     // if production_rate > 0, compute production_rate * unit time, and add to amount, and print an update message
     void update() override;
 
+    // An Island only accumulates fuel, so it can always be advanced
+    int ticks_until_event() const override
+    {
+        return no_event;
+    }
+
+    // add ticks updates' worth of production, without the update messages
+    void advance(int ticks) override;
+
     // output information about the current state
     void describe() const override;
 
     // ask model to notify views of current state
     void broadcast_current_state() const override;
 
+    // add the position, fuel, and production rate to a checkpoint
+    void save(Checkpoint_writer& writer) const override;
+
     // Return whichever is less, the request or the amount left,
     // update the amount on hand accordingly, and output the amount supplied.
     double provide_fuel(double request);
@@ -0,0 +1,71 @@
+/*
+Batch kinematics kernels for moving many tracks at once.
+
+Positions and unit heading vectors are passed as separate x and y arrays, the
+way Ship_store keeps them. The heading of a track is the value of
+course_unit_vector() for its course, so it only needs to be recomputed when
+the course changes rather than on every step.
+
+advance_positions uses AVX2 on x86 processors that support it, NEON on ARM64,
+and a scalar loop otherwise. Every version performs the same IEEE operations in
+the same order as Point + Course_speed * time - distance = speed * time, then
+position + distance * heading - so the results are bit-for-bit identical to
+Track_base::update_position.
+
+closest_approaches is the narrow phase of the CPA screen (see Cpa_screen.h):
+for many pairs of tracks at once, when within a time horizon the two will be
+closest if both hold their course and speed, and how close. It is vectorized
+the same way, and its versions also give identical results.
+*/
+
+#ifndef KINEMATICS_H
+#define KINEMATICS_H
+
+#include <cstddef>
+
+// For i in [0, count): move (x[i], y[i]) along the unit heading
+// (heading_x[i], heading_y[i]) at speed[i] for time[i].
+void advance_positions(double* x,
+    double* y,
+    const double* heading_x,
+    const double* heading_y,
+    const double* speed,
+    const double* time,
+    std::size_t count);
+
+// The same computation without vector instructions, for comparison
+void advance_positions_scalar(double* x,
+    double* y,
+    const double* heading_x,
+    const double* heading_y,
+    const double* speed,
+    const double* time,
+    std::size_t count);
+
+// The vector instructions that advance_positions and closest_approaches use on
+// this processor: "AVX2", "NEON", or "none" if they run the scalar versions
+const char* get_kinematics_vector_instructions();
+
+// For i in [0, count): two tracks are (dx[i], dy[i]) apart and moving apart at
+// (dvx[i], dvy[i]) nm per hour. Put the time in [0, horizon] at which they are
+// closest in time[i], and the square of their distance then in range_squared[i].
+void closest_approaches(const double* dx,
+    const double* dy,
+    const double* dvx,
+    const double* dvy,
+    double horizon,
+    double* time,
+    double* range_squared,
+    std::size_t count);
+
+// The same computation without vector instructions, for comparison
+void closest_approaches_scalar(const double* dx,
+    const double* dy,
+    const double* dvx,
+    const double* dvy,
+    double horizon,
+    double* time,
+    double* range_squared,
+    std::size_t count);
+
+#endif
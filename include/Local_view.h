@@ -7,17 +7,16 @@
 class Local_view : public Twod_view
 {
 public:
-    Local_view(const std::string& ship_name_);
+    // The view of the Ship with this name and id
+    Local_view(const std::string& ship_name_, int ship_id_);
 
-    // Change origin of the Local_view when name matches Local_view's ship name.
-    void update_location(const std::string& name, Point location) override;
-
-    // If name matches the Local_view's Ship's name,
-    // mark it as sunk.
-    void update_remove(const std::string& name) override;
+    // Apply the changes, moving the origin with the Local_view's Ship,
+    // and marking it as sunk when it is gone.
+    void apply_changes(
+        const View_change* changes, std::size_t num_changes, const std::vector<std::string>& names) override;
 
     // Print local view for a Ship.
-    void draw() override;
+    void draw(std::ostream& os) override;
 
     // Throw an Error because you cannot perform these functions
     void set_size(int size_) override;
@@ -32,6 +31,10 @@ private:
     bool sunk;
     Point ship_location;
     std::string ship_name;
+    int ship_id;
+
+    // Return the text of a row of the local view
+    std::string render_row(int i) const override;
 };
 
 #endif
@@ -0,0 +1,308 @@
+/*
+Logger carries the simulation's event messages - "Ajax now at (1.00, 2.00)",
+"Island Exxon supplied 50.00 tons of fuel" and so on - from the objects that
+produce them to the sinks that write them out.
+
+Each message has a severity level and a category, and the Logger can be told
+which levels and categories to keep. The LOG macro checks that first, so for a
+disabled message nothing after the << is evaluated; the check is one load and
+a bit test.
+
+A message is encoded as a compact record - the string literals by address,
+the other values in binary - and appended to a ring buffer belonging to the
+thread that logged it. No lock is taken. A background writer thread takes the
+records off the rings in the order they were logged and hands them to the
+sinks: the Text_log_sink writes them to cout exactly as the objects used to
+write them themselves, and the Binary_log_sink writes the records to a file.
+Each record is numbered when it is logged but copied into its ring after
+that, so the writer only writes a record once every record numbered before
+it has been copied into its own ring; messages from different threads come
+out in exactly the order they were logged. When a thread exits, its ring is
+handed on to the next thread that logs, so there are only ever as many rings
+as threads logging at the same time.
+
+Because the messages are written by another thread, anything that writes to
+cout directly must call flush() first, so that the output stays in order.
+Controller does this before its own output. flush() writes out what is left
+on the calling thread itself, rather than waking the writer and waiting for
+it, and returns at once if everything logged has been written already.
+
+Arguments written to a Log_line with << can be strings, ints, doubles,
+Points, or Course_speeds. Only a string literal - a const char array - is kept
+by address; any other C string, like s.c_str() or error.what(), is copied, as
+a std::string is, since it may be gone by the time the writer gets to it.
+*/
+
+#ifndef LOGGER_H
+#define LOGGER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <iosfwd>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+struct Point;
+struct Course_speed;
+
+enum class Log_level : unsigned char
+{
+    debug,
+    info,
+    warning,
+    error,
+};
+
+enum class Log_category : unsigned char
+{
+    movement,
+    fuel,
+    combat,
+    docking,
+    general,
+};
+
+const int num_log_levels = 4;
+const int num_log_categories = 5;
+
+// A message while it is being written
+class Log_line
+{
+public:
+    Log_line(Log_level level, Log_category category);
+    // Hands the finished message to the Logger
+    ~Log_line();
+
+    // A string literal, kept by address
+    template <std::size_t N>
+    Log_line& operator<<(const char (&literal)[N])
+    {
+        append_literal(literal);
+        return *this;
+    }
+
+    // Any other C string, copied
+    template <typename T,
+        typename std::enable_if<std::is_same<T, const char*>::value || std::is_same<T, char*>::value, int>::type
+        = 0>
+    Log_line& operator<<(const T& s)
+    {
+        append_string(s);
+        return *this;
+    }
+
+    // A char array that is not const may change, so it is copied too
+    template <std::size_t N>
+    Log_line& operator<<(char (&s)[N])
+    {
+        append_string(s);
+        return *this;
+    }
+
+    Log_line& operator<<(const std::string& s);
+    Log_line& operator<<(int i);
+    Log_line& operator<<(double d);
+    Log_line& operator<<(const Point& p);
+    Log_line& operator<<(const Course_speed& cs);
+
+    Log_line(const Log_line& obj) = delete;
+    Log_line& operator=(const Log_line& obj) = delete;
+
+private:
+    Log_level level;
+    Log_category category;
+
+    // The record is built here, or in overflow once it gets too long
+    char data[256];
+    std::size_t size;
+    std::string overflow;
+
+    void append(const void* bytes, std::size_t count);
+    void append_literal(const char* literal);
+    void append_string(const char* s);
+    void append_string(const char* s, std::size_t length);
+};
+
+// A record as seen by a sink
+struct Log_record
+{
+    std::uint64_t sequence;  // order in which the messages were logged
+    int time;  // simulated time when it was logged
+    Log_level level;
+    Log_category category;
+    const char* args;  // the encoded arguments
+    std::size_t args_size;
+};
+
+class Log_sink
+{
+public:
+    virtual ~Log_sink()
+    { }
+
+    virtual void write(const Log_record& record) = 0;
+    virtual void flush() = 0;
+};
+
+// Writes each message as a line of text, as the objects used to
+class Text_log_sink : public Log_sink
+{
+public:
+    explicit Text_log_sink(std::ostream& os_)
+        : os(os_)
+    { }
+
+    void write(const Log_record& record) override;
+    void flush() override;
+
+private:
+    std::ostream& os;
+};
+
+/*
+Writes the records to a file in binary, in the byte order of this machine.
+The first time a string literal appears it is written out once as
+    'L' id:uint32 length:uint16 characters
+and afterwards referred to by its id. Each message is
+    'M' sequence:uint64 time:int32 level:uint8 category:uint8 size:uint16 arguments
+where each argument is a type byte followed by its value:
+    'L' id:uint32, 'S' length:uint16 characters, 'I' int32, 'D' double,
+    'P' x:double y:double, or 'C' course:double speed:double.
+*/
+class Binary_log_sink : public Log_sink
+{
+public:
+    // Throws Error if the file cannot be opened
+    explicit Binary_log_sink(const std::string& filename);
+
+    void write(const Log_record& record) override;
+    void flush() override;
+
+private:
+    std::ofstream file;
+    std::unordered_map<const char*, std::uint32_t> literal_ids;
+    std::string buffer;
+};
+
+class Logger
+{
+public:
+    bool is_enabled(Log_level level, Log_category category) const
+    {
+        return (enabled_mask.load(std::memory_order_relaxed) >> mask_bit(level, category)) & 1;
+    }
+
+    // Keep messages of this level and above
+    void set_level(Log_level level);
+
+    // Keep or drop the messages in a category
+    void set_category_enabled(Log_category category, bool enabled);
+
+    // Start or stop writing the messages in binary to a file as well as to cout.
+    // An empty filename stops it. Throws Error if the file cannot be opened.
+    void set_binary_file(const std::string& filename);
+
+    // Simulated time to put in the records
+    void set_time(int time_)
+    {
+        time.store(time_, std::memory_order_relaxed);
+    }
+
+    // Write out every message logged so far, on the calling thread; returns at once
+    // if they all have been
+    void flush();
+
+    // Logger for the whole program
+    static Logger& get_instance();
+
+    // Used by Log_line: append a finished message to this thread's ring
+    void commit(Log_level level, Log_category category, const char* args, std::size_t args_size);
+
+    // disallow copy/move construction or assignment
+    Logger(Logger& obj) = delete;
+    Logger(Logger&& obj) = delete;
+    Logger& operator=(Logger& obj) = delete;
+    Logger& operator=(Logger&& obj) = delete;
+
+private:
+    Logger();
+    ~Logger();
+
+    // A single-producer, single-consumer byte ring
+    struct Ring;
+
+    // Hands the calling thread's ring back when the thread exits
+    struct Ring_lease;
+
+    // The calling thread's ring, and its lease
+    static thread_local Ring* this_thread_ring;
+    static thread_local Ring_lease this_thread_lease;
+
+    std::atomic<std::uint32_t> enabled_mask;
+    Log_level min_level;
+    std::uint32_t category_mask;
+
+    std::atomic<int> time;
+    std::atomic<std::uint64_t> next_sequence;
+
+    // All the rings that have been made, in use or not; guarded by rings_mutex
+    std::vector<std::shared_ptr<Ring>> rings;
+    std::mutex rings_mutex;
+
+    // The sinks; guarded by sinks_mutex, which the writer holds while writing
+    std::unique_ptr<Text_log_sink> text_sink;
+    std::unique_ptr<Binary_log_sink> binary_sink;
+    std::mutex sinks_mutex;
+
+    // Coordination with the writer thread; guarded by writer_mutex
+    // except for wake_requested
+    std::atomic<bool> wake_requested;
+    std::mutex writer_mutex;
+    std::condition_variable work_ready;
+    bool shutting_down;
+    std::thread writer;
+
+    // The sequence number of the next record to write; guarded by sinks_mutex
+    std::uint64_t next_write_sequence;
+
+    // The records written out so far, so that flush can return at once when every
+    // record logged has been
+    std::atomic<std::uint64_t> num_written;
+
+    static int mask_bit(Log_level level, Log_category category)
+    {
+        return static_cast<int>(level) * num_log_categories + static_cast<int>(category);
+    }
+
+    void update_mask();
+
+    // The calling thread's ring, taken over from a thread that has exited or made on first use
+    Ring& get_ring();
+
+    // Wake the writer up if it is waiting
+    void wake_writer();
+
+    void writer_loop();
+
+    // Write out every record in the rings, oldest first, up to the first one not yet in its ring;
+    // called by the writer, and by flush on the thread that flushes
+    void drain();
+};
+
+// Write a message, e.g. LOG(Log_level::info, Log_category::movement) << name << " now at " << location;
+// Nothing after the macro is evaluated unless the level and category are enabled. It is a for
+// statement rather than an if-else, so that it cannot take the else of an if it is used under.
+#define LOG(level, category)                                                                   \
+    for (bool log_enabled_ = Logger::get_instance().is_enabled(level, category); log_enabled_; \
+         log_enabled_ = false)                                                                 \
+        Log_line(level, category)
+
+#endif
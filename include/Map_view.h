@@ -2,6 +2,7 @@
 #define MAP_VIEW_H
 
 #include "Twod_view.h"
+#include <ostream>
 #include <string>
 
 struct Point;
@@ -12,8 +13,12 @@ public:
     // default constructor sets the default size, scale, and origin, outputs constructor message
     Map_view();
 
-    // prints out the current map
-    void draw() override;
+    // prints out the current map; in live mode, once the whole map is on the
+    // screen, only moves the cursor to the rows that changed and writes those
+    void draw(std::ostream& os) override;
+
+    // Turn live mode on or off; turning it on draws the whole map again next time
+    void set_live(bool live_) override;
 
     // Modify the display parameters:
     // If the size is out of bounds will throw Error("New map size is too big!")
@@ -22,6 +27,23 @@ public:
 
     // If scale is not postive, will throw Error("New map scale must be positive!");
     void set_scale(double scale_) override;
+
+    // Throw the Error that set_size or set_scale would, without changing anything
+    static void check_size(int size_);
+    static void check_scale(double scale_);
+
+private:
+    // The line of the screen, counting from 1, that the top row is on in live mode
+    static const int first_row_line = 3;
+
+    bool live;  // draw with terminal escape sequences
+    bool live_screen_drawn;  // the whole map has been drawn since live mode was turned on
+
+    // Return the text of a row of the map, with its y coordinate every third row
+    std::string render_row(int j) const override;
+
+    // Print the names of the objects outside the map to os, if there are any
+    void print_outside_map(std::ostream& os) const;
 };
 
 #endif
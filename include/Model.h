@@ -1,65 +1,210 @@
 /*
 Model is part of a simplified Model-View-Controller pattern.
-Model keeps track of the Sim_objects in our little world. It is the only
+Model keeps track of the Sim_objects in one little world. It is the only
 component that knows how many Islands and Ships there are, but it does not
 know about any of their derived classes, nor which Ships are of what kind of Ship.
 It has facilities for looking up objects by name, and removing Ships.  When
 created, it creates an initial group of Islands and Ships using the Ship_factory.
 Finally, it keeps the system's time.
 
+There can be any number of Models, each with a world of its own: every
+Sim_object belongs to one Model and talks only to it. The interactive
+Controller works on the one returned by get_instance().
+
 Controller tells Model what to do; Model in turn tells the objects what do, and
 when asked to do so by an object, tells all the Views whenever anything changes that might be relevant.
 Model also provides facilities for looking up objects given their name.
+
+Model also keeps a Spatial_grid of the Islands and one of the Ships, kept up
+to date from notify_location and notify_gone, so that objects can be looked
+up by how close they are to a position. The route that Cruise_ships go round
+the Islands by is planned by a Tour_planner the first time a cruise asks for
+it, and kept, shared with the cruises, until an Island is added.
+
+Every name an object is given gets a dense Object_id from the Model's
+Name_table, which stays the same if the object sinks and another object is
+given its name. The objects are kept in vectors indexed by id, so looking one
+up by name takes one hash lookup of the name, and the Spatial_grids, the
+Event_queue, and the Views know objects only by id. Everything that goes
+through all the objects still does so in name order: the ids are also kept in
+a vector sorted by name, into which the ids of new objects are merged, and
+from which those of removed ones are dropped, the next time it is gone through.
+
+A Ship that sinks during a tick is taken out of the counts, the Spatial_grid,
+and the Event_queue at once, and is passed over by the rest of the tick, but
+the Model keeps it until the end of the tick, when all the Ships removed in
+it are dropped in one pass; so no object is destroyed while the objects are
+being gone through. Objects refer to each other by Object_handle, which
+resolve_ship turns into the object with one comparison of the id's
+generation, or into nullptr if the object has been removed since.
+
+The groups of Ships are indexed by name, whether they are top groups or not,
+so a group is found with one hash lookup rather than a walk down every
+hierarchy. For each Ship the Model also keeps the top groups of the
+hierarchies it is in; a Ship may be in a hierarchy only once, and that is
+checked with one lookup too. Both are kept up to date as groups and Ships
+are added and removed, and built again when a checkpoint is loaded.
+
+The notify functions do not call the Views directly: they record the change
+in a View_change for the object, so that all the changes to an object in a
+tick make one record, and deliver_view_changes hands all the records to each
+View at once. That is done
+at the end of every tick, and whenever the Views are about to be drawn or the
+set of Views changes. With no Views open, nothing is recorded.
+
+The Views are updated and drawn on a thread of their own by the Model's
+View_renderer (see View_renderer.h): delivering the changes publishes them to
+it, and the commands that set up or draw a View are run there after them.
 */
 
 #ifndef MODEL_H
 #define MODEL_H
 
+#include "Cpa_screen.h"
+#include "Event_queue.h"
+#include "Name_table.h"
+#include "Object_arena.h"
+#include "Sim_object.h"
+#include "Ship_store.h"
+#include "Spatial_grid.h"
+#include "View.h"
+#include "View_renderer.h"
+#include <functional>
 #include <map>
 #include <memory>
 #include <set>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
-struct Point;
-class Sim_object;
 class Island;
 class Ship_component;
 class Ship;
-class View;
 
 class Model
 {
 public:
+    // How update() runs a tick.
+    // serial: every object updates itself in turn; this is the reference behavior.
+    // parallel: Ship movement is first computed for all Ships at once on the Thread_pool,
+    // then every object updates in the same order as in serial mode, applying the
+    // precomputed movement where it still holds. Only the movement is computed in parallel;
+    // the decisions in update() - a Warship's targeting and firing, the states of Tankers,
+    // Cruise_ships and Chain_ships, docking and refueling - are still made one object at a
+    // time, as each can depend on what the objects before it changed in the same tick,
+    // which decisions made at once against the state at the start of the tick would not see.
+    // Both modes produce identical results.
+    // event: only the objects that have an event due are updated in full; the others
+    // are advanced quietly (see Sim_object::ticks_until_event), and the ticks in which
+    // no object has an event are skipped over. The objects end up in the same states
+    // as in serial mode, but the per-update messages of the quiet objects are not shown.
+    enum class Update_mode
+    {
+        serial,
+        parallel,
+        event,
+    };
+
     // Getters
     int get_time() const
     {
         return time;
     }
 
-    std::map<std::string, std::shared_ptr<Island>> get_island_map()
+    int get_num_islands() const
     {
-        return island_map;
+        return num_islands;
     }
 
-    std::map<std::string, std::shared_ptr<Ship>> get_ship_map()
+    int get_num_ships() const
     {
-        return ship_map;
+        return num_ships;
     }
 
+    // Return every Island, or every Ship, in name order
+    std::vector<std::shared_ptr<Island>> get_islands() const;
+    std::vector<std::shared_ptr<Ship>> get_ships() const;
+
     // Will throw Error("Island not found!") if no island of that name
     std::shared_ptr<Island> get_island_ptr(const std::string& name) const;
 
     // Returns nullptr if there is no ship of that name
     std::shared_ptr<Ship> get_ship_ptr(const std::string& name) const;
 
+    // Returns nullptr if there is no group of that name
     std::shared_ptr<Ship_component> get_ship_composite_ptr(const std::string& name) const;
 
+    /* Handles */
+    // Return a handle to an object of this Model, or to one that load is about to put in it
+    Object_handle get_handle(const Sim_object& object) const;
+
+    // Return the Ship or Island a handle refers to, or nullptr if it has been removed since
+    Ship* resolve_ship(Object_handle handle) const;
+    Island* resolve_island(Object_handle handle) const;
+
+    // The same as resolve_island, as a pointer that shares the Island, e.g. to dock at it
+    std::shared_ptr<Island> get_island_ptr(Object_handle handle) const;
+
+    Update_mode get_update_mode() const
+    {
+        return update_mode;
+    }
+
+    void set_update_mode(Update_mode update_mode_)
+    {
+        update_mode = update_mode_;
+    }
+
+    /* Proximity queries */
+    // Distances are cartesian_distance from location; of two objects at the same
+    // distance, the one whose name comes first counts as closer.
+
+    // Return the Island closest to location for which predicate is true, or nullptr if none
+    std::shared_ptr<Island> find_nearest_island_if(Point location, const Spatial_grid::Predicate& predicate) const;
+
+    // Return the Islands within radius of location, in name order
+    std::vector<std::shared_ptr<Island>> find_islands_within(Point location, double radius) const;
+
+    // Return the Ship closest to location for which predicate is true, or nullptr if none
+    std::shared_ptr<Ship> find_nearest_ship_if(Point location, const Spatial_grid::Predicate& predicate) const;
+
+    // Return up to k Ships closest to location, closest first
+    std::vector<std::shared_ptr<Ship>> find_nearest_ships(Point location, int k) const;
+
+    /* CPA screening */
+    // Where afloat Ships come closest to each other if they all hold their course
+    // and speed; a Ship that is not moving stays where it is. The pairs are soonest
+    // first, then closest first, then in name order. range must be positive and
+    // hours not negative.
+
+    // Return every pair of Ships that come within range of each other in the next
+    // hours; the name of a pair's id1 comes before that of its id2
+    std::vector<Cpa_pair> screen_cpa(double range, double hours);
+
+    // Return the pairs of ship, as id1, and each Ship that comes within range of it in the next hours
+    std::vector<Cpa_pair> screen_cpa(const Ship& ship, double range, double hours);
+
+    /* Cruises */
+    // Return the Islands in the order of a short tour through all of them that
+    // comes back to where it starts; a cruise goes round it from any Island
+    std::shared_ptr<const std::vector<Object_handle>> get_island_tour() const;
+
     // tell all objects to describe themselves
     void describe() const;
     // increment the time, and tell all objects to update themselves
     void update();
 
+    // Update num_ticks times. Stretches in which every object would only move
+    // steadily or accumulate fuel are skipped over in one step with
+    // Sim_object::advance, without their per-update messages; every other
+    // update, and always the last one, is done in full.
+    void update(int num_ticks);
+
+    // Add a new Island to the containers, and update the view
+    // Throws Error if there is already a Ship or Island with that name.
+    void add_island(std::shared_ptr<Island> new_island);
+
     // Add a new ship to the containers, and update the view
     // Throws Error if there is already a Ship or Island with that name.
     // If insertion fails for any exception, the pointed-to Ship is deleted
@@ -74,7 +219,7 @@ public:
     // Throw an Error when composite or ship does not exist, or when ship is
     // being added to a Ship_composite whose top Ship_composite already
     // has the ship.
-    void add_ship_to_composite(const std::string& composite, std::shared_ptr<Ship_component> ship);
+    void add_ship_to_composite(const std::string& composite, std::shared_ptr<Ship> ship);
 
     // Create a Ship_composite and add it to an existing Ship_composite.
     void add_composite_to_composite(const std::string& composite, std::shared_ptr<Ship_component> composite_in);
@@ -105,30 +250,120 @@ public:
     void detach(std::shared_ptr<View>);
 
     // notify the views about an object's location
-    void notify_location(const std::string& name, Point location);
+    void notify_location(Object_id id, Point location);
     // notify the views that an object is now gone
-    void notify_gone(const std::string& name);
+    void notify_gone(Object_id id);
+
+    // notify the Views about a Ship's location, fuel, course, and speed after it moved
+    void notify_ship_movement(Object_id id, Point location, double fuel, double course, double speed);
 
     // notify the Views about a Ship's fuel
-    void notify_view_about_ship_fuel(const std::string& name, double fuel) const;
+    void notify_view_about_ship_fuel(Object_id id, double fuel);
 
     // notify the Views about a Ship's course
-    void notify_view_about_ship_course(const std::string& name, double course) const;
+    void notify_view_about_ship_course(Object_id id, double course);
 
     // notify the Views about a Ship's speed
-    void notify_view_about_ship_speed(const std::string& name, double speed) const;
+    void notify_view_about_ship_speed(Object_id id, double speed);
+
+    // Hand the changes recorded since the last time to every View
+    void deliver_view_changes();
+
+    // Have the Views' thread run command after the changes recorded so far;
+    // what it writes is a frame (see View_renderer::post)
+    void post_view_command(std::function<void(std::ostream&)> command);
+
+    View_renderer& get_view_renderer()
+    {
+        return view_renderer;
+    }
+
+    // Remove a Ship that has sunk from the objects, and count it. The rest of the
+    // tick passes it over, and it is dropped at the end of the tick.
+    void remove_ship(Ship& ship);
 
-    // Remove a Ship from sim_object_map and ship_map
-    void remove_ship(std::shared_ptr<Ship> ship_ptr);
+    /* Checkpoints */
+    // Write the time, every object, and the groups to a checkpoint file.
+    // Throws Error if the file cannot be written.
+    void save(const std::string& filename) const;
 
-    // Find a Ship_composite with the given name
-    std::shared_ptr<Ship_component> find_composite_ptr(const std::string& name);
+    // Replace the time, every object, and the groups with those in a checkpoint
+    // file, and update the Views. Throws Error if the file cannot be read or is
+    // not a valid checkpoint; the world is then left as it was.
+    void load(const std::string& filename);
+
+    // Tell Model that the object's situation has changed, e.g. it has been
+    // hit or given a new destination, possibly by another object. In event mode the
+    // object then gets a full update at the current time, or at the next if it has
+    // already been updated.
+    void reschedule(Object_id id);
 
     // Check if name conflicts with another Island, Ship, or Ship_composite's name.
     // Throw an Error if it does.
     void check_if_name_duplicate(const std::string& name);
 
-    // For Singleton
+    /* Statistics */
+    // What has happened in the world since the Model was created, for comparing runs
+    struct Statistics
+    {
+        double fuel_delivered = 0.;  // unloaded at Islands by Tankers
+        int ships_sunk = 0;
+        int cruises_finished = 0;
+        long long total_cruise_finish_time = 0;  // sum of the times at which the cruises finished
+    };
+
+    const Statistics& get_statistics() const
+    {
+        return statistics;
+    }
+
+    void record_fuel_delivered(double amount)
+    {
+        statistics.fuel_delivered += amount;
+    }
+
+    // Count a cruise that has just finished
+    void record_cruise_finished()
+    {
+        ++statistics.cruises_finished;
+        statistics.total_cruise_finish_time += time;
+    }
+
+    /* Names */
+    // Return the id of a name, giving it the next one if it has none yet
+    Object_id get_name_id(const std::string& name)
+    {
+        return names.intern(name);
+    }
+
+    const std::string& get_name(Object_id id) const
+    {
+        return names.get_name(id);
+    }
+
+    const Name_table& get_name_table() const
+    {
+        return names;
+    }
+
+    // Where the factory makes the objects of this world
+    Object_arena& get_object_arena()
+    {
+        return *object_arena;
+    }
+
+    // Used by Ships for their per-tick state
+    Ship_store& get_ship_store()
+    {
+        return ship_store;
+    }
+
+    // create the initial objects
+    Model();
+    ~Model()
+    { }
+
+    // The Model that the interactive Controller works on
     static Model& get_instance();
 
     // disallow copy/move construction or assignment
@@ -138,20 +373,127 @@ public:
     Model& operator=(Model&& obj) = delete;
 
 private:
-    // create the initial objects
-    Model();
-    ~Model()
-    { }
+    // Where the objects are made; it is released after everything else is gone,
+    // and only then gives back its memory if no object outlives the Model
+    std::unique_ptr<Object_arena, Object_arena::Releaser> object_arena;
 
     int time;  // the simulated time
+    Update_mode update_mode;
+    Statistics statistics;
 
-    std::map<std::string, std::shared_ptr<Sim_object>> sim_object_map;
-    std::map<std::string, std::shared_ptr<Ship>> ship_map;
-    std::map<std::string, std::shared_ptr<Island>> island_map;
+    // The Ships' per-tick state; it must outlive the Ships below
+    Ship_store ship_store;
+
+    // Every name an object has had; it must outlive the objects, which refer to their names in it
+    Name_table names;
+
+    // What each id is now, and the object with it
+    enum class Object_kind : char
+    {
+        none,
+        island,
+        ship,
+    };
+    std::vector<std::shared_ptr<Sim_object>> objects;
+    std::vector<Object_kind> object_kinds;
+    std::vector<unsigned int> object_generations;  // moved on when the object is removed
+    int num_islands;
+    int num_ships;
+
+    // The Ships removed in this tick, still in objects until drop_removed_ships
+    std::vector<Object_id> removed_ship_ids;
+
+    // The ids of the objects in name order, brought up to date by get_object_order;
+    // an id is in object_order or new_object_ids if and only if in_object_order is set
+    mutable std::vector<Object_id> object_order;
+    mutable std::vector<Object_id> new_object_ids;
+    mutable std::vector<bool> in_object_order;
+    mutable bool object_order_dirty;
+
+    // The top groups
     std::map<std::string, std::shared_ptr<Ship_component>> ship_component_map;
-    std::set<std::string> ship_composite_names;
+
+    // Every group, top or not, by name
+    struct Group_entry
+    {
+        std::shared_ptr<Ship_component> group;
+        std::string parent;  // the group that holds it, empty for a top group
+        std::string top;  // the top group of its hierarchy, its own name for a top group
+    };
+    std::unordered_map<std::string, Group_entry> group_index;
+
+    // By Ship id, the top groups of the hierarchies that hold the Ship
+    std::unordered_map<Object_id, std::unordered_set<std::string>> ship_top_groups;
+
+    // Where the Islands and Ships are; only the objects above are in these
+    Spatial_grid island_grid;
+    Spatial_grid ship_grid;
+
+    // Kept from one CPA screen to the next for its arrays
+    Cpa_screen cpa_screen;
+
+    // The tour of the Islands, planned by get_island_tour; empty when an Island has been added since
+    mutable std::shared_ptr<const std::vector<Object_handle>> island_tour;
 
     std::vector<std::shared_ptr<View>> view_vec;
+
+    // The changes not yet delivered to the Views, in the order the objects first changed
+    std::vector<View_change> view_changes;
+    std::vector<int> view_change_indexes;  // by id, the object's record in view_changes or -1
+
+    // Updates and draws the Views on a thread of its own
+    View_renderer view_renderer;
+
+    // The objects' next events, in event mode
+    Event_queue event_queue;
+
+    // Update every object once, as in serial or parallel mode
+    void update_tick();
+
+    // Update num_ticks times in event mode
+    void run_events(int num_ticks);
+
+    // Schedule the object's next event, counting its quiet updates from from_time
+    void schedule_event(const Sim_object& object, int from_time);
+
+    // Drop the Ships removed in the tick that has just ended from objects
+    void drop_removed_ships();
+
+    // Compute the movement of every Ship in parallel before the update pass
+    void plan_ship_movement();
+
+    // Return the record to put a change to the object in, or nullptr if there are no Views
+    View_change* get_view_change(Object_id id);
+
+    // Tell the Views about every object, as when a View is attached
+    void broadcast_all();
+
+    // Add an object of the kind, whose name must not be that of another object
+    void add_object(std::shared_ptr<Sim_object> object, Object_kind kind);
+
+    // Throw an Error if another Island or Ship, or a Ship_composite, has the new
+    // object's name; the same as check_if_name_duplicate, without looking the name up
+    void check_if_object_duplicate(const Sim_object& new_object);
+
+    // Sort the pairs of a CPA screen as screen_cpa returns them
+    void sort_cpa_pairs(std::vector<Cpa_pair>& pairs) const;
+
+    // Return the ids of the objects in name order, first merging in the new
+    // objects and dropping the removed ones. The Ships removed after that are
+    // still there, but their kind is none.
+    const std::vector<Object_id>& get_object_order() const;
+
+    // Remove every object
+    void clear_objects();
+
+    // Build group_index and ship_top_groups again from the top groups
+    void index_groups();
+
+    // Take the groups and Ships under group, which is in the hierarchy of top, out of the indexes
+    void unindex_members(const Ship_component& group, const std::string& top);
+
+    // The Ship is no longer in the hierarchy of top
+    void forget_top_group(Object_id ship_id, const std::string& top);
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,52 @@
+/*
+The Monte Carlo driver runs many independent worlds at once and sums up how
+they turned out, for what-if analysis. Each world is a Model of its own,
+driven by a quiet Controller (see Controller.h), and the worlds are run in
+parallel on the Thread_pool.
+
+A world runs one of the given command scripts, which are handed out to the
+worlds in turn. If there are no scripts, it runs instead a random scenario
+made from the seed and the number of the world: Ships of every kind placed
+at random near the Islands, with the Tankers carrying fuel between two
+Islands, the Cruise_ships on cruises, the Warships attacking, and the
+Chain_ships chaining other Ships. Then the world is updated for the given
+number of ticks.
+
+The Logger is switched off for the whole program while the worlds run, since
+their messages would be mixed together.
+*/
+
+#ifndef MONTE_CARLO_H
+#define MONTE_CARLO_H
+
+#include "Model.h"
+#include <string>
+#include <vector>
+
+struct Monte_carlo_settings
+{
+    int num_runs;
+    int num_ticks;  // to update each world for after its commands
+    unsigned int seed;  // for the random scenarios
+    int num_ships;  // in each random scenario
+    std::vector<std::string> scripts;
+};
+
+// How one world turned out
+struct Run_outcome
+{
+    bool completed;  // false if the run was stopped by an unexpected exception
+    int time;
+    int failed_commands;
+    int ships_afloat;
+    Model::Statistics statistics;
+};
+
+// Run the worlds and return their outcomes, in the order of the worlds.
+// Throws Error if a script cannot be read.
+std::vector<Run_outcome> run_monte_carlo(const Monte_carlo_settings& settings);
+
+// Output the mean, minimum, and maximum of the outcomes over the runs to cout
+void report_monte_carlo(const std::vector<Run_outcome>& outcomes);
+
+#endif
@@ -0,0 +1,81 @@
+/*
+A Name_table interns the names of the objects of a Model. Every name it is
+given gets a dense Object_id, the next one free, which the name keeps for as
+long as the Name_table lives, even if the object that had it is gone and
+another object is given the name later. Each name is kept only once, and
+never moves, so a reference to it stays good.
+
+Everything inside the Model, the objects, and the Views keeps objects by id;
+a name is looked up only to print it, to order objects by name, and to turn
+a name the user typed into an id.
+
+The ids are found by name in an open-addressing table, kept at most half full,
+whose slots hold an id and part of its name's hash; so a lookup usually reads
+one slot and one name, and interning a name allocates nothing but its string.
+*/
+
+#ifndef NAME_TABLE_H
+#define NAME_TABLE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using Object_id = int;
+
+// The id of no object
+const Object_id no_object_id = -1;
+
+class Name_table
+{
+public:
+    // Return the id of name, giving it the next one if it has none yet
+    Object_id intern(const std::string& name);
+
+    // Return the id of name, or no_object_id if it has none
+    Object_id find(std::string_view name) const;
+
+    const std::string& get_name(Object_id id) const
+    {
+        return names[id];
+    }
+
+    // The number of ids given out; they are 0 through one less than this
+    int size() const
+    {
+        return static_cast<int>(names.size());
+    }
+
+private:
+    // An id, and the low bits of the hash of its name; id is no_object_id in an empty slot
+    struct Slot
+    {
+        Object_id id;
+        std::uint32_t hash;
+    };
+
+    std::deque<std::string> names;  // by id; a deque, so that the strings never move
+    std::vector<Slot> slots;  // a power of two of them, or none
+
+    // Return the slot that holds name, or the empty slot where it would go; there must be slots
+    std::size_t find_slot(std::string_view name, std::size_t hash) const;
+
+    // Double the number of slots, or make the first ones
+    void grow();
+};
+
+// Orders ids by their names, e.g. for a container that is gone through in name order
+struct Name_order
+{
+    const Name_table* names;
+
+    bool operator()(Object_id id1, Object_id id2) const
+    {
+        return names->get_name(id1) < names->get_name(id2);
+    }
+};
+
+#endif
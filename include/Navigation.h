@@ -64,6 +64,7 @@ the Compass_vector for its course and the time to get its new Point:
 
 // forward declarations
 struct Point;
+struct Cartesian_vector;
 struct Polar_vector;
 struct Course_speed;
 struct Compass_position;
@@ -144,6 +145,10 @@ std::ostream& operator<<(std::ostream& os, const Compass_vector& cv);
 
 // *** Other navigation functions  ***
 
+// Return the Cartesian displacement for moving one nm along a compass course.
+// Scaling it by speed * time gives the same displacement as Course_speed * time.
+Cartesian_vector course_unit_vector(double course);
+
 // Given ownship's course and speed, and the target's course and speed, and bearing and range from ownship,
 // compute the range and bearing of the point of closest approach and the time until the point.
 // If the CPA is the current position, it is returned with the time being zero.
@@ -152,4 +157,14 @@ Compass_position compute_CPA(Course_speed ownship_cs,
     Compass_position target_position_cp,
     double& time_to_CPA);
 
+// Given ownship's speed, and the target's course and speed, and bearing and range from ownship,
+// compute the range and bearing of the point at which ownship, heading straight for it at that
+// speed, meets the target soonest if the target holds its course and speed, and the time until then.
+// Return false, leaving intercept_cp and time_to_intercept alone, if ownship can never meet the target.
+bool compute_intercept(double ownship_speed,
+    Course_speed target_cs,
+    Compass_position target_position_cp,
+    Compass_position& intercept_cp,
+    double& time_to_intercept);
+
 #endif
\ No newline at end of file
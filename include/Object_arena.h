@@ -0,0 +1,133 @@
+/*
+Object_arena is the memory that the objects of one Model - its Islands, Ships,
+and groups - are made in, so that making and sinking many of them does not go
+to the global heap each time. Blocks are cut from large chunks, and a block
+given back goes on a free list for its size, to be handed out again to the
+next object of that size: in effect there is a pool for each type of object.
+The chunks are all given back at once when the arena goes away, so a world is
+torn down without a call to the heap for each object.
+
+The objects are still owned by shared_ptrs, made by the factory with
+std::allocate_shared and an Arena_allocator, so that the control block and
+the object share one block, which goes back on its free list when the last
+shared_ptr to the object goes. A shared_ptr may outlive its Model: the Model
+only releases the arena, which deletes itself once its last block is back.
+
+An arena is used by one thread at a time, as is the Model that owns it.
+*/
+
+#ifndef OBJECT_ARENA_H
+#define OBJECT_ARENA_H
+
+#include <cstddef>
+#include <vector>
+
+class Object_arena
+{
+public:
+    // Blocks are rounded up to a multiple of this, which is also their alignment
+    static constexpr std::size_t block_alignment = alignof(std::max_align_t);
+
+    // Larger blocks come from the global heap
+    static constexpr std::size_t max_block_size = 1024;
+
+    Object_arena();
+
+    // Return a block of at least size bytes
+    void* allocate(std::size_t size);
+
+    // Give back a block of size bytes; the arena deletes itself if it has been
+    // released and this was its last block
+    void deallocate(void* block, std::size_t size);
+
+    // Called by the owner instead of delete: the arena deletes itself now, or
+    // when the last block is given back
+    void release();
+
+    // Deletes the arena once released
+    struct Releaser
+    {
+        void operator()(Object_arena* arena) const
+        {
+            arena->release();
+        }
+    };
+
+    // disallow copy/move construction or assignment
+    Object_arena(Object_arena& obj) = delete;
+    Object_arena(Object_arena&& obj) = delete;
+    Object_arena& operator=(Object_arena& obj) = delete;
+    Object_arena& operator=(Object_arena&& obj) = delete;
+
+private:
+    // Chunks start at this size, and double up to the largest
+    static constexpr std::size_t first_chunk_size = 64 * 1024;
+    static constexpr std::size_t max_chunk_size = 4 * 1024 * 1024;
+
+    std::vector<char*> chunks;
+    char* next_free;  // in the last chunk
+    std::size_t bytes_left;  // in the last chunk
+    std::size_t next_chunk_size;
+
+    // By size / block_alignment, the first block given back; each holds a pointer to the next
+    std::vector<void*> free_lists;
+
+    std::size_t num_blocks;  // handed out and not given back
+    bool released;
+
+    // Only release deletes the arena
+    ~Object_arena();
+
+    // Start a new chunk with room for at least size bytes
+    void add_chunk(std::size_t size);
+};
+
+// An allocator that allocates from an Object_arena, e.g. for std::allocate_shared
+template <typename T>
+class Arena_allocator
+{
+public:
+    using value_type = T;
+
+    explicit Arena_allocator(Object_arena& arena_)
+        : arena(&arena_)
+    { }
+
+    template <typename U>
+    Arena_allocator(const Arena_allocator<U>& other)
+        : arena(other.get_arena())
+    { }
+
+    T* allocate(std::size_t n)
+    {
+        static_assert(alignof(T) <= Object_arena::block_alignment, "Arena blocks are not aligned enough");
+        return static_cast<T*>(arena->allocate(n * sizeof(T)));
+    }
+
+    void deallocate(T* ptr, std::size_t n)
+    {
+        arena->deallocate(ptr, n * sizeof(T));
+    }
+
+    Object_arena* get_arena() const
+    {
+        return arena;
+    }
+
+private:
+    Object_arena* arena;
+};
+
+template <typename T, typename U>
+bool operator==(const Arena_allocator<T>& allocator1, const Arena_allocator<U>& allocator2)
+{
+    return allocator1.get_arena() == allocator2.get_arena();
+}
+
+template <typename T, typename U>
+bool operator!=(const Arena_allocator<T>& allocator1, const Arena_allocator<U>& allocator2)
+{
+    return !(allocator1 == allocator2);
+}
+
+#endif
@@ -0,0 +1,223 @@
+/*
+Profiler measures where the time of a tick goes. It is built in only when
+SIMULATION_PROFILE is defined (cmake -DSIMULATION_PROFILE=ON); otherwise the
+PROFILE macros below expand to nothing and cost nothing.
+
+A section is a part of the program that is timed each time it runs: the
+phases of Model::update, the update() of each type of object, the delivery of
+the Views' changes and their application on the renderer's thread, and the
+running of each Controller command. PROFILE_SCOPE times the rest of the block
+it is put in. The clock is the time stamp counter where there is one, and
+std::chrono::steady_clock otherwise; the counter is converted to time by
+comparing it with steady_clock over the whole run.
+
+Each thread records into data of its own, so no lock is taken. The durations
+go into histograms whose buckets are an eighth of a power of two wide, so a
+percentile is reported to within 1/8 of its value; the maximum is exact.
+PROFILE_END_TICK is called whenever the Model's time moves on, and closes the
+tick's counts of view notifications and heap allocations (a stretch skipped
+over in one step counts as one tick). The allocations are those of the whole
+program, counted with PROFILE_COUNT_ALLOCATION by the operator new of the
+simulation (src/Profiler_new.cpp) and of simulation_bench.
+
+If tracing is on, every call is also kept, up to max_trace_events per thread,
+to be written out as a Chrome trace-event file (chrome://tracing or Perfetto).
+The statistics and the trace must only be read while the threads that record
+are idle, as they are between Controller commands.
+*/
+
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define PROFILER_RDTSC
+#include <x86intrin.h>
+#endif
+
+enum class Profile_section : unsigned char
+{
+    tick,
+    plan_movement,
+    update_objects,
+    advance,
+    deliver_changes,
+    apply_changes,
+    update_island,
+    update_tanker,
+    update_cruiser,
+    update_torpedo_boat,
+    update_cruise_ship,
+    update_chain_ship,
+    command,
+};
+
+const int num_profile_sections = 13;
+
+// The name a section is reported under
+const char* get_profile_section_name(Profile_section section);
+
+// Counts of values, in buckets an eighth of a power of two wide
+class Profile_histogram
+{
+public:
+    Profile_histogram();
+
+    void add(std::uint64_t value);
+    void merge(const Profile_histogram& other);
+
+    std::uint64_t get_count() const
+    {
+        return count;
+    }
+    std::uint64_t get_max() const
+    {
+        return max;
+    }
+
+    // The largest value in the bucket that holds the fraction p of the values, at most get_max()
+    std::uint64_t get_percentile(double p) const;
+
+private:
+    // values below 8 have a bucket each; then 8 buckets for each power of two up to 2^63
+    static const int num_buckets = 8 + 61 * 8;
+
+    std::uint64_t buckets[num_buckets];
+    std::uint64_t count;
+    std::uint64_t max;
+
+    static int get_bucket(std::uint64_t value);
+    static std::uint64_t get_bucket_top(int bucket);
+};
+
+class Profiler
+{
+public:
+    // Calls kept for the trace per thread; the rest are only counted
+    static const std::size_t max_trace_events = 1000000;
+
+    // Profiler for the whole program
+    static Profiler& get_instance();
+
+    // A reading of the clock, in clock units
+    static std::uint64_t read_clock()
+    {
+#ifdef PROFILER_RDTSC
+        return __rdtsc();
+#else
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch())
+            .count();
+#endif
+    }
+
+    // Record a call of section that ran from start to end, in clock units
+    void record(Profile_section section, std::uint64_t start, std::uint64_t end);
+
+    // Count a change recorded for the Views
+    void count_notification();
+
+    // Count a heap allocation; called by operator new, so it may not allocate
+    static void count_allocation() noexcept
+    {
+        num_allocations.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Close the counts of the tick that has just ended
+    void end_tick();
+
+    // Start keeping every call for write_trace
+    void set_tracing(bool tracing_)
+    {
+        tracing.store(tracing_, std::memory_order_relaxed);
+    }
+
+    // Write p50/p99/max of each section that has run, and of the counts per tick
+    void write_stats(std::ostream& os);
+
+    // Write the calls kept since tracing started, and the counts of each tick,
+    // as a Chrome trace-event file. Throws Error if the file cannot be written.
+    void write_trace(const std::string& filename);
+
+    // disallow copy/move construction or assignment
+    Profiler(Profiler& obj) = delete;
+    Profiler(Profiler&& obj) = delete;
+    Profiler& operator=(Profiler& obj) = delete;
+    Profiler& operator=(Profiler&& obj) = delete;
+
+private:
+    Profiler();
+
+    // What one thread has recorded
+    struct Thread_data;
+
+    // The calling thread's data
+    static thread_local Thread_data* this_thread_data;
+
+    static std::atomic<std::uint64_t> num_allocations;
+
+    std::atomic<bool> tracing;
+
+    // Where the clock and steady_clock stood when the Profiler was made
+    std::uint64_t start_clock;
+    std::chrono::steady_clock::time_point start_time;
+
+    // The data of every thread that has recorded; guarded by threads_mutex
+    std::vector<std::unique_ptr<Thread_data>> threads;
+    std::mutex threads_mutex;
+
+    // The calling thread's data, made on first use
+    Thread_data& get_thread_data();
+
+    // Nanoseconds per clock unit, measured over the run so far
+    double get_clock_period() const;
+};
+
+// Records the time from its construction to its destruction as a call of a section
+class Profile_scope
+{
+public:
+    explicit Profile_scope(Profile_section section_)
+        : section(section_)
+        , start(Profiler::read_clock())
+    { }
+    ~Profile_scope()
+    {
+        Profiler::get_instance().record(section, start, Profiler::read_clock());
+    }
+
+    Profile_scope(const Profile_scope& obj) = delete;
+    Profile_scope& operator=(const Profile_scope& obj) = delete;
+
+private:
+    Profile_section section;
+    std::uint64_t start;
+};
+
+#ifdef SIMULATION_PROFILE
+const bool profiler_built_in = true;
+
+// Time the rest of the block as a call of section, e.g. PROFILE_SCOPE(Profile_section::tick);
+#define PROFILE_SCOPE(section) Profile_scope profile_scope(section)
+#define PROFILE_COUNT_NOTIFICATION() Profiler::get_instance().count_notification()
+#define PROFILE_END_TICK() Profiler::get_instance().end_tick()
+#define PROFILE_COUNT_ALLOCATION() Profiler::count_allocation()
+#else
+const bool profiler_built_in = false;
+
+#define PROFILE_SCOPE(section)
+#define PROFILE_COUNT_NOTIFICATION()
+#define PROFILE_END_TICK()
+#define PROFILE_COUNT_ALLOCATION()
+#endif
+
+#endif
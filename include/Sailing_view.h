@@ -11,7 +11,7 @@ class Sailing_view : public View
 {
 public:
     // Print Sailing data for all Ships.
-    void draw() override;
+    void draw(std::ostream& os) override;
 };
 
 #endif
\ No newline at end of file
@@ -13,6 +13,9 @@ The describe function outputs information about the ship state.
 Accessors make the ship state available to either the public or to derived classes.
 The is a "fat interface" for the capabilities of derived types of Ships. These
 functions are implemented in this class to throw an Error exception.
+Which of them a type of Ship carries out is given by its capabilities, and each
+command has a try_ form that returns the message of the Error instead of throwing
+it, for callers that give many commands and only count the failures.
 */
 
 #ifndef SHIP_H
@@ -20,12 +23,16 @@ functions are implemented in this class to throw an Error exception.
 
 #include "Geometry.h"
 #include "Ship_component.h"
+#include "Ship_store.h"
 #include "Sim_object.h"
 #include "Track_base.h"
 #include <memory>
 #include <string>
 
+class Checkpoint_reader;
+class Checkpoint_writer;
 class Island;
+struct Ship_record;
 
 class Ship
     : public Sim_object
@@ -38,14 +45,41 @@ public:
     // Print this Ship's name.
     virtual void describe_component() const override;
 
-    // Check if ship is equal to this Ship
-    virtual bool check_if_ship_exists(const std::string& ship) const override;
+    // Return this Ship
+    virtual Ship* as_ship() override
+    {
+        return this;
+    }
+
+    // Add this Ship to a checkpoint's group at index parent
+    virtual void save_group(Checkpoint_writer& writer, int parent) const override;
+
+    // Give this Ship's slot in the Ship_store back
+    virtual ~Ship();
 
     /*** Readers ***/
     // return the current position
     Point get_location() const override
     {
-        return tracker.get_position();
+        return store.get_position(store_index);
+    }
+
+    // return this Ship's movement as a track
+    Track_base get_track() const
+    {
+        return Track_base(get_location(), store.get_course_speed(store_index));
+    }
+
+    // return this Ship's velocity in nm per hour, zero if it is not moving
+    Cartesian_vector get_velocity() const
+    {
+        return store.get_velocity(store_index);
+    }
+
+    // return the fuel on board, in tons
+    double get_fuel() const
+    {
+        return store.get_fuel(store_index);
     }
 
     // Return true if ship can move (it is not dead in the water or in the process or sinking);
@@ -64,9 +98,48 @@ public:
     // is less than or equal to 0.1 nm
     bool can_dock(std::shared_ptr<Island> island_ptr) const;
 
+    /*** Capabilities ***/
+    // The fat interface commands a type of Ship carries out, one bit each;
+    // the commands of every Ship - moving, stopping, docking, and refueling - have none
+    static const unsigned int can_chain = 1;  // chain_all_ship, chain_ship, and unchain_ship
+    static const unsigned int can_load = 2;  // set_load_destination and set_unload_destination
+    static const unsigned int can_attack = 4;  // attack and stop_attack
+
+    // Return the bits of the commands this type of Ship carries out; none for a Ship
+    virtual unsigned int get_capabilities() const
+    {
+        return 0;
+    }
+
+    /*** Command checks ***/
+    // Each returns the message of the Error that the command would throw before
+    // doing anything, or nullptr if it would not throw then. Only this Ship's own
+    // state is read, so that many Ships can be checked concurrently.
+
+    // for set_destination_position_and_speed, set_destination_island_and_speed, and set_course_and_speed
+    virtual const char* check_move(double speed) const;
+    virtual const char* check_stop() const;
+    const char* check_dock(std::shared_ptr<Island> island_ptr) const;
+    const char* check_refuel() const;
+    // A Ship without the capability for a command fails these with the message of its fat interface function
+    virtual const char* check_chain_all() const;
+    virtual const char* check_chain(std::shared_ptr<Ship> target) const;
+    virtual const char* check_unchain(std::shared_ptr<Ship> target) const;
+    virtual const char* check_load_destination() const;
+    virtual const char* check_unload_destination() const;
+    virtual const char* check_attack(std::shared_ptr<Ship> target) const;
+    virtual const char* check_stop_attack() const;
+
     /*** Interface to derived classes ***/
     // Update the state of the Ship
     void update() override;
+    // A moving Ship can skip the steps before it arrives or runs out of fuel;
+    // a Ship that is not moving has nothing to do.
+    int ticks_until_event() const override;
+    // arrive_at or fuel_empty
+    Event_type get_event_type() const override;
+    // Move ticks steps at once and notify Model of the new location and fuel
+    void advance(int ticks) override;
     // output a description of current state to cout
     void describe() const override;
     // Notify Model about this Ship's name and location.
@@ -121,12 +194,32 @@ public:
     // will always throw Error("Cannot attack!");
     virtual void stop_attack() override;
 
+    /*** Non-throwing command functions ***/
+    // Each gives the command as above and returns nullptr, or returns the message
+    // of the Error the command would throw. A command that fails its check throws
+    // nothing at all; only the rare failures found part way through a command,
+    // such as a Chain_ship finding no Ship to chain, are thrown and caught inside.
+    const char* try_set_destination_position_and_speed(Point destination_position, double speed);
+    const char* try_set_destination_island_and_speed(std::shared_ptr<Island> destination_island, double speed);
+    const char* try_set_course_and_speed(double course, double speed);
+    const char* try_stop();
+    const char* try_dock(std::shared_ptr<Island> island_ptr);
+    const char* try_refuel();
+    const char* try_chain_all_ship();
+    const char* try_chain_ship(std::shared_ptr<Ship> target);
+    const char* try_unchain_ship(std::shared_ptr<Ship> target);
+    const char* try_set_load_destination(std::shared_ptr<Island> island_ptr);
+    const char* try_set_unload_destination(std::shared_ptr<Island> island_ptr);
+    const char* try_attack(std::shared_ptr<Ship> target);
+    const char* try_stop_attack();
+
     // interactions with other objects
     // receive a hit from an attacker
     virtual void receive_hit(int hit_force, std::shared_ptr<Ship> attacker_ptr);
 
 protected:
-    Ship(const std::string& name_,
+    Ship(Model& model_,
+        const std::string& name_,
         Point position_,
         double fuel_capacity_,
         double maximum_speed_,
@@ -139,33 +232,33 @@ protected:
     // return pointer to current destination Island, nullptr if not set
     std::shared_ptr<Island> get_destination_Island() const;
 
+    // Return the part of a checkpoint record that every Ship has
+    Ship_record make_ship_record(Checkpoint_writer& writer) const;
+    // Set this Ship's movement, fuel, resistance, and Islands from a checkpoint record
+    // Throws Error if the record is not valid.
+    void restore_ship_record(const Ship_record& record, const Checkpoint_reader& reader);
+
 private:
-    double fuel;  // Current amount of fuel
+    // The per-tick state - position, course, speed, fuel, fuel consumption,
+    // destination point, and movement state - is kept in the Ship_store
+    Ship_store& store;
+    int store_index;
+
     double fuel_capacity;
     double maximum_speed;
-    double fuel_consumption;  // tons/nm required
-    Point destination_point;  // Current destination position
     std::shared_ptr<Island> destination_Island;  // Current destination Island, if any
     std::shared_ptr<Island> docked_island;
     int resistance;
 
-    Track_base tracker;
+    using State = Ship_state;
+
+    State get_state() const
+    {
+        return store.get_state(store_index);
+    }
 
     // Updates position, fuel, and movement_state, assuming 1 time unit (1 hr)
     void calculate_movement();
-
-    enum class State
-    {
-        sunk,
-        moving_to_position,
-        moving_to_island,
-        moving_on_course,
-        docked,
-        stopped,
-        dead_in_the_water,
-    };
-
-    State ship_state;
 };
 
-#endif
\ No newline at end of file
+#endif
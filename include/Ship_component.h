@@ -9,9 +9,11 @@ both Ships and Ship_composites in its container.
 #ifndef SHIP_COMPONENT_H
 #define SHIP_COMPONENT_H
 
+#include <functional>
 #include <memory>
 #include <string>
 
+class Checkpoint_writer;
 class Island;
 class Ship;
 struct Point;
@@ -25,14 +27,19 @@ public:
     // index_count is 1, it is right below a top group.
     static int& index_counter();
 
-    // Always return nullptr
-    virtual std::shared_ptr<Ship_component> find_ship_composite(const std::string& name);
+    // Return this Ship_component as a Ship, or nullptr if it is a group
+    virtual Ship* as_ship();
 
-    // Always return false
-    virtual bool find_and_remove_ship_composite(const std::string& name);
+    // Called with each Ship_component under a group and the name of the group that holds it directly
+    using Member_visitor = std::function<void(const std::shared_ptr<Ship_component>&, const std::string&)>;
 
-    // Always return false
-    virtual bool check_if_ship_exists(const std::string& ship) const;
+    // Call visit for every Ship_component under this one, all the way down,
+    // each group before what it holds. Does nothing by default.
+    virtual void visit_members(const Member_visitor& visit) const;
+
+    // Add this Ship_component to a checkpoint's groups, in the group at index parent.
+    // Does nothing by default.
+    virtual void save_group(Checkpoint_writer& writer, int parent) const;
 
     /*** Fat Interface Functioins ***/
 
@@ -4,17 +4,24 @@
 #include <memory>
 #include <string>
 
+class Island;
+class Model;
 struct Point;
 class Ship;
 class Ship_component;
 /* This is a very simple form of factory, a function; you supply the information, it creates
-the specified kind of object and returns a pointer to it. The Ship is allocated
-with new, so some other component is resposible for deleting it.
+the specified kind of object and returns a pointer to it. The object is made in the
+Model's Object_arena, in the same block as its shared_ptr control block, and goes
+back to the arena when the last shared_ptr to it goes (see Object_arena.h).
 */
 
 // may throw Error("Trying to create ship of unknown type!")
-std::shared_ptr<Ship> create_ship(const std::string& name, const std::string& type, Point initial_position);
+std::shared_ptr<Ship> create_ship(
+    Model& model, const std::string& name, const std::string& type, Point initial_position);
 
-std::shared_ptr<Ship_component> create_composite(const std::string& name);
+std::shared_ptr<Island> create_island(
+    Model& model, const std::string& name, Point position, double fuel = 0., double production_rate = 0.);
+
+std::shared_ptr<Ship_component> create_composite(Model& model, const std::string& name);
 
 #endif
\ No newline at end of file
@@ -2,26 +2,38 @@
 Ship_composite represents a class which can contain
 Ship_components which can be either a Ship or a Ship_composite.
 When you issue a ship command to a Ship_composite, the Ship_composite
-performs the command on its container of Ship_components. If a Ship_component
-throws an Error because a command could not be performed on it, the Error
-is simply ignored.
+performs the command on every Ship in it, all the way down, in the order in
+which a walk through its container of Ship_components would reach them. The
+Ships that cannot carry out the command are left as they are and the rest go
+on; how many did, and which did not and why, is kept in a Group_status and
+logged. Only the checks of whether each Ship can carry out the command run in
+parallel; the command itself is then given to the Ships one at a time, in order.
 */
 
 #ifndef SHIP_COMPOSITE_H
 #define SHIP_COMPOSITE_H
 
 #include "Ship_component.h"
+#include <functional>
 #include <map>
 #include <memory>
 #include <string>
 #include <vector>
 
 class Island;
+class Ship;
 struct Point;
 
-class Ship_composite
-    : public Ship_component
-    , public std::enable_shared_from_this<Ship_composite>
+// What became of the last command given to a group
+struct Group_status
+{
+    int num_ships = 0;  // the Ships it was given to
+    int num_carried_out = 0;
+    // The Ships that did not carry it out, in the order they were given it, with the message of the Error
+    std::vector<std::pair<std::shared_ptr<Ship>, const char*>> failures;
+};
+
+class Ship_composite : public Ship_component
 {
 public:
     Ship_composite(std::string composite_name_);
@@ -32,25 +44,31 @@ public:
     // Remove a Ship_component from ship_components
     virtual void remove_component(std::shared_ptr<Ship_component> ship_component) override;
 
-    // Find Ship_composite from ship_components
-    virtual std::shared_ptr<Ship_component> find_ship_composite(const std::string& name) override;
-
-    // Find Ship_composite and remove it
-    virtual bool find_and_remove_ship_composite(const std::string& name) override;
+    // Call visit for every Ship_component in ship_components, all the way down,
+    // each group before what it holds
+    virtual void visit_members(const Member_visitor& visit) const override;
 
-    // Return a bool indicating if a Ship exists in ship_components
-    virtual bool check_if_ship_exists(const std::string& ship) const override;
+    // Add this Ship_composite and its Ship_components to a checkpoint's groups,
+    // under the group at index parent (-1 for a top group)
+    virtual void save_group(Checkpoint_writer& writer, int parent) const override;
 
     // Describe ship_components
     virtual void describe_component() const override;
 
     virtual std::string get_name() const override;
 
+    // Return the Ships in this group, all the way down, in the order they are given commands
+    std::vector<std::shared_ptr<Ship>> get_ships() const;
+
+    const Group_status& get_last_status() const
+    {
+        return last_status;
+    }
+
     /*** Command functions ***/
 
-    // When given a command, this Ship_composite also performs the command on its container
-    // of Ship_components. If a Ship_component throws an Error because a command could not
-    // be performed on it, the Error is simply ignored.
+    // When given a command, this Ship_composite gives it to each of its Ships in turn.
+    // The Ships that cannot carry it out are counted in the Group_status, and no Error is thrown.
 
     // Start moving to a destination position at a speed
     virtual void set_destination_position_and_speed(Point destination_position, double speed);
@@ -94,6 +112,15 @@ public:
 private:
     std::map<std::string, std::shared_ptr<Ship_component>> ship_components;
     std::string composite_name;
+    Group_status last_status;
+
+    // Return the message of the Error a Ship would throw at once, or nullptr
+    using Check = std::function<const char*(const Ship&)>;
+    // Give the command to a Ship without throwing; return the message of the failure, or nullptr
+    using Give = std::function<const char*(Ship&)>;
+
+    // Check every Ship concurrently, then give the command to those that passed in order
+    void give_command(const Check& check, const Give& give);
 };
 
 #endif
\ No newline at end of file
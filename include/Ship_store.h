@@ -0,0 +1,172 @@
+/*
+Ship_store keeps the per-tick state of every Ship - position, course, speed,
+fuel, destination, and movement state - in one contiguous array per field
+(a structure of arrays) instead of inside each Ship object. A Ship is given a
+dense index into the arrays when it is created and gives it back when it is
+destroyed; the Ship itself only keeps its rarely used data and acts as a
+handle for the rest.
+
+Each Model has its own Ship_store for the Ships in its world.
+
+Keeping the fields in columns lets the movement of all Ships be computed in
+one tight loop over the arrays (plan_movement), with the position update done
+by the vectorized advance_positions kernel. The unit vector for each Ship's
+course is kept alongside the course and only recomputed when it changes.
+Each computed movement is remembered together with the version of the Ship's
+state it was computed from. Every write to a Ship's state bumps its version,
+so move() can tell whether a planned movement still applies or has to be
+recomputed.
+*/
+
+#ifndef SHIP_STORE_H
+#define SHIP_STORE_H
+
+#include "Geometry.h"
+#include "Navigation.h"
+#include <vector>
+
+// The movement state of a Ship
+enum class Ship_state : unsigned char
+{
+    sunk,
+    moving_to_position,
+    moving_to_island,
+    moving_on_course,
+    docked,
+    stopped,
+    dead_in_the_water,
+};
+
+class Ship_store
+{
+public:
+    // Add a stopped Ship at position with a full tank and return its index
+    int add(Point position, double fuel, double fuel_consumption);
+
+    // Give the index back for reuse by a later Ship
+    void remove(int index);
+
+    // Return the number of slots, including free ones
+    int get_size() const
+    {
+        return static_cast<int>(state.size());
+    }
+
+    /*** Readers ***/
+    Point get_position(int index) const
+    {
+        return Point(x[index], y[index]);
+    }
+
+    Course_speed get_course_speed(int index) const
+    {
+        return Course_speed(course[index], speed[index]);
+    }
+
+    double get_course(int index) const
+    {
+        return course[index];
+    }
+
+    double get_speed(int index) const
+    {
+        return speed[index];
+    }
+
+    double get_fuel(int index) const
+    {
+        return fuel[index];
+    }
+
+    Point get_destination(int index) const
+    {
+        return Point(destination_x[index], destination_y[index]);
+    }
+
+    Ship_state get_state(int index) const
+    {
+        return state[index];
+    }
+
+    bool is_moving(int index) const
+    {
+        return is_moving_state(state[index]);
+    }
+
+    // Return the velocity of a Ship in nm per hour, zero if it is not moving
+    Cartesian_vector get_velocity(int index) const
+    {
+        if (!is_moving(index))
+            return Cartesian_vector();
+        return Cartesian_vector(heading_x[index] * speed[index], heading_y[index] * speed[index]);
+    }
+
+    // Return the highest speed of any moving Ship, 0 if none is moving
+    double get_max_speed() const;
+
+    /*** Writers ***/
+    // Each of these makes any planned movement for the Ship stale
+    void set_position(int index, Point position);
+    void set_course(int index, double course_);
+    void set_speed(int index, double speed_);
+    void set_fuel(int index, double fuel_);
+    void set_destination(int index, Point destination);
+    void set_state(int index, Ship_state state_);
+
+    /*** Movement ***/
+    // Compute one time unit of movement for every moving Ship and remember it.
+    // Only the store's own arrays are touched; the work is split over the Thread_pool.
+    void plan_movement();
+
+    // Update position, fuel, speed, and state of a moving Ship for one time unit,
+    // using the planned movement if it is still current.
+    void move(int index);
+
+    // Return how many time units a moving Ship can certainly move and still be
+    // moving, with a margin of one for rounding; the largest int if it never stops.
+    int get_ticks_until_stop(int index) const;
+
+    // Return true if a moving Ship will reach its destination before it runs out of fuel
+    bool will_arrive(int index) const;
+
+    // Move a Ship for ticks time units at once, to exactly where ticks calls of move()
+    // would; ticks must not be more than get_ticks_until_stop(index).
+    void advance(int index, int ticks);
+
+private:
+    // Per-Ship columns
+    std::vector<double> x, y;
+    std::vector<double> course, speed;
+    std::vector<double> heading_x, heading_y;  // course_unit_vector() of course
+    std::vector<double> fuel, fuel_consumption;
+    std::vector<double> destination_x, destination_y;
+    std::vector<Ship_state> state;
+    std::vector<unsigned int> version;
+
+    // Planned movement columns
+    std::vector<double> planned_x, planned_y;
+    std::vector<double> planned_fuel, planned_speed;
+    std::vector<Ship_state> planned_state;
+    std::vector<unsigned int> planned_version;  // version of the state a plan was made from
+    std::vector<double> planned_time;  // how long a Ship can move during the step
+
+    std::vector<int> free_indices;
+
+    static bool is_moving_state(Ship_state state_)
+    {
+        return state_ == Ship_state::moving_to_position || state_ == Ship_state::moving_to_island
+            || state_ == Ship_state::moving_on_course;
+    }
+
+    // Compute one time unit of movement for the Ships in [begin, end) into the planned columns.
+    // Ships that are not moving get a plan that leaves them where they are.
+    void plan_movement(int begin, int end);
+
+    // Mark the state of the Ship at index as changed
+    void touch(int index)
+    {
+        ++version[index];
+    }
+};
+
+#endif
@@ -2,17 +2,55 @@
 #define SIM_OBJECT_H
 
 /* The Sim_object class provides the interface for all of simulation objects.
-It also stores the object's name, and has pure virtual accessor functions for
-the object's position and other information. */
+It also stores the id the Model gives to the object's name, the name itself
+as kept in the Model's Name_table, and the Model it belongs to, and has pure
+virtual accessor functions for the object's position and other information. */
 
+#include "Name_table.h"
+#include <limits>
 #include <string>
 
+class Checkpoint_writer;
+class Model;
 struct Point;
 
+// What ends a stretch of updates that an object could skip
+enum class Event_type
+{
+    arrive_at,  // a Ship reaches its destination
+    fuel_empty,  // a Ship runs out of fuel
+    dock_complete,  // a Ship that has stopped at an Island docks there
+    refuel_complete,  // a docked Ship finishes taking on or handing over fuel
+    target_in_range,  // a Warship fires at, or loses, its target
+    state_change,  // anything else that needs a full update
+};
+
+// How one object refers to another without owning it: the id of the object and
+// the generation of the id when the handle was taken. The Model moves an id on
+// to its next generation when the object with it is removed, so a handle to an
+// object that is gone resolves to nullptr (see Model::resolve_ship), even if
+// another object has since been given the name. The default handle refers to
+// no object.
+struct Object_handle
+{
+    Object_id id = no_object_id;
+    unsigned int generation = 0;
+};
+
+inline bool operator==(Object_handle handle1, Object_handle handle2)
+{
+    return handle1.id == handle2.id && handle1.generation == handle2.generation;
+}
+
+inline bool operator!=(Object_handle handle1, Object_handle handle2)
+{
+    return !(handle1 == handle2);
+}
+
 class Sim_object
 {
 public:
-    Sim_object(const std::string& name_);
+    Sim_object(Model& model_, const std::string& name_);
     virtual ~Sim_object()
     { }
 
@@ -21,6 +59,18 @@ public:
         return name;
     }
 
+    // Return the id of this object's name in its Model
+    Object_id get_id() const
+    {
+        return id;
+    }
+
+    // Return the Model this object is in
+    Model& get_model() const
+    {
+        return model;
+    }
+
     /* Interface for derived classes */
     // Ask model to notify views of current state
     virtual void broadcast_current_state() const = 0;
@@ -29,6 +79,31 @@ public:
     virtual void describe() const = 0;
     virtual void update() = 0;
 
+    // Add this object's record to a checkpoint
+    virtual void save(Checkpoint_writer& writer) const = 0;
+
+    // Return how many of the coming updates this object could skip over with advance()
+    // because in each of them it would do nothing but move steadily or accumulate,
+    // without any change of state or effect on other objects. Returns no_event if that
+    // holds indefinitely, and 0 if the next update must be done in full.
+    virtual int ticks_until_event() const
+    {
+        return 0;
+    }
+
+    // Bring the object to where ticks quiet updates would have brought it, without
+    // any output. ticks must not be more than ticks_until_event().
+    virtual void advance(int /* ticks */)
+    { }
+
+    // Return what will happen at the end of the ticks_until_event() quiet updates
+    virtual Event_type get_event_type() const
+    {
+        return Event_type::state_change;
+    }
+
+    static constexpr int no_event = std::numeric_limits<int>::max();
+
     // Sim_objects must be unique, so disable copy/move construction, assignment
     // of base class; this will disable these operations for derived classes also.'
     Sim_object(Sim_object& obj) = delete;
@@ -37,7 +112,9 @@ public:
     Sim_object& operator=(Sim_object&& obj) = delete;
 
 private:
-    std::string name;
+    Model& model;
+    Object_id id;
+    const std::string& name;  // in the Model's Name_table
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,118 @@
+/*
+Spatial_grid is a uniform grid index of objects in the plane, known by their
+Object_ids, used by Model to answer proximity questions without looking at
+every object.
+
+The plane is divided into square cells of a fixed size. Only cells that hold
+at least one object are stored, so the world can be any size. An object is
+kept in the cell that contains its location, and is moved to another cell
+when its location changes.
+
+A query looks at the cell containing its center first and then at rings of
+cells further and further out, stopping as soon as no unvisited cell could
+hold a better answer. When that would mean visiting more cells than there are
+objects, it looks at every object instead. Either way the answer is the same.
+
+Distances are computed with cartesian_distance. When two objects are at the
+same distance, the one whose name comes first is taken to be closer, which
+matches a scan of the objects in name order; the names are looked up in the
+Model's Name_table only to break such ties and to sort.
+*/
+
+#ifndef SPATIAL_GRID_H
+#define SPATIAL_GRID_H
+
+#include "Geometry.h"
+#include "Name_table.h"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+class Spatial_grid
+{
+public:
+    // A predicate on an object's id and location
+    using Predicate = std::function<bool(Object_id, Point)>;
+
+    // The names of the objects are those in names
+    Spatial_grid(double cell_size_, const Name_table& names_);
+
+    // Add an object, or move it if it is already in the grid
+    void insert(Object_id id, Point location);
+
+    // Move an object that is in the grid; do nothing if it is not
+    void move(Object_id id, Point location);
+
+    // Take an object out of the grid; do nothing if it is not there
+    void remove(Object_id id);
+
+    int get_size() const
+    {
+        return num_objects;
+    }
+
+    // Return the ids of the k objects closest to center, closest first
+    std::vector<Object_id> find_nearest(Point center, int k) const;
+
+    // Return the ids of the objects within radius of center, in name order
+    std::vector<Object_id> find_within(Point center, double radius) const;
+
+    // Return the id of the closest object to center for which predicate is true,
+    // or no_object_id if there is none
+    Object_id find_nearest_if(Point center, const Predicate& predicate) const;
+
+private:
+    using Cell_key = std::int64_t;
+
+    double cell_size;
+    const Name_table* names;
+
+    // By id, whether the object is in the grid, and where
+    std::vector<bool> in_grid;
+    std::vector<Point> locations;
+    int num_objects;
+
+    std::unordered_map<Cell_key, std::vector<Object_id>> cells;
+
+    // Cell coordinates of every cell that has ever been used, so that a
+    // ring search knows when it has gone past all of them
+    int min_cell_x, max_cell_x, min_cell_y, max_cell_y;
+
+    int to_cell(double coordinate) const;
+    static Cell_key make_key(int cell_x, int cell_y);
+
+    // True if the object with id1 at distance1 counts as closer than the one with id2 at distance2
+    bool is_closer(double distance1, Object_id id1, double distance2, Object_id id2) const
+    {
+        return distance1 < distance2 || (distance1 == distance2 && names->get_name(id1) < names->get_name(id2));
+    }
+
+    bool contains(Object_id id) const
+    {
+        return std::size_t(id) < in_grid.size() && in_grid[id];
+    }
+
+    void add_to_cell(Object_id id, Point location);
+    void remove_from_cell(Object_id id, Point location);
+
+    // Call visit(id, location) for each object in the grid
+    void visit_all(const std::function<void(Object_id, Point)>& visit) const;
+
+    // Call visit(id, location) for each object in the given cell
+    void visit_cell(int cell_x, int cell_y, const std::function<void(Object_id, Point)>& visit) const;
+
+    // Call visit(id, location) for each object in the cells on the square ring
+    // at distance ring from (cell_x, cell_y); ring 0 is the center cell alone.
+    void visit_ring(int cell_x, int cell_y, int ring, const std::function<void(Object_id, Point)>& visit) const;
+
+    // The smallest distance from center to anything outside the square of
+    // rings 0 through ring around its cell
+    double distance_past_ring(Point center, int ring) const;
+
+    // True if rings beyond ring around (cell_x, cell_y) cannot hold any object
+    bool past_all_cells(int cell_x, int cell_y, int ring) const;
+};
+
+#endif
@@ -18,12 +18,19 @@ resistance 0, cargo capacity 1000 tons, initial cargo is 0 tons.
 #include <memory>
 
 class Island;
+struct Tanker_record;
 
 class Tanker : public Ship
 {
 public:
     // initialize, the output constructor message
-    Tanker(const std::string& name_, Point position_);
+    Tanker(Model& model_, const std::string& name_, Point position_);
+
+    // Tankers can load and unload cargo
+    unsigned int get_capabilities() const override
+    {
+        return can_load;
+    }
 
     // This class overrides these Ship functions so that it can check if this Tanker has assigned cargo destinations.
     // if so, throw an Error("Tanker has cargo destinations!"); otherwise, simply call the Ship functions.
@@ -31,6 +38,9 @@ public:
     void set_destination_island_and_speed(std::shared_ptr<Island> destination_island, double speed) override;
     void set_course_and_speed(double course, double speed) override;
 
+    // A Tanker with cargo destinations refuses to move before anything else
+    const char* check_move(double speed) const override;
+
     // Set the loading and unloading Island destinations
     // if both cargo destination are already set, throw Error("Tanker has cargo destinations!").
     // if they are the same, leave at the set values, and throw Error("Load and unload cargo destinations are the
@@ -38,15 +48,29 @@ public:
     void set_load_destination(std::shared_ptr<Island>) override;
     void set_unload_destination(std::shared_ptr<Island>) override;
 
+    // A Tanker with cargo destinations refuses new ones
+    const char* check_load_destination() const override;
+    const char* check_unload_destination() const override;
+
     // when told to stop, clear the cargo destinations and stop
     void stop() override;
 
     // perform Tanker-specific behavior
     void update() override;
+    // A Tanker that is loading, unloading, or about to dock must be updated;
+    // otherwise it can be advanced like any Ship.
+    int ticks_until_event() const override;
+    Event_type get_event_type() const override;
     // Call Ship::describe() first, and describe this Tanker's
     // specific states.
     void describe() const override;
 
+    // Add this Tanker's record to a checkpoint
+    void save(Checkpoint_writer& writer) const override;
+    // Set this Tanker's state, cargo, and cargo destinations from a checkpoint record
+    // Throws Error if the record is not valid.
+    void restore(const Tanker_record& record, const Checkpoint_reader& reader);
+
 private:
     double cargo, cargo_capacity;
     std::shared_ptr<Island> load_destination;
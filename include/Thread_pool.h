@@ -0,0 +1,75 @@
+/*
+Thread_pool is a small fixed-size pool of worker threads used to run
+independent pieces of work in parallel. The only operation it offers is
+parallel_for, which splits the index range [0, count) into chunks and hands
+them out to the workers and the calling thread. parallel_for returns only
+after every chunk has been processed, so callers never see work in flight.
+A parallel_for called from inside a chunk runs on the calling thread alone.
+*/
+
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class Thread_pool
+{
+public:
+    // Create a pool with the given number of threads, counting the calling thread.
+    // A value of 0 means one thread per hardware thread.
+    explicit Thread_pool(unsigned int num_threads = 0);
+    ~Thread_pool();
+
+    // Call body(begin, end) for disjoint chunks covering [0, count).
+    // Chunks may run concurrently, so body must only touch data owned by its chunk.
+    void parallel_for(std::size_t count, const std::function<void(std::size_t, std::size_t)>& body);
+
+    unsigned int get_num_threads() const
+    {
+        return static_cast<unsigned int>(workers.size()) + 1;
+    }
+
+    // Pool shared by the whole program
+    static Thread_pool& get_instance();
+
+    // disallow copy/move construction or assignment
+    Thread_pool(Thread_pool& obj) = delete;
+    Thread_pool(Thread_pool&& obj) = delete;
+    Thread_pool& operator=(Thread_pool& obj) = delete;
+    Thread_pool& operator=(Thread_pool&& obj) = delete;
+
+private:
+    std::vector<std::thread> workers;
+
+    std::mutex job_mutex;
+    std::condition_variable job_ready;
+    std::condition_variable job_done;
+
+    // The job currently being run; guarded by job_mutex
+    const std::function<void(std::size_t, std::size_t)>* job_body;
+    std::size_t job_count;
+    std::size_t job_chunk_size;
+    std::size_t next_chunk;
+    std::size_t chunks_left;
+    unsigned long job_generation;
+    bool shutting_down;
+
+    // Serializes callers of parallel_for
+    std::mutex caller_mutex;
+
+    // True while the thread is running a chunk
+    static thread_local bool in_chunk;
+
+    void worker_loop();
+
+    // Grab and run chunks of the current job until none are left.
+    // job_mutex must be held by lock on entry and is held on exit.
+    void run_chunks(std::unique_lock<std::mutex>& lock);
+};
+
+#endif
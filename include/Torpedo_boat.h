@@ -1,6 +1,10 @@
 /*
 A Torpedo_boat is similar to a Cruiser, but when commanded to attack, a Torpedo_boat
-closes with its target by changing its course on every update. When it is close enough,
+closes with its target. It heads at full speed for the point where it will meet the
+target if the target holds its course and speed (see compute_intercept), and plans
+again only when the target's course or speed changes, or when it has stopped or been
+sent elsewhere; a target too fast to be caught that way it chases by heading for
+where the target is on every update. When it is close enough,
 it fires at the target and continues until the target is sunk like Cruiser. However,
 if a Torpedo_boat is fired upon, instead of counter-attacking like Cruiser, it runs away
 to an Island of refuge.
@@ -13,24 +17,48 @@ resistance 9, firepower 3, maximum attacking range 5
 #ifndef TORPEDO_BOAT_H
 #define TORPEDO_BOAT_H
 
+#include "Navigation.h"
 #include "Warship.h"
 
 struct Point;
+struct Torpedo_boat_record;
 
 class Torpedo_boat : public Warship
 {
 public:
-    Torpedo_boat(const std::string& name_, Point position_);
+    Torpedo_boat(Model& model_, const std::string& name_, Point position_);
 
-    // When target is out of range this Torpedo_boat can move,
-    // set the target's loation as the destination.
+    // When target is out of range and this Torpedo_boat can move,
+    // head for where it will meet the target.
     void update() override;
 
+    // Start an attack on a target ship, with a new intercept
+    void attack(std::shared_ptr<Ship> target_ptr_) override;
+
+    void stop_attack() override;
+
     // Describe this Torpedo_boat's state
     void describe() const override;
 
     // Perform Torpedo_boat specific behavior for receive_hit
     void receive_hit(int hit_force, std::shared_ptr<Ship> attacker_ptr) override;
+
+    // Add this Torpedo_boat's record to a checkpoint
+    void save(Checkpoint_writer& writer) const override;
+    // Set this Torpedo_boat's state, target, and intercept from a checkpoint record
+    // Throws Error if the record is not valid.
+    void restore(const Torpedo_boat_record& record, const Checkpoint_reader& reader);
+
+private:
+    // Whether this Torpedo_boat is heading for an intercept point, its course to
+    // it, and the target's course and speed that the intercept was planned for
+    bool intercepting;
+    double planned_course;
+    Course_speed planned_target_cs;
+
+    // Head for the point where this Torpedo_boat will meet target moving on target_cs,
+    // or for where target is now if it cannot be met
+    void plan_intercept(const Ship& target, Course_speed target_cs);
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,144 @@
+/*
+Tour_planner plans a short closed tour through a set of points - the route of
+a cruise that visits every Island once and comes back - as the order in which
+to visit them. The shortest tour takes time exponential in the number of
+points to find, so the planner builds a good one quickly instead, in two
+phases. The first is the greedy tour: from the first point, always go on to
+the nearest point not yet visited. The second improves it with local moves for
+as long as one of them makes the tour shorter: 2-opt, which takes two edges
+out of the tour and joins it up the other way, reversing the path between
+them, and Or-opt, which moves a run of up to three points that follow one
+another, either way round, to between two other points.
+
+Only moves that join a point to one of its nearest neighbours are looked at,
+since the other moves seldom make a good tour shorter. Each point's
+neighbours, with their distances, are found once, with a uniform grid over the
+points that also finds the greedy tour; they are the rows of the distance
+matrix that the moves need, where the whole matrix would take memory in
+proportion to the square of the number of points - 200 MB for 5000 of them. A
+point whose moves have all been looked at without finding one that helps is
+passed over until a move changes one of its edges. So thousands of points are
+planned for in a fraction of a second.
+
+The tour is kept as an array of the points in the order they are visited,
+with the first point staying first, and where each point is in it.
+*/
+
+#ifndef TOUR_PLANNER_H
+#define TOUR_PLANNER_H
+
+#include "Geometry.h"
+#include <deque>
+#include <vector>
+
+class Tour_planner
+{
+public:
+    Tour_planner();
+
+    // Return the indexes of points in the order a short tour that starts and
+    // ends at the first of them visits them, the first first
+    std::vector<int> plan(const std::vector<Point>& points);
+
+    // The lengths in nm of the greedy tour and of the tour returned by the last plan
+    double get_greedy_length() const
+    {
+        return greedy_length;
+    }
+
+    double get_length() const
+    {
+        return length;
+    }
+
+    // disallow copy/move construction or assignment
+    Tour_planner(Tour_planner& obj) = delete;
+    Tour_planner(Tour_planner&& obj) = delete;
+    Tour_planner& operator=(Tour_planner& obj) = delete;
+    Tour_planner& operator=(Tour_planner&& obj) = delete;
+
+private:
+    // How many of its nearest neighbours the moves join a point to, and the longest run Or-opt moves
+    static constexpr int max_neighbours = 10;
+    static constexpr int max_run_length = 3;
+
+    // The points
+    std::vector<double> x, y;
+
+    // The grid: the points in cell c not yet in the greedy tour are cell_points[cell_starts[c]]
+    // up to cell_points[cell_starts[c] + cell_sizes[c]], and the ones in it after them
+    double grid_x, grid_y;  // the low corner of the grid
+    double cell_size;
+    int num_cells_x, num_cells_y;
+    std::vector<int> cell_starts;
+    std::vector<int> cell_sizes;
+    std::vector<int> cell_points;
+    std::vector<int> point_cells;  // by point, its cell
+    std::vector<int> point_slots;  // by point, where it is in cell_points
+
+    // Each point's neighbours, nearest first, num_neighbours of them from neighbours[point * num_neighbours]
+    int num_neighbours;
+    std::vector<int> neighbours;
+    std::vector<double> neighbour_distances;
+
+    // The tour, and by point where it is in the tour
+    std::vector<int> tour;
+    std::vector<int> positions;
+
+    // The points whose moves are to be looked at, in the order they are to be
+    std::deque<int> queue;
+    std::vector<bool> queued;
+
+    double greedy_length;
+    double length;
+
+    double distance(int point1, int point2) const;
+
+    // Return the point after or before point in the tour
+    int next(int point) const;
+    int previous(int point) const;
+
+    // Return the total length of the tour
+    double get_tour_length() const;
+
+    // Put the points in the grid
+    void build_grid();
+
+    // Return the column or row of the grid that holds a coordinate
+    int to_cell_x(double coordinate) const;
+    int to_cell_y(double coordinate) const;
+
+    // Find the nearest neighbours of every point
+    void find_neighbours();
+
+    // Make the greedy tour
+    void make_greedy_tour();
+
+    // Return the point not yet in the greedy tour that is nearest to point,
+    // the one with the lower index of two as near
+    int find_nearest_unvisited(int point) const;
+
+    // Take a point that has been put in the greedy tour out of its cell
+    void remove_from_grid(int point);
+
+    // Apply 2-opt and Or-opt moves until none makes the tour shorter
+    void improve_tour();
+
+    // Look for a 2-opt move, or an Or-opt move, that joins point to one of its
+    // neighbours and makes the tour shorter; make the first one found, queue the
+    // points whose edges it changed, and return true, or return false if there is none
+    bool try_2_opt(int point);
+    bool try_or_opt(int point);
+
+    // Reverse the part of the tour from position first to position last
+    void reverse_tour(int first, int last);
+
+    // Move the run of the tour from position first to position last to just
+    // after point, reversing it if reversed
+    void move_run(int first, int last, int point, bool reversed);
+
+    // Put a point in the queue if it is not there
+    void enqueue(int point);
+};
+
+#endif
@@ -1,23 +1,30 @@
 /*
 Twod_view represents an intermdiate class for Views which
-display a two-dimensional view. Twod_view's draw function
-populates a two-dimensional vector with remembered information
-of locations of simulation objects.
+display a two-dimensional view. Twod_view keeps a grid of
+which objects are in which cell, and moves an object from
+cell to cell as the changes to its location come in, so a
+change takes constant time. The rows whose cells changed are marked dirty,
+and update_rows renders the text of only those rows again, with the
+render_row function of the derived class; the other rows keep
+the text from the last time. Changing the size, scale, or
+origin of the display builds the grid again at the next draw.
 */
 
 #ifndef TWOD_VIEW_H
 #define TWOD_VIEW_H
 
 #include "View.h"
+#include <set>
 #include <string>
+#include <string_view>
 #include <vector>
 
 class Twod_view : public View
 {
 public:
-    // Populate a two-dimensional vector
-    // and a vector of objects which are outside the view of the map
-    virtual void draw() override;
+    // Apply the changes, moving each object that changed cells
+    void apply_changes(
+        const View_change* changes, std::size_t num_changes, const std::vector<std::string>& names) override;
 
     virtual void set_size(int size_) override;
 
@@ -31,15 +38,53 @@ protected:
     // Protected constructor for quasi-abstractness
     Twod_view(int size_, double scale_, Point origin_);
 
+    // What a cell shows when it has no object, or more than one
+    static const char empty_cell = '.';
+    static const char crowded_cell = '*';
+
+    // Return the text of a row of the grid, counted from the top, as the View shows it
+    virtual std::string render_row(int row) const = 0;
+
+    // Bring the text of the dirty rows up to date; the derived draw calls it first
+    void update_rows();
+
     // Getters
-    std::vector<std::string> get_object_outside_map() const
+    const std::set<std::string>& get_object_outside_map() const
     {
         return object_outside_map;
     }
 
-    std::vector<std::vector<std::string>> get_twod_map() const
+    // Return what the cell at row (counted from the top) and column shows:
+    // the first two characters of the name of the one object in it,
+    // empty_cell if there is none, or crowded_cell if there is more than one
+    std::string_view get_cell(int row, int column) const
+    {
+        const char* cell = &grid[(row * size + column) * cell_width];
+        return std::string_view(cell, cell[1] == '\0' ? 1 : cell_width);
+    }
+
+    // Return true if the cell shows the name of an object
+    static bool is_name(std::string_view cell)
+    {
+        return cell.size() == cell_width;
+    }
+
+    // The text of a row as of the last draw
+    const std::string& get_row_text(int row) const
+    {
+        return row_texts[row];
+    }
+
+    // The rows whose text the last draw rendered again, from the top down
+    const std::vector<int>& get_changed_rows() const
+    {
+        return changed_rows;
+    }
+
+    // True if objects went outside the map or came back in before the last draw
+    bool is_outside_changed() const
     {
-        return two_dimensional_map;
+        return outside_changed;
     }
 
     int get_size() const
@@ -62,8 +107,35 @@ private:
     double scale;  // distance per cell of the display
     Point origin;  // coordinates of the lower-left-hand corner
 
-    std::vector<std::string> object_outside_map;
-    std::vector<std::vector<std::string>> two_dimensional_map;
+    // false if the grid has to be built again for a new size, scale, or origin
+    bool grid_valid;
+
+    std::set<std::string> object_outside_map;
+    bool outside_dirty;  // objects went outside or came back in since the last draw
+    bool outside_changed;  // ... before the last draw
+
+    // size rows of size cells, from the top row down, of cell_width chars each:
+    // two characters of a name, or a symbol followed by '\0'
+    static const std::size_t cell_width = 2;
+    std::vector<char> grid;
+    std::vector<std::vector<int>> cell_objects;  // the ids of the objects in each cell
+
+    std::vector<bool> dirty_rows;
+    std::vector<std::string> row_texts;
+    std::vector<int> changed_rows;
+
+    // Build the grid from all the objects, with every row dirty
+    void build_grid();
+
+    // Put an object into, or take it out of, the cell for location
+    void add_to_grid(int id, const std::string& name, Point location);
+    void remove_from_grid(int id, const std::string& name, Point location);
+
+    // Set what the cell with this index shows from the objects in it, and mark its row dirty
+    void refresh_cell(int index);
+
+    // Return the index of the cell for location, or -1 if it is outside the grid
+    int get_cell_index(Point location) const;
 
     // Calculate the cell subscripts corresponding to the supplied location parameter,
     // using the current size, scale, and origin of the display.
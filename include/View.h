@@ -5,19 +5,18 @@ display, and control its properties. It has a "memory" for the names and locatio
 of the to-be-plotted objects.
 
 Usage:
-1. Call the update_location function with the name and position of each object
-to be plotted. If the object name is not already in the View's memory, it will be added
-along with its location. If it is already present, its location will be set to the
-supplied location. If a single object changes location, its location can be separately
-updated with a call to update_location.
-
-2. Call the update_remove function with the name of any object that should
-no longer be plotted. This must be done *after* any call to update_location that
-has the same object name since update_location will add any object name supplied.
-
-3. Call the draw function to print out the map.
-
-4. As needed, change the origin, scale, or displayed size of the map
+1. The Model keeps track of what changes about each object during a tick - its
+location, a Ship's fuel, course, and speed, or that it is gone - as one
+View_change per object, and hands all of them to each View at once with
+apply_changes, in the order in which the objects first changed. Objects are
+known by the Object_id of their names in the Model's Name_table, so the View
+keeps what it remembers in vectors indexed by id. An object is added to the
+View's memory when it is first given a location, and a Ship's sailing data
+when it is first given any of it. An object that is gone is forgotten.
+
+2. Call the draw function to print out the map to a stream.
+
+3. As needed, change the origin, scale, or displayed size of the map
 with the appropriate functions. Since the view "remembers" the previously updated
 information, immediately calling the draw function will print out a map showing
 the previous objects using the new settings.
@@ -27,34 +26,44 @@ the previous objects using the new settings.
 #define VIEW_H
 
 #include "Geometry.h"
-#include <map>
+#include "Name_table.h"
+#include <cstddef>
+#include <ostream>
 #include <string>
 #include <vector>
 
+// What has changed about an object since the Views were last told; only the
+// fields whose bits are set in dirty_mask mean anything. If gone is set along
+// with others, the object changed and then went, in that order.
+struct View_change
+{
+    static const unsigned int location_changed = 1;
+    static const unsigned int fuel_changed = 2;
+    static const unsigned int course_changed = 4;
+    static const unsigned int speed_changed = 8;
+    static const unsigned int gone = 16;
+
+    Object_id id;
+    unsigned int dirty_mask;
+    Point location;
+    double fuel;
+    double course;
+    double speed;
+};
+
 class View
 {
 public:
     virtual ~View()
     { }
 
-    // Save the supplied name and location for future use in a draw() call
-    // If the name is already present,the new location replaces the previous one.
-    virtual void update_location(const std::string& name, Point location);
-
-    // Remove the name and its location; no error if the name is not present.
-    virtual void update_remove(const std::string& name);
+    // Apply the changes of a tick, which come in the order they were made;
+    // names holds the name of every object by id
+    virtual void apply_changes(
+        const View_change* changes, std::size_t num_changes, const std::vector<std::string>& names);
 
-    // Update information about a Ship's fuel
-    virtual void ship_fuel_update(const std::string& name, double fuel);
-
-    // Update information about a Ship's course
-    virtual void ship_course_update(const std::string& name, double course);
-
-    // Update information about a Ship's speed
-    virtual void ship_speed_update(const std::string& name, double speed);
-
-    // prints out the current map
-    virtual void draw() = 0;
+    // prints out the current map to os
+    virtual void draw(std::ostream& os) = 0;
 
     // Throw an Error because you cannot perform these functions.
     virtual void set_size(int size_);
@@ -65,6 +74,8 @@ public:
 
     virtual void set_defaults();
 
+    virtual void set_live(bool live_);
+
 protected:
     struct Ship_info
     {
@@ -78,19 +89,27 @@ protected:
         double speed;
     };
 
-    std::map<std::string, Point> get_object_info_map() const
+    // What the View remembers about an object
+    struct Object_info
     {
-        return object_info_map;
-    }
+        std::string name;
+        bool has_location = false;  // false if the View does not know of the object
+        bool has_ship_info = false;
+        Point location;
+        Ship_info ship_info{0., 0., 0.};
+    };
 
-    std::map<std::string, Ship_info> get_ship_info_map() const
+    // Return what is remembered about every object, by id
+    const std::vector<Object_info>& get_objects() const
     {
-        return ship_info_map;
+        return objects;
     }
 
+    // Apply one change
+    void apply_change(const View_change& change, const std::vector<std::string>& names);
+
 private:
-    std::map<std::string, Point> object_info_map;
-    std::map<std::string, Ship_info> ship_info_map;
+    std::vector<Object_info> objects;
 };
 
 #endif
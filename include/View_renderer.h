@@ -0,0 +1,129 @@
+/*
+View_renderer draws the Views on a thread of its own, so that the Controller
+does not wait while they are formatted. Once a View is attached, only the
+renderer's thread touches it: the changes the Model records, the commands
+that change a View's settings, and the requests to draw are all put into one
+queue of jobs in the order they are made, and the thread does them in turn.
+
+The changes come in the batches that the Model publishes at the end of every
+tick and before anything else is put into the queue. The Model's buffer and
+the renderer's are swapped rather than copied. A batch becomes immutable when
+the thread takes it; until then the next batch is merged into it, one record
+per object as in the Model, so that the Model never waits for the thread
+however far behind it is.
+
+What a command writes is a frame. The frames go into a bounded queue, which
+the Controller writes out to cout at the points where it also flushes the
+Logger. When the queue is full, the frame policy decides:
+block: the thread waits for room. The Controller writes out the frames of every
+command put in before, waiting for them if need be, so that the output comes
+out exactly as if the Views were drawn at once.
+drop: the oldest frame is dropped. The Controller writes out only the frames
+that are ready and never waits, except when asked to at the end of the input.
+*/
+
+#ifndef VIEW_RENDERER_H
+#define VIEW_RENDERER_H
+
+#include "Name_table.h"
+#include "View.h"
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <ios>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+class View_renderer
+{
+public:
+    enum class Frame_policy
+    {
+        block,
+        drop,
+    };
+
+    // The thread is started when the first job is put in
+    View_renderer();
+    ~View_renderer();
+
+    // Add or remove a View; after attach, only the thread may touch the View
+    void attach(std::shared_ptr<View> view_ptr);
+    void detach(std::shared_ptr<View> view_ptr);
+
+    // Hand a batch of changes over to the Views, leaving changes empty;
+    // the thread keeps its own copy of the names in names
+    void publish(std::vector<View_change>& changes, const Name_table& names);
+
+    // Have the thread run command after everything put in before. What it
+    // writes, formatted as cout is now, is a frame. If it throws an Error,
+    // the message is written to the frame instead.
+    void post(std::function<void(std::ostream&)> command);
+
+    // Write the frames that are ready to os; wait for the frames of every
+    // command put in so far if wait_all is true or the policy is block
+    void write_frames(std::ostream& os, bool wait_all);
+
+    // Throws Error if max_frames is not positive
+    void set_frame_policy(Frame_policy frame_policy_, int max_frames_);
+
+    // disallow copy/move construction or assignment
+    View_renderer(View_renderer& obj) = delete;
+    View_renderer(View_renderer&& obj) = delete;
+    View_renderer& operator=(View_renderer& obj) = delete;
+    View_renderer& operator=(View_renderer&& obj) = delete;
+
+private:
+    // A batch of changes if command is empty, a command if not
+    struct Job
+    {
+        std::vector<View_change> changes;
+        std::vector<std::string> new_names;  // the names given ids since the last batch
+        std::function<void(std::ostream&)> command;
+        std::ios::fmtflags flags;
+        std::streamsize precision;
+    };
+
+    // Guarded by render_mutex
+    std::mutex render_mutex;
+    std::condition_variable work_ready;
+    std::condition_variable frame_room;
+    std::condition_variable progress;
+    std::deque<Job> jobs;
+    bool batch_open;  // the last job is a batch that the thread has not taken
+    std::vector<int> open_batch_indexes;  // by id, the record in the open batch or -1
+    std::vector<View_change> spare_changes;  // the buffer of the last batch applied
+    std::size_t num_names_published;
+    unsigned long jobs_posted;
+    unsigned long jobs_done;
+    std::deque<std::string> frames;
+    Frame_policy frame_policy;
+    std::size_t max_frames;
+    bool shutting_down;
+    std::thread renderer;
+
+    // Only the thread touches these
+    std::vector<std::shared_ptr<View>> views;
+    std::vector<std::string> names;
+
+    // Put a command into the queue; render_mutex must be held by lock
+    void push_command(std::unique_lock<std::mutex>& lock, std::function<void(std::ostream&)> command);
+
+    // Merge the changes into the open batch, one record per object
+    void merge_into_open_batch(const std::vector<View_change>& changes);
+
+    // No more changes go into the last batch
+    void close_batch();
+
+    // Put a frame into the queue as the policy says; render_mutex must be held by lock
+    void push_frame(std::unique_lock<std::mutex>& lock, std::string frame);
+
+    void render_loop();
+};
+
+#endif
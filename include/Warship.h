@@ -5,6 +5,8 @@
 #include <memory>
 #include <string>
 
+struct Warship_record;
+
 // Intermediate class for different types of Warships to derive from
 
 class Warship : public Ship
@@ -13,16 +15,34 @@ public:
     // Update the state of the Warship
     void update() override;
 
+    // An attacking Warship fires or checks its range on every update
+    int ticks_until_event() const override;
+    Event_type get_event_type() const override;
+
     // Output a description of current state to cout
     void describe() const override;
 
+    // Warships can attack
+    unsigned int get_capabilities() const override
+    {
+        return can_attack;
+    }
+
     // Start an attack on a target ship
     void attack(std::shared_ptr<Ship> target_ptr_) override;
 
     void stop_attack() override;
 
+    const char* check_attack(std::shared_ptr<Ship> target_ptr_) const override;
+    const char* check_stop_attack() const override;
+
+    // Set this Warship's state and target from a checkpoint record
+    // Throws Error if the record is not valid.
+    void restore(const Warship_record& record, const Checkpoint_reader& reader);
+
 protected:
-    Warship(const std::string& name_,
+    Warship(Model& model_,
+        const std::string& name_,
         Point position_,
         int firepower_,
         double max_range,
@@ -42,13 +62,16 @@ protected:
         return state == Warship_state::attacking;
     }
 
-    std::weak_ptr<Ship> get_target() const
+    Object_handle get_target() const
     {
         return target;
     }
 
+    // Return a checkpoint record of this Warship
+    Warship_record make_warship_record(Checkpoint_writer& writer) const;
+
 private:
-    std::weak_ptr<Ship> target;
+    Object_handle target;
     int firepower;
     double max_range;
 
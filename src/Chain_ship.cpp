@@ -1,45 +1,38 @@
 #include "Chain_ship.h"
+#include "Checkpoint.h"
+#include "Logger.h"
 #include "Model.h"
+#include "Profiler.h"
 #include "Utility.h"
+#include <algorithm>
 #include <iostream>
-#include <limits>
+#include <vector>
 
 using namespace std;
 
-Chain_ship::Chain_ship(const string& name_, Point position_)
-    : Ship(name_, position_, 1500, 10.0, 4.0, 1)
+Chain_ship::Chain_ship(Model& model_, const string& name_, Point position_)
+    : Ship(model_, name_, position_, 1500, 10.0, 4.0, 1)
+    , chained_ship(Name_order{&model_.get_name_table()})
+    , map_of_ship_to_chain(Name_order{&model_.get_name_table()})
+    , num_of_ship_needed_to_chain(0)
+    , num_of_ship_chained(0)
     , state(State::not_moving_to_chain_ship)
 { }
 
 // Chain every other Ship in the simulation world.
 void Chain_ship::chain_all_ship()
 {
-    if (state != State::not_moving_to_chain_ship)
-        cout << get_name() << " canceling its current plan to chain " << ship_to_chain->get_name() << endl;
-
-    map_of_ship_to_chain = Model::get_instance().get_ship_map();
-
-    // While loop for erasing Ships which are already chained
-    // to this Chain_ship. Also erases this Chain_ship from
-    // the map because it doesn't need to chain itself.
-    auto it = map_of_ship_to_chain.cbegin();
-    while (it != map_of_ship_to_chain.cend()) {
-        if (it->second->get_name() == get_name()) {
-            map_of_ship_to_chain.erase(it++);
-        } else {
-            // Bool for indicating if we need to
-            // increment the iterator, it.
-            bool erased = false;
-            for (const auto& pair : chained_ship) {
-                if (it->second->get_name() == pair.second->get_name()) {
-                    map_of_ship_to_chain.erase(it++);
-                    erased = true;
-                    break;
-                }
-            }
-            if (!erased)
-                ++it;
-        }
+    if (state != State::not_moving_to_chain_ship && ship_to_chain.id != no_object_id)
+        LOG(Log_level::info, Log_category::general) << get_name() << " canceling its current plan to chain "
+                                                    << get_model().get_name(ship_to_chain.id);
+
+    // Every other Ship that is not already chained to this Chain_ship;
+    // it doesn't need to chain itself.
+    map_of_ship_to_chain.clear();
+    for (const auto& ship_ptr : get_model().get_ships()) {
+        Object_id id = ship_ptr->get_id();
+        if (id != get_id() && chained_ship.find(id) == chained_ship.cend())
+            map_of_ship_to_chain.emplace_hint(map_of_ship_to_chain.cend(), id, get_model().get_handle(*ship_ptr));
     }
 
     if (map_of_ship_to_chain.empty()) {
@@ -59,22 +52,24 @@ void Chain_ship::chain_all_ship()
 // Throws an Error when target_to_chain is already chained to this Ship.
 void Chain_ship::chain_ship(shared_ptr<Ship> target_to_chain)
 {
-    if (chained_ship.find(target_to_chain->get_name()) != chained_ship.cend())
-        throw Error("Chain_ship already contains this Ship!");
+    if (const char* failure = check_chain(target_to_chain))
+        throw Error(failure);
 
     if (state != State::not_moving_to_chain_ship) {
-        cout << get_name() << " canceling its current plan to chain " << ship_to_chain->get_name() << endl;
+        if (ship_to_chain.id != no_object_id)
+            LOG(Log_level::info, Log_category::general) << get_name() << " canceling its current plan to chain "
+                                                        << get_model().get_name(ship_to_chain.id);
         map_of_ship_to_chain.clear();
     }
 
     target_to_chain->stop();
-    ship_to_chain = target_to_chain;
+    ship_to_chain = get_model().get_handle(*target_to_chain);
     state = State::moving_to_chain_ship;
 
     // Remember the location of Ship to chain so that when it changes,
     // this Chain_ship can set_destination_position_and_speed to the
     // new location.
-    location_of_ship_to_chain = ship_to_chain->get_location();
+    location_of_ship_to_chain = target_to_chain->get_location();
     set_destination_position_and_speed(location_of_ship_to_chain, get_maximum_speed());
 }
 
@@ -82,25 +77,45 @@ void Chain_ship::chain_ship(shared_ptr<Ship> target_to_chain)
 // Throws an Error ship_to_unchain is not chained to this Ship.
 void Chain_ship::unchain_ship(shared_ptr<Ship> ship_to_drop)
 {
-    if (chained_ship.erase(ship_to_drop->get_name()) == 0)
-        throw Error("Chain_ship does not contain this Ship!");
-    cout << ship_to_drop->get_name() << " unchained from " << get_name() << endl;
+    if (const char* failure = check_unchain(ship_to_drop))
+        throw Error(failure);
+
+    chained_ship.erase(ship_to_drop->get_id());
+    LOG(Log_level::info, Log_category::general) << ship_to_drop->get_name() << " unchained from " << get_name();
+}
+
+// A Ship can be chained only once, and unchained only if it was chained
+const char* Chain_ship::check_chain(shared_ptr<Ship> target_to_chain) const
+{
+    if (chained_ship.find(target_to_chain->get_id()) != chained_ship.cend())
+        return "Chain_ship already contains this Ship!";
+    return nullptr;
+}
+
+const char* Chain_ship::check_unchain(shared_ptr<Ship> ship_to_unchain) const
+{
+    if (chained_ship.find(ship_to_unchain->get_id()) == chained_ship.cend())
+        return "Chain_ship does not contain this Ship!";
+    return nullptr;
 }
 
 // Update the state of Chain_ship
 void Chain_ship::update()
 {
+    PROFILE_SCOPE(Profile_section::update_chain_ship);
     Ship::update();
 
     // While loop for automatically unchaining Ships
-    // which cannot move
+    // which cannot move, or have sunk
     auto it = chained_ship.cbegin();
     while (it != chained_ship.cend()) {
-        if (!it->second->can_move()) {
-            cout << it->second->get_name() << " unchained from " << get_name() << endl;
+        Ship* ship_ptr = get_model().resolve_ship(it->second);
+        if (!ship_ptr || !ship_ptr->can_move()) {
+            LOG(Log_level::info, Log_category::general) << get_model().get_name(it->first) << " unchained from "
+                                                        << get_name();
 
             if (it->second == ship_to_chain)
-                ship_to_chain.reset();
+                ship_to_chain = Object_handle();
             chained_ship.erase(it++);
         } else
             ++it;
@@ -111,7 +126,8 @@ void Chain_ship::update()
     // afloat.
     it = map_of_ship_to_chain.cbegin();
     while (it != map_of_ship_to_chain.cend()) {
-        if (!it->second->is_afloat()) {
+        Ship* ship_ptr = get_model().resolve_ship(it->second);
+        if (!ship_ptr || !ship_ptr->is_afloat()) {
             map_of_ship_to_chain.erase(it++);
 
             // decrement number of Ships needed to chain
@@ -122,51 +138,61 @@ void Chain_ship::update()
             ++it;
     }
 
+    Ship* target_ptr = get_model().resolve_ship(ship_to_chain);
     switch (state) {
     case State::not_moving_to_chain_ship:
         break;
 
     case State::moving_to_chain_ship:
-        if (!ship_to_chain->is_afloat()) {
-            cout << get_name() << "'s Ship to chain is not afloat anymore" << endl;
+        if (!target_ptr || !target_ptr->is_afloat()) {
+            LOG(Log_level::info, Log_category::general) << get_name() << "'s Ship to chain is not afloat anymore";
             stop();
             state = State::not_moving_to_chain_ship;
         }
         // When ship_to_chain is in range of this Chain_ship, chain ship_to_chain
-        else if (cartesian_distance(get_location(), ship_to_chain->get_location()) < 0.1) {
-            cout << ship_to_chain->get_name() << " chained to " << get_name() << endl;
-            chained_ship.insert(make_pair(ship_to_chain->get_name(), ship_to_chain));
+        else if (cartesian_distance(get_location(), target_ptr->get_location()) < 0.1) {
+            LOG(Log_level::info, Log_category::general) << target_ptr->get_name() << " chained to " << get_name();
+            chained_ship.insert(make_pair(ship_to_chain.id, ship_to_chain));
             state = State::not_moving_to_chain_ship;
         }
         // When the location of the Ship to chain has changed, set_destination
         // _position and speed to the Ship's new location.
-        else if (location_of_ship_to_chain != ship_to_chain->get_location()) {
-            set_destination_position_and_speed(ship_to_chain->get_location(), get_maximum_speed());
-            location_of_ship_to_chain = ship_to_chain->get_location();
+        else if (location_of_ship_to_chain != target_ptr->get_location()) {
+            set_destination_position_and_speed(target_ptr->get_location(), get_maximum_speed());
+            location_of_ship_to_chain = target_ptr->get_location();
         }
         break;
     case State::moving_to_chain_all_ship:
+        // A Ship that sank before it was reached is one fewer Ship to chain
+        if (!target_ptr && num_of_ship_chained != num_of_ship_needed_to_chain) {
+            --num_of_ship_needed_to_chain;
+            if (num_of_ship_chained != num_of_ship_needed_to_chain) {
+                find_closest_ship_to_chain();
+                target_ptr = get_model().resolve_ship(ship_to_chain);
+            }
+        }
+
         // Case when this Chain_ship has chained all Ships
         if (num_of_ship_chained == num_of_ship_needed_to_chain) {
-            cout << get_name() << " has chained all Ships" << endl;
+            LOG(Log_level::info, Log_category::general) << get_name() << " has chained all Ships";
             state = State::not_moving_to_chain_ship;
         }
 
         // When ship_to_chain is in range of this Chained_ship, chain the ship and find
         // next closest Ship to chain if this Chained_ship must find more Ships to chain.
-        else if (cartesian_distance(get_location(), ship_to_chain->get_location()) < 0.1) {
-            cout << ship_to_chain->get_name() << " chained to " << get_name() << endl;
-            chained_ship.insert(make_pair(ship_to_chain->get_name(), ship_to_chain));
+        else if (cartesian_distance(get_location(), target_ptr->get_location()) < 0.1) {
+            LOG(Log_level::info, Log_category::general) << target_ptr->get_name() << " chained to " << get_name();
+            chained_ship.insert(make_pair(ship_to_chain.id, ship_to_chain));
             ++num_of_ship_chained;
-            ship_to_chain.reset();
+            ship_to_chain = Object_handle();
 
             if (num_of_ship_chained != num_of_ship_needed_to_chain)
                 find_closest_ship_to_chain();
         }
         // Update the destination when location of ship_to_chain changes
-        else if (location_of_ship_to_chain != ship_to_chain->get_location()) {
-            set_destination_position_and_speed(ship_to_chain->get_location(), get_maximum_speed());
-            location_of_ship_to_chain = ship_to_chain->get_location();
+        else if (location_of_ship_to_chain != target_ptr->get_location()) {
+            set_destination_position_and_speed(target_ptr->get_location(), get_maximum_speed());
+            location_of_ship_to_chain = target_ptr->get_location();
         }
         break;
 
@@ -176,6 +202,38 @@ void Chain_ship::update()
     }
 }
 
+// A Chain_ship that is chasing a Ship, or has a chained Ship to drop,
+// must be updated; otherwise it can be advanced like any Ship until
+// one of its chained Ships has an event that might stop it.
+int Chain_ship::ticks_until_event() const
+{
+    if (state != State::not_moving_to_chain_ship)
+        return 0;
+    for (const auto& pair : map_of_ship_to_chain) {
+        const Ship* ship_ptr = get_model().resolve_ship(pair.second);
+        if (!ship_ptr || !ship_ptr->is_afloat())
+            return 0;
+    }
+
+    int ticks = Ship::ticks_until_event();
+    for (const auto& pair : chained_ship) {
+        const Ship* ship_ptr = get_model().resolve_ship(pair.second);
+        if (!ship_ptr || !ship_ptr->can_move())
+            return 0;
+        ticks = min(ticks, ship_ptr->ticks_until_event());
+    }
+    return ticks;
+}
+
+Event_type Chain_ship::get_event_type() const
+{
+    if (state != State::not_moving_to_chain_ship)
+        return Event_type::state_change;
+    if (Ship::ticks_until_event() == ticks_until_event())
+        return Ship::get_event_type();
+    return Event_type::state_change;
+}
+
 // Output a description of current state to cout
 void Chain_ship::describe() const
 {
@@ -194,7 +252,7 @@ void Chain_ship::describe() const
     for (const auto& pair : chained_ship) {
         if (print_comma)
             cout << ", ";
-        cout << pair.second->get_name();
+        cout << get_model().get_name(pair.first);
         print_comma = true;
     }
 
@@ -206,7 +264,8 @@ void Chain_ship::set_destination_position_and_speed(Point destination_point, dou
 {
     Ship::set_destination_position_and_speed(destination_point, speed);
     for (const auto& pair : chained_ship)
-        pair.second->Ship::set_destination_position_and_speed(destination_point, speed);
+        if (Ship* ship_ptr = get_model().resolve_ship(pair.second))
+            ship_ptr->Ship::set_destination_position_and_speed(destination_point, speed);
 }
 
 // Command this Ship's chained Ships to also set_destination_island_and_speed
@@ -214,7 +273,8 @@ void Chain_ship::set_destination_island_and_speed(shared_ptr<Island> destination
 {
     Ship::set_destination_island_and_speed(destination_island, speed);
     for (const auto& pair : chained_ship)
-        pair.second->Ship::set_destination_island_and_speed(destination_island, speed);
+        if (Ship* ship_ptr = get_model().resolve_ship(pair.second))
+            ship_ptr->Ship::set_destination_island_and_speed(destination_island, speed);
 }
 
 // Command this Ship's chained Ships to also set_course_and_speed
@@ -222,7 +282,8 @@ void Chain_ship::set_course_and_speed(double course, double speed)
 {
     Ship::set_course_and_speed(course, speed);
     for (const auto& pair : chained_ship)
-        pair.second->Ship::set_course_and_speed(course, speed);
+        if (Ship* ship_ptr = get_model().resolve_ship(pair.second))
+            ship_ptr->Ship::set_course_and_speed(course, speed);
 }
 
 // Command this Ship's chained Ships to stop
@@ -233,7 +294,8 @@ void Chain_ship::stop()
     num_of_ship_chained = 0;
     num_of_ship_needed_to_chain = 0;
     for (const auto& pair : chained_ship)
-        pair.second->Ship::stop();
+        if (Ship* ship_ptr = get_model().resolve_ship(pair.second))
+            ship_ptr->Ship::stop();
 }
 
 // This Ship's chained Ships also take hit
@@ -241,35 +303,79 @@ void Chain_ship::receive_hit(int hit_force, shared_ptr<Ship> attacker_ptr)
 {
     Ship::receive_hit(hit_force, attacker_ptr);
     for (const auto& pair : chained_ship)
-        pair.second->receive_hit(hit_force, attacker_ptr);
+        if (Ship* ship_ptr = get_model().resolve_ship(pair.second))
+            ship_ptr->receive_hit(hit_force, attacker_ptr);
+}
+
+// Add this Chain_ship's record to a checkpoint
+void Chain_ship::save(Checkpoint_writer& writer) const
+{
+    Chain_ship_record record{};
+    record.ship = make_ship_record(writer);
+    record.location_of_ship_to_chain_x = location_of_ship_to_chain.x;
+    record.location_of_ship_to_chain_y = location_of_ship_to_chain.y;
+    record.ship_to_chain = writer.get_ship_id(get_model().resolve_ship(ship_to_chain));
+    record.num_of_ship_needed_to_chain = num_of_ship_needed_to_chain;
+    record.num_of_ship_chained = num_of_ship_chained;
+
+    // the Ships that have sunk since this Chain_ship's last update are left out
+    vector<uint32_t> ship_ids;
+    ship_ids.reserve(chained_ship.size());
+    for (const auto& pair : chained_ship)
+        if (const Ship* ship_ptr = get_model().resolve_ship(pair.second))
+            ship_ids.push_back(static_cast<uint32_t>(writer.get_ship_id(ship_ptr)));
+    record.first_chained_ship = writer.add_links(ship_ids);
+    record.num_chained_ships = static_cast<uint32_t>(ship_ids.size());
+
+    ship_ids.clear();
+    for (const auto& pair : map_of_ship_to_chain)
+        if (const Ship* ship_ptr = get_model().resolve_ship(pair.second))
+            ship_ids.push_back(static_cast<uint32_t>(writer.get_ship_id(ship_ptr)));
+    record.first_ship_to_chain = writer.add_links(ship_ids);
+    record.num_ships_to_chain = static_cast<uint32_t>(ship_ids.size());
+
+    record.chain_state = static_cast<uint8_t>(state);
+    writer.chain_ships.push_back(record);
+}
+
+// Set this Chain_ship's chained Ships and chasing from a checkpoint record
+// Throws Error if the record is not valid.
+void Chain_ship::restore(const Chain_ship_record& record, const Checkpoint_reader& reader)
+{
+    if (record.chain_state > static_cast<uint8_t>(State::not_moving_to_chain_ship))
+        throw Error("Checkpoint file is damaged!");
+
+    restore_ship_record(record.ship, reader);
+    location_of_ship_to_chain = Point(record.location_of_ship_to_chain_x, record.location_of_ship_to_chain_y);
+    ship_to_chain = reader.get_ship_handle(record.ship_to_chain);
+    num_of_ship_needed_to_chain = record.num_of_ship_needed_to_chain;
+    num_of_ship_chained = record.num_of_ship_chained;
+
+    // a sunk Ship gets the default handle, so it is dropped on the next update
+    auto handle_of = [](const shared_ptr<Ship>& ship) {
+        return ship->is_afloat() ? ship->get_model().get_handle(*ship) : Object_handle();
+    };
+    for (const auto& ship : reader.get_link_ships(record.first_chained_ship, record.num_chained_ships))
+        chained_ship.insert(make_pair(ship->get_id(), handle_of(ship)));
+    for (const auto& ship : reader.get_link_ships(record.first_ship_to_chain, record.num_ships_to_chain))
+        map_of_ship_to_chain.insert(make_pair(ship->get_id(), handle_of(ship)));
+    state = static_cast<State>(record.chain_state);
 }
 
 // Helper function that finds a Ship that is closest to this Chain_ship
 void Chain_ship::find_closest_ship_to_chain()
 {
-    double shortest_distance = numeric_limits<double>::max();
+    // Only the Ships still waiting to be chained are candidates.
+    shared_ptr<Ship> ship_ptr = get_model().find_nearest_ship_if(get_location(), [this](Object_id id, Point) {
+        return map_of_ship_to_chain.find(id) != map_of_ship_to_chain.cend();
+    });
+    ship_to_chain = get_model().get_handle(*ship_ptr);
 
-    auto it = map_of_ship_to_chain.cbegin();
-    auto closest_ship = map_of_ship_to_chain.cbegin();
-    while (it != map_of_ship_to_chain.cend()) {
-        double distance = cartesian_distance(get_location(), it->second->get_location());
-
-        // When the distance to the current Ship is less than the shortest distance,
-        // update the shortest distance
-        // and set ship_to_chain to the current Ship.
-        if (distance < shortest_distance) {
-            shortest_distance = distance;
-            ship_to_chain = it->second;
-            closest_ship = it;
-        }
-        ++it;
-    }
-
-    location_of_ship_to_chain = ship_to_chain->get_location();
-    ship_to_chain->stop();
+    location_of_ship_to_chain = ship_ptr->get_location();
+    ship_ptr->stop();
 
     // Erase the Ship from map_of_ship_to_chain because this Chained_ship
     // does not need to chain the Ship anymore.
-    map_of_ship_to_chain.erase(closest_ship);
-    set_destination_position_and_speed(ship_to_chain->get_location(), get_maximum_speed());
-}
\ No newline at end of file
+    map_of_ship_to_chain.erase(ship_ptr->get_id());
+    set_destination_position_and_speed(ship_ptr->get_location(), get_maximum_speed());
+}
@@ -0,0 +1,451 @@
+#include "Checkpoint.h"
+#include "Chain_ship.h"
+#include "Cruise_ship.h"
+#include "Cruiser.h"
+#include "Island.h"
+#include "Model.h"
+#include "Ship_component_factory.h"
+#include "Ship_composite.h"
+#include "Tanker.h"
+#include "Torpedo_boat.h"
+#include "Utility.h"
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <limits>
+
+using namespace std;
+
+const char checkpoint_magic[8] = "SHIPSIM";
+
+// The records are copied to and from the file as they are, so their layout must not change
+static_assert(sizeof(Checkpoint_header) == 56, "Checkpoint_header layout changed");
+static_assert(sizeof(Island_record) == 40, "Island_record layout changed");
+static_assert(sizeof(Ship_record) == 80, "Ship_record layout changed");
+static_assert(sizeof(Warship_record) == 88, "Warship_record layout changed");
+static_assert(sizeof(Torpedo_boat_record) == 120, "Torpedo_boat_record layout changed");
+static_assert(sizeof(Tanker_record) == 104, "Tanker_record layout changed");
+static_assert(sizeof(Cruise_ship_record) == 112, "Cruise_ship_record layout changed");
+static_assert(sizeof(Chain_ship_record) == 128, "Chain_ship_record layout changed");
+static_assert(sizeof(Group_record) == 16, "Group_record layout changed");
+
+// The file is in little-endian byte order, and the records are copied as they are
+static void check_byte_order()
+{
+    const uint16_t one = 1;
+    unsigned char first_byte;
+    memcpy(&first_byte, &one, 1);
+    if (first_byte != 1)
+        throw Error("Checkpoints need a little-endian machine!");
+}
+
+/*** Checkpoint_writer ***/
+// Return the index of name in the string table, adding it if needed
+uint32_t Checkpoint_writer::get_id(const string& name)
+{
+    auto result = string_ids.insert(make_pair(name, static_cast<uint32_t>(strings.size())));
+    if (result.second)
+        strings.push_back(name);
+    return result.first->second;
+}
+
+// Return the index of the Island's name, or -1 for nullptr
+int32_t Checkpoint_writer::get_island_id(const Island* island)
+{
+    if (!island)
+        return -1;
+    return static_cast<int32_t>(get_id(island->get_name()));
+}
+
+// Return the Ship's number, giving it the next one if it has none yet; -1 for nullptr
+int32_t Checkpoint_writer::get_ship_id(const Ship* ship)
+{
+    if (!ship)
+        return -1;
+    auto result = ship_ids.insert(make_pair(ship, static_cast<int32_t>(ships.size())));
+    if (result.second) {
+        ships.push_back(ship);
+        ship_added.push_back(false);
+    }
+    return result.first->second;
+}
+
+// Return the number of a Ship that is writing its own record now
+uint32_t Checkpoint_writer::add_ship(const Ship* ship)
+{
+    int32_t number = get_ship_id(ship);
+    ship_added[number] = true;
+    return static_cast<uint32_t>(number);
+}
+
+// Have every Ship that has been given a number but has not written its
+// record - a sunk Ship something still refers to - write it
+void Checkpoint_writer::add_referenced_ships()
+{
+    // a Ship written here can give numbers to more Ships
+    for (size_t i = 0; i < ships.size(); ++i)
+        if (!ship_added[i])
+            ships[i]->save(*this);
+}
+
+// Add a list of names or Ship numbers to the links and return the index of the first
+uint32_t Checkpoint_writer::add_links(const vector<uint32_t>& ids)
+{
+    uint32_t first = static_cast<uint32_t>(links.size());
+    links.insert(links.end(), ids.begin(), ids.end());
+    return first;
+}
+
+// Add the list that get_ids returns to the links the first time it is added
+// for key, and return the index of its first link, then and every time after
+uint32_t Checkpoint_writer::add_shared_links(const void* key, const function<vector<uint32_t>()>& get_ids)
+{
+    auto found = shared_links.find(key);
+    if (found != shared_links.end())
+        return found->second;
+    uint32_t first = add_links(get_ids());
+    shared_links.insert(make_pair(key, first));
+    return first;
+}
+
+// Add a group under the group at index parent (-1 for none) and return its index
+int Checkpoint_writer::add_group(const string& name, int parent)
+{
+    Group_record record{};
+    record.name = get_id(name);
+    record.parent = parent;
+    groups.push_back(record);
+    group_members.emplace_back();
+    return static_cast<int>(groups.size()) - 1;
+}
+
+// Add a Ship to the group at index group
+void Checkpoint_writer::add_group_member(int group, const Ship* ship)
+{
+    group_members[group].push_back(static_cast<uint32_t>(get_ship_id(ship)));
+}
+
+// Write the vector's elements to the file as they are
+template <typename T>
+static void write_section(ofstream& file, const vector<T>& section)
+{
+    if (!section.empty())
+        file.write(reinterpret_cast<const char*>(section.data()), section.size() * sizeof(T));
+}
+
+// Write everything added, with the given time, to the file.
+// Throws Error if the file cannot be written.
+void Checkpoint_writer::write(const string& filename, int time) const
+{
+    check_byte_order();
+
+    // the members of the groups go at the end of the links
+    vector<Group_record> group_records(groups);
+    vector<uint32_t> all_links(links);
+    for (size_t i = 0; i < group_records.size(); ++i) {
+        group_records[i].first_member = static_cast<uint32_t>(all_links.size());
+        group_records[i].num_members = static_cast<uint32_t>(group_members[i].size());
+        all_links.insert(all_links.end(), group_members[i].begin(), group_members[i].end());
+    }
+
+    vector<uint32_t> string_offsets;
+    string_offsets.reserve(strings.size() + 1);
+    uint32_t offset = 0;
+    for (const auto& name : strings) {
+        string_offsets.push_back(offset);
+        offset += static_cast<uint32_t>(name.size());
+    }
+    string_offsets.push_back(offset);
+
+    Checkpoint_header header{};
+    memcpy(header.magic, checkpoint_magic, sizeof(header.magic));
+    header.version = checkpoint_version;
+    header.time = time;
+    header.num_strings = static_cast<uint32_t>(strings.size());
+    header.string_bytes = offset;
+    header.num_islands = static_cast<uint32_t>(islands.size());
+    header.num_cruisers = static_cast<uint32_t>(cruisers.size());
+    header.num_torpedo_boats = static_cast<uint32_t>(torpedo_boats.size());
+    header.num_tankers = static_cast<uint32_t>(tankers.size());
+    header.num_cruise_ships = static_cast<uint32_t>(cruise_ships.size());
+    header.num_chain_ships = static_cast<uint32_t>(chain_ships.size());
+    header.num_groups = static_cast<uint32_t>(group_records.size());
+    header.num_links = static_cast<uint32_t>(all_links.size());
+
+    ofstream file(filename, ios::binary | ios::trunc);
+    if (!file)
+        throw Error("Cannot open checkpoint file!");
+
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    write_section(file, string_offsets);
+    for (const auto& name : strings)
+        file.write(name.data(), name.size());
+    write_section(file, islands);
+    write_section(file, cruisers);
+    write_section(file, torpedo_boats);
+    write_section(file, tankers);
+    write_section(file, cruise_ships);
+    write_section(file, chain_ships);
+    write_section(file, group_records);
+    write_section(file, all_links);
+
+    file.close();
+    if (!file)
+        throw Error("Cannot write checkpoint file!");
+}
+
+/*** Checkpoint_reader ***/
+
+// Copy count elements of the file's contents at offset into section, and advance offset
+template <typename T>
+static void read_section(const vector<char>& contents, size_t& offset, uint32_t count, vector<T>& section)
+{
+    section.resize(count);
+    if (count > 0)
+        memcpy(section.data(), contents.data() + offset, count * sizeof(T));
+    offset += count * sizeof(T);
+}
+
+// Read and check a checkpoint file.
+// Throws Error if it cannot be read or is not a valid checkpoint.
+Checkpoint_reader::Checkpoint_reader(const string& filename)
+{
+    check_byte_order();
+
+    ifstream file(filename, ios::binary);
+    if (!file)
+        throw Error("Cannot open checkpoint file!");
+    vector<char> contents((istreambuf_iterator<char>(file)), istreambuf_iterator<char>());
+    if (file.bad())
+        throw Error("Cannot read checkpoint file!");
+
+    Checkpoint_header header;
+    if (contents.size() < sizeof(header))
+        throw Error("Not a checkpoint file!");
+    memcpy(&header, contents.data(), sizeof(header));
+    if (memcmp(header.magic, checkpoint_magic, sizeof(header.magic)) != 0)
+        throw Error("Not a checkpoint file!");
+    if (header.version != checkpoint_version)
+        throw Error("Unsupported checkpoint version!");
+
+    // the counts are 32 bits, so the sum cannot overflow 64 bits
+    uint64_t expected_size = sizeof(header) + (uint64_t(header.num_strings) + 1) * sizeof(uint32_t)
+        + header.string_bytes + uint64_t(header.num_islands) * sizeof(Island_record)
+        + uint64_t(header.num_cruisers) * sizeof(Warship_record)
+        + uint64_t(header.num_torpedo_boats) * sizeof(Torpedo_boat_record)
+        + uint64_t(header.num_tankers) * sizeof(Tanker_record)
+        + uint64_t(header.num_cruise_ships) * sizeof(Cruise_ship_record)
+        + uint64_t(header.num_chain_ships) * sizeof(Chain_ship_record)
+        + uint64_t(header.num_groups) * sizeof(Group_record) + uint64_t(header.num_links) * sizeof(uint32_t);
+    if (contents.size() != expected_size)
+        throw Error("Checkpoint file is damaged!");
+
+    time = header.time;
+    if (time < 0)
+        throw Error("Checkpoint file is damaged!");
+
+    size_t offset = sizeof(header);
+    vector<uint32_t> string_offsets;
+    read_section(contents, offset, header.num_strings + 1, string_offsets);
+    if (string_offsets.front() != 0 || string_offsets.back() != header.string_bytes)
+        throw Error("Checkpoint file is damaged!");
+    strings.reserve(header.num_strings);
+    for (uint32_t i = 0; i < header.num_strings; ++i) {
+        if (string_offsets[i + 1] < string_offsets[i])
+            throw Error("Checkpoint file is damaged!");
+        strings.emplace_back(contents.data() + offset + string_offsets[i], string_offsets[i + 1] - string_offsets[i]);
+    }
+    offset += header.string_bytes;
+
+    read_section(contents, offset, header.num_islands, island_records);
+    read_section(contents, offset, header.num_cruisers, cruiser_records);
+    read_section(contents, offset, header.num_torpedo_boats, torpedo_boat_records);
+    read_section(contents, offset, header.num_tankers, tanker_records);
+    read_section(contents, offset, header.num_cruise_ships, cruise_ship_records);
+    read_section(contents, offset, header.num_chain_ships, chain_ship_records);
+    read_section(contents, offset, header.num_groups, group_records);
+    read_section(contents, offset, header.num_links, links);
+}
+
+// Build the objects in the checkpoint, in model, into the given containers,
+// which must be empty. Sunk Ships are made but not put in the containers.
+// Throws Error if the records are not consistent.
+void Checkpoint_reader::create_objects(Model& model,
+    map<string, shared_ptr<Island>>& islands,
+    map<string, shared_ptr<Ship>>& ships,
+    map<string, shared_ptr<Ship_component>>& groups,
+    set<string>& group_names)
+{
+    islands_by_id.assign(strings.size(), nullptr);
+    for (const auto& record : island_records) {
+        const string& name = get_name(record.name);
+        auto island = create_island(model, name, Point(record.x, record.y), record.fuel, record.production_rate);
+        // the Islands were written in name order, so each one goes at the end
+        if (islands.insert(islands.end(), make_pair(name, island))->second != island)
+            throw Error("Checkpoint file is damaged!");
+        islands_by_id[record.name] = island;
+    }
+
+    // First make every Ship, so that the Ships can find each other when they restore their state
+    size_t num_ships = cruiser_records.size() + torpedo_boat_records.size() + tanker_records.size()
+        + cruise_ship_records.size() + chain_ship_records.size();
+    ships_by_id.assign(num_ships, nullptr);
+    auto place_ship = [this, &model](const Ship_record& record, const char* type) {
+        if (record.number >= ships_by_id.size() || ships_by_id[record.number])
+            throw Error("Checkpoint file is damaged!");
+        ships_by_id[record.number] = create_ship(model, get_name(record.name), type, Point(record.x, record.y));
+    };
+    for (const auto& record : cruiser_records)
+        place_ship(record.ship, "Cruiser");
+    for (const auto& record : torpedo_boat_records)
+        place_ship(record.warship.ship, "Torpedo_boat");
+    for (const auto& record : tanker_records)
+        place_ship(record.ship, "Tanker");
+    for (const auto& record : cruise_ship_records)
+        place_ship(record.ship, "Cruise_ship");
+    for (const auto& record : chain_ship_records)
+        place_ship(record.ship, "Chain_ship");
+
+    for (const auto& record : cruiser_records)
+        static_pointer_cast<Warship>(ships_by_id[record.ship.number])->restore(record, *this);
+    for (const auto& record : torpedo_boat_records)
+        static_pointer_cast<Torpedo_boat>(ships_by_id[record.warship.ship.number])->restore(record, *this);
+    for (const auto& record : tanker_records)
+        static_pointer_cast<Tanker>(ships_by_id[record.ship.number])->restore(record, *this);
+    for (const auto& record : cruise_ship_records)
+        static_pointer_cast<Cruise_ship>(ships_by_id[record.ship.number])->restore(record, *this);
+    for (const auto& record : chain_ship_records)
+        static_pointer_cast<Chain_ship>(ships_by_id[record.ship.number])->restore(record, *this);
+
+    for (const auto& ship : ships_by_id) {
+        if (!ship->is_afloat())
+            continue;
+        if (islands.count(ship->get_name()) || !ships.insert(make_pair(ship->get_name(), ship)).second)
+            throw Error("Checkpoint file is damaged!");
+    }
+
+    // A group's parent comes before it
+    vector<shared_ptr<Ship_component>> groups_by_index;
+    groups_by_index.reserve(group_records.size());
+    for (const auto& record : group_records) {
+        const string& name = get_name(record.name);
+        if (islands.count(name) || ships.count(name) || !group_names.insert(name).second)
+            throw Error("Checkpoint file is damaged!");
+
+        auto group = create_composite(model, name);
+        if (record.parent == -1)
+            groups.insert(make_pair(name, group));
+        else if (record.parent >= 0 && static_cast<size_t>(record.parent) < groups_by_index.size())
+            groups_by_index[record.parent]->add_component(group);
+        else
+            throw Error("Checkpoint file is damaged!");
+
+        for (const auto& ship : get_link_ships(record.first_member, record.num_members)) {
+            try {
+                group->add_component(ship);
+            } catch (Error&) {
+                throw Error("Checkpoint file is damaged!");
+            }
+        }
+        groups_by_index.push_back(group);
+    }
+}
+
+// Return the Island whose name has this index, or the Ship with this number;
+// nullptr for -1. Throws Error if there is no such Island or Ship.
+shared_ptr<Island> Checkpoint_reader::get_island(int32_t id) const
+{
+    if (id == -1)
+        return nullptr;
+    if (id < 0 || static_cast<size_t>(id) >= islands_by_id.size() || !islands_by_id[id])
+        throw Error("Checkpoint file is damaged!");
+    return islands_by_id[id];
+}
+
+shared_ptr<Ship> Checkpoint_reader::get_ship(int32_t id) const
+{
+    if (id == -1)
+        return nullptr;
+    if (id < 0 || static_cast<size_t>(id) >= ships_by_id.size())
+        throw Error("Checkpoint file is damaged!");
+    return ships_by_id[id];
+}
+
+// Return a handle to the Island or Ship, as above; the default handle for -1
+// and for a sunk Ship, which will not be in the world
+Object_handle Checkpoint_reader::get_island_handle(int32_t id) const
+{
+    shared_ptr<Island> island = get_island(id);
+    return island ? island->get_model().get_handle(*island) : Object_handle();
+}
+
+Object_handle Checkpoint_reader::get_ship_handle(int32_t id) const
+{
+    shared_ptr<Ship> ship = get_ship(id);
+    return ship && ship->is_afloat() ? ship->get_model().get_handle(*ship) : Object_handle();
+}
+
+// Return the names of a list in the links.
+// Throws Error if the list is not in the links.
+vector<string> Checkpoint_reader::get_link_names(uint32_t first, uint32_t count) const
+{
+    check_links(first, count);
+    vector<string> names;
+    names.reserve(count);
+    for (uint32_t i = first; i < first + count; ++i)
+        names.push_back(get_name(links[i]));
+    return names;
+}
+
+// Return the Ships of a list of Ship numbers in the links.
+// Throws Error if the list is not in the links or a number is not a Ship's.
+vector<shared_ptr<Ship>> Checkpoint_reader::get_link_ships(uint32_t first, uint32_t count) const
+{
+    check_links(first, count);
+    vector<shared_ptr<Ship>> link_ships;
+    link_ships.reserve(count);
+    for (uint32_t i = first; i < first + count; ++i) {
+        if (links[i] >= ships_by_id.size())
+            throw Error("Checkpoint file is damaged!");
+        link_ships.push_back(ships_by_id[links[i]]);
+    }
+    return link_ships;
+}
+
+// Return the name with this index.
+// Throws Error if there is none.
+const string& Checkpoint_reader::get_name(uint32_t id) const
+{
+    if (id >= strings.size())
+        throw Error("Checkpoint file is damaged!");
+    return strings[id];
+}
+
+// Return the Islands of a list of Island names in the links, as handles; a
+// list is made once, and shared by every record that refers to it.
+// Throws Error if the list is not in the links or a name is not an Island's.
+shared_ptr<const vector<Object_handle>> Checkpoint_reader::get_link_island_handles(uint32_t first,
+    uint32_t count) const
+{
+    auto& handles = island_handle_lists[make_pair(first, count)];
+    if (handles)
+        return handles;
+
+    check_links(first, count);
+    auto new_handles = make_shared<vector<Object_handle>>();
+    new_handles->reserve(count);
+    for (uint32_t i = first; i < first + count; ++i) {
+        if (links[i] > uint32_t(numeric_limits<int32_t>::max()))
+            throw Error("Checkpoint file is damaged!");
+        new_handles->push_back(get_island_handle(static_cast<int32_t>(links[i])));
+    }
+    handles = new_handles;
+    return handles;
+}
+
+// Check that a list is in the links
+void Checkpoint_reader::check_links(uint32_t first, uint32_t count) const
+{
+    if (first > links.size() || count > links.size() - first)
+        throw Error("Checkpoint file is damaged!");
+}
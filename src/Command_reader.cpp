@@ -0,0 +1,305 @@
+#include "Command_reader.h"
+#include "Utility.h"
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace std;
+
+/*** Stream_reader ***/
+string_view Stream_reader::read_word()
+{
+    if (!(is >> word))
+        word.clear();
+    return word;
+}
+
+bool Stream_reader::read_int(int& value)
+{
+    is >> value;
+
+    if (!is.good()) {
+        is.clear();
+        return false;
+    }
+    return true;
+}
+
+bool Stream_reader::read_double(double& value)
+{
+    is >> value;
+
+    if (!is.good()) {
+        is.clear();
+        return false;
+    }
+    return true;
+}
+
+bool Stream_reader::at_end_of_line()
+{
+    while (is.peek() == ' ' || is.peek() == '\t')
+        is.get();
+    int next = is.peek();
+    return next == '\n' || next == '\r' || next == istream::traits_type::eof();
+}
+
+void Stream_reader::skip_line()
+{
+    is.ignore(numeric_limits<streamsize>::max(), '\n');
+}
+
+/*** Mapped_reader ***/
+
+// the characters operator>> treats as whitespace in the "C" locale
+static bool is_space(char c)
+{
+    return c == ' ' || c == '\n' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+}
+
+static bool is_digit(char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+// Map the named file, or standard input if filename is "-".
+// Throws Error if the file cannot be read.
+Mapped_reader::Mapped_reader(const string& filename)
+    : pos(nullptr)
+    , end(nullptr)
+    , mapping(nullptr)
+    , mapping_size(0)
+{
+    bool from_stdin = filename == "-";
+    int fd = from_stdin ? STDIN_FILENO : open(filename.c_str(), O_RDONLY);
+    if (fd < 0)
+        throw Error("Cannot open script file!");
+
+    // Regular files are mapped; pipes and terminals are read into the buffer
+    struct stat file_status;
+    if (fstat(fd, &file_status) == 0 && S_ISREG(file_status.st_mode) && file_status.st_size > 0) {
+        mapping_size = static_cast<size_t>(file_status.st_size);
+        mapping = mmap(nullptr, mapping_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapping == MAP_FAILED)
+            mapping = nullptr;
+        else
+            madvise(mapping, mapping_size, MADV_SEQUENTIAL);
+    }
+
+    if (!mapping) {
+        char block[1 << 16];
+        ssize_t count;
+        while ((count = read(fd, block, sizeof(block))) > 0)
+            buffer.append(block, static_cast<size_t>(count));
+        if (count < 0) {
+            if (!from_stdin)
+                close(fd);
+            throw Error("Cannot read script file!");
+        }
+    }
+
+    if (!from_stdin)
+        close(fd);
+
+    if (mapping) {
+        pos = static_cast<const char*>(mapping);
+        end = pos + mapping_size;
+    } else {
+        pos = buffer.data();
+        end = pos + buffer.size();
+    }
+}
+
+Mapped_reader::~Mapped_reader()
+{
+    if (mapping)
+        munmap(mapping, mapping_size);
+}
+
+string_view Mapped_reader::read_word()
+{
+    skip_whitespace();
+    const char* word_begin = pos;
+    while (pos != end && !is_space(*pos))
+        ++pos;
+    return string_view(word_begin, static_cast<size_t>(pos - word_begin));
+}
+
+// Accepts [+-]digits like operator>>, failing on overflow
+bool Mapped_reader::read_int(int& value)
+{
+    skip_whitespace();
+    const char* p = pos;
+    bool negative = false;
+    if (p != end && (*p == '+' || *p == '-'))
+        negative = *p++ == '-';
+
+    if (p == end || !is_digit(*p)) {
+        pos = p;
+        return false;
+    }
+
+    long long magnitude = 0;
+    bool overflow = false;
+    for (; p != end && is_digit(*p); ++p) {
+        if (overflow)
+            continue;
+        magnitude = magnitude * 10 + (*p - '0');
+        if (magnitude > static_cast<long long>(numeric_limits<int>::max()) + 1)
+            overflow = true;
+    }
+    pos = p;
+
+    long long signed_value = negative ? -magnitude : magnitude;
+    if (overflow || signed_value > numeric_limits<int>::max() || signed_value < numeric_limits<int>::min())
+        return false;
+
+    value = static_cast<int>(signed_value);
+    return true;
+}
+
+/*
+Accepts [+-]digits[.digits][(e|E)[+-]digits] like operator>>, with at least
+one digit before the exponent. Most numbers in a command file are short
+decimals; those are converted with a single multiplication or division by an
+exact power of ten, which rounds exactly like strtod does. Anything longer
+or larger is handed to strtod.
+*/
+bool Mapped_reader::read_double(double& value)
+{
+    static const double powers_of_ten[] = {1e0,
+        1e1,
+        1e2,
+        1e3,
+        1e4,
+        1e5,
+        1e6,
+        1e7,
+        1e8,
+        1e9,
+        1e10,
+        1e11,
+        1e12,
+        1e13,
+        1e14,
+        1e15,
+        1e16,
+        1e17,
+        1e18,
+        1e19,
+        1e20,
+        1e21,
+        1e22};
+    const int max_exact_digits = 15;  // any 15-digit integer is exact in a double
+
+    skip_whitespace();
+    const char* number_begin = pos;
+    const char* p = pos;
+
+    bool negative = false;
+    if (p != end && (*p == '+' || *p == '-'))
+        negative = *p++ == '-';
+
+    uint64_t mantissa = 0;
+    int significant_digits = 0;
+    int exponent = 0;
+    bool any_digits = false;
+    bool exact = true;  // false if digits had to be dropped from mantissa
+
+    for (; p != end && is_digit(*p); ++p) {
+        any_digits = true;
+        if (mantissa == 0 && *p == '0')
+            continue;
+        if (significant_digits < max_exact_digits) {
+            mantissa = mantissa * 10 + static_cast<uint64_t>(*p - '0');
+            ++significant_digits;
+        } else {
+            ++exponent;
+            exact = false;
+        }
+    }
+    if (p != end && *p == '.') {
+        for (++p; p != end && is_digit(*p); ++p) {
+            any_digits = true;
+            if (mantissa == 0 && *p == '0') {
+                --exponent;
+                continue;
+            }
+            if (significant_digits < max_exact_digits) {
+                mantissa = mantissa * 10 + static_cast<uint64_t>(*p - '0');
+                ++significant_digits;
+                --exponent;
+            } else {
+                exact = false;
+            }
+        }
+    }
+    if (!any_digits) {
+        pos = p;
+        return false;
+    }
+
+    if (p != end && (*p == 'e' || *p == 'E')) {
+        ++p;
+        bool negative_exponent = false;
+        if (p != end && (*p == '+' || *p == '-'))
+            negative_exponent = *p++ == '-';
+        if (p == end || !is_digit(*p)) {
+            pos = p;
+            return false;
+        }
+        int written_exponent = 0;
+        for (; p != end && is_digit(*p); ++p)
+            if (written_exponent < 100000)
+                written_exponent = written_exponent * 10 + (*p - '0');
+        exponent += negative_exponent ? -written_exponent : written_exponent;
+    }
+    pos = p;
+
+    if (exact && mantissa == 0) {
+        value = negative ? -0.0 : 0.0;
+        return true;
+    }
+
+    if (exact && exponent >= -22 && exponent <= 22) {
+        double result = static_cast<double>(mantissa);
+        result = exponent < 0 ? result / powers_of_ten[-exponent] : result * powers_of_ten[exponent];
+        value = negative ? -result : result;
+        return true;
+    }
+
+    string number(number_begin, p);
+    double result = strtod(number.c_str(), nullptr);
+    if (result == HUGE_VAL || result == -HUGE_VAL)
+        return false;
+    value = result;
+    return true;
+}
+
+bool Mapped_reader::at_end_of_line()
+{
+    while (pos != end && (*pos == ' ' || *pos == '\t'))
+        ++pos;
+    return pos == end || *pos == '\n' || *pos == '\r';
+}
+
+void Mapped_reader::skip_line()
+{
+    while (pos != end && *pos != '\n')
+        ++pos;
+    if (pos != end)
+        ++pos;
+}
+
+void Mapped_reader::skip_whitespace()
+{
+    while (pos != end && is_space(*pos))
+        ++pos;
+}
@@ -1,21 +1,40 @@
 #include "Controller.h"
+#include "Command_reader.h"
 #include "Model.h"
 #include "Ship.h"
 #include "Ship_component.h"
 #include "Island.h"
 #include "Geometry.h"
+#include "Logger.h"
+#include "Profiler.h"
 #include "Ship_component_factory.h"
 #include "Utility.h"
 #include "Local_view.h"
 #include "Map_view.h"
 #include "Sailing_view.h"
 #include <algorithm>
+#include <chrono>
+#include <iomanip>
 #include <iostream>
 
 using namespace std;
 
-// Initialize command maps
+// Initialize command maps; the commands work on Model::get_instance()
 Controller::Controller()
+    : Controller(Model::get_instance(), false)
+{ }
+
+// Initialize command maps for commands that work on the given Model.
+// A quiet Controller writes nothing, so that several can run at once: the
+// commands that write - status, describe_groups, and the View commands - are
+// not available, nor are the log commands, which set up the Logger of the
+// whole program; and failed commands are only counted.
+Controller::Controller(Model& model_, bool quiet_)
+    : model(model_)
+    , quiet(quiet_)
+    , reader(nullptr)
+    , num_failed_commands(0)
+    , frames_pending(false)
 {
     view_command_map = {{"open_map_view", &Controller::open_map_view},
         {"close_map_view", &Controller::close_map_view},
@@ -27,7 +46,9 @@ Controller::Controller()
         {"size", &Controller::view_size},
         {"zoom", &Controller::view_zoom},
         {"pan", &Controller::view_pan},
-        {"show", &Controller::view_show}};
+        {"live", &Controller::view_live},
+        {"show", &Controller::view_show},
+        {"render_policy", &Controller::view_render_policy}};
 
     ship_command_map = {{"course", &Controller::ship_course},
         {"position", &Controller::ship_position},
@@ -45,13 +66,22 @@ Controller::Controller()
 
     model_command_map = {{"status", &Controller::model_status},
         {"go", &Controller::model_go},
+        {"run_until", &Controller::model_run_until},
+        {"update_mode", &Controller::model_update_mode},
         {"create", &Controller::model_create},
         {"create_group", &Controller::model_create_composite},
         {"remove_group", &Controller::model_remove_composite},
         {"remove_ship_from_group", &Controller::model_remove_ship_from_composite},
         {"add_ship_to_group", &Controller::model_add_ship_to_composite},
         {"add_group_to_group", &Controller::model_add_composite_to_composite},
-        {"describe_groups", &Controller::model_describe_groups}};
+        {"describe_groups", &Controller::model_describe_groups},
+        {"log_level", &Controller::model_log_level},
+        {"log_category", &Controller::model_log_category},
+        {"log_binary", &Controller::model_log_binary},
+        {"stats", &Controller::model_stats},
+        {"cpa_report", &Controller::model_cpa_report},
+        {"save", &Controller::model_save},
+        {"load", &Controller::model_load}};
 
     command_set = {"open_map_view",
         "close_map_view",
@@ -63,10 +93,14 @@ Controller::Controller()
         "size",
         "zoom",
         "pan",
+        "live",
         "show",
+        "render_policy",
         "quit",
         "status",
         "go",
+        "run_until",
+        "update_mode",
         "create",
         "course",
         "position",
@@ -89,66 +123,62 @@ Controller::Controller()
         "remove_ship_from_group",
         "remove_group",
         "add_group_to_group",
-        "describe_groups"};
+        "describe_groups",
+        "log_level",
+        "log_category",
+        "log_binary",
+        "stats",
+        "cpa_report",
+        "save",
+        "load"};
+
+    if (quiet) {
+        for (auto& pair : view_command_map)
+            pair.second = &Controller::skip_command;
+        for (const char* command :
+            {"status", "describe_groups", "log_level", "log_category", "log_binary", "stats", "cpa_report"})
+            model_command_map[command] = &Controller::skip_command;
+    }
 }
 
 // Run the program by acccepting user commands
 void Controller::run()
 {
-    string first_input;
-    while (true) {
-        try {
-            cout << "\nTime " << Model::get_instance().get_time() << ": Enter command: ";
-            cin >> first_input;
-
-            // If the first word is "quit", check if View
-            // is still open, and detach and delete view_ptr.
-            // Then exit the while loop.
-            if (first_input == "quit") {
-                cout << "Done";
-                return;
-            }
-
-            // Check and see if first_input is a Ship's name.
-            shared_ptr<Ship_component> ship_ptr = Model::get_instance().get_ship_ptr(first_input);
+    Stream_reader stream_reader(cin);
+    reader = &stream_reader;
+    run_commands(true);
+    reader = nullptr;
+}
 
-            // When there is a Ship that matches first_input
-            if (ship_ptr) {
-                process_ship_command(ship_ptr);
-            } else {
-                shared_ptr<Ship_component> composite_ptr = Model::get_instance().get_ship_composite_ptr(first_input);
+// Run the commands in a script file ("-" for standard input) without prompting,
+// then report how many commands and ticks were run and how fast.
+void Controller::run_script(const string& filename)
+{
+    Mapped_reader script_reader(filename);
+    reader = &script_reader;
 
-                // When there is a Ship_composite which matches first_input
-                if (composite_ptr) {
-                    process_ship_command(composite_ptr);
-                } else {
-                    // Check if first_input is a Model command
-                    auto model_command_iter = model_command_map.find(first_input);
+    int start_time = model.get_time();
+    auto start = chrono::steady_clock::now();
+    int num_commands = run_commands(false);
+    chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+    reader = nullptr;
 
-                    // If it is a Model command, run the Model command.
-                    if (model_command_iter != model_command_map.cend()) {
-                        model_command_iter->second(this);
-                    } else {
-                        // Check if first_input is a View command
-                        auto view_command_iter = view_command_map.find(first_input);
+    int num_ticks = model.get_time() - start_time;
+    cout << "\n" << num_commands << " commands, " << num_ticks << " ticks in " << elapsed.count() << " s";
+    if (elapsed.count() > 0.)
+        cout << " (" << num_ticks / elapsed.count() << " ticks/s)";
+    cout << endl;
+}
 
-                        // If it is a View commnad, run it.
-                        // If it is not a View command, throw an Error
-                        // because it cannot be any other command.
-                        if (view_command_iter != view_command_map.cend())
-                            view_command_iter->second(this);
-                        else
-                            throw Error("Unrecognized command!");
-                    }
-                }
-            }
-        }
-        // If an Error is thrown, skip rest of the line.
-        catch (Error& e) {
-            cout << e.what() << endl;
-            cin.ignore(numeric_limits<streamsize>::max(), '\n');
-        }
-    }
+// Run the commands from a reader without prompting or reporting on them.
+// Return the number of commands that failed.
+int Controller::run_batch(Command_reader& reader_)
+{
+    reader = &reader_;
+    num_failed_commands = 0;
+    run_commands(false);
+    reader = nullptr;
+    return num_failed_commands;
 }
 
 // View commands
@@ -161,7 +191,7 @@ void Controller::open_map_view()
         throw Error("Map view is already open!");
 
     map_view_ptr = make_shared<Map_view>();
-    Model::get_instance().attach(map_view_ptr);
+    model.attach(map_view_ptr);
     view_vec.push_back(map_view_ptr);
 }
 
@@ -172,7 +202,7 @@ void Controller::close_map_view()
     if (!map_view_ptr)
         throw Error("Map view is not open!");
 
-    Model::get_instance().detach(map_view_ptr);
+    model.detach(map_view_ptr);
     view_vec.erase(find(view_vec.cbegin(), view_vec.cend(), map_view_ptr));
     map_view_ptr.reset();
 }
@@ -186,7 +216,7 @@ void Controller::open_sailing_view()
 
     sailing_view_ptr = make_shared<Sailing_view>();
     view_vec.push_back(sailing_view_ptr);
-    Model::get_instance().attach(sailing_view_ptr);
+    model.attach(sailing_view_ptr);
 }
 
 // close and destroy the sailing data view view.
@@ -196,7 +226,7 @@ void Controller::close_sailing_view()
     if (!sailing_view_ptr)
         throw Error("Sailing data view is not open!");
 
-    Model::get_instance().detach(sailing_view_ptr);
+    model.detach(sailing_view_ptr);
     view_vec.erase(find(view_vec.cbegin(), view_vec.cend(), sailing_view_ptr));
     sailing_view_ptr.reset();
 }
@@ -206,34 +236,32 @@ void Controller::close_sailing_view()
 // with that name; local view is already open for that name.
 void Controller::open_local_view()
 {
-    string ship_name;
-    cin >> ship_name;
-    shared_ptr<Ship> ship_ptr = Model::get_instance().get_ship_ptr(ship_name);
+    string ship_name = read_word();
+    shared_ptr<Ship> ship_ptr = model.get_ship_ptr(ship_name);
 
     if (!ship_ptr)
         throw Error("Ship not found!");
 
-    shared_ptr<Local_view> new_view = make_shared<Local_view>(Local_view(ship_ptr->get_name()));
+    shared_ptr<Local_view> new_view = make_shared<Local_view>(ship_ptr->get_name(), ship_ptr->get_id());
 
     if (!local_view_ptr_map.insert(make_pair(ship_ptr->get_name(), new_view)).second)
         throw Error("Local view is already open for that ship!");
 
     view_vec.push_back(new_view);
-    Model::get_instance().attach(new_view);
+    model.attach(new_view);
 }
 
 // close and destroy the view with that name.
 // Error: local view is not open for that name.
 void Controller::close_local_view()
 {
-    string ship_name;
-    cin >> ship_name;
+    string ship_name = read_word();
 
     auto view_ptr = local_view_ptr_map.find(ship_name);
     if (view_ptr == local_view_ptr_map.cend())
         throw Error("Local view for that ship is not open!");
 
-    Model::get_instance().detach(view_ptr->second);
+    model.detach(view_ptr->second);
     view_vec.erase(find(view_vec.cbegin(), view_vec.cend(), view_ptr->second));
     local_view_ptr_map.erase(view_ptr);
 }
@@ -245,7 +273,7 @@ void Controller::view_default() const
     if (!map_view_ptr)
         throw Error("Map view is not open!");
 
-    map_view_ptr->set_defaults();
+    model.post_view_command([view_ptr = map_view_ptr](ostream&) { view_ptr->set_defaults(); });
 }
 
 // read a single integer for the size of
@@ -256,15 +284,9 @@ void Controller::view_size() const
     if (!map_view_ptr)
         throw Error("Map view is not open!");
 
-    int size;
-    cin >> size;
-
-    if (!cin.good()) {
-        cin.clear();
-        throw Error("Expected an integer!");
-    }
-
-    map_view_ptr->set_size(size);
+    int size = read_int();
+    Map_view::check_size(size);
+    model.post_view_command([view_ptr = map_view_ptr, size](ostream&) { view_ptr->set_size(size); });
 }
 
 // read a double value for the scale of the map
@@ -274,15 +296,10 @@ void Controller::view_zoom() const
     if (!map_view_ptr)
         throw Error("Map view is not open!");
 
-    double scale;
-    cin >> scale;
-
-    if (!cin.good()) {
-        cin.clear();
-        throw Error("Expected a double!");
-    }
+    double scale = read_double();
+    Map_view::check_scale(scale);
 
-    map_view_ptr->set_scale(scale);
+    model.post_view_command([view_ptr = map_view_ptr, scale](ostream&) { view_ptr->set_scale(scale); });
 }
 
 // read a pair of double values for the (x, y) origin of the map.
@@ -292,9 +309,25 @@ void Controller::view_pan() const
     if (!map_view_ptr)
         throw Error("Map view is not open!");
 
-    double x, y;
-    cin >> x >> y;
-    map_view_ptr->set_origin(Point(x, y));
+    double x = read_double();
+    double y = read_double();
+    model.post_view_command([view_ptr = map_view_ptr, x, y](ostream&) { view_ptr->set_origin(Point(x, y)); });
+}
+
+// read "on" or "off" to turn live mode of the map on or off: the map is then
+// drawn with terminal escape sequences, and after the first time only its
+// changed rows are. If the View is not open, throw an Error.
+void Controller::view_live() const
+{
+    if (!map_view_ptr)
+        throw Error("Map view is not open!");
+
+    string setting = read_word();
+    if (setting != "on" && setting != "off")
+        throw Error("Expected on or off!");
+
+    bool live = setting == "on";
+    model.post_view_command([view_ptr = map_view_ptr, live](ostream&) { view_ptr->set_live(live); });
 }
 
 // tell the View to draw the map note that the Model and the objects
@@ -305,7 +338,24 @@ void Controller::view_show() const
     if (view_vec.empty())
         throw Error("Map view is not open!");
 
-    for_each(view_vec.cbegin(), view_vec.cend(), [](const shared_ptr<View> ptr) { ptr->draw(); });
+    // The Views are drawn on the Views' thread, and the frames written out
+    // before the next command
+    for_each(view_vec.cbegin(), view_vec.cend(), [this](const shared_ptr<View> ptr) {
+        model.post_view_command([ptr](ostream& os) { ptr->draw(os); });
+    });
+}
+
+// read "block" or "drop", and the number of drawn frames that may wait to
+// be written out (see View_renderer.h)
+void Controller::view_render_policy() const
+{
+    string policy = read_word();
+    if (policy != "block" && policy != "drop")
+        throw Error("Expected block or drop!");
+
+    int max_frames = read_int();
+    model.get_view_renderer().set_frame_policy(
+        policy == "block" ? View_renderer::Frame_policy::block : View_renderer::Frame_policy::drop, max_frames);
 }
 
 // Model commands
@@ -314,298 +364,538 @@ void Controller::view_show() const
 // alphabetical order by name of all of the objects.
 void Controller::model_status() const
 {
-    Model::get_instance().describe();
+    Logger::get_instance().flush();
+    model.describe();
 }
 
-// call the Model::update() function
+// call the Model::update() function, or if a number of ticks follows
+// on the same line, update that many times
 void Controller::model_go() const
 {
-    Model::get_instance().update();
+    if (reader->at_end_of_line()) {
+        model.update();
+        return;
+    }
+
+    int num_ticks = read_int();
+    if (num_ticks <= 0)
+        throw Error("Number of ticks must be positive!");
+    model.update(num_ticks);
+}
+
+// read a time and update until the Model reaches it
+void Controller::model_run_until() const
+{
+    int end_time = read_int();
+    if (end_time < model.get_time())
+        throw Error("Time has already passed!");
+    model.update(end_time - model.get_time());
+}
+
+// read "serial", "parallel" or "event" to choose how Model::update() runs
+void Controller::model_update_mode() const
+{
+    string mode = read_word();
+
+    if (mode == "serial")
+        model.set_update_mode(Model::Update_mode::serial);
+    else if (mode == "parallel")
+        model.set_update_mode(Model::Update_mode::parallel);
+    else if (mode == "event")
+        model.set_update_mode(Model::Update_mode::event);
+    else
+        throw Error("Unrecognized update mode!");
+}
+
+// read "debug", "info", "warning" or "error"; keep log messages of that level and above
+void Controller::model_log_level() const
+{
+    string level = read_word();
+
+    if (level == "debug")
+        Logger::get_instance().set_level(Log_level::debug);
+    else if (level == "info")
+        Logger::get_instance().set_level(Log_level::info);
+    else if (level == "warning")
+        Logger::get_instance().set_level(Log_level::warning);
+    else if (level == "error")
+        Logger::get_instance().set_level(Log_level::error);
+    else
+        throw Error("Unrecognized log level!");
+}
+
+// read a category ("movement", "fuel", "combat", "docking", "general" or "all")
+// and "on" or "off" to keep or drop its log messages
+void Controller::model_log_category() const
+{
+    static const map<string, Log_category> categories = {{"movement", Log_category::movement},
+        {"fuel", Log_category::fuel},
+        {"combat", Log_category::combat},
+        {"docking", Log_category::docking},
+        {"general", Log_category::general}};
+
+    string category = read_word();
+    if (category != "all" && categories.find(category) == categories.end())
+        throw Error("Unrecognized log category!");
+
+    string setting = read_word();
+    if (setting != "on" && setting != "off")
+        throw Error("Expected on or off!");
+
+    for (const auto& pair : categories)
+        if (category == "all" || category == pair.first)
+            Logger::get_instance().set_category_enabled(pair.second, setting == "on");
+}
+
+// read a file name to also write the log to in binary, or "off" to stop
+void Controller::model_log_binary() const
+{
+    string filename = read_word();
+
+    Logger::get_instance().set_binary_file(filename == "off" ? string() : filename);
+}
+
+// write how long each part of a tick takes, and the counts per tick (see Profiler.h).
+// If the profiler is not built in, throw an Error.
+void Controller::model_stats() const
+{
+    if (!profiler_built_in)
+        throw Error("Profiler is not built in!");
+
+    // the Views' thread records too, so it must be idle
+    flush_output(true);
+    Profiler::get_instance().write_stats(cout);
+}
+
+// read a range in nm and a time in hours, and write every pair of Ships that
+// will come within that range of each other in that time, soonest first, if
+// they hold their course and speed (see Model::screen_cpa)
+void Controller::model_cpa_report() const
+{
+    double range = read_double();
+    if (range <= 0.)
+        throw Error("Range must be positive!");
+    double hours = read_double();
+    if (hours < 0.)
+        throw Error("Time must not be negative!");
+
+    vector<Cpa_pair> pairs = model.screen_cpa(range, hours);
+
+    Logger::get_instance().flush();
+    ios::fmtflags old_flags = cout.flags();
+    streamsize old_precision = cout.precision();
+    cout << fixed << setprecision(2);
+    if (pairs.empty()) {
+        cout << "No Ships come within " << range << " nm of each other in " << hours << " hours" << endl;
+    } else {
+        cout << "Ships that come within " << range << " nm of each other in " << hours << " hours:" << endl;
+        for (const Cpa_pair& pair : pairs) {
+            cout << model.get_name(pair.id1) << " and " << model.get_name(pair.id2) << " pass " << pair.range
+                 << " nm apart in " << pair.time << " hours" << endl;
+        }
+    }
+    cout.flags(old_flags);
+    cout.precision(old_precision);
+}
+
+// read a file name and write a checkpoint of the world to it
+void Controller::model_save() const
+{
+    string filename = read_word();
+
+    model.save(filename);
+}
+
+// read a file name and replace the world with the checkpoint in it
+void Controller::model_load() const
+{
+    string filename = read_word();
+
+    model.load(filename);
 }
 
 // create a new Ship using the supplied name,
 // type name, and initial position.
 void Controller::model_create() const
 {
-    string ship_name;
-    cin >> ship_name;
+    string ship_name = read_word();
 
     check_if_name_valid(ship_name);
 
     // Read in object_type which can be
     // Tanker or Cruiser. add_ship() will check
     // if it is one of these two.
-    string object_type;
-    cin >> object_type;
+    string object_type = read_word();
 
-    double x, y;
-    cin >> x;
+    double x = read_double();
+    double y = read_double();
 
-    if (!cin.good()) {
-        cin.clear();
-        throw Error("Expected a double!");
-    }
-
-    cin >> y;
-
-    if (!cin.good()) {
-        cin.clear();
-        throw Error("Expected a double!");
-    }
-
-    Model::get_instance().add_ship(create_ship(ship_name, object_type, Point(x, y)));
+    model.add_ship(create_ship(model, ship_name, object_type, Point(x, y)));
 }
 
 // Create a Ship_composite and add it to the Model
 void Controller::model_create_composite() const
 {
-    string composite_name;
-    cin >> composite_name;
+    string composite_name = read_word();
 
     check_if_name_valid(composite_name);
 
-    Model::get_instance().add_composite(create_composite(composite_name));
+    model.add_composite(create_composite(model, composite_name));
 }
 
 // Remove a Ship_composite from the Model
 void Controller::model_remove_composite() const
 {
-    string composite_name;
-    cin >> composite_name;
+    string composite_name = read_word();
 
-    Model::get_instance().remove_composite(composite_name);
+    model.remove_composite(composite_name);
 }
 
 // Remove a Ship from a Ship_composite
 void Controller::model_remove_ship_from_composite() const
 {
-    string composite_name, ship_name;
-    cin >> composite_name >> ship_name;
+    string composite_name = read_word();
+    string ship_name = read_word();
 
-    Model::get_instance().remove_ship_from_composite(composite_name, ship_name);
+    model.remove_ship_from_composite(composite_name, ship_name);
 }
 
 // Add a Ship to a Ship_composite
 void Controller::model_add_ship_to_composite() const
 {
-    string composite_name, ship_name;
-    cin >> composite_name >> ship_name;
+    string composite_name = read_word();
+    string ship_name = read_word();
 
-    Model::get_instance().add_ship_to_composite(composite_name, Model::get_instance().get_ship_ptr(ship_name));
+    model.add_ship_to_composite(composite_name, model.get_ship_ptr(ship_name));
 }
 
 // Add a Ship_composite to a Ship_composite
 void Controller::model_add_composite_to_composite() const
 {
-    string composite_name, new_composite_name;
-    cin >> composite_name >> new_composite_name;
+    string composite_name = read_word();
+    string new_composite_name = read_word();
 
-    Model::get_instance().add_composite_to_composite(composite_name, create_composite(new_composite_name));
+    model.add_composite_to_composite(composite_name, create_composite(model, new_composite_name));
 }
 
 // Describe a set of Ship_composites
 void Controller::model_describe_groups() const
 {
-    Model::get_instance().describe_composite();
+    Logger::get_instance().flush();
+    model.describe_composite();
 }
 
 // Ship commands
 
+// Give a command to a Ship or a group. A quiet Controller gives it to a Ship with the
+// try_ form of the command, and counts a failure without an Error being thrown;
+// otherwise the command is called, and a Ship that cannot carry it out throws Error.
+template <typename... Params, typename... Args>
+void Controller::give_ship_command(Ship_component& target,
+    const char* (Ship::*try_command)(Params...),
+    void (Ship_component::*command)(Params...),
+    const Args&... args)
+{
+    Ship* ship_ptr = quiet ? target.as_ship() : nullptr;
+    if (!ship_ptr) {
+        (target.*command)(args...);
+        return;
+    }
+
+    // as when an Error is caught, the rest of the line is skipped
+    if ((ship_ptr->*try_command)(args...)) {
+        ++num_failed_commands;
+        reader->skip_line();
+    }
+}
+
 // read a compass heading and a speed (both doubles) for the
 // Ship to set course and speed. basic validity check:
 // 0.0 <= compass heading < 360.0, speed >= 0.0
-void Controller::ship_course(shared_ptr<Ship_component> const ship_ptr) const
+void Controller::ship_course(shared_ptr<Ship_component> const ship_ptr)
 {
-    double compass_heading;
-    cin >> compass_heading;
-
-    if (!cin.good()) {
-        cin.clear();
-        throw Error("Expected a double!");
-    }
+    double compass_heading = read_double();
 
     if (compass_heading < 0.0 || compass_heading >= 360.0)
         throw Error("Invalid heading entered!");
 
-    double speed;
-    cin >> speed;
-
-    if (!cin.good()) {
-        cin.clear();
-        throw Error("Expected a double!");
-    }
+    double speed = read_double();
 
     if (speed < 0.0)
         throw Error("Negative speed entered!");
 
-    ship_ptr->set_course_and_speed(compass_heading, speed);
+    give_ship_command(
+        *ship_ptr, &Ship::try_set_course_and_speed, &Ship_component::set_course_and_speed, compass_heading, speed);
 }
 
 // read an (x, y) position and then a speed (all doubles) for
 // the Ship to set destination position and speed to go to.
 // basic validity check : x, y can have any value, speed >= 0.0
-void Controller::ship_position(shared_ptr<Ship_component> const ship_ptr) const
+void Controller::ship_position(shared_ptr<Ship_component> const ship_ptr)
 {
-    double x, y, speed;
-    cin >> x;
-
-    if (!cin.good()) {
-        cin.clear();
-        throw Error("Expected a double!");
-    }
-
-    cin >> y;
-
-    if (!cin.good()) {
-        cin.clear();
-        throw Error("Expected a double!");
-    }
-
-    cin >> speed;
-
-    if (!cin.good()) {
-        cin.clear();
-        throw Error("Expected a double!");
-    }
+    double x = read_double();
+    double y = read_double();
+    double speed = read_double();
 
     if (speed < 0.0)
         throw Error("Negative speed entered!");
 
-    ship_ptr->set_destination_position_and_speed(Point(x, y), speed);
+    give_ship_command(*ship_ptr,
+        &Ship::try_set_destination_position_and_speed,
+        &Ship_component::set_destination_position_and_speed,
+        Point(x, y),
+        speed);
 }
 
 // read an Island name and a speed (a double) for the ship
 // to set destination Island and speed. basic validity check
 // : Island must exist, speed >= 0.0
-void Controller::ship_destination(shared_ptr<Ship_component> const ship_ptr) const
+void Controller::ship_destination(shared_ptr<Ship_component> const ship_ptr)
 {
-    string island_name;
-    cin >> island_name;
+    string island_name = read_word();
 
-    shared_ptr<Island> island_ptr = Model::get_instance().get_island_ptr(island_name);
+    shared_ptr<Island> island_ptr = model.get_island_ptr(island_name);
 
-    double speed;
-    cin >> speed;
-
-    if (!cin.good()) {
-        cin.clear();
-        throw Error("Expected a double!");
-    }
+    double speed = read_double();
 
     if (speed < 0.0)
         throw Error("Negative speed entered!");
 
-    ship_ptr->set_destination_island_and_speed(island_ptr, speed);
+    give_ship_command(*ship_ptr,
+        &Ship::try_set_destination_island_and_speed,
+        &Ship_component::set_destination_island_and_speed,
+        island_ptr,
+        speed);
 }
 
 // read an Island name to load at.
 // basic validity check : Island must exist
-void Controller::ship_load_at(shared_ptr<Ship_component> const ship_ptr) const
+void Controller::ship_load_at(shared_ptr<Ship_component> const ship_ptr)
 {
-    string island_name;
-    cin >> island_name;
+    string island_name = read_word();
 
     // Get island_ptr from island_name and set load destination
     // to the found Island.
-    shared_ptr<Island> island_ptr = Model::get_instance().get_island_ptr(island_name);
-    ship_ptr->set_load_destination(island_ptr);
+    shared_ptr<Island> island_ptr = model.get_island_ptr(island_name);
+    give_ship_command(*ship_ptr, &Ship::try_set_load_destination, &Ship_component::set_load_destination, island_ptr);
 }
 
 // read an Island name to unload at.
 // basic validity check : Island must exist
-void Controller::ship_unload_at(shared_ptr<Ship_component> const ship_ptr) const
+void Controller::ship_unload_at(shared_ptr<Ship_component> const ship_ptr)
 {
-    string island_name;
-    cin >> island_name;
+    string island_name = read_word();
 
-    shared_ptr<Island> island_ptr = Model::get_instance().get_island_ptr(island_name);
-    ship_ptr->set_unload_destination(island_ptr);
+    shared_ptr<Island> island_ptr = model.get_island_ptr(island_name);
+    give_ship_command(
+        *ship_ptr, &Ship::try_set_unload_destination, &Ship_component::set_unload_destination, island_ptr);
 }
 
 // Chain other Ships in the simulation world
-void Controller::ship_chain_all_ship(shared_ptr<Ship_component> const ship_ptr) const
+void Controller::ship_chain_all_ship(shared_ptr<Ship_component> const ship_ptr)
 {
-    ship_ptr->chain_all_ship();
+    give_ship_command(*ship_ptr, &Ship::try_chain_all_ship, &Ship_component::chain_all_ship);
 }
 
 // Chain a Ship to a Chain_ship so that when
 // Chain_ship sets its destination or course,
 // its chained Ships do the same.
 // check : ship_ptr exists
-void Controller::ship_chain_ship(shared_ptr<Ship_component> const ship_ptr) const
+void Controller::ship_chain_ship(shared_ptr<Ship_component> const ship_ptr)
 {
-    string ship_name;
-    cin >> ship_name;
+    string ship_name = read_word();
 
-    shared_ptr<Ship> ship_to_chain = Model::get_instance().get_ship_ptr(ship_name);
+    shared_ptr<Ship> ship_to_chain = model.get_ship_ptr(ship_name);
 
     if (!ship_to_chain)
         throw Error("Ship not found!");
 
-    ship_ptr->chain_ship(ship_to_chain);
+    give_ship_command(*ship_ptr, &Ship::try_chain_ship, &Ship_component::chain_ship, ship_to_chain);
 }
 
 // Unchain a Ship from a Chain_ship.
 // check: ship_ptr exists
-void Controller::ship_unchain_ship(shared_ptr<Ship_component> const ship_ptr) const
+void Controller::ship_unchain_ship(shared_ptr<Ship_component> const ship_ptr)
 {
-    string ship_name;
-    cin >> ship_name;
+    string ship_name = read_word();
 
-    shared_ptr<Ship> ship_to_unchain = Model::get_instance().get_ship_ptr(ship_name);
+    shared_ptr<Ship> ship_to_unchain = model.get_ship_ptr(ship_name);
 
     if (!ship_to_unchain)
         throw Error("Ship not found!");
 
-    ship_ptr->unchain_ship(ship_to_unchain);
+    give_ship_command(*ship_ptr, &Ship::try_unchain_ship, &Ship_component::unchain_ship, ship_to_unchain);
 }
 
 // read an Island name to dock at.
 // basic validity check : Island must exist
-void Controller::ship_dock_at(shared_ptr<Ship_component> const ship_ptr) const
+void Controller::ship_dock_at(shared_ptr<Ship_component> const ship_ptr)
 {
-    string island_name;
-    cin >> island_name;
+    string island_name = read_word();
 
-    shared_ptr<Island> island_ptr = Model::get_instance().get_island_ptr(island_name);
-    ship_ptr->dock(island_ptr);
+    shared_ptr<Island> island_ptr = model.get_island_ptr(island_name);
+    give_ship_command(*ship_ptr, &Ship::try_dock, &Ship_component::dock, island_ptr);
 }
 
 // read a Ship name to attack.
 // basic validity check : Ship must exist
-void Controller::ship_attack(shared_ptr<Ship_component> const ship_ptr) const
+void Controller::ship_attack(shared_ptr<Ship_component> const ship_ptr)
 {
-    string ship_name;
-    cin >> ship_name;
+    string ship_name = read_word();
 
-    shared_ptr<Ship> ship_target_ptr = Model::get_instance().get_ship_ptr(ship_name);
+    shared_ptr<Ship> ship_target_ptr = model.get_ship_ptr(ship_name);
 
     if (!ship_target_ptr)
         throw Error("Ship not found!");
 
-    ship_ptr->attack(ship_target_ptr);
+    give_ship_command(*ship_ptr, &Ship::try_attack, &Ship_component::attack, ship_target_ptr);
 }
 
 // refuel a Ship
-void Controller::ship_refuel(shared_ptr<Ship_component> const ship_ptr) const
+void Controller::ship_refuel(shared_ptr<Ship_component> const ship_ptr)
 {
-    ship_ptr->refuel();
+    give_ship_command(*ship_ptr, &Ship::try_refuel, &Ship_component::refuel);
 }
 
 // stop a Ship
-void Controller::ship_stop(shared_ptr<Ship_component> const ship_ptr) const
+void Controller::ship_stop(shared_ptr<Ship_component> const ship_ptr)
 {
-    ship_ptr->stop();
+    give_ship_command(*ship_ptr, &Ship::try_stop, &Ship_component::stop);
 }
 
 // stop a Ship from attacking
-void Controller::ship_stop_attack(shared_ptr<Ship_component> const ship_ptr) const
+void Controller::ship_stop_attack(shared_ptr<Ship_component> const ship_ptr)
 {
-    ship_ptr->stop_attack();
+    give_ship_command(*ship_ptr, &Ship::try_stop_attack, &Ship_component::stop_attack);
 }
 
 /*** Helper Functions ***/
 
+// Read and run commands until "quit" or the end of the input, prompting
+// for each one if prompt is true. Return the number of commands read.
+// The output is flushed only before the prompt, after a View command, and
+// before the Controller writes to cout itself, so a script of commands
+// that only log runs without waiting on the Logger's thread.
+int Controller::run_commands(bool prompt)
+{
+    int num_commands = 0;
+    while (true) {
+        try {
+            if (!quiet && (prompt || frames_pending)) {
+                flush_output(false);
+                frames_pending = false;
+            }
+            if (prompt)
+                cout << "\nTime " << model.get_time() << ": Enter command: ";
+            string first_input = read_word();
+
+            if (first_input.empty()) {
+                if (!quiet)
+                    flush_output(true);
+                return num_commands;
+            }
+            ++num_commands;
+            PROFILE_SCOPE(Profile_section::command);
+
+            // If the first word is "quit", check if View
+            // is still open, and detach and delete view_ptr.
+            // Then exit the while loop.
+            if (first_input == "quit") {
+                if (!quiet) {
+                    flush_output(true);
+                    cout << "Done";
+                }
+                return num_commands;
+            }
+
+            // Check and see if first_input is a Ship's name.
+            shared_ptr<Ship_component> ship_ptr = model.get_ship_ptr(first_input);
+
+            // When there is a Ship that matches first_input
+            if (ship_ptr) {
+                process_ship_command(ship_ptr);
+            } else {
+                shared_ptr<Ship_component> composite_ptr = model.get_ship_composite_ptr(first_input);
+
+                // When there is a Ship_composite which matches first_input
+                if (composite_ptr) {
+                    process_ship_command(composite_ptr);
+                } else {
+                    // Check if first_input is a Model command
+                    auto model_command_iter = model_command_map.find(first_input);
+
+                    // If it is a Model command, run the Model command.
+                    if (model_command_iter != model_command_map.cend()) {
+                        model_command_iter->second(this);
+                    } else {
+                        // Check if first_input is a View command
+                        auto view_command_iter = view_command_map.find(first_input);
+
+                        // If it is a View commnad, run it.
+                        // If it is not a View command, throw an Error
+                        // because it cannot be any other command.
+                        if (view_command_iter != view_command_map.cend()) {
+                            // its frames are written out before the next command
+                            frames_pending = true;
+                            view_command_iter->second(this);
+                        } else
+                            throw Error("Unrecognized command!");
+                    }
+                }
+            }
+        }
+        // If an Error is thrown, skip rest of the line.
+        catch (Error& e) {
+            ++num_failed_commands;
+            if (!quiet) {
+                flush_output(false);
+                frames_pending = false;
+                cout << e.what() << endl;
+            }
+            reader->skip_line();
+        }
+    }
+}
+
+// Skip the rest of a command that a quiet Controller does not run
+void Controller::skip_command()
+{
+    reader->skip_line();
+}
+
+// Flush the Logger and write out the frames the Views have drawn, so that
+// what is written next comes after them; wait for every frame if wait_all
+// is true (see View_renderer::write_frames)
+void Controller::flush_output(bool wait_all) const
+{
+    Logger::get_instance().flush();
+    model.get_view_renderer().write_frames(cout, wait_all);
+}
+
+// Read the next word of a command
+string Controller::read_word() const
+{
+    return string(reader->read_word());
+}
+
+// Read an integer; throw Error("Expected an integer!") if there is none
+int Controller::read_int() const
+{
+    int value;
+    if (!reader->read_int(value))
+        throw Error("Expected an integer!");
+    return value;
+}
+
+// Read a double; throw Error("Expected a double!") if there is none
+double Controller::read_double() const
+{
+    double value;
+    if (!reader->read_double(value))
+        throw Error("Expected a double!");
+    return value;
+}
+
 void Controller::check_if_name_valid(const std::string& name) const
 {
     if (name.length() < 2)
@@ -625,8 +915,7 @@ void Controller::check_if_name_valid(const std::string& name) const
 void Controller::process_ship_command(std::shared_ptr<Ship_component> const ptr)
 {
     // If first_input is a Ship's name, read in a Ship command.
-    string ship_command;
-    cin >> ship_command;
+    string ship_command = read_word();
 
     // If the second input is not a Ship command, throw an Error.
     auto ship_command_iter = ship_command_map.find(ship_command);
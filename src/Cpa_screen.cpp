@@ -0,0 +1,289 @@
+#include "Cpa_screen.h"
+#include "Kinematics.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+
+using namespace std;
+
+Cpa_screen::Cpa_screen()
+    : grid_x(0.)
+    , grid_y(0.)
+    , cell_scale(1.)
+    , num_cells_x(0)
+    , num_cells_y(0)
+    , candidate_id1(batch_size)
+    , candidate_id2(batch_size)
+    , candidate_dx(batch_size)
+    , candidate_dy(batch_size)
+    , candidate_dvx(batch_size)
+    , candidate_dvy(batch_size)
+    , candidate_time(batch_size)
+    , candidate_range_squared(batch_size)
+    , num_candidates(0)
+{ }
+
+// Remove every track
+void Cpa_screen::clear()
+{
+    ids.clear();
+    x.clear();
+    y.clear();
+    velocity_x.clear();
+    velocity_y.clear();
+}
+
+// Add the track of an object at position with velocity in nm per hour
+void Cpa_screen::add_track(Object_id id, Point position, Cartesian_vector velocity)
+{
+    ids.push_back(id);
+    x.push_back(position.x);
+    y.push_back(position.y);
+    velocity_x.push_back(velocity.delta_x);
+    velocity_y.push_back(velocity.delta_y);
+}
+
+// Add to pairs every pair of the tracks that come within range of each
+// other in the next hours, in no particular order; a pair's id1 is that of
+// the track added first. range must be positive and hours not negative.
+void Cpa_screen::screen(double range, double hours, vector<Cpa_pair>& pairs)
+{
+    if (get_num_tracks() < 2)
+        return;
+
+    build_grid(range, hours);
+    double range_squared = range * range;
+    num_candidates = 0;
+    for (int cell_y = 0; cell_y < num_cells_y; ++cell_y) {
+        for (int cell_x = 0; cell_x < num_cells_x; ++cell_x) {
+            int cell = cell_y * num_cells_x + cell_x;
+            int begin = cell_starts[cell];
+            int end = cell_starts[cell + 1];
+            int moving_end = begin + cell_num_moving[cell];
+            // each pair with at least one moving track, with the moving track first
+            for (int i = begin; i < moving_end; ++i) {
+                int track1 = cell_tracks[i];
+                for (int j = i + 1; j < end; ++j) {
+                    int track2 = cell_tracks[j];
+                    double overlap_x = max(box_min_x[track1], box_min_x[track2]);
+                    double overlap_y = max(box_min_y[track1], box_min_y[track2]);
+                    if (overlap_x > min(box_max_x[track1], box_max_x[track2])
+                        || overlap_y > min(box_max_y[track1], box_max_y[track2]))
+                        continue;
+                    if (to_cell_x(overlap_x) != cell_x || to_cell_y(overlap_y) != cell_y)
+                        continue;
+
+                    bool added_first = sorted_tracks[track1] < sorted_tracks[track2];
+                    int first = added_first ? track1 : track2;
+                    int second = added_first ? track2 : track1;
+                    add_candidate(ids[sorted_tracks[first]],
+                        Point(sorted_x[first], sorted_y[first]),
+                        Cartesian_vector(sorted_velocity_x[first], sorted_velocity_y[first]),
+                        ids[sorted_tracks[second]],
+                        Point(sorted_x[second], sorted_y[second]),
+                        Cartesian_vector(sorted_velocity_x[second], sorted_velocity_y[second]),
+                        range_squared,
+                        hours,
+                        pairs);
+                }
+            }
+        }
+    }
+    check_candidates(range_squared, hours, pairs);
+}
+
+// Add to pairs every track that comes within range in the next hours of the
+// object id at position with velocity, in the order they were added, as a
+// pair whose id1 is id. A track that has id itself is passed over.
+void Cpa_screen::screen_track(Object_id id,
+    Point position,
+    Cartesian_vector velocity,
+    double range,
+    double hours,
+    vector<Cpa_pair>& pairs)
+{
+    double range_squared = range * range;
+    bool moving = velocity.delta_x != 0. || velocity.delta_y != 0.;
+    num_candidates = 0;
+    for (int track = 0; track < get_num_tracks(); ++track) {
+        if (ids[track] == id || (!moving && !is_moving(track)))
+            continue;
+        add_candidate(id,
+            position,
+            velocity,
+            ids[track],
+            Point(x[track], y[track]),
+            Cartesian_vector(velocity_x[track], velocity_y[track]),
+            range_squared,
+            hours,
+            pairs);
+    }
+    check_candidates(range_squared, hours, pairs);
+}
+
+/*** Helper Functions ***/
+
+// Sort the tracks, compute their boxes, and fill the grid with them
+void Cpa_screen::build_grid(double range, double hours)
+{
+    int num_tracks = get_num_tracks();
+    // a little more than half the range, so that rounding cannot lose a pair
+    double margin = range / 2. * (1. + 1e-9) + 1e-9;
+
+    // The low corner of the box of the track added at index
+    auto get_box_min = [&](int index) {
+        return Point(min(x[index], x[index] + velocity_x[index] * hours) - margin,
+            min(y[index], y[index] + velocity_y[index] * hours) - margin);
+    };
+
+    grid_x = grid_y = numeric_limits<double>::max();
+    double grid_max_x = numeric_limits<double>::lowest();
+    double grid_max_y = numeric_limits<double>::lowest();
+    double total_extent = 0.;
+    for (int index = 0; index < num_tracks; ++index) {
+        double travel_x = velocity_x[index] * hours;
+        double travel_y = velocity_y[index] * hours;
+        Point box_min = get_box_min(index);
+        double box_max_x_ = max(x[index], x[index] + travel_x) + margin;
+        double box_max_y_ = max(y[index], y[index] + travel_y) + margin;
+        total_extent += max(box_max_x_ - box_min.x, box_max_y_ - box_min.y);
+        grid_x = min(grid_x, box_min.x);
+        grid_y = min(grid_y, box_min.y);
+        grid_max_x = max(grid_max_x, box_max_x_);
+        grid_max_y = max(grid_max_y, box_max_y_);
+    }
+
+    // Cells about the size of an average box, but no more than about twice as
+    // many cells as tracks, and no more than that in a row or column either
+    double width = grid_max_x - grid_x;
+    double height = grid_max_y - grid_y;
+    double cell_size = max({total_extent / num_tracks,
+        sqrt(width * height / (2. * num_tracks)),
+        max(width, height) / (2. * num_tracks)});
+    cell_scale = 1. / cell_size;
+    num_cells_x = static_cast<int>(width * cell_scale) + 1;
+    num_cells_y = static_cast<int>(height * cell_scale) + 1;
+    int num_cells = num_cells_x * num_cells_y;
+
+    // Sort the tracks by the cell their box starts in, counting them by cell first
+    cell_starts.assign(num_cells + 1, 0);
+    cell_next.resize(num_tracks);
+    for (int index = 0; index < num_tracks; ++index) {
+        Point box_min = get_box_min(index);
+        cell_next[index] = to_cell_y(box_min.y) * num_cells_x + to_cell_x(box_min.x);
+        ++cell_starts[cell_next[index] + 1];
+    }
+    partial_sum(cell_starts.begin(), cell_starts.end(), cell_starts.begin());
+    sorted_tracks.resize(num_tracks);
+    for (int index = 0; index < num_tracks; ++index)
+        sorted_tracks[cell_starts[cell_next[index]]++] = index;
+
+    sorted_x.resize(num_tracks);
+    sorted_y.resize(num_tracks);
+    sorted_velocity_x.resize(num_tracks);
+    sorted_velocity_y.resize(num_tracks);
+    box_min_x.resize(num_tracks);
+    box_min_y.resize(num_tracks);
+    box_max_x.resize(num_tracks);
+    box_max_y.resize(num_tracks);
+    for (int track = 0; track < num_tracks; ++track) {
+        int index = sorted_tracks[track];
+        sorted_x[track] = x[index];
+        sorted_y[track] = y[index];
+        sorted_velocity_x[track] = velocity_x[index];
+        sorted_velocity_y[track] = velocity_y[index];
+        double end_x = x[index] + velocity_x[index] * hours;
+        double end_y = y[index] + velocity_y[index] * hours;
+        box_min_x[track] = min(x[index], end_x) - margin;
+        box_min_y[track] = min(y[index], end_y) - margin;
+        box_max_x[track] = max(x[index], end_x) + margin;
+        box_max_y[track] = max(y[index], end_y) + margin;
+    }
+
+    // Count the tracks in each cell, then set where each cell's tracks start
+    cell_starts.assign(num_cells + 1, 0);
+    cell_num_moving.assign(num_cells, 0);
+    for (int track = 0; track < num_tracks; ++track) {
+        bool moving = sorted_velocity_x[track] != 0. || sorted_velocity_y[track] != 0.;
+        int last_x = to_cell_x(box_max_x[track]);
+        int last_y = to_cell_y(box_max_y[track]);
+        for (int cell_y = to_cell_y(box_min_y[track]); cell_y <= last_y; ++cell_y) {
+            for (int cell_x = to_cell_x(box_min_x[track]); cell_x <= last_x; ++cell_x) {
+                int cell = cell_y * num_cells_x + cell_x;
+                ++cell_starts[cell + 1];
+                if (moving)
+                    ++cell_num_moving[cell];
+            }
+        }
+    }
+    partial_sum(cell_starts.begin(), cell_starts.end(), cell_starts.begin());
+
+    // Put the moving tracks in first, then the others after them
+    cell_tracks.resize(cell_starts[num_cells]);
+    cell_next.assign(cell_starts.begin(), cell_starts.end() - 1);
+    for (bool moving : {true, false}) {
+        for (int track = 0; track < num_tracks; ++track) {
+            if ((sorted_velocity_x[track] != 0. || sorted_velocity_y[track] != 0.) != moving)
+                continue;
+            int last_x = to_cell_x(box_max_x[track]);
+            int last_y = to_cell_y(box_max_y[track]);
+            for (int cell_y = to_cell_y(box_min_y[track]); cell_y <= last_y; ++cell_y)
+                for (int cell_x = to_cell_x(box_min_x[track]); cell_x <= last_x; ++cell_x)
+                    cell_tracks[cell_next[cell_y * num_cells_x + cell_x]++] = track;
+        }
+    }
+}
+
+// Return the column or row of the grid that holds a coordinate of a box
+int Cpa_screen::to_cell_x(double coordinate) const
+{
+    return min(static_cast<int>((coordinate - grid_x) * cell_scale), num_cells_x - 1);
+}
+
+int Cpa_screen::to_cell_y(double coordinate) const
+{
+    return min(static_cast<int>((coordinate - grid_y) * cell_scale), num_cells_y - 1);
+}
+
+// Add the pair of a track at position1 with velocity1 and one at position2
+// with velocity2 to the batch, and check the batch if it is full
+void Cpa_screen::add_candidate(Object_id id1,
+    Point position1,
+    Cartesian_vector velocity1,
+    Object_id id2,
+    Point position2,
+    Cartesian_vector velocity2,
+    double range_squared,
+    double hours,
+    vector<Cpa_pair>& pairs)
+{
+    candidate_id1[num_candidates] = id1;
+    candidate_id2[num_candidates] = id2;
+    candidate_dx[num_candidates] = position2.x - position1.x;
+    candidate_dy[num_candidates] = position2.y - position1.y;
+    candidate_dvx[num_candidates] = velocity2.delta_x - velocity1.delta_x;
+    candidate_dvy[num_candidates] = velocity2.delta_y - velocity1.delta_y;
+    if (++num_candidates == batch_size)
+        check_candidates(range_squared, hours, pairs);
+}
+
+// Run the narrow phase on the batch, add the pairs that come within range to pairs, and empty it
+void Cpa_screen::check_candidates(double range_squared, double hours, vector<Cpa_pair>& pairs)
+{
+    closest_approaches(candidate_dx.data(),
+        candidate_dy.data(),
+        candidate_dvx.data(),
+        candidate_dvy.data(),
+        hours,
+        candidate_time.data(),
+        candidate_range_squared.data(),
+        size_t(num_candidates));
+    for (int i = 0; i < num_candidates; ++i) {
+        if (candidate_range_squared[i] < range_squared) {
+            pairs.push_back(Cpa_pair{
+                candidate_id1[i], candidate_id2[i], candidate_time[i], sqrt(candidate_range_squared[i])});
+        }
+    }
+    num_candidates = 0;
+}
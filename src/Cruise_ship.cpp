@@ -1,22 +1,28 @@
 #include "Cruise_ship.h"
+#include "Checkpoint.h"
 #include "Island.h"
+#include "Logger.h"
 #include "Model.h"
+#include "Profiler.h"
 #include "Utility.h"
+#include <algorithm>
 #include <iostream>
-#include <limits>
+#include <vector>
 
 using namespace std;
 
-Cruise_ship::Cruise_ship(const string& name_, Point position_)
-    : Ship(name_, position_, 500, 15.0, 2.0, 0)
-    , visited_vec(Model::get_instance().get_island_map().size(), false)
+Cruise_ship::Cruise_ship(Model& model_, const string& name_, Point position_)
+    : Ship(model_, name_, position_, 500, 15.0, 2.0, 0)
+    , itinerary_start(0)
     , state(Cruise_ship_state::not_cruising)
     , island_visited(0)
+    , starting_speed(0.)
 { }
 
 // Update the state of Cruise_ship
 void Cruise_ship::update()
 {
+    PROFILE_SCOPE(Profile_section::update_cruise_ship);
     Ship::update();
 
     switch (state) {
@@ -26,13 +32,15 @@ void Cruise_ship::update()
 
         // If Cruise_ship has just set a destination island for cruising and
         // can dock there, dock there.
-    case Cruise_ship_state::set_cruise:
-        if (can_dock(island_to_visit)) {
-            dock(island_to_visit);
+    case Cruise_ship_state::set_cruise: {
+        shared_ptr<Island> island_ptr = get_model().get_island_ptr(island_to_visit);
+        if (can_dock(island_ptr)) {
+            dock(island_ptr);
             ++island_visited;
             state = Cruise_ship_state::just_docked;
         }
         break;
+    }
 
         // If Cruise_ship has just docked, refuel.
     case Cruise_ship_state::just_docked:
@@ -48,52 +56,24 @@ void Cruise_ship::update()
     case Cruise_ship_state::waiting: {
         // When Cruise_ship has visited all of the islands,
         // go back to the starting Island.
-        if (island_visited == (int)Model::get_instance().get_island_map().size()) {
+        int num_stops = static_cast<int>(itinerary->size());
+        if (island_visited >= num_stops) {
             Ship::set_destination_island_and_speed(starting_island, starting_speed);
 
-            cout << get_name() << " will visit " << starting_island->get_name() << endl;
+            LOG(Log_level::info, Log_category::movement) << get_name() << " will visit " << starting_island->get_name();
 
-            island_to_visit = starting_island;
+            island_to_visit = get_model().get_handle(*starting_island);
             state = Cruise_ship_state::going_back;
             return;
         }
 
-        map<string, shared_ptr<Island>> island_temp_map = Model::get_instance().get_island_map();
-        double lowest_distance = numeric_limits<double>::max();
-
-        // island_index indicates which index in visited_vec
-        // corresponds to the Island.
-        int island_index;
-        int i = 0;
-
-        // Loop for finding an island closest to the current location.
-        for (const auto& island : island_temp_map) {
-            // If the Island has been visited already, skip rest of the for loop.
-            if (visited_vec[i]) {
-                ++i;
-                continue;
-            }
-
-            double distance_from_island = cartesian_distance(get_location(), island.second->get_location());
-
-            // If the new distance is lower than the current lowest distance,
-            // set the new distance as the lowest distance and remember
-            // the index of the island in the visited_vec
-            if (distance_from_island < lowest_distance) {
-                island_to_visit = island.second;
-                lowest_distance = distance_from_island;
-                island_index = i;
-            }
-            ++i;
-        }
-
-        // Mark the Island as visited and set destination
-        // to the Island.
-        visited_vec[island_index] = true;
-        Ship::set_destination_island_and_speed(island_to_visit, starting_speed);
+        // Go on to the next Island of the itinerary.
+        island_to_visit = (*itinerary)[(itinerary_start + island_visited) % num_stops];
+        shared_ptr<Island> island_ptr = get_model().get_island_ptr(island_to_visit);
+        Ship::set_destination_island_and_speed(island_ptr, starting_speed);
         state = Cruise_ship_state::set_cruise;
 
-        cout << get_name() << " will visit " << island_to_visit->get_name() << endl;
+        LOG(Log_level::info, Log_category::movement) << get_name() << " will visit " << island_ptr->get_name();
         break;
     }
 
@@ -103,13 +83,46 @@ void Cruise_ship::update()
     case Cruise_ship_state::going_back:
         if (can_dock(starting_island)) {
             dock(starting_island);
-            cout << get_name() << " cruise is over at " << starting_island->get_name() << endl;
+            LOG(Log_level::info, Log_category::movement) << get_name() << " cruise is over at "
+                                                         << starting_island->get_name();
             state = Cruise_ship_state::not_cruising;
+            get_model().record_cruise_finished();
         }
         break;
     }
 }
 
+// A Cruise_ship that is docking, refueling, or choosing its next Island
+// must be updated; otherwise it can be advanced like any Ship.
+int Cruise_ship::ticks_until_event() const
+{
+    switch (state) {
+    case Cruise_ship_state::not_cruising:
+        return Ship::ticks_until_event();
+    case Cruise_ship_state::set_cruise:
+    case Cruise_ship_state::going_back:
+        return is_moving() ? Ship::ticks_until_event() : 0;
+    default:
+        return 0;
+    }
+}
+
+Event_type Cruise_ship::get_event_type() const
+{
+    switch (state) {
+    case Cruise_ship_state::not_cruising:
+        return Ship::get_event_type();
+    case Cruise_ship_state::set_cruise:
+    case Cruise_ship_state::going_back:
+        return is_moving() ? Ship::get_event_type() : Event_type::dock_complete;
+    case Cruise_ship_state::just_docked:
+    case Cruise_ship_state::refuel:
+        return Event_type::refuel_complete;
+    default:
+        return Event_type::state_change;
+    }
+}
+
 // Output a description of current state to cout
 void Cruise_ship::describe() const
 {
@@ -121,18 +134,71 @@ void Cruise_ship::describe() const
         break;
     case Cruise_ship_state::set_cruise:
     case Cruise_ship_state::going_back:
-        cout << "On cruise to " << island_to_visit->get_name() << endl;
+        cout << "On cruise to " << get_model().get_name(island_to_visit.id) << endl;
         break;
     case Cruise_ship_state::just_docked:
     case Cruise_ship_state::refuel:
     case Cruise_ship_state::waiting:
-        cout << "Waiting during cruise at " << island_to_visit->get_name() << endl;
+        cout << "Waiting during cruise at " << get_model().get_name(island_to_visit.id) << endl;
         break;
     default:
         throw Error("Unrecognized state!");
     }
 }
 
+// Add this Cruise_ship's record to a checkpoint
+void Cruise_ship::save(Checkpoint_writer& writer) const
+{
+    Cruise_ship_record record{};
+    record.ship = make_ship_record(writer);
+    record.starting_speed = starting_speed;
+    record.island_to_visit = writer.get_island_id(get_model().resolve_island(island_to_visit));
+    record.starting_island = writer.get_island_id(starting_island.get());
+    record.island_visited = island_visited;
+
+    // the cruises that share an itinerary share its links
+    if (itinerary) {
+        record.first_itinerary_island = writer.add_shared_links(itinerary.get(), [this, &writer] {
+            vector<uint32_t> island_ids;
+            island_ids.reserve(itinerary->size());
+            for (Object_handle island : *itinerary)
+                island_ids.push_back(writer.get_id(get_model().get_name(island.id)));
+            return island_ids;
+        });
+        record.num_itinerary_islands = static_cast<uint32_t>(itinerary->size());
+    }
+
+    record.cruise_state = static_cast<uint8_t>(state);
+    writer.cruise_ships.push_back(record);
+}
+
+// Set this Cruise_ship's cruise from a checkpoint record
+// Throws Error if the record is not valid.
+void Cruise_ship::restore(const Cruise_ship_record& record, const Checkpoint_reader& reader)
+{
+    if (record.cruise_state > static_cast<uint8_t>(Cruise_ship_state::going_back))
+        throw Error("Checkpoint file is damaged!");
+
+    restore_ship_record(record.ship, reader);
+    starting_speed = record.starting_speed;
+    island_to_visit = reader.get_island_handle(record.island_to_visit);
+    starting_island = reader.get_island(record.starting_island);
+    island_visited = record.island_visited;
+    state = static_cast<Cruise_ship_state>(record.cruise_state);
+    if (state == Cruise_ship_state::not_cruising)
+        return;
+
+    // every state but not_cruising describes the Island to visit, and has an
+    // itinerary that starts somewhere and has not been gone round more than once
+    if (island_to_visit.id == no_object_id || !starting_island || record.num_itinerary_islands == 0)
+        throw Error("Checkpoint file is damaged!");
+    itinerary = reader.get_link_island_handles(record.first_itinerary_island, record.num_itinerary_islands);
+    auto start = find(itinerary->begin(), itinerary->end(), get_model().get_handle(*starting_island));
+    if (start == itinerary->end() || island_visited < 0 || island_visited > static_cast<int>(itinerary->size()))
+        throw Error("Checkpoint file is damaged!");
+    itinerary_start = static_cast<int>(start - itinerary->begin());
+}
+
 // When Cruise_ship is cruising, cancel it.
 void Cruise_ship::set_destination_position_and_speed(Point destination_point, double speed)
 {
@@ -154,30 +220,24 @@ void Cruise_ship::set_destination_island_and_speed(shared_ptr<Island> destinatio
 
     Ship::set_destination_island_and_speed(destination_island, speed);
 
-    cout << get_name() << " will visit " << destination_island->get_name() << endl;
+    LOG(Log_level::info, Log_category::movement) << get_name() << " will visit " << destination_island->get_name();
 
-    cout << get_name() << " cruise will start and end at " << destination_island->get_name() << endl;
+    LOG(Log_level::info, Log_category::movement) << get_name() << " cruise will start and end at "
+                                                 << destination_island->get_name();
 
     // If Cruise_ship was initially cruising, do nothing further.
     if (initially_cruising)
         return;
 
     state = Cruise_ship_state::set_cruise;
-    island_to_visit = destination_island;
+    island_to_visit = get_model().get_handle(*destination_island);
     starting_island = destination_island;
     starting_speed = speed;
 
-    int counter = 0;
-    map<string, shared_ptr<Island>> island_temp_map = Model::get_instance().get_island_map();
-
-    // Find and mark Island as visited
-    for (const auto& island : island_temp_map) {
-        if (island.second == destination_island) {
-            visited_vec[counter] = true;
-            break;
-        }
-        ++counter;
-    }
+    // Go round the Model's Island tour from the starting Island
+    itinerary = get_model().get_island_tour();
+    auto start = find(itinerary->begin(), itinerary->end(), island_to_visit);
+    itinerary_start = static_cast<int>(start - itinerary->begin());
 }
 
 // Cancel cruise if Cruise_ship was cruising
@@ -196,12 +256,25 @@ void Cruise_ship::stop()
     Ship::stop();
 }
 
+// A cruising Cruise_ship cancels its cruise even if it then refuses the
+// command, so it is never known in advance to refuse.
+const char* Cruise_ship::check_move(double speed) const
+{
+    return state != Cruise_ship_state::not_cruising ? nullptr : Ship::check_move(speed);
+}
+
+const char* Cruise_ship::check_stop() const
+{
+    return state != Cruise_ship_state::not_cruising ? nullptr : Ship::check_stop();
+}
+
 // Helper function for canceling cruise, resetting variables
 // used for cruising, and printing a message.
 void Cruise_ship::cancel_cruise_and_print()
 {
     island_visited = 0;
     state = Cruise_ship_state::not_cruising;
-    visited_vec = vector<bool>(Model::get_instance().get_island_map().size(), false);
-    cout << get_name() << " canceling current cruise" << endl;
+    itinerary.reset();
+    itinerary_start = 0;
+    LOG(Log_level::info, Log_category::movement) << get_name() << " canceling current cruise";
 }
\ No newline at end of file
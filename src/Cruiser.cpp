@@ -1,21 +1,25 @@
 #include "Cruiser.h"
+#include "Checkpoint.h"
+#include "Logger.h"
+#include "Profiler.h"
 #include <iostream>
 
 using namespace std;
 
 /* Public Function Definitions */
 
-Cruiser::Cruiser(const string& name_, Point position_)
-    : Warship(name_, position_, 3, 15.0, 1000, 20, 10, 6)
+Cruiser::Cruiser(Model& model_, const string& name_, Point position_)
+    : Warship(model_, name_, position_, 3, 15.0, 1000, 20, 10, 6)
 { }
 
 // perform Cruiser-specific behavior
 void Cruiser::update()
 {
+    PROFILE_SCOPE(Profile_section::update_cruiser);
     Warship::update();
 
     if (target_out_of_range()) {
-        cout << get_name() << " target is out of range" << endl;
+        LOG(Log_level::info, Log_category::combat) << get_name() << " target is out of range";
         stop_attack();
     }
 }
@@ -38,4 +42,9 @@ void Cruiser::receive_hit(int hit_force, shared_ptr<Ship> attacker_ptr)
     // Counter attack if Cruiser is not attacking.
     if (!is_attacking())
         attack(attacker_ptr);
-}
\ No newline at end of file
+}
+// Add this Cruiser's record to a checkpoint
+void Cruiser::save(Checkpoint_writer& writer) const
+{
+    writer.cruisers.push_back(make_warship_record(writer));
+}
@@ -0,0 +1,75 @@
+#include "Event_queue.h"
+
+using namespace std;
+
+Event_queue::Event_queue()
+    : next_sequence(0)
+{ }
+
+// Give the object an event of this type at time, replacing any it had
+void Event_queue::schedule(Object_id id, int time, Event_type type)
+{
+    if (size_t(id) >= scheduled.size())
+        scheduled.resize(id + 1, Scheduled{0, Event_type::state_change, 0, false});
+    Scheduled& entry = scheduled[id];
+    entry.time = time;
+    entry.type = type;
+    ++entry.generation;
+    entry.active = true;
+    heap.push(Entry{time, next_sequence++, id, entry.generation});
+}
+
+// Drop the object's event, if it has one
+void Event_queue::cancel(Object_id id)
+{
+    if (size_t(id) >= scheduled.size())
+        return;
+    ++scheduled[id].generation;
+    scheduled[id].active = false;
+}
+
+// Drop every event
+void Event_queue::clear()
+{
+    scheduled.clear();
+    heap = decltype(heap)();
+}
+
+// Return the time of the earliest event, or Sim_object::no_event if there is none
+int Event_queue::get_next_time()
+{
+    while (!heap.empty()) {
+        const Entry& top = heap.top();
+        const Scheduled& entry = scheduled[top.id];
+        if (entry.active && entry.generation == top.generation)
+            return top.time;
+        heap.pop();
+    }
+    return Sim_object::no_event;
+}
+
+// Return true if the object has an event at or before time
+bool Event_queue::is_due(Object_id id, int time) const
+{
+    return size_t(id) < scheduled.size() && scheduled[id].active && scheduled[id].time <= time;
+}
+
+// Return the name of an event type, e.g. "arrive_at"
+const char* get_event_type_name(Event_type type)
+{
+    switch (type) {
+    case Event_type::arrive_at:
+        return "arrive_at";
+    case Event_type::fuel_empty:
+        return "fuel_empty";
+    case Event_type::dock_complete:
+        return "dock_complete";
+    case Event_type::refuel_complete:
+        return "refuel_complete";
+    case Event_type::target_in_range:
+        return "target_in_range";
+    case Event_type::state_change:
+        return "state_change";
+    }
+    return "unknown";
+}
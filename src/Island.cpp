@@ -1,11 +1,14 @@
 #include "Island.h"
+#include "Checkpoint.h"
+#include "Logger.h"
 #include "Model.h"
+#include "Profiler.h"
 #include <iostream>
 
 using namespace std;
 
-Island::Island(const string& name_, Point position_, double fuel_, double production_rate_)
-    : Sim_object(name_)
+Island::Island(Model& model_, const string& name_, Point position_, double fuel_, double production_rate_)
+    : Sim_object(model_, name_)
     , position(position_)
     , fuel(fuel_)
     , production_rate(production_rate_)
@@ -15,9 +18,20 @@ Island::Island(const string& name_, Point position_, double fuel_, double produc
 // and add to amount, and print an update message
 void Island::update()
 {
+    PROFILE_SCOPE(Profile_section::update_island);
     if (production_rate > 0) {
         fuel += production_rate;
-        cout << "Island " << get_name() << " now has " << fuel << " tons" << endl;
+        LOG(Log_level::info, Log_category::fuel) << "Island " << get_name() << " now has " << fuel << " tons";
+    }
+}
+
+// add ticks updates' worth of production, without the update messages,
+// one update at a time so that the sum is rounded as the updates would round it
+void Island::advance(int ticks)
+{
+    if (production_rate > 0) {
+        for (int tick = 0; tick < ticks; ++tick)
+            fuel += production_rate;
     }
 }
 
@@ -31,7 +45,19 @@ void Island::describe() const
 // ask model to notify views of current state
 void Island::broadcast_current_state() const
 {
-    Model::get_instance().notify_location(get_name(), get_location());
+    get_model().notify_location(get_id(), get_location());
+}
+
+// add the position, fuel, and production rate to a checkpoint
+void Island::save(Checkpoint_writer& writer) const
+{
+    Island_record record{};
+    record.x = position.x;
+    record.y = position.y;
+    record.fuel = fuel;
+    record.production_rate = production_rate;
+    record.name = writer.get_id(get_name());
+    writer.islands.push_back(record);
 }
 
 // Return whichever is less, the request or the amount left,
@@ -46,7 +72,7 @@ double Island::provide_fuel(double request)
         supplied = request;
         fuel -= request;
     }
-    cout << "Island " << get_name() << " supplied " << supplied << " tons of fuel" << endl;
+    LOG(Log_level::info, Log_category::fuel) << "Island " << get_name() << " supplied " << supplied << " tons of fuel";
     return supplied;
 }
 
@@ -55,5 +81,5 @@ double Island::provide_fuel(double request)
 void Island::accept_fuel(double amount)
 {
     fuel += amount;
-    cout << "Island " << get_name() << " now has " << fuel << " tons" << endl;
+    LOG(Log_level::info, Log_category::fuel) << "Island " << get_name() << " now has " << fuel << " tons";
 }
\ No newline at end of file
@@ -0,0 +1,227 @@
+#include "Kinematics.h"
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+    #define KINEMATICS_AVX2
+    #include <immintrin.h>
+#elif defined(__aarch64__)
+    #define KINEMATICS_NEON
+    #include <arm_neon.h>
+#endif
+
+using namespace std;
+
+// The same computation without vector instructions, for comparison
+void advance_positions_scalar(double* x,
+    double* y,
+    const double* heading_x,
+    const double* heading_y,
+    const double* speed,
+    const double* time,
+    size_t count)
+{
+    for (size_t i = 0; i < count; ++i) {
+        double distance = speed[i] * time[i];
+        x[i] = x[i] + distance * heading_x[i];
+        y[i] = y[i] + distance * heading_y[i];
+    }
+}
+
+// The same computation without vector instructions, for comparison.
+// The time is -(d . dv) / (dv . dv), or 0 if the tracks are not moving apart
+// at all, limited to [0, horizon]; the comparisons are written the way the
+// vector instructions make them, so that a time of -0 also becomes 0.
+void closest_approaches_scalar(const double* dx,
+    const double* dy,
+    const double* dvx,
+    const double* dvy,
+    double horizon,
+    double* time,
+    double* range_squared,
+    size_t count)
+{
+    for (size_t i = 0; i < count; ++i) {
+        double speed_squared = dvx[i] * dvx[i] + dvy[i] * dvy[i];
+        double t = speed_squared > 0. ? -(dx[i] * dvx[i] + dy[i] * dvy[i]) / speed_squared : 0.;
+        t = t > 0. ? t : 0.;
+        t = t < horizon ? t : horizon;
+        double cpa_x = dx[i] + dvx[i] * t;
+        double cpa_y = dy[i] + dvy[i] * t;
+        time[i] = t;
+        range_squared[i] = cpa_x * cpa_x + cpa_y * cpa_y;
+    }
+}
+
+#ifdef KINEMATICS_AVX2
+
+// Four tracks per step; only compiled for AVX2, so it must not be called
+// unless the processor supports it.
+__attribute__((target("avx2"))) static void advance_positions_avx2(double* x,
+    double* y,
+    const double* heading_x,
+    const double* heading_y,
+    const double* speed,
+    const double* time,
+    size_t count)
+{
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m256d distance = _mm256_mul_pd(_mm256_loadu_pd(speed + i), _mm256_loadu_pd(time + i));
+        __m256d dx = _mm256_mul_pd(distance, _mm256_loadu_pd(heading_x + i));
+        __m256d dy = _mm256_mul_pd(distance, _mm256_loadu_pd(heading_y + i));
+        _mm256_storeu_pd(x + i, _mm256_add_pd(_mm256_loadu_pd(x + i), dx));
+        _mm256_storeu_pd(y + i, _mm256_add_pd(_mm256_loadu_pd(y + i), dy));
+    }
+    advance_positions_scalar(x + i, y + i, heading_x + i, heading_y + i, speed + i, time + i, count - i);
+}
+
+__attribute__((target("avx2"))) static void closest_approaches_avx2(const double* dx,
+    const double* dy,
+    const double* dvx,
+    const double* dvy,
+    double horizon,
+    double* time,
+    double* range_squared,
+    size_t count)
+{
+    const __m256d zero = _mm256_setzero_pd();
+    const __m256d sign = _mm256_set1_pd(-0.);
+    const __m256d limit = _mm256_set1_pd(horizon);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m256d delta_x = _mm256_loadu_pd(dx + i);
+        __m256d delta_y = _mm256_loadu_pd(dy + i);
+        __m256d velocity_x = _mm256_loadu_pd(dvx + i);
+        __m256d velocity_y = _mm256_loadu_pd(dvy + i);
+        __m256d speed_squared
+            = _mm256_add_pd(_mm256_mul_pd(velocity_x, velocity_x), _mm256_mul_pd(velocity_y, velocity_y));
+        __m256d dot = _mm256_add_pd(_mm256_mul_pd(delta_x, velocity_x), _mm256_mul_pd(delta_y, velocity_y));
+        __m256d t = _mm256_div_pd(_mm256_xor_pd(dot, sign), speed_squared);
+        t = _mm256_and_pd(t, _mm256_cmp_pd(speed_squared, zero, _CMP_GT_OQ));
+        t = _mm256_min_pd(_mm256_max_pd(t, zero), limit);
+        __m256d cpa_x = _mm256_add_pd(delta_x, _mm256_mul_pd(velocity_x, t));
+        __m256d cpa_y = _mm256_add_pd(delta_y, _mm256_mul_pd(velocity_y, t));
+        _mm256_storeu_pd(time + i, t);
+        _mm256_storeu_pd(range_squared + i, _mm256_add_pd(_mm256_mul_pd(cpa_x, cpa_x), _mm256_mul_pd(cpa_y, cpa_y)));
+    }
+    closest_approaches_scalar(dx + i, dy + i, dvx + i, dvy + i, horizon, time + i, range_squared + i, count - i);
+}
+
+#endif
+
+#ifdef KINEMATICS_NEON
+
+// Two tracks per step
+static void advance_positions_neon(double* x,
+    double* y,
+    const double* heading_x,
+    const double* heading_y,
+    const double* speed,
+    const double* time,
+    size_t count)
+{
+    size_t i = 0;
+    for (; i + 2 <= count; i += 2) {
+        float64x2_t distance = vmulq_f64(vld1q_f64(speed + i), vld1q_f64(time + i));
+        float64x2_t dx = vmulq_f64(distance, vld1q_f64(heading_x + i));
+        float64x2_t dy = vmulq_f64(distance, vld1q_f64(heading_y + i));
+        vst1q_f64(x + i, vaddq_f64(vld1q_f64(x + i), dx));
+        vst1q_f64(y + i, vaddq_f64(vld1q_f64(y + i), dy));
+    }
+    advance_positions_scalar(x + i, y + i, heading_x + i, heading_y + i, speed + i, time + i, count - i);
+}
+
+// Two pairs per step; the limits are applied with selects rather than
+// vmaxq/vminq, which would not turn -0 into 0 as the other versions do
+static void closest_approaches_neon(const double* dx,
+    const double* dy,
+    const double* dvx,
+    const double* dvy,
+    double horizon,
+    double* time,
+    double* range_squared,
+    size_t count)
+{
+    const float64x2_t zero = vdupq_n_f64(0.);
+    const float64x2_t limit = vdupq_n_f64(horizon);
+    size_t i = 0;
+    for (; i + 2 <= count; i += 2) {
+        float64x2_t delta_x = vld1q_f64(dx + i);
+        float64x2_t delta_y = vld1q_f64(dy + i);
+        float64x2_t velocity_x = vld1q_f64(dvx + i);
+        float64x2_t velocity_y = vld1q_f64(dvy + i);
+        float64x2_t speed_squared = vaddq_f64(vmulq_f64(velocity_x, velocity_x), vmulq_f64(velocity_y, velocity_y));
+        float64x2_t dot = vaddq_f64(vmulq_f64(delta_x, velocity_x), vmulq_f64(delta_y, velocity_y));
+        float64x2_t t = vdivq_f64(vnegq_f64(dot), speed_squared);
+        t = vbslq_f64(vcgtq_f64(speed_squared, zero), t, zero);
+        t = vbslq_f64(vcgtq_f64(t, zero), t, zero);
+        t = vbslq_f64(vcltq_f64(t, limit), t, limit);
+        float64x2_t cpa_x = vaddq_f64(delta_x, vmulq_f64(velocity_x, t));
+        float64x2_t cpa_y = vaddq_f64(delta_y, vmulq_f64(velocity_y, t));
+        vst1q_f64(time + i, t);
+        vst1q_f64(range_squared + i, vaddq_f64(vmulq_f64(cpa_x, cpa_x), vmulq_f64(cpa_y, cpa_y)));
+    }
+    closest_approaches_scalar(dx + i, dy + i, dvx + i, dvy + i, horizon, time + i, range_squared + i, count - i);
+}
+
+#endif
+
+// For i in [0, count): move (x[i], y[i]) along the unit heading
+// (heading_x[i], heading_y[i]) at speed[i] for time[i].
+void advance_positions(double* x,
+    double* y,
+    const double* heading_x,
+    const double* heading_y,
+    const double* speed,
+    const double* time,
+    size_t count)
+{
+#if defined(KINEMATICS_AVX2)
+    static const bool has_avx2 = __builtin_cpu_supports("avx2");
+    if (has_avx2) {
+        advance_positions_avx2(x, y, heading_x, heading_y, speed, time, count);
+        return;
+    }
+#elif defined(KINEMATICS_NEON)
+    advance_positions_neon(x, y, heading_x, heading_y, speed, time, count);
+    return;
+#endif
+    advance_positions_scalar(x, y, heading_x, heading_y, speed, time, count);
+}
+
+// The vector instructions that advance_positions and closest_approaches use on
+// this processor: "AVX2", "NEON", or "none" if they run the scalar versions
+const char* get_kinematics_vector_instructions()
+{
+#if defined(KINEMATICS_AVX2)
+    return __builtin_cpu_supports("avx2") ? "AVX2" : "none";
+#elif defined(KINEMATICS_NEON)
+    return "NEON";
+#else
+    return "none";
+#endif
+}
+
+// For i in [0, count): two tracks are (dx[i], dy[i]) apart and moving apart at
+// (dvx[i], dvy[i]) nm per hour. Put the time in [0, horizon] at which they are
+// closest in time[i], and the square of their distance then in range_squared[i].
+void closest_approaches(const double* dx,
+    const double* dy,
+    const double* dvx,
+    const double* dvy,
+    double horizon,
+    double* time,
+    double* range_squared,
+    size_t count)
+{
+#if defined(KINEMATICS_AVX2)
+    static const bool has_avx2 = __builtin_cpu_supports("avx2");
+    if (has_avx2) {
+        closest_approaches_avx2(dx, dy, dvx, dvy, horizon, time, range_squared, count);
+        return;
+    }
+#elif defined(KINEMATICS_NEON)
+    closest_approaches_neon(dx, dy, dvx, dvy, horizon, time, range_squared, count);
+    return;
+#endif
+    closest_approaches_scalar(dx, dy, dvx, dvy, horizon, time, range_squared, count);
+}
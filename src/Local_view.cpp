@@ -2,84 +2,93 @@
 #include "Utility.h"
 #include <iostream>
 #include <iomanip>
+#include <sstream>
+#include <string_view>
 
 using namespace std;
 
-Local_view::Local_view(const string& ship_name_)
+Local_view::Local_view(const string& ship_name_, int ship_id_)
     : Twod_view(9, 2.0, Point(0, 0))
     , sunk(false)
     , ship_name(ship_name_)
+    , ship_id(ship_id_)
 { }
 
-// Change origin of the Local_view when name matches Local_view's ship name.
-void Local_view::update_location(const string& name, Point location)
+// Apply the changes, moving the origin with the Local_view's Ship,
+// and marking it as sunk when it is gone.
+void Local_view::apply_changes(const View_change* changes, size_t num_changes, const vector<string>& names)
 {
-    View::update_location(name, location);
+    Twod_view::apply_changes(changes, num_changes, names);
 
-    if (ship_name == name && !sunk) {
-        ship_location = location;
-        Twod_view::set_origin(
-            Point(location.x - (get_size() / 2.0) * get_scale(), location.y - (get_size() / 2.0) * get_scale()));
+    for (size_t i = 0; i < num_changes; ++i) {
+        const View_change& change = changes[i];
+        if (change.id != ship_id)
+            continue;
+
+        if ((change.dirty_mask & View_change::location_changed) && !sunk) {
+            ship_location = change.location;
+            Twod_view::set_origin(Point(ship_location.x - (get_size() / 2.0) * get_scale(),
+                ship_location.y - (get_size() / 2.0) * get_scale()));
+        }
+        if (change.dirty_mask & View_change::gone)
+            sunk = true;
     }
 }
 
-// If name matches the Local_view's Ship's name,
-// mark it as sunk.
-void Local_view::update_remove(const string& name)
+// Print local view for a Ship.
+void Local_view::draw(ostream& os)
 {
-    View::update_remove(name);
+    update_rows();
+    if (sunk)
+        os << "Local view for " << ship_name << " sunk at " << ship_location << endl;
+    else
+        os << "Local view for " << ship_name << " at position " << ship_location << endl;
 
-    if (ship_name == name)
-        sunk = true;
+    for (int i = 0; i < get_size(); ++i)
+        os << get_row_text(i) << endl;
 }
 
-// Print local view for a Ship.
-void Local_view::draw()
+// Return the text of a row of the local view
+string Local_view::render_row(int i) const
 {
-    Twod_view::draw();
-    if (sunk)
-        cout << "Local view for " << ship_name << " sunk at " << ship_location << endl;
-    else
-        cout << "Local view for " << ship_name << " at position " << ship_location << endl;
-
-    const vector<vector<string>> twod_map = get_twod_map();
-
-    for (int i = 0; i < get_size(); ++i) {
-        // printed_str_before indicates if
-        // the loop printed a string before
-        bool printed_str_before = false;
-        cout << "    ";
-        for (int j = 0; j < get_size(); ++j) {
-            // Format strings according to each case
-            if (twod_map[i][j] == ".") {
-                if (!printed_str_before)
-                    cout << setw(2);
-
-                if (j == get_size() - 1 && !printed_str_before)
-                    cout << " . ";
-                else if (j == get_size() - 1)
-                    cout << ". ";
-                else
-                    cout << ".";
-
-                printed_str_before = false;
-            } else if (twod_map[i][j] == "*") {
-                if (!printed_str_before)
-                    cout << setw(2);
-                cout << "*";
-                printed_str_before = false;
-            }
-            // Case when it is an object's name.
-            else {
-                if (!printed_str_before)
-                    cout << setw(3);
-                // Print the first two characters of the object's name.
-                cout << string(twod_map[i][j].cbegin(), twod_map[i][j].cbegin() + 2);
-                printed_str_before = true;
-            }
+    ostringstream row;
+
+    // printed_str_before indicates if
+    // the loop printed a string before
+    bool printed_str_before = false;
+    row << "    ";
+    for (int j = 0; j < get_size(); ++j) {
+        string_view cell = get_cell(i, j);
+
+        // Format strings according to each case
+        if (cell[0] == empty_cell) {
+            if (!printed_str_before)
+                row << setw(2);
+
+            if (j == get_size() - 1 && !printed_str_before)
+                row << " . ";
+            else if (j == get_size() - 1)
+                row << ". ";
+            else
+                row << ".";
+
+            printed_str_before = false;
+        } else if (cell[0] == crowded_cell) {
+            if (!printed_str_before)
+                row << setw(2);
+            row << "*";
+            printed_str_before = false;
+        }
+        // Case when it is an object's name.
+        else {
+            if (!printed_str_before)
+                row << setw(3);
+            // Print the first two characters of the object's name.
+            row << cell;
+            printed_str_before = true;
         }
-        cout << endl;
     }
+    return row.str();
 }
 
 // Throw an Error because you cannot perform these functions
@@ -0,0 +1,544 @@
+#include "Logger.h"
+#include "Geometry.h"
+#include "Navigation.h"
+#include "Utility.h"
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+using namespace std;
+
+// Argument type bytes in a record
+const char literal_tag = 'L';
+const char string_tag = 'S';
+const char int_tag = 'I';
+const char double_tag = 'D';
+const char point_tag = 'P';
+const char course_speed_tag = 'C';
+
+// In a ring, each record is its size (uint32) followed by a header and the arguments
+const size_t record_header_size
+    = sizeof(uint32_t) + sizeof(uint64_t) + sizeof(int32_t) + sizeof(Log_level) + sizeof(Log_category);
+
+// How long the writer sleeps when nobody wakes it up
+const chrono::milliseconds writer_interval(10);
+
+/*** Log_line ***/
+Log_line::Log_line(Log_level level_, Log_category category_)
+    : level(level_)
+    , category(category_)
+    , size(0)
+{ }
+
+// Hands the finished message to the Logger
+Log_line::~Log_line()
+{
+    if (overflow.empty())
+        Logger::get_instance().commit(level, category, data, size);
+    else
+        Logger::get_instance().commit(level, category, overflow.data(), overflow.size());
+}
+
+Log_line& Log_line::operator<<(const string& s)
+{
+    append_string(s.data(), s.size());
+    return *this;
+}
+
+Log_line& Log_line::operator<<(int i)
+{
+    int32_t value = i;
+    append(&int_tag, 1);
+    append(&value, sizeof(value));
+    return *this;
+}
+
+Log_line& Log_line::operator<<(double d)
+{
+    append(&double_tag, 1);
+    append(&d, sizeof(d));
+    return *this;
+}
+
+Log_line& Log_line::operator<<(const Point& p)
+{
+    append(&point_tag, 1);
+    append(&p.x, sizeof(p.x));
+    append(&p.y, sizeof(p.y));
+    return *this;
+}
+
+Log_line& Log_line::operator<<(const Course_speed& cs)
+{
+    append(&course_speed_tag, 1);
+    append(&cs.course, sizeof(cs.course));
+    append(&cs.speed, sizeof(cs.speed));
+    return *this;
+}
+
+void Log_line::append(const void* bytes, size_t count)
+{
+    if (overflow.empty() && size + count <= sizeof(data)) {
+        memcpy(data + size, bytes, count);
+        size += count;
+        return;
+    }
+    if (overflow.empty())
+        overflow.assign(data, size);
+    overflow.append(static_cast<const char*>(bytes), count);
+}
+
+void Log_line::append_literal(const char* literal)
+{
+    append(&literal_tag, 1);
+    append(&literal, sizeof(literal));
+}
+
+void Log_line::append_string(const char* s)
+{
+    append_string(s, strlen(s));
+}
+
+void Log_line::append_string(const char* s, size_t length)
+{
+    uint16_t stored_length = static_cast<uint16_t>(min(length, size_t(UINT16_MAX)));
+    append(&string_tag, 1);
+    append(&stored_length, sizeof(stored_length));
+    append(s, stored_length);
+}
+
+/*** Text_log_sink ***/
+
+// Read a value of type T from p and advance p past it
+template <typename T>
+static T read_value(const char*& p)
+{
+    T value;
+    memcpy(&value, p, sizeof(value));
+    p += sizeof(value);
+    return value;
+}
+
+void Text_log_sink::write(const Log_record& record)
+{
+    const char* p = record.args;
+    const char* end = p + record.args_size;
+    while (p < end) {
+        switch (*p++) {
+        case literal_tag:
+            os << read_value<const char*>(p);
+            break;
+        case string_tag: {
+            uint16_t length = read_value<uint16_t>(p);
+            os.write(p, length);
+            p += length;
+            break;
+        }
+        case int_tag:
+            os << read_value<int32_t>(p);
+            break;
+        case double_tag:
+            os << read_value<double>(p);
+            break;
+        case point_tag: {
+            double x = read_value<double>(p);
+            double y = read_value<double>(p);
+            os << Point(x, y);
+            break;
+        }
+        case course_speed_tag: {
+            double course = read_value<double>(p);
+            double speed = read_value<double>(p);
+            os << Course_speed(course, speed);
+            break;
+        }
+        default:
+            return;
+        }
+    }
+    os << '\n';
+}
+
+void Text_log_sink::flush()
+{
+    os.flush();
+}
+
+/*** Binary_log_sink ***/
+
+// Append a value of type T to the buffer
+template <typename T>
+static void write_value(string& buffer, T value)
+{
+    buffer.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+// Throws Error if the file cannot be opened
+Binary_log_sink::Binary_log_sink(const string& filename)
+    : file(filename, ios::binary | ios::trunc)
+{
+    if (!file)
+        throw Error("Cannot open log file!");
+}
+
+void Binary_log_sink::write(const Log_record& record)
+{
+    // The literals are replaced by their ids, so the arguments are rebuilt
+    string args;
+    const char* p = record.args;
+    const char* end = p + record.args_size;
+    while (p < end) {
+        char tag = *p++;
+        const char* value_begin = p;
+        switch (tag) {
+        case literal_tag: {
+            const char* literal = read_value<const char*>(p);
+            auto it = literal_ids.find(literal);
+            if (it == literal_ids.end()) {
+                it = literal_ids.insert(make_pair(literal, static_cast<uint32_t>(literal_ids.size()))).first;
+                uint16_t length = static_cast<uint16_t>(min(strlen(literal), size_t(UINT16_MAX)));
+                buffer += literal_tag;
+                write_value(buffer, it->second);
+                write_value(buffer, length);
+                buffer.append(literal, length);
+            }
+            args += literal_tag;
+            write_value(args, it->second);
+            continue;
+        }
+        case string_tag:
+            p += sizeof(uint16_t) + read_value<uint16_t>(value_begin);
+            break;
+        case int_tag:
+            p += sizeof(int32_t);
+            break;
+        case double_tag:
+            p += sizeof(double);
+            break;
+        case point_tag:
+        case course_speed_tag:
+            p += 2 * sizeof(double);
+            break;
+        default:
+            p = end;
+            continue;
+        }
+        args += tag;
+        args.append(value_begin, p);
+    }
+
+    buffer += 'M';
+    write_value(buffer, record.sequence);
+    write_value(buffer, static_cast<int32_t>(record.time));
+    write_value(buffer, static_cast<uint8_t>(record.level));
+    write_value(buffer, static_cast<uint8_t>(record.category));
+    write_value(buffer, static_cast<uint16_t>(min(args.size(), size_t(UINT16_MAX))));
+    buffer += args;
+}
+
+void Binary_log_sink::flush()
+{
+    file.write(buffer.data(), buffer.size());
+    file.flush();
+    buffer.clear();
+}
+
+/*** Logger ***/
+
+// A single-producer, single-consumer byte ring. Positions only ever grow;
+// the byte for position n is bytes[n % capacity].
+struct Logger::Ring
+{
+    static const size_t capacity = size_t(1) << 20;
+
+    unique_ptr<char[]> bytes;
+    // written by the logging thread
+    alignas(64) atomic<uint64_t> head;
+    // written by the writer thread
+    alignas(64) atomic<uint64_t> tail;
+    // whether a thread is logging into it; cleared by the thread's lease when it exits
+    atomic<bool> in_use;
+
+    Ring()
+        : bytes(new char[capacity])
+        , head(0)
+        , tail(0)
+        , in_use(true)
+    { }
+
+    void copy_in(uint64_t position, const void* source, size_t count)
+    {
+        size_t offset = position % capacity;
+        size_t first = min(count, capacity - offset);
+        memcpy(bytes.get() + offset, source, first);
+        memcpy(bytes.get(), static_cast<const char*>(source) + first, count - first);
+    }
+
+    void copy_out(uint64_t position, void* destination, size_t count) const
+    {
+        size_t offset = position % capacity;
+        size_t first = min(count, capacity - offset);
+        memcpy(destination, bytes.get() + offset, first);
+        memcpy(static_cast<char*>(destination) + first, bytes.get(), count - first);
+    }
+};
+
+// Hands the calling thread's ring back when the thread exits. Sharing the ring
+// keeps it alive if the Logger has gone first, as it has for a thread that
+// exits after the program does.
+struct Logger::Ring_lease
+{
+    shared_ptr<Ring> ring;
+
+    ~Ring_lease()
+    {
+        if (ring)
+            ring->in_use.store(false, memory_order_release);
+    }
+};
+
+// The calling thread's ring, and its lease
+thread_local Logger::Ring* Logger::this_thread_ring = nullptr;
+thread_local Logger::Ring_lease Logger::this_thread_lease;
+
+Logger::Logger()
+    : enabled_mask(0)
+    , min_level(Log_level::info)
+    , category_mask((1u << num_log_categories) - 1)
+    , time(0)
+    , next_sequence(0)
+    , text_sink(new Text_log_sink(cout))
+    , wake_requested(false)
+    , shutting_down(false)
+    , next_write_sequence(0)
+    , num_written(0)
+{
+    update_mask();
+    writer = thread(&Logger::writer_loop, this);
+}
+
+Logger::~Logger()
+{
+    {
+        lock_guard<mutex> lock(writer_mutex);
+        shutting_down = true;
+    }
+    work_ready.notify_one();
+    writer.join();
+}
+
+// Keep messages of this level and above
+void Logger::set_level(Log_level level)
+{
+    min_level = level;
+    update_mask();
+}
+
+// Keep or drop the messages in a category
+void Logger::set_category_enabled(Log_category category, bool enabled)
+{
+    if (enabled)
+        category_mask |= 1u << static_cast<int>(category);
+    else
+        category_mask &= ~(1u << static_cast<int>(category));
+    update_mask();
+}
+
+// Start or stop writing the messages in binary to a file as well as to cout.
+// An empty filename stops it. Throws Error if the file cannot be opened.
+void Logger::set_binary_file(const string& filename)
+{
+    unique_ptr<Binary_log_sink> new_sink;
+    if (!filename.empty())
+        new_sink.reset(new Binary_log_sink(filename));
+
+    flush();
+    lock_guard<mutex> lock(sinks_mutex);
+    binary_sink = move(new_sink);
+}
+
+// Write out every message logged so far, on the calling thread; returns at once
+// if they all have been
+void Logger::flush()
+{
+    // a record still being put in its ring has its number already, so drain waits for it
+    if (num_written.load(memory_order_acquire) == next_sequence.load(memory_order_relaxed))
+        return;
+    drain();
+}
+
+// Logger for the whole program
+Logger& Logger::get_instance()
+{
+    static Logger the_logger;
+    return the_logger;
+}
+
+// Used by Log_line: append a finished message to this thread's ring
+void Logger::commit(Log_level level, Log_category category, const char* args, size_t args_size)
+{
+    Ring& ring = get_ring();
+    size_t record_size = record_header_size + args_size;
+    if (record_size > Ring::capacity)
+        return;
+
+    uint64_t head = ring.head.load(memory_order_relaxed);
+    uint64_t tail = ring.tail.load(memory_order_acquire);
+    while (head + record_size - tail > Ring::capacity) {
+        // Full; let the writer catch up
+        wake_writer();
+        this_thread::yield();
+        tail = ring.tail.load(memory_order_acquire);
+    }
+
+    uint32_t size = static_cast<uint32_t>(record_size);
+    uint64_t sequence = next_sequence.fetch_add(1, memory_order_relaxed);
+    int32_t record_time = time.load(memory_order_relaxed);
+    char header[record_header_size];
+    char* p = header;
+    memcpy(p, &size, sizeof(size));
+    p += sizeof(size);
+    memcpy(p, &sequence, sizeof(sequence));
+    p += sizeof(sequence);
+    memcpy(p, &record_time, sizeof(record_time));
+    p += sizeof(record_time);
+    memcpy(p, &level, sizeof(level));
+    p += sizeof(level);
+    memcpy(p, &category, sizeof(category));
+
+    ring.copy_in(head, header, record_header_size);
+    ring.copy_in(head + record_header_size, args, args_size);
+    ring.head.store(head + record_size, memory_order_release);
+
+    // The writer comes round every writer_interval anyway; wake it early only once
+    // the ring is half full, rather than for every record that finds it empty
+    if (head + record_size - tail > Ring::capacity / 2)
+        wake_writer();
+}
+
+void Logger::update_mask()
+{
+    uint32_t mask = 0;
+    for (int level = static_cast<int>(min_level); level < num_log_levels; ++level)
+        for (int category = 0; category < num_log_categories; ++category)
+            if (category_mask & (1u << category))
+                mask |= 1u << mask_bit(static_cast<Log_level>(level), static_cast<Log_category>(category));
+    enabled_mask.store(mask, memory_order_relaxed);
+}
+
+// The calling thread's ring, taken over from a thread that has exited or made on first use.
+// A ring taken over may still hold records; the new thread's records follow them.
+Logger::Ring& Logger::get_ring()
+{
+    if (!this_thread_ring) {
+        lock_guard<mutex> lock(rings_mutex);
+        for (auto& ring : rings) {
+            if (!ring->in_use.load(memory_order_acquire)) {
+                ring->in_use.store(true, memory_order_relaxed);
+                this_thread_lease.ring = ring;
+                break;
+            }
+        }
+        if (!this_thread_lease.ring) {
+            rings.push_back(make_shared<Ring>());
+            this_thread_lease.ring = rings.back();
+        }
+        this_thread_ring = this_thread_lease.ring.get();
+    }
+    return *this_thread_ring;
+}
+
+// Wake the writer up if it is waiting
+void Logger::wake_writer()
+{
+    if (!wake_requested.exchange(true, memory_order_acq_rel))
+        work_ready.notify_one();
+}
+
+void Logger::writer_loop()
+{
+    unique_lock<mutex> lock(writer_mutex);
+    while (true) {
+        work_ready.wait_for(lock, writer_interval, [this] { return shutting_down || wake_requested.load(); });
+        wake_requested.store(false);
+        bool stopping = shutting_down;
+
+        lock.unlock();
+        drain();
+        lock.lock();
+
+        if (stopping)
+            return;
+    }
+}
+
+// Write out every record in the rings, oldest first, up to the first one not yet in its ring;
+// called by the writer, and by flush on the thread that flushes
+void Logger::drain()
+{
+    vector<Ring*> current_rings;
+    auto get_current_rings = [&] {
+        lock_guard<mutex> lock(rings_mutex);
+        current_rings.clear();
+        for (auto& ring : rings)
+            current_rings.push_back(ring.get());
+    };
+    get_current_rings();
+
+    lock_guard<mutex> lock(sinks_mutex);
+    vector<char> record;
+    bool wrote_any = false;
+    while (true) {
+        // Find the ring whose next record was logged first
+        Ring* oldest_ring = nullptr;
+        uint64_t oldest_sequence = 0;
+        for (Ring* ring : current_rings) {
+            uint64_t tail = ring->tail.load(memory_order_relaxed);
+            if (tail == ring->head.load(memory_order_acquire))
+                continue;
+            uint64_t sequence;
+            ring->copy_out(tail + sizeof(uint32_t), &sequence, sizeof(sequence));
+            if (!oldest_ring || sequence < oldest_sequence) {
+                oldest_ring = ring;
+                oldest_sequence = sequence;
+            }
+        }
+        if (!oldest_ring)
+            break;
+        if (oldest_sequence != next_write_sequence) {
+            // The record numbered next is still being copied into its ring, which may be a new one
+            this_thread::yield();
+            get_current_rings();
+            continue;
+        }
+        ++next_write_sequence;
+
+        uint64_t tail = oldest_ring->tail.load(memory_order_relaxed);
+        uint32_t size;
+        oldest_ring->copy_out(tail, &size, sizeof(size));
+        record.resize(size);
+        oldest_ring->copy_out(tail, record.data(), size);
+        oldest_ring->tail.store(tail + size, memory_order_release);
+
+        const char* p = record.data() + sizeof(uint32_t);
+        Log_record log_record;
+        log_record.sequence = read_value<uint64_t>(p);
+        log_record.time = read_value<int32_t>(p);
+        log_record.level = read_value<Log_level>(p);
+        log_record.category = read_value<Log_category>(p);
+        log_record.args = p;
+        log_record.args_size = size - record_header_size;
+
+        text_sink->write(log_record);
+        if (binary_sink)
+            binary_sink->write(log_record);
+        wrote_any = true;
+    }
+
+    if (wrote_any) {
+        text_sink->flush();
+        if (binary_sink)
+            binary_sink->flush();
+        num_written.store(next_write_sequence, memory_order_release);
+    }
+}
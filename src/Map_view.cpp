@@ -2,7 +2,8 @@
 #include "Utility.h"
 #include <iostream>
 #include <iomanip>
-#include <vector>
+#include <sstream>
+#include <string_view>
 
 using namespace std;
 
@@ -10,113 +11,169 @@ using namespace std;
 // scale, and origin
 Map_view::Map_view()
     : Twod_view(25, 2.0, Point(-10, -10))
+    , live(false)
+    , live_screen_drawn(false)
 { }
 
-// prints out the current map
-void Map_view::draw()
+// prints out the current map; in live mode, once the whole map is on the
+// screen, only moves the cursor to the rows that changed and writes those
+void Map_view::draw(ostream& os)
 {
-    Twod_view::draw();
-    cout << "Display size: " << get_size() << ", scale: " << get_scale() << ", origin: " << get_origin() << endl;
+    update_rows();
+
+    if (live && live_screen_drawn && int(get_changed_rows().size()) < get_size()) {
+        for (int row : get_changed_rows())
+            os << "\x1b[" << first_row_line + row << ";1H" << get_row_text(row) << "\x1b[K";
+        if (is_outside_changed()) {
+            os << "\x1b[" << first_row_line - 1 << ";1H";
+            print_outside_map(os);
+            os << "\x1b[K";
+        }
+        os << "\x1b[" << first_row_line + get_size() + 1 << ";1H" << flush;
+        return;
+    }
 
-    // Save cout settings and set precision to 0.
-    ios::fmtflags old_settings = cout.flags();
-    int old_precision = cout.precision();
-    cout.precision(0);
+    // In live mode the whole map is drawn from the top of a cleared screen,
+    // and the line for the objects outside the map is there even if empty.
+    if (live) {
+        os << "\x1b[H\x1b[2J";
+        live_screen_drawn = true;
+    }
 
-    const vector<vector<string>> twod_map = get_twod_map();
+    os << "Display size: " << get_size() << ", scale: " << get_scale() << ", origin: " << get_origin() << endl;
 
-    const vector<string> object_outside_map = get_object_outside_map();
+    // Save the settings of os and set precision to 0.
+    ios::fmtflags old_settings = os.flags();
+    int old_precision = os.precision();
+    os.precision(0);
 
-    bool print_comma = false;
-    for (const string& name : object_outside_map) {
-        if (print_comma)
-            cout << ", ";
-        cout << name;
-        print_comma = true;
+    print_outside_map(os);
+    if (live || !get_object_outside_map().empty())
+        os << endl;
+
+    for (int j = 0; j < get_size(); ++j)
+        os << get_row_text(j) << endl;
+
+    // Print x coordinates
+    for (int a = 0; a < get_size(); ++a)
+        if (a % 3 == 0)
+            os << setw(6) << a * get_scale() + get_origin().x;
+    os << endl;
+
+    // Reset the settings of os.
+    os.flags(old_settings);
+    os.precision(old_precision);
+}
+
+// Turn live mode on or off
+void Map_view::set_live(bool live_)
+{
+    live = live_;
+    live_screen_drawn = false;
+}
+
+// Return the text of a row of the map, with its y coordinate every third row
+string Map_view::render_row(int j) const
+{
+    ostringstream row;
+    row.setf(ios::fixed, ios::floatfield);
+    row.precision(0);
+
+    // coord_printed indicates if a coordinate was printed
+    // in a certain row.
+    bool coord_printed = false;
+
+    // Check if you should print a y coordinate in a certain row.
+    if ((get_size() - j - 1) % 3 == 0) {
+        row << setw(4) << (get_size() - j - 1) * get_scale() + get_origin().y;
+        coord_printed = true;
     }
 
-    if (!object_outside_map.empty())
-        cout << " outside the map" << endl;
+    bool printed_str_before = false;
 
-    for (int j = 0; j < get_size(); ++j) {
-        // coord_printed indicates if a coordinate was printed
-        // in a certain row.
-        bool coord_printed = false;
+    // Set width accordingly.
+    for (int k = 0; k < get_size(); ++k) {
+        string_view cell = get_cell(j, k);
+        bool is_string = is_name(cell);
 
-        // Check if you should print a y coordinate in a certain row.
-        if ((get_size() - j - 1) % 3 == 0) {
-            cout << setw(4) << (get_size() - j - 1) * get_scale() + get_origin().y;
-            coord_printed = true;
+        // Case when a coord was printed, and it is the first point in a row,
+        // and it is a string
+        if (!coord_printed && k == 0 && is_string) {
+            row << setw(7);
+            printed_str_before = true;
         }
-
-        bool printed_str_before = false;
-
-        // Set width accordingly.
-        for (int k = 0; k < get_size(); ++k) {
-            // Case when a coord was printed, and it is the first point in a row,
-            // and it is a string
-            if (!coord_printed && k == 0 && twod_map[j][k] != "." && twod_map[j][k] != "*") {
-                cout << setw(7);
-                printed_str_before = true;
-            }
-            // Case when a coord was not printed and it is the first
-            // point in a row.
-            else if (!coord_printed && k == 0) {
-                cout << setw(6);
-                printed_str_before = false;
-            }
-            // Case when a string was not printed before, and the current point
-            // is a string.
-            else if (!printed_str_before && twod_map[j][k] != "." && twod_map[j][k] != "*") {
-                cout << setw(3);
-                printed_str_before = true;
-            }
-            // Case when a string was not printed before, and the current point
-            // is not a string.
-            else if (!printed_str_before && (twod_map[j][k] == "." || twod_map[j][k] == "*")) {
-                cout << setw(2);
-            }
-            // Case when a string was printed before, and the current point is
-            // not a string.
-            else if (printed_str_before && (twod_map[j][k] == "." || twod_map[j][k] == "*")) {
-                printed_str_before = false;
-            }
-
-            cout << twod_map[j][k];
+        // Case when a coord was not printed and it is the first
+        // point in a row.
+        else if (!coord_printed && k == 0) {
+            row << setw(6);
+            printed_str_before = false;
+        }
+        // Case when a string was not printed before, and the current point
+        // is a string.
+        else if (!printed_str_before && is_string) {
+            row << setw(3);
+            printed_str_before = true;
+        }
+        // Case when a string was not printed before, and the current point
+        // is not a string.
+        else if (!printed_str_before && !is_string) {
+            row << setw(2);
         }
-        cout << " " << endl;
+        // Case when a string was printed before, and the current point is
+        // not a string.
+        else if (printed_str_before && !is_string) {
+            printed_str_before = false;
+        }
+
+        row << cell;
     }
+    row << " ";
+    return row.str();
+}
 
-    // Print x coordinates
-    for (int a = 0; a < get_size(); ++a)
-        if (a % 3 == 0)
-            cout << setw(6) << a * get_scale() + get_origin().x;
-    cout << endl;
+// Print the names of the objects outside the map to os, if there are any
+void Map_view::print_outside_map(ostream& os) const
+{
+    bool print_comma = false;
+    for (const string& name : get_object_outside_map()) {
+        if (print_comma)
+            os << ", ";
+        os << name;
+        print_comma = true;
+    }
 
-    // Reset cout info.
-    cout.flags(old_settings);
-    cout.precision(old_precision);
+    if (!get_object_outside_map().empty())
+        os << " outside the map";
 }
 
 // Modify the display parameters:
 // If the size is out of bounds will throw Error("New map size is too big!")
 // or Error("New map size is too small!").
 void Map_view::set_size(int size_)
+{
+    check_size(size_);
+    Twod_view::set_size(size_);
+}
+
+// If scale is not postive, will throw Error("New map scale must be positive!");
+void Map_view::set_scale(double scale_)
+{
+    check_scale(scale_);
+    Twod_view::set_scale(scale_);
+}
+
+// Throw the Error that set_size or set_scale would, without changing anything
+void Map_view::check_size(int size_)
 {
     if (size_ > 30)
         throw Error("New map size is too big!");
 
     if (size_ <= 6)
         throw Error("New map size is too small!");
-
-    Twod_view::set_size(size_);
 }
 
-// If scale is not postive, will throw Error("New map scale must be positive!");
-void Map_view::set_scale(double scale_)
+void Map_view::check_scale(double scale_)
 {
     if (scale_ < 0.0)
         throw Error("New map scale must be positive!");
-
-    Twod_view::set_scale(scale_);
 }
\ No newline at end of file
@@ -1,85 +1,309 @@
 #include "Model.h"
+#include "Checkpoint.h"
+#include "Logger.h"
+#include "Profiler.h"
 #include "Sim_object.h"
 #include "Island.h"
 #include "Ship.h"
 #include "View.h"
 #include "Geometry.h"
 #include "Ship_component_factory.h"
+#include "Ship_store.h"
+#include "Tour_planner.h"
 #include "Utility.h"
 #include <algorithm>
+#include <cmath>
 #include <iostream>
+#include <utility>
 
 using namespace std;
 
+// Size of a Spatial_grid cell in nm
+const double grid_cell_size = 10.;
+
 // create the initial objects
 Model::Model()
-    : time(0)
-{
-    // first insert Islands into island_map and insert the returned iterator
-    // from .insert() back into sim_object_map
-    sim_object_map.insert(
-        *island_map.insert(make_pair("Exxon", make_shared<Island>("Exxon", Point(10, 10), 1000, 200))).first);
-    sim_object_map.insert(
-        *island_map.insert(make_pair("Shell", make_shared<Island>("Shell", Point(0, 30), 1000, 200))).first);
-    sim_object_map.insert(
-        *island_map.insert(make_pair("Bermuda", make_shared<Island>("Bermuda", Point(20, 20)))).first);
-    sim_object_map.insert(
-        *island_map.insert(make_pair("Treasure_Island", make_shared<Island>("Treasure_Island", Point(50, 5), 100, 5)))
-             .first);
-
-    // first insert Ship into ship_map and insert the returned iterator
-    // from .insert() back into sim_object_map
-    sim_object_map.insert(*ship_map.insert(make_pair("Ajax", create_ship("Ajax", "Cruiser", Point(15, 15)))).first);
-    sim_object_map.insert(*ship_map.insert(make_pair("Xerxes", create_ship("Xerxes", "Cruiser", Point(25, 25)))).first);
-    sim_object_map.insert(*ship_map.insert(make_pair("Valdez", create_ship("Valdez", "Tanker", Point(30, 30)))).first);
+    : object_arena(new Object_arena)
+    , time(0)
+    , update_mode(Update_mode::serial)
+    , num_islands(0)
+    , num_ships(0)
+    , object_order_dirty(false)
+    , island_grid(grid_cell_size, names)
+    , ship_grid(grid_cell_size, names)
+{
+    add_object(create_island(*this, "Exxon", Point(10, 10), 1000, 200), Object_kind::island);
+    add_object(create_island(*this, "Shell", Point(0, 30), 1000, 200), Object_kind::island);
+    add_object(create_island(*this, "Bermuda", Point(20, 20)), Object_kind::island);
+    add_object(create_island(*this, "Treasure_Island", Point(50, 5), 100, 5), Object_kind::island);
+
+    add_object(create_ship(*this, "Ajax", "Cruiser", Point(15, 15)), Object_kind::ship);
+    add_object(create_ship(*this, "Xerxes", "Cruiser", Point(25, 25)), Object_kind::ship);
+    add_object(create_ship(*this, "Valdez", "Tanker", Point(30, 30)), Object_kind::ship);
 }
 
 // Will throw Error("Island not found!") if no island of that name
 shared_ptr<Island> Model::get_island_ptr(const string& name) const
 {
-    auto iter_found = island_map.find(name);
+    Object_id id = names.find(name);
 
-    if (iter_found == island_map.cend())
+    if (id == no_object_id || size_t(id) >= object_kinds.size() || object_kinds[id] != Object_kind::island)
         throw Error("Island not found!");
 
-    return iter_found->second;
+    return static_pointer_cast<Island>(objects[id]);
 }
 
 // Returns nullptr if there is no ship of that name
 shared_ptr<Ship> Model::get_ship_ptr(const string& name) const
 {
-    auto iter_found = ship_map.find(name);
+    Object_id id = names.find(name);
 
-    if (iter_found == ship_map.cend())
+    if (id == no_object_id || size_t(id) >= object_kinds.size() || object_kinds[id] != Object_kind::ship)
         return nullptr;
 
-    return iter_found->second;
+    return static_pointer_cast<Ship>(objects[id]);
+}
+
+// Return every Island, or every Ship, in name order
+vector<shared_ptr<Island>> Model::get_islands() const
+{
+    vector<shared_ptr<Island>> islands;
+    islands.reserve(num_islands);
+    for (Object_id id : get_object_order())
+        if (object_kinds[id] == Object_kind::island)
+            islands.push_back(static_pointer_cast<Island>(objects[id]));
+    return islands;
+}
+
+vector<shared_ptr<Ship>> Model::get_ships() const
+{
+    vector<shared_ptr<Ship>> ships;
+    ships.reserve(num_ships);
+    for (Object_id id : get_object_order())
+        if (object_kinds[id] == Object_kind::ship)
+            ships.push_back(static_pointer_cast<Ship>(objects[id]));
+    return ships;
 }
 
-// Find a Ship_composite with the given name from ship_component_map
+// Returns nullptr if there is no group of that name
 shared_ptr<Ship_component> Model::get_ship_composite_ptr(const string& name) const
 {
-    shared_ptr<Ship_component> ship_composite;
-    for (const auto& pair : ship_component_map) {
-        ship_composite = pair.second->find_ship_composite(name);
-        if (ship_composite)
-            return ship_composite;
+    auto it = group_index.find(name);
+    return it == group_index.cend() ? nullptr : it->second.group;
+}
+
+/* Handles */
+// Return a handle to an object of this Model, or to one that load is about to put in it
+Object_handle Model::get_handle(const Sim_object& object) const
+{
+    Object_id id = object.get_id();
+    return Object_handle{id, size_t(id) < object_generations.size() ? object_generations[id] : 0};
+}
+
+// Return the Ship or Island a handle refers to, or nullptr if it has been removed since
+Ship* Model::resolve_ship(Object_handle handle) const
+{
+    size_t id = size_t(handle.id);
+    if (id >= objects.size() || object_generations[id] != handle.generation || object_kinds[id] != Object_kind::ship)
+        return nullptr;
+    return static_cast<Ship*>(objects[id].get());
+}
+
+Island* Model::resolve_island(Object_handle handle) const
+{
+    size_t id = size_t(handle.id);
+    if (id >= objects.size() || object_generations[id] != handle.generation
+        || object_kinds[id] != Object_kind::island)
+        return nullptr;
+    return static_cast<Island*>(objects[id].get());
+}
+
+// The same as resolve_island, as a pointer that shares the Island, e.g. to dock at it
+shared_ptr<Island> Model::get_island_ptr(Object_handle handle) const
+{
+    if (!resolve_island(handle))
+        return nullptr;
+    return static_pointer_cast<Island>(objects[handle.id]);
+}
+
+/* Proximity queries */
+// Return the Island closest to location for which predicate is true, or nullptr if none
+shared_ptr<Island> Model::find_nearest_island_if(Point location, const Spatial_grid::Predicate& predicate) const
+{
+    Object_id id = island_grid.find_nearest_if(location, predicate);
+    if (id == no_object_id)
+        return nullptr;
+    return static_pointer_cast<Island>(objects[id]);
+}
+
+// Return the Islands within radius of location, in name order
+vector<shared_ptr<Island>> Model::find_islands_within(Point location, double radius) const
+{
+    vector<shared_ptr<Island>> islands;
+    for (Object_id id : island_grid.find_within(location, radius))
+        islands.push_back(static_pointer_cast<Island>(objects[id]));
+    return islands;
+}
+
+// Return the Ship closest to location for which predicate is true, or nullptr if none
+shared_ptr<Ship> Model::find_nearest_ship_if(Point location, const Spatial_grid::Predicate& predicate) const
+{
+    Object_id id = ship_grid.find_nearest_if(location, predicate);
+    if (id == no_object_id)
+        return nullptr;
+    return static_pointer_cast<Ship>(objects[id]);
+}
+
+// Return up to k Ships closest to location, closest first
+vector<shared_ptr<Ship>> Model::find_nearest_ships(Point location, int k) const
+{
+    vector<shared_ptr<Ship>> ships;
+    for (Object_id id : ship_grid.find_nearest(location, k))
+        ships.push_back(static_pointer_cast<Ship>(objects[id]));
+    return ships;
+}
+
+/* CPA screening */
+// Return every pair of Ships that come within range of each other in the next
+// hours; the name of a pair's id1 comes before that of its id2
+vector<Cpa_pair> Model::screen_cpa(double range, double hours)
+{
+    // added in name order, so the first of a pair has the first name
+    cpa_screen.clear();
+    for (Object_id id : get_object_order()) {
+        if (object_kinds[id] != Object_kind::ship)
+            continue;
+        const Ship& ship = static_cast<const Ship&>(*objects[id]);
+        cpa_screen.add_track(id, ship.get_location(), ship.get_velocity());
     }
-    return ship_composite;
+
+    vector<Cpa_pair> pairs;
+    cpa_screen.screen(range, hours, pairs);
+    sort_cpa_pairs(pairs);
+    return pairs;
+}
+
+// Return the pairs of ship, as id1, and each Ship that comes within range of it in the next hours
+vector<Cpa_pair> Model::screen_cpa(const Ship& ship, double range, double hours)
+{
+    // no Ship further away than this can come within range in time
+    Cartesian_vector velocity = ship.get_velocity();
+    double own_speed = sqrt(velocity.delta_x * velocity.delta_x + velocity.delta_y * velocity.delta_y);
+    double reach = (range + (own_speed + ship_store.get_max_speed()) * hours) * (1. + 1e-9);
+
+    cpa_screen.clear();
+    for (Object_id id : ship_grid.find_within(ship.get_location(), reach)) {
+        const Ship& other = static_cast<const Ship&>(*objects[id]);
+        cpa_screen.add_track(id, other.get_location(), other.get_velocity());
+    }
+
+    vector<Cpa_pair> pairs;
+    cpa_screen.screen_track(ship.get_id(), ship.get_location(), velocity, range, hours, pairs);
+    sort_cpa_pairs(pairs);
+    return pairs;
+}
+
+/* Cruises */
+// Return the Islands in the order of a short tour through all of them that
+// comes back to where it starts; a cruise goes round it from any Island
+shared_ptr<const vector<Object_handle>> Model::get_island_tour() const
+{
+    if (island_tour)
+        return island_tour;
+
+    // planned from the Island whose name comes first
+    vector<Object_id> island_ids;
+    vector<Point> locations;
+    island_ids.reserve(num_islands);
+    locations.reserve(num_islands);
+    for (Object_id id : get_object_order()) {
+        if (object_kinds[id] != Object_kind::island)
+            continue;
+        island_ids.push_back(id);
+        locations.push_back(objects[id]->get_location());
+    }
+
+    Tour_planner planner;
+    vector<int> order = planner.plan(locations);
+    auto tour = make_shared<vector<Object_handle>>();
+    tour->reserve(order.size());
+    for (int index : order)
+        tour->push_back(get_handle(*objects[island_ids[index]]));
+    island_tour = tour;
+
+    // reported whenever a tour is planned, so that what planning saves shows outside the bench too
+    double greedy_length = planner.get_greedy_length();
+    LOG(Log_level::info, Log_category::movement)
+        << "Island tour of " << num_islands << " Islands planned: " << planner.get_length() << " nm, against "
+        << greedy_length << " nm going to the nearest Island each time ("
+        << (greedy_length > 0. ? 100. * (1. - planner.get_length() / greedy_length) : 0.) << "% shorter)";
+    return island_tour;
 }
 
 // tell all objects to describe themselves
 void Model::describe() const
 {
-    for_each(sim_object_map.cbegin(), sim_object_map.cend(), [](const auto& map_pair) { map_pair.second->describe(); });
+    for (Object_id id : get_object_order())
+        if (objects[id])
+            objects[id]->describe();
 }
 
 // increment the time, and tell all objects to update themselves
 void Model::update()
 {
-    for_each(sim_object_map.cbegin(), sim_object_map.cend(), [](const auto& map_pair) { map_pair.second->update(); });
+    if (update_mode == Update_mode::event)
+        run_events(1);
+    else
+        update_tick();
+}
+
+// Update num_ticks times. Stretches in which every object would only move
+// steadily or accumulate fuel are skipped over in one step with
+// Sim_object::advance, without their per-update messages; every other
+// update, and always the last one, is done in full.
+void Model::update(int num_ticks)
+{
+    if (update_mode == Update_mode::event) {
+        run_events(num_ticks);
+        return;
+    }
 
-    ++time;
+    while (num_ticks > 0) {
+        const vector<Object_id>& order = get_object_order();
+        int ticks_to_skip = num_ticks - 1;
+        for (Object_id id : order) {
+            if (ticks_to_skip == 0)
+                break;
+            ticks_to_skip = min(ticks_to_skip, objects[id]->ticks_until_event());
+        }
+
+        if (ticks_to_skip == 0) {
+            update_tick();
+            --num_ticks;
+            continue;
+        }
+
+        {
+            PROFILE_SCOPE(Profile_section::advance);
+            for (Object_id id : order)
+                objects[id]->advance(ticks_to_skip);
+        }
+        time += ticks_to_skip;
+        num_ticks -= ticks_to_skip;
+        deliver_view_changes();
+        PROFILE_END_TICK();
+    }
+}
+
+// Add a new Island to the containers, and update the view
+// Throws Error if there is already a Ship or Island with that name.
+void Model::add_island(shared_ptr<Island> new_island)
+{
+    check_if_object_duplicate(*new_island);
+
+    Island& island = *new_island;
+    add_object(move(new_island), Object_kind::island);
+    island.broadcast_current_state();
 }
 
 // Add a new ship to the containers, and update the view
@@ -88,16 +312,16 @@ void Model::update()
 // and the exception rethrown.
 void Model::add_ship(shared_ptr<Ship> new_ship)
 {
-    check_if_name_duplicate(new_ship->get_name());
+    check_if_object_duplicate(*new_ship);
 
-    sim_object_map.insert(make_pair(new_ship->get_name(), new_ship));
-    ship_map.insert(make_pair(new_ship->get_name(), new_ship));
+    Ship& ship = *new_ship;
+    add_object(move(new_ship), Object_kind::ship);
 
     // Notify View about the new Ship.
-    new_ship->broadcast_current_state();
-    new_ship->broadcast_ship_fuel();
-    new_ship->broadcast_ship_course();
-    new_ship->broadcast_ship_speed();
+    ship.broadcast_current_state();
+    ship.broadcast_ship_fuel();
+    ship.broadcast_ship_course();
+    ship.broadcast_ship_speed();
 }
 
 // Add a Ship_composite to ship_component_map
@@ -107,107 +331,84 @@ void Model::add_composite(shared_ptr<Ship_component> new_group)
     check_if_name_duplicate(new_group->get_name());
 
     ship_component_map.insert(make_pair(new_group->get_name(), new_group));
-    ship_composite_names.insert(new_group->get_name());
+    group_index.insert(make_pair(new_group->get_name(), Group_entry{new_group, string(), new_group->get_name()}));
 
-    cout << "Group " << new_group->get_name() << " added" << endl;
+    LOG(Log_level::info, Log_category::general) << "Group " << new_group->get_name() << " added";
 }
 
 // Add a Ship to an existing Ship_composite
 // Throw an Error when composite or ship does not exist, or when ship is
 // being added to a Ship_composite whose top Ship_composite already
 // has the ship.
-void Model::add_ship_to_composite(const string& composite, shared_ptr<Ship_component> ship)
+void Model::add_ship_to_composite(const string& composite, shared_ptr<Ship> ship)
 {
-    // top_ship_composite is a Ship_composite who is at the very top
-    // of a Ship_composite hierarchy.
-    shared_ptr<Ship_component> top_ship_composite;
-
-    // leaf_ship_composite is a Ship_composite which is under
-    // a top Ship_ composite
-    shared_ptr<Ship_component> leaf_ship_composite;
-
-    // find the top Ship_composite which contains a Ship_composite with
-    // the given string, composite, and also find a Ship_composite
-    // with the given string
-    for (const auto& pair : ship_component_map) {
-        leaf_ship_composite = pair.second->find_ship_composite(composite);
-        if (leaf_ship_composite) {
-            top_ship_composite = pair.second;
-            break;
-        }
-    }
-
-    if (!top_ship_composite)
+    auto it = group_index.find(composite);
+    if (it == group_index.cend())
         throw Error("Group does not exist!");
 
     if (!ship)
         throw Error("Ship not found!");
 
-    if (top_ship_composite->check_if_ship_exists(ship->get_name()))
+    const Group_entry& entry = it->second;
+    unordered_set<string>& top_groups = ship_top_groups[ship->get_id()];
+    if (top_groups.count(entry.top))
         throw Error("Cannot add the same Ship under the same group!");
 
-    leaf_ship_composite->add_component(ship);
-    cout << ship->get_name() << " added to " << leaf_ship_composite->get_name() << endl;
+    entry.group->add_component(ship);
+    top_groups.insert(entry.top);
+    LOG(Log_level::info, Log_category::general) << ship->get_name() << " added to " << composite;
 }
 
 // Create a Ship_composite and add it to an existing Ship_composite.
 void Model::add_composite_to_composite(const string& composite_name, shared_ptr<Ship_component> composite_in)
 {
-    shared_ptr<Ship_component> composite_ptr = find_composite_ptr(composite_name);
+    auto it = group_index.find(composite_name);
 
-    if (!composite_ptr)
+    if (it == group_index.cend())
         throw Error("Group does not exist!");
 
     check_if_name_duplicate(composite_in->get_name());
 
-    composite_ptr->add_component(composite_in);
-    ship_composite_names.insert(composite_in->get_name());
-    cout << composite_in->get_name() << " added to " << composite_ptr->get_name() << endl;
+    it->second.group->add_component(composite_in);
+    Group_entry entry{composite_in, composite_name, it->second.top};
+    group_index.insert(make_pair(composite_in->get_name(), move(entry)));
+    LOG(Log_level::info, Log_category::general) << composite_in->get_name() << " added to " << composite_name;
 }
 
-// Remove a Ship_composite
+// Remove a Ship_composite, along with the groups under it
 void Model::remove_composite(const string& group_to_remove)
 {
-    auto it = ship_component_map.cbegin();
-    while (it != ship_component_map.cend()) {
-        // If the iterator, it, matches group_to_remove,
-        // remove it.
-        if (it->second->get_name() == group_to_remove) {
-            ship_component_map.erase(it);
-            cout << group_to_remove << " removed" << endl;
-            ship_composite_names.erase(group_to_remove);
-            return;
-        } else {
-            // If the iterator, it, does not match group_to_remove,
-            // search the iterator's container to find group_to_remove
-            // and erase it.
-            if (it->second->find_and_remove_ship_composite(group_to_remove)) {
-                cout << group_to_remove << " removed" << endl;
-                ship_composite_names.erase(group_to_remove);
-                return;
-            }
-            ++it;
-        }
-    }
-    throw Error("Group does not exist!");
+    auto it = group_index.find(group_to_remove);
+    if (it == group_index.cend())
+        throw Error("Group does not exist!");
+
+    Group_entry entry = move(it->second);
+    group_index.erase(it);
+    if (entry.parent.empty())
+        ship_component_map.erase(group_to_remove);
+    else
+        group_index.at(entry.parent).group->remove_component(entry.group);
+    unindex_members(*entry.group, entry.top);
+    LOG(Log_level::info, Log_category::general) << group_to_remove << " removed";
 }
 
 // Find a Ship_composite with the given string
 // and remove the given Ship from the Ship_composite
 void Model::remove_ship_from_composite(const string& composite, const string& ship_name)
 {
-    shared_ptr<Ship_component> composite_ptr = find_composite_ptr(composite);
+    auto it = group_index.find(composite);
 
-    if (!composite_ptr)
+    if (it == group_index.cend())
         throw Error("Group not found!");
 
-    auto it = ship_map.find(ship_name);
+    shared_ptr<Ship> ship_ptr = get_ship_ptr(ship_name);
 
-    if (it == ship_map.cend())
+    if (!ship_ptr)
         throw Error("Ship not found!");
 
-    composite_ptr->remove_component(it->second);
-    cout << it->second->get_name() << " removed from " << composite_ptr->get_name() << endl;
+    it->second.group->remove_component(ship_ptr);
+    forget_top_group(ship_ptr->get_id(), it->second.top);
+    LOG(Log_level::info, Log_category::general) << ship_ptr->get_name() << " removed from " << composite;
 }
 
 // Describe Ship_components in ship_component_map.
@@ -233,18 +434,10 @@ void Model::describe_composite() const
 void Model::attach(shared_ptr<View> view_ptr)
 {
     view_vec.push_back(view_ptr);
+    view_renderer.attach(view_ptr);
 
-    // Notify View about every Sim_object in sim_object_map.
-    for_each(sim_object_map.cbegin(), sim_object_map.cend(), [](const auto& map_pair) {
-        map_pair.second->broadcast_current_state();
-    });
-
-    // Notify View about Ships' information
-    for_each(ship_map.cbegin(), ship_map.cend(), [](const auto& map_pair) {
-        map_pair.second->broadcast_ship_fuel();
-        map_pair.second->broadcast_ship_course();
-        map_pair.second->broadcast_ship_speed();
-    });
+    broadcast_all();
+    deliver_view_changes();
 }
 // Detach the View by discarding the supplied pointer from the container
 // of Views - no updates sent to it thereafter.
@@ -256,77 +449,472 @@ void Model::detach(shared_ptr<View> view_ptr)
     if (it == view_vec.cend())
         return;
 
+    // the other Views still get what has changed
+    deliver_view_changes();
+    view_renderer.detach(view_ptr);
     view_vec.erase(it);
 }
 
 // notify the views about an object's location
-void Model::notify_location(const string& name, Point location)
+void Model::notify_location(Object_id id, Point location)
 {
-    for_each(view_vec.cbegin(), view_vec.cend(), [&](shared_ptr<View> ptr) { ptr->update_location(name, location); });
+    // Islands never move, so only the Ships need to be kept track of
+    ship_grid.move(id, location);
+    if (View_change* change = get_view_change(id)) {
+        change->dirty_mask |= View_change::location_changed;
+        change->location = location;
+    }
 }
 // notify the views that an object is now gone
-void Model::notify_gone(const string& name)
+void Model::notify_gone(Object_id id)
 {
-    for_each(view_vec.cbegin(), view_vec.cend(), [&](shared_ptr<View> ptr) { ptr->update_remove(name); });
+    ship_grid.remove(id);
+    if (View_change* change = get_view_change(id))
+        change->dirty_mask |= View_change::gone;
+}
+
+// notify the Views about a Ship's location, fuel, course, and speed after it moved
+void Model::notify_ship_movement(Object_id id, Point location, double fuel, double course, double speed)
+{
+    ship_grid.move(id, location);
+    if (View_change* change = get_view_change(id)) {
+        change->dirty_mask |= View_change::location_changed | View_change::fuel_changed | View_change::course_changed
+            | View_change::speed_changed;
+        change->location = location;
+        change->fuel = fuel;
+        change->course = course;
+        change->speed = speed;
+    }
 }
 
 // notify the Views about a Ship's fuel
-void Model::notify_view_about_ship_fuel(const string& name, double fuel) const
+void Model::notify_view_about_ship_fuel(Object_id id, double fuel)
 {
-    for (auto ptr : view_vec)
-        ptr->ship_fuel_update(name, fuel);
+    if (View_change* change = get_view_change(id)) {
+        change->dirty_mask |= View_change::fuel_changed;
+        change->fuel = fuel;
+    }
 }
 
 // notify the Views about a Ship's course
-void Model::notify_view_about_ship_course(const std::string& name, double course) const
+void Model::notify_view_about_ship_course(Object_id id, double course)
 {
-    for (auto ptr : view_vec)
-        ptr->ship_course_update(name, course);
+    if (View_change* change = get_view_change(id)) {
+        change->dirty_mask |= View_change::course_changed;
+        change->course = course;
+    }
 }
 
 // notify the Views about a Ship's speed
-void Model::notify_view_about_ship_speed(const std::string& name, double speed) const
+void Model::notify_view_about_ship_speed(Object_id id, double speed)
+{
+    if (View_change* change = get_view_change(id)) {
+        change->dirty_mask |= View_change::speed_changed;
+        change->speed = speed;
+    }
+}
+
+// Hand the changes recorded since the last time to every View
+void Model::deliver_view_changes()
+{
+    if (view_changes.empty())
+        return;
+
+    PROFILE_SCOPE(Profile_section::deliver_changes);
+    for (const View_change& change : view_changes)
+        view_change_indexes[change.id] = -1;
+    view_renderer.publish(view_changes, names);
+}
+
+// Have the Views' thread run command after the changes recorded so far;
+// what it writes is a frame (see View_renderer::post)
+void Model::post_view_command(function<void(ostream&)> command)
+{
+    deliver_view_changes();
+    view_renderer.post(move(command));
+}
+
+// Remove a Ship that has sunk from the objects, and count it. The rest of the
+// tick passes it over, and it is dropped at the end of the tick.
+void Model::remove_ship(Ship& ship)
 {
-    for (auto ptr : view_vec)
-        ptr->ship_speed_update(name, speed);
+    Object_id id = ship.get_id();
+    ++statistics.ships_sunk;
+    object_kinds[id] = Object_kind::none;
+    ++object_generations[id];
+    removed_ship_ids.push_back(id);
+    --num_ships;
+    ship_grid.remove(id);
+    event_queue.cancel(id);
 }
 
-// Remove a Ship from sim_object_map and ship_map
-void Model::remove_ship(shared_ptr<Ship> ship_ptr)
+/* Checkpoints */
+// Write the time, every object, and the groups to a checkpoint file.
+// Throws Error if the file cannot be written.
+void Model::save(const string& filename) const
 {
-    sim_object_map.erase(ship_ptr->get_name());
-    ship_map.erase(ship_ptr->get_name());
+    Checkpoint_writer writer;
+    for (Object_id id : get_object_order())
+        objects[id]->save(writer);
+    for (const auto& pair : ship_component_map)
+        pair.second->save_group(writer, -1);
+    writer.add_referenced_ships();
+    writer.write(filename, time);
+}
+
+// Replace the time, every object, and the groups with those in a checkpoint
+// file, and update the Views. Throws Error if the file cannot be read or is
+// not a valid checkpoint; the world is then left as it was.
+void Model::load(const string& filename)
+{
+    // Build the whole new world first, so that nothing changes if that fails
+    Checkpoint_reader reader(filename);
+    map<string, shared_ptr<Island>> new_island_map;
+    map<string, shared_ptr<Ship>> new_ship_map;
+    map<string, shared_ptr<Ship_component>> new_ship_component_map;
+    set<string> new_ship_composite_names;
+    reader.create_objects(*this, new_island_map, new_ship_map, new_ship_component_map, new_ship_composite_names);
+
+    // The Views forget the objects that are not in the new world
+    for (Object_id id : get_object_order())
+        if (new_island_map.find(names.get_name(id)) == new_island_map.cend()
+            && new_ship_map.find(names.get_name(id)) == new_ship_map.cend())
+            notify_gone(id);
+
+    ship_component_map.swap(new_ship_component_map);
+    index_groups();
+
+    clear_objects();
+    for (const auto& pair : new_island_map)
+        add_object(pair.second, Object_kind::island);
+    for (const auto& pair : new_ship_map)
+        add_object(pair.second, Object_kind::ship);
+
+    time = reader.get_time();
+    Logger::get_instance().set_time(time);
+    event_queue.clear();
+
+    // Tell the Views about every object, as when a View is attached
+    broadcast_all();
+    deliver_view_changes();
+}
+
+// Tell Model that the object's situation has changed, e.g. it has been
+// hit or given a new destination, possibly by another object. In event mode the
+// object then gets a full update at the current time, or at the next if it has
+// already been updated.
+void Model::reschedule(Object_id id)
+{
+    if (update_mode == Update_mode::event)
+        event_queue.schedule(id, time, Event_type::state_change);
 }
 
 /*** Helper Functions ***/
 
-// Find a Ship_composite with the given name
-shared_ptr<Ship_component> Model::find_composite_ptr(const string& name)
+// Update every object once, as in serial or parallel mode
+void Model::update_tick()
 {
-    shared_ptr<Ship_component> composite_ptr;
-    for (const auto& pair : ship_component_map) {
-        composite_ptr = pair.second->find_ship_composite(name);
-        if (composite_ptr)
+    {
+        PROFILE_SCOPE(Profile_section::tick);
+        Logger::get_instance().set_time(time);
+
+        if (update_mode == Update_mode::parallel) {
+            PROFILE_SCOPE(Profile_section::plan_movement);
+            plan_ship_movement();
+        }
+
+        {
+            PROFILE_SCOPE(Profile_section::update_objects);
+            // a Ship that sinks is passed over, and dropped after the pass
+            for (Object_id id : get_object_order())
+                if (object_kinds[id] != Object_kind::none)
+                    objects[id]->update();
+        }
+        drop_removed_ships();
+
+        ++time;
+        Logger::get_instance().set_time(time);
+        deliver_view_changes();
+    }
+    PROFILE_END_TICK();
+}
+
+/*
+Update num_ticks times in event mode. Each object's next event is the time of
+the first update it cannot skip. Up to the earliest event every object is
+advanced at once; at an event time the objects are gone through in the usual
+order, and those with an event due are updated in full and have their next
+event scheduled, while the rest are advanced by one tick. So every object sees
+the others just as it would in serial mode.
+*/
+void Model::run_events(int num_ticks)
+{
+    int end_time = time + num_ticks;
+
+    // commands may have changed anything since the last run
+    event_queue.clear();
+    for (Object_id id : get_object_order())
+        schedule_event(*objects[id], time);
+
+    while (time < end_time) {
+        int event_time = max(time, min(event_queue.get_next_time(), end_time));
+        int ticks_to_skip = event_time - time;
+        if (ticks_to_skip > 0) {
+            {
+                PROFILE_SCOPE(Profile_section::advance);
+                for (Object_id id : get_object_order())
+                    objects[id]->advance(ticks_to_skip);
+            }
+            time = event_time;
+            PROFILE_END_TICK();
+        }
+        if (time == end_time)
             break;
+
+        PROFILE_SCOPE(Profile_section::tick);
+        Logger::get_instance().set_time(time);
+        for (Object_id id : get_object_order()) {
+            if (object_kinds[id] == Object_kind::none)
+                continue;
+            Sim_object& object = *objects[id];
+            if (!event_queue.is_due(id, time)) {
+                object.advance(1);
+                continue;
+            }
+            LOG(Log_level::debug, Log_category::general)
+                << object.get_name() << " " << get_event_type_name(event_queue.get_type(id));
+            object.update();
+            schedule_event(object, time + 1);
+        }
+        drop_removed_ships();
+        ++time;
+        deliver_view_changes();
+        PROFILE_END_TICK();
     }
-    return composite_ptr;
+    Logger::get_instance().set_time(time);
+    deliver_view_changes();
+}
+
+// Schedule the object's next event, counting its quiet updates from from_time
+void Model::schedule_event(const Sim_object& object, int from_time)
+{
+    int ticks = object.ticks_until_event();
+    if (ticks > Sim_object::no_event - from_time)
+        event_queue.cancel(object.get_id());
+    else
+        event_queue.schedule(object.get_id(), from_time + ticks, object.get_event_type());
+}
+
+// Drop the Ships removed in the tick that has just ended from objects
+void Model::drop_removed_ships()
+{
+    if (removed_ship_ids.empty())
+        return;
+
+    // a Ship whose name has been given to a new object since is already replaced
+    for (Object_id id : removed_ship_ids)
+        if (object_kinds[id] == Object_kind::none)
+            objects[id] = nullptr;
+    removed_ship_ids.clear();
+    object_order_dirty = true;
+}
+
+// Compute the movement of every Ship in parallel before the update pass.
+// Only the Ship_store's arrays are read and written here; everything that touches
+// other objects happens afterwards in the ordinary update pass.
+void Model::plan_ship_movement()
+{
+    ship_store.plan_movement();
+}
+
+// Throw an Error if another Island or Ship, or a Ship_composite, has the new
+// object's name; the same as check_if_name_duplicate, without looking the name up
+void Model::check_if_object_duplicate(const Sim_object& new_object)
+{
+    Object_id id = new_object.get_id();
+    if (size_t(id) < objects.size() && object_kinds[id] != Object_kind::none)
+        throw Error("New object has duplicate name!");
+
+    if (!group_index.empty() && group_index.find(new_object.get_name()) != group_index.cend())
+        throw Error("New object has duplicate name!");
 }
 
 // Check if name conflicts with another Island, Ship, or Ship_composite's name.
 // Throw an Error if it does.
 void Model::check_if_name_duplicate(const string& name)
 {
-    if (island_map.find(name) != island_map.cend())
+    Object_id id = names.find(name);
+    if (id != no_object_id && size_t(id) < objects.size() && object_kinds[id] != Object_kind::none)
         throw Error("New object has duplicate name!");
 
-    if (ship_map.find(name) != ship_map.cend())
+    if (group_index.find(name) != group_index.cend())
         throw Error("New object has duplicate name!");
+}
 
-    if (ship_composite_names.find(name) != ship_composite_names.cend())
-        throw Error("New object has duplicate name!");
+// Return the record to put a change to the object in, or nullptr if there are no Views
+View_change* Model::get_view_change(Object_id id)
+{
+    PROFILE_COUNT_NOTIFICATION();
+    if (view_vec.empty())
+        return nullptr;
+
+    if (size_t(id) >= view_change_indexes.size())
+        view_change_indexes.resize(names.size(), -1);
+    int& index = view_change_indexes[id];
+    // a change after the object went gets a record of its own, so that the two are applied in order
+    if (index == -1 || (view_changes[index].dirty_mask & View_change::gone)) {
+        index = int(view_changes.size());
+        view_changes.push_back(View_change{id, 0, Point(), 0., 0., 0.});
+    }
+    return &view_changes[index];
+}
+
+// Tell the Views about every object, as when a View is attached
+void Model::broadcast_all()
+{
+    for (Object_id id : get_object_order()) {
+        objects[id]->broadcast_current_state();
+        if (object_kinds[id] == Object_kind::ship) {
+            Ship& ship = static_cast<Ship&>(*objects[id]);
+            ship.broadcast_ship_fuel();
+            ship.broadcast_ship_course();
+            ship.broadcast_ship_speed();
+        }
+    }
+}
+
+// Add an object of the kind, whose name must not be that of another object
+void Model::add_object(shared_ptr<Sim_object> object, Object_kind kind)
+{
+    Object_id id = object->get_id();
+    if (size_t(id) >= objects.size()) {
+        objects.resize(names.size());
+        object_kinds.resize(names.size(), Object_kind::none);
+        object_generations.resize(names.size(), 0);
+        in_object_order.resize(names.size(), false);
+    }
+
+    if (kind == Object_kind::island) {
+        island_grid.insert(id, object->get_location());
+        ++num_islands;
+        island_tour.reset();
+    } else {
+        ship_grid.insert(id, object->get_location());
+        ++num_ships;
+    }
+    objects[id] = move(object);
+    object_kinds[id] = kind;
+
+    // an id that is still in the order from an object removed since is already in place
+    if (!in_object_order[id]) {
+        in_object_order[id] = true;
+        new_object_ids.push_back(id);
+        object_order_dirty = true;
+    }
+}
+
+// Sort the pairs of a CPA screen as screen_cpa returns them
+void Model::sort_cpa_pairs(vector<Cpa_pair>& pairs) const
+{
+    sort(pairs.begin(), pairs.end(), [this](const Cpa_pair& pair1, const Cpa_pair& pair2) {
+        if (pair1.time != pair2.time)
+            return pair1.time < pair2.time;
+        if (pair1.range != pair2.range)
+            return pair1.range < pair2.range;
+        if (pair1.id1 != pair2.id1)
+            return names.get_name(pair1.id1) < names.get_name(pair2.id1);
+        return names.get_name(pair1.id2) < names.get_name(pair2.id2);
+    });
+}
+
+// Return the ids of the objects in name order, first merging in the new
+// objects and dropping the removed ones. The Ships removed after that are
+// still there, but their kind is none.
+const vector<Object_id>& Model::get_object_order() const
+{
+    if (!object_order_dirty)
+        return object_order;
+
+    auto drop_removed = [this](vector<Object_id>& ids) {
+        ids.erase(remove_if(ids.begin(), ids.end(), [this](Object_id id) {
+            if (objects[id])
+                return false;
+            in_object_order[id] = false;
+            return true;
+        }), ids.end());
+    };
+    drop_removed(object_order);
+    drop_removed(new_object_ids);
+
+    // the names are all different, so this is a strict order
+    Name_order order{&names};
+    sort(new_object_ids.begin(), new_object_ids.end(), order);
+    size_t num_old = object_order.size();
+    object_order.insert(object_order.end(), new_object_ids.begin(), new_object_ids.end());
+    inplace_merge(object_order.begin(), object_order.begin() + num_old, object_order.end(), order);
+
+    new_object_ids.clear();
+    object_order_dirty = false;
+    return object_order;
+}
+
+// Remove every object
+void Model::clear_objects()
+{
+    objects.assign(objects.size(), nullptr);
+    object_kinds.assign(object_kinds.size(), Object_kind::none);
+    in_object_order.assign(in_object_order.size(), false);
+    num_islands = 0;
+    num_ships = 0;
+    removed_ship_ids.clear();
+    object_order.clear();
+    new_object_ids.clear();
+    object_order_dirty = false;
+    island_grid = Spatial_grid(grid_cell_size, names);
+    ship_grid = Spatial_grid(grid_cell_size, names);
+    island_tour.reset();
+}
+
+// Build group_index and ship_top_groups again from the top groups
+void Model::index_groups()
+{
+    group_index.clear();
+    ship_top_groups.clear();
+    for (const auto& pair : ship_component_map) {
+        const string& top = pair.first;
+        group_index.insert(make_pair(top, Group_entry{pair.second, string(), top}));
+        pair.second->visit_members([this, &top](const shared_ptr<Ship_component>& member, const string& group) {
+            if (Ship* ship_ptr = member->as_ship())
+                ship_top_groups[ship_ptr->get_id()].insert(top);
+            else
+                group_index.insert(make_pair(member->get_name(), Group_entry{member, group, top}));
+        });
+    }
+}
+
+// Take the groups and Ships under group, which is in the hierarchy of top, out of the indexes
+void Model::unindex_members(const Ship_component& group, const string& top)
+{
+    group.visit_members([this, &top](const shared_ptr<Ship_component>& member, const string&) {
+        if (Ship* ship_ptr = member->as_ship())
+            forget_top_group(ship_ptr->get_id(), top);
+        else
+            group_index.erase(member->get_name());
+    });
+}
+
+// The Ship is no longer in the hierarchy of top
+void Model::forget_top_group(Object_id ship_id, const string& top)
+{
+    auto it = ship_top_groups.find(ship_id);
+    if (it == ship_top_groups.end())
+        return;
+    it->second.erase(top);
+    if (it->second.empty())
+        ship_top_groups.erase(it);
 }
 
-// for Singleton
+// The Model that the interactive Controller works on
 Model& Model::get_instance()
 {
     static Model the_model;
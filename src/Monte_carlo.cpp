@@ -0,0 +1,191 @@
+#include "Monte_carlo.h"
+#include "Command_reader.h"
+#include "Controller.h"
+#include "Island.h"
+#include "Logger.h"
+#include "Ship.h"
+#include "Thread_pool.h"
+#include "Utility.h"
+#include <algorithm>
+#include <exception>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <random>
+#include <sstream>
+#include <utility>
+
+using namespace std;
+
+// How far from an Island the Ships of a random scenario are placed, in nm
+const double scenario_spread = 15.;
+
+// Return the commands of a random scenario for the world of model
+static string make_random_scenario(const Model& model, int num_ships, unsigned int seed)
+{
+    static const char* const ship_types[] = {"Cruiser", "Torpedo_boat", "Tanker", "Cruise_ship", "Chain_ship"};
+
+    mt19937 generator(seed);
+    auto pick = [&generator](size_t count) { return uniform_int_distribution<size_t>(0, count - 1)(generator); };
+    uniform_real_distribution<double> offset(-scenario_spread, scenario_spread);
+    uniform_real_distribution<double> cruise_speed(5., 15.);
+
+    vector<shared_ptr<Island>> islands = model.get_islands();
+    vector<string> ship_names;
+    for (const auto& ship_ptr : model.get_ships())
+        ship_names.push_back(ship_ptr->get_name());
+
+    ostringstream commands;
+    commands.setf(ios::fixed, ios::floatfield);
+    commands.precision(2);
+
+    vector<pair<string, string>> new_ships;  // name and type
+    for (int i = 0; i < num_ships; ++i) {
+        string name = "R" + to_string(i);
+        string type = ship_types[pick(size(ship_types))];
+        Point location = islands[pick(islands.size())]->get_location();
+        commands << "create " << name << " " << type << " " << location.x + offset(generator) << " "
+                 << location.y + offset(generator) << "\n";
+        new_ships.push_back(make_pair(name, type));
+        ship_names.push_back(name);
+    }
+
+    // Another Ship than the named one
+    auto pick_other_ship = [&](const string& name) {
+        string other;
+        do
+            other = ship_names[pick(ship_names.size())];
+        while (other == name);
+        return other;
+    };
+
+    for (const auto& new_ship : new_ships) {
+        const string& name = new_ship.first;
+        const string& type = new_ship.second;
+        if (type == "Tanker") {
+            size_t load = pick(islands.size());
+            size_t unload = (load + 1 + pick(islands.size() - 1)) % islands.size();
+            commands << name << " load_at " << islands[load]->get_name() << "\n";
+            commands << name << " unload_at " << islands[unload]->get_name() << "\n";
+        } else if (type == "Cruise_ship") {
+            commands << name << " destination " << islands[pick(islands.size())]->get_name() << " "
+                     << cruise_speed(generator) << "\n";
+        } else if (type == "Chain_ship") {
+            commands << name << " chain " << pick_other_ship(name) << "\n";
+        } else {
+            commands << name << " attack " << pick_other_ship(name) << "\n";
+        }
+    }
+    return commands.str();
+}
+
+// Run world number run, with the script text if there is one, and return how it turned out
+static Run_outcome run_world(const Monte_carlo_settings& settings, const string* script, int run)
+{
+    Run_outcome outcome{};
+    try {
+        Model model;
+        Controller controller(model, true);
+
+        string text = script ? *script : make_random_scenario(model, settings.num_ships, settings.seed + run);
+        istringstream commands(text);
+        Stream_reader command_reader(commands);
+        outcome.failed_commands = controller.run_batch(command_reader);
+
+        if (settings.num_ticks > 0) {
+            istringstream go_command("go " + to_string(settings.num_ticks) + "\n");
+            Stream_reader go_reader(go_command);
+            outcome.failed_commands += controller.run_batch(go_reader);
+        }
+
+        outcome.time = model.get_time();
+        outcome.ships_afloat = model.get_num_ships();
+        outcome.statistics = model.get_statistics();
+        outcome.completed = true;
+    } catch (exception&) {
+        outcome.completed = false;
+    }
+    return outcome;
+}
+
+// Run the worlds and return their outcomes, in the order of the worlds.
+// Throws Error if a script cannot be read.
+vector<Run_outcome> run_monte_carlo(const Monte_carlo_settings& settings)
+{
+    // Every world that runs a script gets it from here
+    vector<string> scripts;
+    for (const auto& filename : settings.scripts) {
+        ifstream file(filename);
+        if (!file)
+            throw Error("Cannot open script file!");
+        scripts.emplace_back(istreambuf_iterator<char>(file), istreambuf_iterator<char>());
+        if (file.bad())
+            throw Error("Cannot read script file!");
+    }
+
+    for (int category = 0; category < num_log_categories; ++category)
+        Logger::get_instance().set_category_enabled(static_cast<Log_category>(category), false);
+
+    vector<Run_outcome> outcomes(settings.num_runs);
+    Thread_pool::get_instance().parallel_for(outcomes.size(), [&](size_t begin, size_t end) {
+        for (size_t run = begin; run < end; ++run) {
+            const string* script = scripts.empty() ? nullptr : &scripts[run % scripts.size()];
+            outcomes[run] = run_world(settings, script, static_cast<int>(run));
+        }
+    });
+    return outcomes;
+}
+
+// Output a line of the report: the mean, minimum, and maximum of the values
+static void report_line(const char* label, const vector<double>& values)
+{
+    cout << setw(20) << left << label << right;
+    if (values.empty()) {
+        cout << setw(12) << "-" << setw(12) << "-" << setw(12) << "-" << endl;
+        return;
+    }
+
+    double sum = 0.;
+    for (double value : values)
+        sum += value;
+    cout << setw(12) << sum / values.size() << setw(12) << *min_element(values.begin(), values.end()) << setw(12)
+         << *max_element(values.begin(), values.end()) << endl;
+}
+
+// Output the mean, minimum, and maximum of the outcomes over the runs to cout
+void report_monte_carlo(const vector<Run_outcome>& outcomes)
+{
+    vector<double> times, fuel_delivered, ships_sunk, ships_afloat, cruises_finished, cruise_finish_times;
+    vector<double> failed_commands;
+    int num_stopped = 0;
+    for (const auto& outcome : outcomes) {
+        if (!outcome.completed) {
+            ++num_stopped;
+            continue;
+        }
+        times.push_back(outcome.time);
+        fuel_delivered.push_back(outcome.statistics.fuel_delivered);
+        ships_sunk.push_back(outcome.statistics.ships_sunk);
+        ships_afloat.push_back(outcome.ships_afloat);
+        cruises_finished.push_back(outcome.statistics.cruises_finished);
+        // only the runs in which a cruise finished have a finish time
+        if (outcome.statistics.cruises_finished > 0)
+            cruise_finish_times.push_back(
+                double(outcome.statistics.total_cruise_finish_time) / outcome.statistics.cruises_finished);
+        failed_commands.push_back(outcome.failed_commands);
+    }
+
+    cout << outcomes.size() << " runs";
+    if (num_stopped > 0)
+        cout << ", " << num_stopped << " stopped by an unexpected error";
+    cout << endl;
+    cout << setw(20) << "" << setw(12) << "mean" << setw(12) << "min" << setw(12) << "max" << endl;
+    report_line("time", times);
+    report_line("fuel delivered", fuel_delivered);
+    report_line("ships sunk", ships_sunk);
+    report_line("ships afloat", ships_afloat);
+    report_line("cruises finished", cruises_finished);
+    report_line("cruise finish time", cruise_finish_times);
+    report_line("failed commands", failed_commands);
+}
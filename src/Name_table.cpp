@@ -0,0 +1,70 @@
+#include "Name_table.h"
+#include <functional>
+
+using namespace std;
+
+// The number of slots the table starts with
+const size_t initial_num_slots = 64;
+
+// Return the id of name, giving it the next one if it has none yet
+Object_id Name_table::intern(const string& name)
+{
+    size_t hash = std::hash<string_view>()(name);
+    size_t slot = 0;
+    if (!slots.empty()) {
+        slot = find_slot(name, hash);
+        if (slots[slot].id != no_object_id)
+            return slots[slot].id;
+    }
+
+    // keep the table at most half full
+    if (2 * (names.size() + 1) > slots.size()) {
+        grow();
+        slot = find_slot(name, hash);
+    }
+
+    Object_id id = size();
+    names.push_back(name);
+    slots[slot] = Slot{id, uint32_t(hash)};
+    return id;
+}
+
+// Return the id of name, or no_object_id if it has none
+Object_id Name_table::find(string_view name) const
+{
+    if (slots.empty())
+        return no_object_id;
+    return slots[find_slot(name, std::hash<string_view>()(name))].id;
+}
+
+// Return the slot that holds name, or the empty slot where it would go; there must be slots
+size_t Name_table::find_slot(string_view name, size_t hash) const
+{
+    size_t mask = slots.size() - 1;
+    for (size_t slot = hash & mask;; slot = (slot + 1) & mask) {
+        const Slot& candidate = slots[slot];
+        if (candidate.id == no_object_id)
+            return slot;
+        if (candidate.hash == uint32_t(hash) && names[candidate.id] == name)
+            return slot;
+    }
+}
+
+// Double the number of slots, or make the first ones
+void Name_table::grow()
+{
+    vector<Slot> old_slots(slots.empty() ? initial_num_slots : 2 * slots.size(), Slot{no_object_id, 0});
+    old_slots.swap(slots);
+
+    size_t mask = slots.size() - 1;
+    for (const Slot& old_slot : old_slots) {
+        if (old_slot.id == no_object_id)
+            continue;
+        // the names are all different, so only an empty slot need be looked for; and the
+        // hash bits kept are enough to place it, as there are never 2^32 slots
+        size_t slot = old_slot.hash & mask;
+        while (slots[slot].id != no_object_id)
+            slot = (slot + 1) & mask;
+        slots[slot] = old_slot;
+    }
+}
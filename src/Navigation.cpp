@@ -169,6 +169,13 @@ ostream& operator<<(ostream& os, const Compass_vector& cv)
 
 // *** Other navigation functions  ***
 
+// Return the Cartesian displacement for moving one nm along a compass course.
+// Scaling it by speed * time gives the same displacement as Course_speed * time.
+Cartesian_vector course_unit_vector(double course)
+{
+    return Cartesian_vector(Polar_vector(1., to_radians(to_other_degrees(course))));
+}
+
 // *** compute_CPA ***
 // Given ownship's course and speed, and the target's course and speed, and bearing and range from ownship,
 // compute the range and bearing of the point of closest approach and the time until the point.
@@ -212,4 +219,47 @@ Compass_position compute_CPA(Course_speed ownship_cs,
         Cartesian_vector future_target_displacement = time_to_CPA * relative_target_motion;
         return Compass_position(Polar_vector(relative_target_position + future_target_displacement));
     }
-}
\ No newline at end of file
+}
+
+// *** compute_intercept ***
+// Given ownship's speed, and the target's course and speed, and bearing and range from ownship,
+// compute the range and bearing of the point at which ownship, heading straight for it at that
+// speed, meets the target soonest if the target holds its course and speed, and the time until then.
+// Return false, leaving intercept_cp and time_to_intercept alone, if ownship can never meet the target.
+
+bool compute_intercept(double ownship_speed,
+    Course_speed target_cs,
+    Compass_position target_position_cp,
+    Compass_position& intercept_cp,
+    double& time_to_intercept)
+{
+    // the target's position relative to ownship, and its motion
+    Cartesian_vector relative_target_position(to_Polar_vector(target_position_cp));
+    Cartesian_vector target_cv(Polar_vector(target_cs.speed, to_radians(to_other_degrees(target_cs.course))));
+
+    // ownship meets the target at the first time t >= 0 at which the target is as far from
+    // ownship's position now as ownship can go: |position + motion * t| = ownship_speed * t,
+    // that is a * t * t + 2 * b * t + c = 0
+    double a = target_cv.delta_x * target_cv.delta_x + target_cv.delta_y * target_cv.delta_y
+        - ownship_speed * ownship_speed;
+    double b = relative_target_position.delta_x * target_cv.delta_x
+        + relative_target_position.delta_y * target_cv.delta_y;
+    double c = relative_target_position.delta_x * relative_target_position.delta_x
+        + relative_target_position.delta_y * relative_target_position.delta_y;
+
+    double t = 0.;
+    if (c > 0.) {
+        // If ownship is no faster than the target (a >= 0), it can only meet a target
+        // that is closing (b < 0). Each root is computed in the form that does not
+        // subtract nearly equal numbers.
+        double discriminant = b * b - a * c;
+        if ((a >= 0. && b >= 0.) || discriminant < 0.)
+            return false;
+        double root = sqrt(discriminant);
+        t = b <= 0. ? c / (root - b) : (b + root) / -a;
+    }
+
+    time_to_intercept = t;
+    intercept_cp = Compass_position(Polar_vector(relative_target_position + t * target_cv));
+    return true;
+}
@@ -0,0 +1,84 @@
+#include "Object_arena.h"
+#include <algorithm>
+#include <new>
+
+using namespace std;
+
+Object_arena::Object_arena()
+    : next_free(nullptr)
+    , bytes_left(0)
+    , next_chunk_size(first_chunk_size)
+    , free_lists(max_block_size / block_alignment + 1, nullptr)
+    , num_blocks(0)
+    , released(false)
+{ }
+
+// Only release deletes the arena
+Object_arena::~Object_arena()
+{
+    for (char* chunk : chunks)
+        ::operator delete(chunk);
+}
+
+// Return a block of at least size bytes
+void* Object_arena::allocate(size_t size)
+{
+    if (size > max_block_size) {
+        void* block = ::operator new(size);
+        ++num_blocks;
+        return block;
+    }
+
+    size_t slot = (size + block_alignment - 1) / block_alignment;
+    size_t block_size = slot * block_alignment;
+    ++num_blocks;
+
+    void*& free_block = free_lists[slot];
+    if (free_block) {
+        void* block = free_block;
+        free_block = *static_cast<void**>(block);
+        return block;
+    }
+
+    if (bytes_left < block_size)
+        add_chunk(block_size);
+    void* block = next_free;
+    next_free += block_size;
+    bytes_left -= block_size;
+    return block;
+}
+
+// Give back a block of size bytes; the arena deletes itself if it has been
+// released and this was its last block
+void Object_arena::deallocate(void* block, size_t size)
+{
+    if (size > max_block_size) {
+        ::operator delete(block);
+    } else {
+        size_t slot = (size + block_alignment - 1) / block_alignment;
+        *static_cast<void**>(block) = free_lists[slot];
+        free_lists[slot] = block;
+    }
+
+    if (--num_blocks == 0 && released)
+        delete this;
+}
+
+// Called by the owner instead of delete: the arena deletes itself now, or
+// when the last block is given back
+void Object_arena::release()
+{
+    released = true;
+    if (num_blocks == 0)
+        delete this;
+}
+
+// Start a new chunk with room for at least size bytes
+void Object_arena::add_chunk(size_t size)
+{
+    size_t chunk_size = max(next_chunk_size, size);
+    chunks.push_back(static_cast<char*>(::operator new(chunk_size)));
+    next_free = chunks.back();
+    bytes_left = chunk_size;
+    next_chunk_size = min(2 * next_chunk_size, max_chunk_size);
+}
@@ -0,0 +1,310 @@
+#include "Profiler.h"
+#include "Utility.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+
+using namespace std;
+
+static const char* const section_names[num_profile_sections] = {"tick",
+    "plan_movement",
+    "update_objects",
+    "advance",
+    "deliver_changes",
+    "apply_changes",
+    "Island::update",
+    "Tanker::update",
+    "Cruiser::update",
+    "Torpedo_boat::update",
+    "Cruise_ship::update",
+    "Chain_ship::update",
+    "command"};
+
+// The name a section is reported under
+const char* get_profile_section_name(Profile_section section)
+{
+    return section_names[static_cast<int>(section)];
+}
+
+/* Profile_histogram */
+
+Profile_histogram::Profile_histogram()
+    : buckets()
+    , count(0)
+    , max(0)
+{ }
+
+void Profile_histogram::add(uint64_t value)
+{
+    ++buckets[get_bucket(value)];
+    ++count;
+    if (value > max)
+        max = value;
+}
+
+void Profile_histogram::merge(const Profile_histogram& other)
+{
+    for (int i = 0; i < num_buckets; ++i)
+        buckets[i] += other.buckets[i];
+    count += other.count;
+    if (other.max > max)
+        max = other.max;
+}
+
+// The largest value in the bucket that holds the fraction p of the values, at most get_max()
+uint64_t Profile_histogram::get_percentile(double p) const
+{
+    if (count == 0)
+        return 0;
+
+    uint64_t rank = std::max(uint64_t(1), uint64_t(ceil(p * count)));
+    uint64_t seen = 0;
+    for (int i = 0; i < num_buckets; ++i) {
+        seen += buckets[i];
+        if (seen >= rank)
+            return min(get_bucket_top(i), max);
+    }
+    return max;
+}
+
+int Profile_histogram::get_bucket(uint64_t value)
+{
+    if (value < 8)
+        return int(value);
+
+#if defined(__GNUC__) || defined(__clang__)
+    int power = 63 - __builtin_clzll(value);
+#else
+    int power = 3;
+    while (value >> (power + 1))
+        ++power;
+#endif
+    int eighth = int(value >> (power - 3)) & 7;
+    return 8 + (power - 3) * 8 + eighth;
+}
+
+uint64_t Profile_histogram::get_bucket_top(int bucket)
+{
+    if (bucket < 8)
+        return uint64_t(bucket);
+
+    int power = (bucket - 8) / 8 + 3;
+    uint64_t eighth = uint64_t((bucket - 8) % 8);
+    return ((8 + eighth) << (power - 3)) + ((uint64_t(1) << (power - 3)) - 1);
+}
+
+/* Profiler */
+
+// A call kept for the trace
+struct Trace_event
+{
+    uint64_t start;
+    uint64_t end;
+    Profile_section section;
+};
+
+// The counts of a tick kept for the trace
+struct Tick_record
+{
+    uint64_t end;
+    uint64_t notifications;
+    uint64_t allocations;
+};
+
+struct Profiler::Thread_data
+{
+    explicit Thread_data(int number_)
+        : number(number_)
+        , num_notifications(0)
+        , last_num_allocations(Profiler::num_allocations.load(memory_order_relaxed))
+        , num_dropped_events(0)
+    { }
+
+    int number;  // the thread's tid in the trace
+    Profile_histogram durations[num_profile_sections];  // in clock units
+
+    // Counts of the tick in progress and of the ticks ended
+    uint64_t num_notifications;
+    uint64_t last_num_allocations;  // Profiler::num_allocations when the last tick ended
+    Profile_histogram notifications_per_tick;
+    Profile_histogram allocations_per_tick;
+
+    vector<Trace_event> events;
+    vector<Tick_record> ticks;
+    uint64_t num_dropped_events;
+};
+
+// The calling thread's data
+thread_local Profiler::Thread_data* Profiler::this_thread_data = nullptr;
+
+atomic<uint64_t> Profiler::num_allocations(0);
+
+Profiler::Profiler()
+    : tracing(false)
+    , start_clock(read_clock())
+    , start_time(chrono::steady_clock::now())
+{ }
+
+// Profiler for the whole program; it is never destroyed, so that any thread
+// may record until the program ends
+Profiler& Profiler::get_instance()
+{
+    static Profiler* the_profiler = new Profiler;
+    return *the_profiler;
+}
+
+// Record a call of section that ran from start to end, in clock units
+void Profiler::record(Profile_section section, uint64_t start, uint64_t end)
+{
+    Thread_data& data = get_thread_data();
+    data.durations[static_cast<int>(section)].add(end - start);
+    if (!tracing.load(memory_order_relaxed))
+        return;
+
+    if (data.events.size() + data.ticks.size() < max_trace_events)
+        data.events.push_back(Trace_event{start, end, section});
+    else
+        ++data.num_dropped_events;
+}
+
+// Count a change recorded for the Views
+void Profiler::count_notification()
+{
+    ++get_thread_data().num_notifications;
+}
+
+// Close the counts of the tick that has just ended
+void Profiler::end_tick()
+{
+    Thread_data& data = get_thread_data();
+    uint64_t allocations_now = num_allocations.load(memory_order_relaxed);
+    uint64_t allocations = allocations_now - data.last_num_allocations;
+    data.notifications_per_tick.add(data.num_notifications);
+    data.allocations_per_tick.add(allocations);
+
+    if (tracing.load(memory_order_relaxed)) {
+        if (data.events.size() + data.ticks.size() < max_trace_events)
+            data.ticks.push_back(Tick_record{read_clock(), data.num_notifications, allocations});
+        else
+            ++data.num_dropped_events;
+    }
+
+    data.num_notifications = 0;
+    data.last_num_allocations = allocations_now;
+}
+
+// Write p50/p99/max of each section that has run, and of the counts per tick
+void Profiler::write_stats(ostream& os)
+{
+    Profile_histogram durations[num_profile_sections];
+    Profile_histogram notifications_per_tick;
+    Profile_histogram allocations_per_tick;
+    {
+        lock_guard<mutex> lock(threads_mutex);
+        for (const auto& data_ptr : threads) {
+            for (int i = 0; i < num_profile_sections; ++i)
+                durations[i].merge(data_ptr->durations[i]);
+            notifications_per_tick.merge(data_ptr->notifications_per_tick);
+            allocations_per_tick.merge(data_ptr->allocations_per_tick);
+        }
+    }
+
+    ios::fmtflags old_flags = os.flags();
+    streamsize old_precision = os.precision();
+    os << fixed << setprecision(2);
+
+    uint64_t num_ticks = notifications_per_tick.get_count();
+    double microseconds_per_unit = get_clock_period() / 1000.;
+    os << "Profile of " << num_ticks << " ticks, times in microseconds" << endl;
+    os << left << setw(22) << "Section" << right << setw(10) << "Calls" << setw(10) << "Per tick" << setw(12)
+       << "p50" << setw(12) << "p99" << setw(12) << "max" << endl;
+    for (int i = 0; i < num_profile_sections; ++i) {
+        const Profile_histogram& histogram = durations[i];
+        if (histogram.get_count() == 0)
+            continue;
+        os << left << setw(22) << section_names[i] << right << setw(10) << histogram.get_count() << setw(10)
+           << (num_ticks ? double(histogram.get_count()) / num_ticks : 0.) << setw(12)
+           << histogram.get_percentile(0.5) * microseconds_per_unit << setw(12)
+           << histogram.get_percentile(0.99) * microseconds_per_unit << setw(12)
+           << histogram.get_max() * microseconds_per_unit << endl;
+    }
+
+    os << left << setw(42) << "Counts per tick" << right << setw(12) << "p50" << setw(12) << "p99" << setw(12)
+       << "max" << endl;
+    for (const auto& row : {make_pair("notifications", &notifications_per_tick),
+             make_pair("allocations", &allocations_per_tick)}) {
+        os << left << setw(42) << row.first << right << setw(12) << row.second->get_percentile(0.5) << setw(12)
+           << row.second->get_percentile(0.99) << setw(12) << row.second->get_max() << endl;
+    }
+
+    os.flags(old_flags);
+    os.precision(old_precision);
+}
+
+// Write the calls kept since tracing started, and the counts of each tick,
+// as a Chrome trace-event file. Throws Error if the file cannot be written.
+void Profiler::write_trace(const string& filename)
+{
+    ofstream file(filename);
+    if (!file)
+        throw Error("Could not open trace file!");
+
+    double microseconds_per_unit = get_clock_period() / 1000.;
+    auto timestamp = [&](uint64_t clock) { return double(clock - start_clock) * microseconds_per_unit; };
+    file << fixed << setprecision(3);
+    file << "{\"traceEvents\":[";
+
+    uint64_t num_dropped_events = 0;
+    bool first = true;
+    lock_guard<mutex> lock(threads_mutex);
+    for (const auto& data_ptr : threads) {
+        const Thread_data& data = *data_ptr;
+        num_dropped_events += data.num_dropped_events;
+
+        file << (first ? "\n" : ",\n");
+        first = false;
+        file << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << data.number
+             << ",\"args\":{\"name\":\"thread " << data.number << "\"}}";
+        for (const Trace_event& event : data.events) {
+            file << ",\n{\"name\":\"" << get_profile_section_name(event.section)
+                 << "\",\"cat\":\"simulation\",\"ph\":\"X\",\"pid\":1,\"tid\":" << data.number
+                 << ",\"ts\":" << timestamp(event.start)
+                 << ",\"dur\":" << double(event.end - event.start) * microseconds_per_unit << "}";
+        }
+        for (const Tick_record& tick : data.ticks) {
+            file << ",\n{\"name\":\"thread " << data.number << " per tick\",\"ph\":\"C\",\"pid\":1,\"tid\":"
+                 << data.number << ",\"ts\":" << timestamp(tick.end)
+                 << ",\"args\":{\"notifications\":" << tick.notifications
+                 << ",\"allocations\":" << tick.allocations << "}}";
+        }
+    }
+    file << "\n],\"displayTimeUnit\":\"ns\",\"otherData\":{\"dropped_events\":\"" << num_dropped_events
+         << "\"}}\n";
+
+    if (!file)
+        throw Error("Could not write trace file!");
+}
+
+// The calling thread's data, made on first use
+Profiler::Thread_data& Profiler::get_thread_data()
+{
+    if (!this_thread_data) {
+        lock_guard<mutex> lock(threads_mutex);
+        threads.emplace_back(new Thread_data(int(threads.size()) + 1));
+        this_thread_data = threads.back().get();
+    }
+    return *this_thread_data;
+}
+
+// Nanoseconds per clock unit, measured over the run so far
+double Profiler::get_clock_period() const
+{
+#ifdef PROFILER_RDTSC
+    uint64_t clock_elapsed = read_clock() - start_clock;
+    chrono::duration<double, nano> time_elapsed = chrono::steady_clock::now() - start_time;
+    return clock_elapsed ? time_elapsed.count() / clock_elapsed : 1.;
+#else
+    return 1.;
+#endif
+}
@@ -0,0 +1,78 @@
+/*
+The operator new of the simulation when the profiler is built in: the same as
+the standard one, but counting every allocation for the Profiler. It is linked
+into the simulation only, as simulation_bench has an operator new of its own.
+*/
+
+#include "Profiler.h"
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+using namespace std;
+
+void* operator new(size_t size)
+{
+    PROFILE_COUNT_ALLOCATION();
+    while (true) {
+        if (void* ptr = malloc(size ? size : 1))
+            return ptr;
+        new_handler handler = get_new_handler();
+        if (!handler)
+            throw bad_alloc();
+        handler();
+    }
+}
+
+void* operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void* operator new(size_t size, const nothrow_t&) noexcept
+{
+    try {
+        return operator new(size);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void* operator new[](size_t size, const nothrow_t&) noexcept
+{
+    try {
+        return operator new(size);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void operator delete(void* ptr) noexcept
+{
+    free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept
+{
+    free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept
+{
+    free(ptr);
+}
+
+void operator delete[](void* ptr, size_t) noexcept
+{
+    free(ptr);
+}
+
+void operator delete(void* ptr, const nothrow_t&) noexcept
+{
+    free(ptr);
+}
+
+void operator delete[](void* ptr, const nothrow_t&) noexcept
+{
+    free(ptr);
+}
@@ -1,20 +1,28 @@
 #include "Sailing_view.h"
+#include <algorithm>
 #include <iostream>
 #include <iomanip>
+#include <vector>
 
 using namespace std;
 
 // Print Sailing data for all Ships.
-void Sailing_view::draw()
+void Sailing_view::draw(ostream& os)
 {
-    cout << "----- Sailing Data -----" << endl;
-    cout << "      Ship      Fuel    Course     Speed" << endl;
+    os << "----- Sailing Data -----" << endl;
+    os << "      Ship      Fuel    Course     Speed" << endl;
 
-    std::map<std::string, Ship_info> ship_info = get_ship_info_map();
-    for (const auto& info_pair : ship_info) {
-        cout << setw(10) << info_pair.first;
-        cout << setw(10) << info_pair.second.fuel;
-        cout << setw(10) << info_pair.second.course;
-        cout << setw(10) << info_pair.second.speed << endl;
+    // The Ships are listed in order of name
+    vector<const Object_info*> ships;
+    for (const Object_info& object : get_objects())
+        if (object.has_ship_info)
+            ships.push_back(&object);
+    sort(ships.begin(), ships.end(), [](const Object_info* a, const Object_info* b) { return a->name < b->name; });
+
+    for (const Object_info* ship : ships) {
+        os << setw(10) << ship->name;
+        os << setw(10) << ship->ship_info.fuel;
+        os << setw(10) << ship->ship_info.course;
+        os << setw(10) << ship->ship_info.speed << endl;
     }
 }
\ No newline at end of file
@@ -8,6 +8,8 @@ are defining it just to get the destructor message output.
 */
 
 #include "Ship.h"
+#include "Checkpoint.h"
+#include "Logger.h"
 #include "Model.h"
 #include "Island.h"
 #include "Utility.h"
@@ -16,22 +18,27 @@ are defining it just to get the destructor message output.
 using namespace std;
 
 // initialize, then output constructor message
-Ship::Ship(const string& name_,
+Ship::Ship(Model& model_,
+    const string& name_,
     Point position_,
     double fuel_capacity_,
     double maximum_speed_,
     double fuel_consumption_,
     int resistance_)
-    : Sim_object(name_)
-    , fuel(fuel_capacity_)
+    : Sim_object(model_, name_)
+    , store(model_.get_ship_store())
+    , store_index(store.add(position_, fuel_capacity_, fuel_consumption_))
     , fuel_capacity(fuel_capacity_)
     , maximum_speed(maximum_speed_)
-    , fuel_consumption(fuel_consumption_)
     , resistance(resistance_)
-    , tracker(position_)
-    , ship_state(State::stopped)
 { }
 
+// Give this Ship's slot in the Ship_store back
+Ship::~Ship()
+{
+    store.remove(store_index);
+}
+
 string Ship::get_name() const
 {
     return Sim_object::get_name();
@@ -47,10 +54,10 @@ void Ship::describe_component() const
     cout << get_name() << endl;
 }
 
-// Check if ship is equal to this Ship
-bool Ship::check_if_ship_exists(const string& ship) const
+// Add this Ship to a checkpoint's group at index parent
+void Ship::save_group(Checkpoint_writer& writer, int parent) const
 {
-    return ship == get_name();
+    writer.add_group_member(parent, this);
 }
 
 /*** Readers ***/
@@ -58,42 +65,110 @@ bool Ship::check_if_ship_exists(const string& ship) const
 // (it is not dead in the water or in the process or sinking);
 bool Ship::can_move() const
 {
-    return ship_state != State::sunk && ship_state != State::dead_in_the_water;
+    return get_state() != State::sunk && get_state() != State::dead_in_the_water;
 }
 
 // Return true if ship is moving
 bool Ship::is_moving() const
 {
-    return ship_state == State::moving_to_position || ship_state == State::moving_to_island
-        || ship_state == State::moving_on_course;
+    return get_state() == State::moving_to_position || get_state() == State::moving_to_island
+        || get_state() == State::moving_on_course;
 }
 
 // Return true if ship is docked
 bool Ship::is_docked() const
 {
-    return ship_state == State::docked;
+    return get_state() == State::docked;
 }
 
 // Return true if ship is afloat (not in process of sinking), false if not
 bool Ship::is_afloat() const
 {
-    return ship_state != State::sunk;
+    return get_state() != State::sunk;
 }
 
 // Return true if the ship is Stopped and the distance to the supplied island
 // is less than or equal to 0.1 nm
 bool Ship::can_dock(shared_ptr<Island> island_ptr) const
 {
-    return ship_state == State::stopped && cartesian_distance(get_location(), island_ptr->get_location()) <= 0.1;
+    return get_state() == State::stopped && cartesian_distance(get_location(), island_ptr->get_location()) <= 0.1;
+}
+
+/*** Command checks ***/
+// Each returns the message of the Error that the command would throw before
+// doing anything, or nullptr if it would not throw then. Only this Ship's own
+// state is read, so that many Ships can be checked concurrently.
+
+// for set_destination_position_and_speed, set_destination_island_and_speed, and set_course_and_speed
+const char* Ship::check_move(double speed) const
+{
+    if (!can_move())
+        return "Ship cannot move!";
+    if (speed > maximum_speed)
+        return "Ship cannot go that fast!";
+    return nullptr;
+}
+
+const char* Ship::check_stop() const
+{
+    if (get_state() == State::dead_in_the_water || !is_afloat())
+        return "Ship cannot move!";
+    return nullptr;
+}
+
+const char* Ship::check_dock(shared_ptr<Island> island_ptr) const
+{
+    return can_dock(island_ptr) ? nullptr : "Can't dock!";
+}
+
+const char* Ship::check_refuel() const
+{
+    return get_state() == State::docked ? nullptr : "Must be docked!";
+}
+
+// A Ship without the capability for a command fails these with the message of its fat interface function
+const char* Ship::check_chain_all() const
+{
+    return get_capabilities() & can_chain ? nullptr : "Cannot chain Ship!";
+}
+
+const char* Ship::check_chain(shared_ptr<Ship>) const
+{
+    return get_capabilities() & can_chain ? nullptr : "Cannot chain Ship!";
+}
+
+const char* Ship::check_unchain(shared_ptr<Ship>) const
+{
+    return get_capabilities() & can_chain ? nullptr : "Cannot drop Ship!";
+}
+
+const char* Ship::check_load_destination() const
+{
+    return get_capabilities() & can_load ? nullptr : "Cannot load at a destination!";
+}
+
+const char* Ship::check_unload_destination() const
+{
+    return get_capabilities() & can_load ? nullptr : "Cannot unload at a destination!";
+}
+
+const char* Ship::check_attack(shared_ptr<Ship>) const
+{
+    return get_capabilities() & can_attack ? nullptr : "Cannot attack!";
+}
+
+const char* Ship::check_stop_attack() const
+{
+    return get_capabilities() & can_attack ? nullptr : "Cannot attack!";
 }
 
 /*** Interface to derived classes ***/
 // Update the state of the Ship according to its current state.
 void Ship::update()
 {
-    switch (ship_state) {
+    switch (get_state()) {
     case State::sunk:
-        cout << get_name() << " sunk" << endl;
+        LOG(Log_level::warning, Log_category::combat) << get_name() << " sunk";
         break;
 
     // If this Ship is moving, calculate_movement() to
@@ -103,54 +178,80 @@ void Ship::update()
     case State::moving_to_island:
     case State::moving_to_position:
         calculate_movement();
-        cout << get_name() << " now at " << get_location() << endl;
+        LOG(Log_level::info, Log_category::movement) << get_name() << " now at " << get_location();
 
-        Model::get_instance().notify_location(get_name(), get_location());
-        Model::get_instance().notify_view_about_ship_fuel(get_name(), fuel);
-        Model::get_instance().notify_view_about_ship_course(get_name(), tracker.get_course());
-        Model::get_instance().notify_view_about_ship_speed(get_name(), tracker.get_speed());
+        get_model().notify_ship_movement(
+            get_id(), get_location(), get_fuel(), store.get_course(store_index), store.get_speed(store_index));
 
         break;
 
     case State::stopped:
-        cout << get_name() << " stopped at " << get_location() << endl;
+        LOG(Log_level::info, Log_category::movement) << get_name() << " stopped at " << get_location();
         break;
 
     case State::docked:
-        cout << get_name() << " docked at " << docked_island->get_name() << endl;
+        LOG(Log_level::info, Log_category::docking) << get_name() << " docked at " << docked_island->get_name();
         break;
 
     case State::dead_in_the_water:
-        cout << get_name() << " dead in the water at " << get_location() << endl;
+        LOG(Log_level::warning, Log_category::fuel) << get_name() << " dead in the water at " << get_location();
         break;
 
     default:
         throw Error("Unrecognized state!");
     }
 }
+// A moving Ship can skip the steps before it arrives or runs out of fuel;
+// a Ship that is not moving has nothing to do.
+int Ship::ticks_until_event() const
+{
+    if (is_moving())
+        return store.get_ticks_until_stop(store_index);
+    return no_event;
+}
+
+// arrive_at or fuel_empty
+Event_type Ship::get_event_type() const
+{
+    if (!is_moving())
+        return Event_type::state_change;
+    return store.will_arrive(store_index) ? Event_type::arrive_at : Event_type::fuel_empty;
+}
+
+// Move ticks steps at once and notify Model of the new location and fuel
+void Ship::advance(int ticks)
+{
+    if (!is_moving())
+        return;
+
+    store.advance(store_index, ticks);
+    get_model().notify_location(get_id(), get_location());
+    get_model().notify_view_about_ship_fuel(get_id(), get_fuel());
+}
+
 // output a description of current state to cout
 void Ship::describe() const
 {
     cout << get_name() << " at " << get_location();
 
-    if (ship_state == State::sunk) {
+    if (get_state() == State::sunk) {
         cout << " sunk" << endl;
         return;
     }
 
-    cout << ", fuel: " << fuel << " tons, resistance: " << resistance << endl;
+    cout << ", fuel: " << get_fuel() << " tons, resistance: " << resistance << endl;
 
     // Output messages accordingly to this Ship's
     // state.
-    switch (ship_state) {
+    switch (get_state()) {
     case State::moving_to_position:
-        cout << "Moving to " << destination_point << " on " << tracker.get_course_speed() << endl;
+        cout << "Moving to " << store.get_destination(store_index) << " on " << store.get_course_speed(store_index) << endl;
         break;
     case State::moving_to_island:
-        cout << "Moving to " << destination_Island->get_name() << " on " << tracker.get_course_speed() << endl;
+        cout << "Moving to " << destination_Island->get_name() << " on " << store.get_course_speed(store_index) << endl;
         break;
     case State::moving_on_course:
-        cout << "Moving on " << tracker.get_course_speed() << endl;
+        cout << "Moving on " << store.get_course_speed(store_index) << endl;
         break;
     case State::docked:
         cout << "Docked at " << docked_island->get_name() << endl;
@@ -169,28 +270,28 @@ void Ship::describe() const
 // Notify Model about this Ship's name and location.
 void Ship::broadcast_current_state() const
 {
-    Model::get_instance().notify_location(get_name(), get_location());
+    get_model().notify_location(get_id(), get_location());
 }
 
 // Notify Model about this Ship's name, fuel, course, speed, and whether it is
 // afloat or now.
 void Ship::broadcast_ship_fuel() const
 {
-    Model::get_instance().notify_view_about_ship_fuel(get_name(), fuel);
+    get_model().notify_view_about_ship_fuel(get_id(), get_fuel());
 }
 
 // Notify Model about this Ship's name, fuel, course, speed, and whether it is
 // afloat or now.
 void Ship::broadcast_ship_course() const
 {
-    Model::get_instance().notify_view_about_ship_course(get_name(), tracker.get_course());
+    get_model().notify_view_about_ship_course(get_id(), store.get_course(store_index));
 }
 
 // Notify Model about this Ship's name, fuel, course, speed, and whether it is
 // afloat or now.
 void Ship::broadcast_ship_speed() const
 {
-    Model::get_instance().notify_view_about_ship_speed(get_name(), tracker.get_speed());
+    get_model().notify_view_about_ship_speed(get_id(), store.get_speed(store_index));
 }
 
 /*** Command functions ***/
@@ -199,17 +300,14 @@ void Ship::broadcast_ship_speed() const
 // may throw Error("Ship cannot go that fast!")
 void Ship::set_destination_position_and_speed(Point destination_position, double speed)
 {
-    if (!can_move())
-        throw Error("Ship cannot move!");
-
-    if (speed > maximum_speed)
-        throw Error("Ship cannot go that fast!");
+    if (const char* failure = Ship::check_move(speed))
+        throw Error(failure);
 
     // Create Compass_vector with this Ship's location and
     // destination_position to get the Ship's direction.
     Compass_vector vec(get_location(), destination_position);
-    tracker.set_course(vec.direction);
-    tracker.set_speed(speed);
+    store.set_course(store_index, vec.direction);
+    store.set_speed(store_index, speed);
 
     // No longer docked, and this Ship is no longer
     // going to an Island, so reset docked_island and
@@ -218,12 +316,15 @@ void Ship::set_destination_position_and_speed(Point destination_position, double
         docked_island = nullptr;
 
     destination_Island = nullptr;
-    destination_point = destination_position;
-    ship_state = State::moving_to_position;
-
-    cout << get_name() << " will sail on " << tracker.get_course_speed() << " to " << destination_position << endl;
-    Model::get_instance().notify_view_about_ship_course(get_name(), tracker.get_course());
-    Model::get_instance().notify_view_about_ship_speed(get_name(), tracker.get_speed());
+    store.set_destination(store_index, destination_position);
+    store.set_state(store_index, State::moving_to_position);
+
+    LOG(Log_level::info, Log_category::movement) << get_name() << " will sail on "
+                                                 << store.get_course_speed(store_index) << " to "
+                                                 << destination_position;
+    get_model().notify_view_about_ship_course(get_id(), store.get_course(store_index));
+    get_model().notify_view_about_ship_speed(get_id(), store.get_speed(store_index));
+    get_model().reschedule(get_id());
 }
 
 // Start moving to a destination Island at a speed
@@ -231,17 +332,14 @@ void Ship::set_destination_position_and_speed(Point destination_position, double
 // may throw Error("Ship cannot go that fast!")
 void Ship::set_destination_island_and_speed(shared_ptr<Island> destination_island, double speed)
 {
-    if (!can_move())
-        throw Error("Ship cannot move!");
-
-    if (speed > maximum_speed)
-        throw Error("Ship cannot go that fast!");
+    if (const char* failure = Ship::check_move(speed))
+        throw Error(failure);
 
     // Create Compass_vector with this Ship's location and
     // destination_position to get the Ship's direction.
     Compass_vector vec(get_location(), destination_island->get_location());
-    tracker.set_course(vec.direction);
-    tracker.set_speed(speed);
+    store.set_course(store_index, vec.direction);
+    store.set_speed(store_index, speed);
 
     // Reset docked_island because this Ship is no longer
     // docked.
@@ -249,14 +347,16 @@ void Ship::set_destination_island_and_speed(shared_ptr<Island> destination_islan
         docked_island = nullptr;
 
     destination_Island = destination_island;
-    ship_state = State::moving_to_island;
-    destination_point = destination_island->get_location();
+    store.set_state(store_index, State::moving_to_island);
+    store.set_destination(store_index, destination_island->get_location());
 
-    cout << get_name() << " will sail on " << tracker.get_course_speed() << " to " << destination_island->get_name()
-         << endl;
+    LOG(Log_level::info, Log_category::movement) << get_name() << " will sail on "
+                                                 << store.get_course_speed(store_index) << " to "
+                                                 << destination_island->get_name();
 
-    Model::get_instance().notify_view_about_ship_course(get_name(), tracker.get_course());
-    Model::get_instance().notify_view_about_ship_speed(get_name(), tracker.get_speed());
+    get_model().notify_view_about_ship_course(get_id(), store.get_course(store_index));
+    get_model().notify_view_about_ship_speed(get_id(), store.get_speed(store_index));
+    get_model().reschedule(get_id());
 }
 
 // Start moving on a course and speed
@@ -264,14 +364,11 @@ void Ship::set_destination_island_and_speed(shared_ptr<Island> destination_islan
 // may throw Error("Ship cannot go that fast!");
 void Ship::set_course_and_speed(double course, double speed)
 {
-    if (!can_move())
-        throw Error("Ship cannot move!");
-
-    if (speed > maximum_speed)
-        throw Error("Ship cannot go that fast!");
+    if (const char* failure = Ship::check_move(speed))
+        throw Error(failure);
 
-    tracker.set_course(course);
-    tracker.set_speed(speed);
+    store.set_course(store_index, course);
+    store.set_speed(store_index, speed);
 
     // No longer docked, and this Ship is no longer
     // going to an Island, so reset docked_island and
@@ -280,25 +377,28 @@ void Ship::set_course_and_speed(double course, double speed)
         docked_island = nullptr;
 
     destination_Island = nullptr;
-    ship_state = State::moving_on_course;
+    store.set_state(store_index, State::moving_on_course);
 
-    cout << get_name() << " will sail on " << tracker.get_course_speed() << endl;
-    Model::get_instance().notify_view_about_ship_course(get_name(), tracker.get_course());
-    Model::get_instance().notify_view_about_ship_speed(get_name(), tracker.get_speed());
+    LOG(Log_level::info, Log_category::movement) << get_name() << " will sail on "
+                                                 << store.get_course_speed(store_index);
+    get_model().notify_view_about_ship_course(get_id(), store.get_course(store_index));
+    get_model().notify_view_about_ship_speed(get_id(), store.get_speed(store_index));
+    get_model().reschedule(get_id());
 }
 
 // Stop moving
 // may throw Error("Ship cannot move!");
 void Ship::stop()
 {
-    if (ship_state == State::dead_in_the_water || !is_afloat())
-        throw Error("Ship cannot move!");
+    if (const char* failure = Ship::check_stop())
+        throw Error(failure);
 
-    tracker.set_speed(0);
-    cout << get_name() << " stopping at " << get_location() << endl;
-    ship_state = State::stopped;
-    Model::get_instance().notify_view_about_ship_course(get_name(), tracker.get_course());
-    Model::get_instance().notify_view_about_ship_speed(get_name(), tracker.get_speed());
+    store.set_speed(store_index, 0);
+    LOG(Log_level::info, Log_category::movement) << get_name() << " stopping at " << get_location();
+    store.set_state(store_index, State::stopped);
+    get_model().notify_view_about_ship_course(get_id(), store.get_course(store_index));
+    get_model().notify_view_about_ship_speed(get_id(), store.get_speed(store_index));
+    get_model().reschedule(get_id());
 }
 
 // dock at an Island - set our position = Island's position,
@@ -308,38 +408,39 @@ void Ship::dock(shared_ptr<Island> island_ptr)
     // If this Ship is not stopped or if the distance from its location
     // and the island_ptr's location is greater than 0.1, the Ship cannot
     // dock, so throw an Error.
-    if (ship_state != State::stopped || cartesian_distance(get_location(), island_ptr->get_location()) > 0.1)
-        throw Error("Can't dock!");
+    if (const char* failure = check_dock(island_ptr))
+        throw Error(failure);
 
-    tracker.set_position(island_ptr->get_location());
-    Model::get_instance().notify_location(get_name(), get_location());
+    store.set_position(store_index, island_ptr->get_location());
+    get_model().notify_location(get_id(), get_location());
     docked_island = island_ptr;
-    ship_state = State::docked;
+    store.set_state(store_index, State::docked);
 
-    cout << get_name() << " docked at " << island_ptr->get_name() << endl;
+    LOG(Log_level::info, Log_category::docking) << get_name() << " docked at " << island_ptr->get_name();
+    get_model().reschedule(get_id());
 }
 
 // Refuel - must already be docked at an island; fill takes as much as possible
 // may throw Error("Must be docked!");
 void Ship::refuel()
 {
-    if (ship_state != State::docked)
-        throw Error("Must be docked!");
+    if (const char* failure = check_refuel())
+        throw Error(failure);
 
     // Calculate amount needed and if it is less than 0.005,
     // completely refuel it to the capacity.
-    double fuel_needed = fuel_capacity - fuel;
+    double fuel_needed = fuel_capacity - get_fuel();
 
     if (fuel_needed < 0.005) {
-        fuel = fuel_capacity;
-        Model::get_instance().notify_view_about_ship_fuel(get_name(), fuel);
+        store.set_fuel(store_index, fuel_capacity);
+        get_model().notify_view_about_ship_fuel(get_id(), get_fuel());
         return;
     }
 
     // Otherwise, ask the docked_island for the fuel_needed.
-    fuel += docked_island->provide_fuel(fuel_needed);
-    cout << get_name() << " now has " << fuel << " tons of fuel" << endl;
-    Model::get_instance().notify_view_about_ship_fuel(get_name(), fuel);
+    store.set_fuel(store_index, get_fuel() + docked_island->provide_fuel(fuel_needed));
+    LOG(Log_level::info, Log_category::fuel) << get_name() << " now has " << get_fuel() << " tons of fuel";
+    get_model().notify_view_about_ship_fuel(get_id(), get_fuel());
 }
 
 /*** Fat interface command functions ***/
@@ -381,21 +482,128 @@ void Ship::stop_attack()
     throw Error("Cannot attack!");
 }
 
+/*** Non-throwing command functions ***/
+// Give a command whose check passed, and return the message of the Error
+// it throws part way through, or nullptr if it was carried out
+template <typename Command>
+static const char* carry_out(Command command)
+{
+    try {
+        command();
+        return nullptr;
+    } catch (Error& error) {
+        return error.what();
+    }
+}
+
+const char* Ship::try_set_destination_position_and_speed(Point destination_position, double speed)
+{
+    if (const char* failure = check_move(speed))
+        return failure;
+    return carry_out([&] { set_destination_position_and_speed(destination_position, speed); });
+}
+
+const char* Ship::try_set_destination_island_and_speed(shared_ptr<Island> destination_island, double speed)
+{
+    if (const char* failure = check_move(speed))
+        return failure;
+    return carry_out([&] { set_destination_island_and_speed(destination_island, speed); });
+}
+
+const char* Ship::try_set_course_and_speed(double course, double speed)
+{
+    if (const char* failure = check_move(speed))
+        return failure;
+    return carry_out([&] { set_course_and_speed(course, speed); });
+}
+
+const char* Ship::try_stop()
+{
+    if (const char* failure = check_stop())
+        return failure;
+    return carry_out([&] { stop(); });
+}
+
+const char* Ship::try_dock(shared_ptr<Island> island_ptr)
+{
+    if (const char* failure = check_dock(island_ptr))
+        return failure;
+    return carry_out([&] { dock(island_ptr); });
+}
+
+const char* Ship::try_refuel()
+{
+    if (const char* failure = check_refuel())
+        return failure;
+    return carry_out([&] { refuel(); });
+}
+
+const char* Ship::try_chain_all_ship()
+{
+    if (const char* failure = check_chain_all())
+        return failure;
+    return carry_out([&] { chain_all_ship(); });
+}
+
+const char* Ship::try_chain_ship(shared_ptr<Ship> target)
+{
+    if (const char* failure = check_chain(target))
+        return failure;
+    return carry_out([&] { chain_ship(target); });
+}
+
+const char* Ship::try_unchain_ship(shared_ptr<Ship> target)
+{
+    if (const char* failure = check_unchain(target))
+        return failure;
+    return carry_out([&] { unchain_ship(target); });
+}
+
+const char* Ship::try_set_load_destination(shared_ptr<Island> island_ptr)
+{
+    if (const char* failure = check_load_destination())
+        return failure;
+    return carry_out([&] { set_load_destination(island_ptr); });
+}
+
+const char* Ship::try_set_unload_destination(shared_ptr<Island> island_ptr)
+{
+    if (const char* failure = check_unload_destination())
+        return failure;
+    return carry_out([&] { set_unload_destination(island_ptr); });
+}
+
+const char* Ship::try_attack(shared_ptr<Ship> target)
+{
+    if (const char* failure = check_attack(target))
+        return failure;
+    return carry_out([&] { attack(target); });
+}
+
+const char* Ship::try_stop_attack()
+{
+    if (const char* failure = check_stop_attack())
+        return failure;
+    return carry_out([&] { stop_attack(); });
+}
+
 // interactions with other objects
 // receive a hit from an attacker
 void Ship::receive_hit(int hit_force, shared_ptr<Ship> attacker_ptr)
 {
+    get_model().reschedule(get_id());
     resistance -= hit_force;
-    cout << get_name() << " hit with " << hit_force << ", resistance now " << resistance << endl;
+    LOG(Log_level::info, Log_category::combat) << get_name() << " hit with " << hit_force << ", resistance now "
+                                               << resistance;
 
     // If this Ship's resistance is less than 0, and it
     // is still floating, it starts sinking with speed 0.
     if (resistance < 0) {
-        ship_state = State::sunk;
-        cout << get_name() << " sunk" << endl;
-        tracker.set_speed(0.0);
-        Model::get_instance().notify_gone(get_name());
-        Model::get_instance().remove_ship(shared_from_this());
+        store.set_state(store_index, State::sunk);
+        LOG(Log_level::warning, Log_category::combat) << get_name() << " sunk";
+        store.set_speed(store_index, 0.0);
+        get_model().notify_gone(get_id());
+        get_model().remove_ship(*this);
     }
 }
 
@@ -414,6 +622,46 @@ shared_ptr<Island> Ship::get_destination_Island() const
     return destination_Island;
 }
 
+// Return the part of a checkpoint record that every Ship has
+Ship_record Ship::make_ship_record(Checkpoint_writer& writer) const
+{
+    Ship_record record{};
+    Point position = get_location();
+    record.x = position.x;
+    record.y = position.y;
+    record.course = store.get_course(store_index);
+    record.speed = store.get_speed(store_index);
+    record.fuel = get_fuel();
+    Point destination = store.get_destination(store_index);
+    record.destination_x = destination.x;
+    record.destination_y = destination.y;
+    record.name = writer.get_id(get_name());
+    record.number = writer.add_ship(this);
+    record.resistance = resistance;
+    record.destination_island = writer.get_island_id(destination_Island.get());
+    record.docked_island = writer.get_island_id(docked_island.get());
+    record.state = static_cast<uint8_t>(get_state());
+    return record;
+}
+
+// Set this Ship's movement, fuel, resistance, and Islands from a checkpoint record
+// Throws Error if the record is not valid.
+void Ship::restore_ship_record(const Ship_record& record, const Checkpoint_reader& reader)
+{
+    if (record.state > static_cast<uint8_t>(State::dead_in_the_water))
+        throw Error("Checkpoint file is damaged!");
+
+    store.set_position(store_index, Point(record.x, record.y));
+    store.set_course(store_index, record.course);
+    store.set_speed(store_index, record.speed);
+    store.set_fuel(store_index, record.fuel);
+    store.set_destination(store_index, Point(record.destination_x, record.destination_y));
+    store.set_state(store_index, static_cast<State>(record.state));
+    resistance = record.resistance;
+    destination_Island = reader.get_island(record.destination_island);
+    docked_island = reader.get_island(record.docked_island);
+}
+
 /* Private Function Definitions */
 
 /*
@@ -421,58 +669,10 @@ Calculate the new position of a ship based on how it is moving, its speed, and
 fuel state. This function should be called only if the state is
 moving_to_position, moving_to_island, or moving_on_course.
 
-Track_base has an update_position(double time) function that computes the new position
-of an object after the specified time has elapsed. If the Ship is going to move
-for a full time unit (one hour), then it will get go the "full step" distance,
-so update_position would be called with time = 1.0. If we can move less than that,
-e.g. due to not enough fuel, update position  will be called with the corresponding
-time less than 1.0.
-
-For clarity in specifying the computation, this code assumes the specified private variable names,
-but you may change the variable names or enum class names, or state names if you wish (e.g. movement_state).
+The computation itself is done by the Ship_store, which may already have
+planned this tick's movement for all Ships at once.
 */
 void Ship::calculate_movement()
 {
-    // Compute values for how much we need to move, and how much we can, and how long we can,
-    // given the fuel state, then decide what to do.
-    double time = 1.0;  // "full step" time
-    // get the distance to destination
-    double destination_distance = cartesian_distance(get_location(), destination_point);
-    // get full step distance we can move on this time step
-    double full_distance = tracker.get_speed() * time;
-    // get fuel required for full step distance
-    double full_fuel_required = full_distance * fuel_consumption;  // tons = nm * tons/nm
-    // how far and how long can we sail in this time period based on the fuel state?
-    double distance_possible, time_possible;
-    if (full_fuel_required <= fuel) {
-        distance_possible = full_distance;
-        time_possible = time;
-    } else {
-        distance_possible = fuel / fuel_consumption;  // nm = tons / tons/nm
-        time_possible = (distance_possible / full_distance) * time;
-    }
-
-    // are we are moving to a destination, and is the destination within the distance possible?
-    if ((ship_state == State::moving_to_position || ship_state == State::moving_to_island)
-        && destination_distance <= distance_possible) {
-        // yes, make our new position the destination
-        tracker.set_position(destination_point);
-        // we travel the destination distance, using that much fuel
-        double fuel_required = destination_distance * fuel_consumption;
-        fuel -= fuel_required;
-        tracker.set_speed(0.);
-        ship_state = State::stopped;
-    } else {
-        // go as far as we can, stay in the same movement state
-        // simply move for the amount of time possible
-        tracker.update_position(time_possible);
-        // have we used up our fuel?
-        if (full_fuel_required >= fuel) {
-            fuel = 0.0;
-            tracker.set_speed(0.);
-            ship_state = State::dead_in_the_water;
-        } else {
-            fuel -= full_fuel_required;
-        }
-    }
-}
\ No newline at end of file
+    store.move(store_index);
+}
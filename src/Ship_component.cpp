@@ -25,23 +25,21 @@ int& Ship_component::index_counter()
     return index_count;
 }
 
-// Always return a nullptr
-shared_ptr<Ship_component> Ship_component::find_ship_composite(const string& name)
+// Return this Ship_component as a Ship, or nullptr if it is a group
+Ship* Ship_component::as_ship()
 {
     return nullptr;
 }
 
-// Always return false
-bool Ship_component::find_and_remove_ship_composite(const string& name)
-{
-    return false;
-}
+// Call visit for every Ship_component under this one, all the way down,
+// each group before what it holds. Does nothing by default.
+void Ship_component::visit_members(const Member_visitor& visit) const
+{ }
 
-// Always return false
-bool Ship_component::check_if_ship_exists(const string& ship) const
-{
-    return false;
-}
+// Add this Ship_component to a checkpoint's groups, in the group at index parent.
+// Does nothing by default.
+void Ship_component::save_group(Checkpoint_writer& writer, int parent) const
+{ }
 
 /*** Fat Interface Functioins ***/
 
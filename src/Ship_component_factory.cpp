@@ -3,6 +3,9 @@
 #include "Chain_ship.h"
 #include "Cruiser.h"
 #include "Cruise_ship.h"
+#include "Island.h"
+#include "Model.h"
+#include "Object_arena.h"
 #include "Tanker.h"
 #include "Torpedo_boat.h"
 #include "Utility.h"
@@ -10,26 +13,38 @@
 
 using namespace std;
 
-// Create a new Ship with the given name, type, and initial_possition
+// Make a T in the Model's arena
+template <typename T, typename... Args>
+static shared_ptr<T> make_in_arena(Model& model, Args&&... args)
+{
+    return allocate_shared<T>(Arena_allocator<T>(model.get_object_arena()), forward<Args>(args)...);
+}
+
+// Create a new Ship in the model with the given name, type, and initial_possition
 // may throw Error("Trying to create ship of unknown type!")
-std::shared_ptr<Ship> create_ship(const string& name, const string& type, Point initial_position)
+std::shared_ptr<Ship> create_ship(Model& model, const string& name, const string& type, Point initial_position)
 {
     if (type == "Tanker")
-        return make_shared<Tanker>(name, initial_position);
+        return make_in_arena<Tanker>(model, model, name, initial_position);
     else if (type == "Cruiser")
-        return make_shared<Cruiser>(name, initial_position);
+        return make_in_arena<Cruiser>(model, model, name, initial_position);
     else if (type == "Cruise_ship")
-        return make_shared<Cruise_ship>(name, initial_position);
+        return make_in_arena<Cruise_ship>(model, model, name, initial_position);
     // There cannot be any other type of Ship, so throw an Error.
     else if (type == "Torpedo_boat")
-        return make_shared<Torpedo_boat>(name, initial_position);
+        return make_in_arena<Torpedo_boat>(model, model, name, initial_position);
     else if (type == "Chain_ship")
-        return make_shared<Chain_ship>(name, initial_position);
+        return make_in_arena<Chain_ship>(model, model, name, initial_position);
     else
         throw Error("Trying to create ship of unknown type!");
 }
 
-shared_ptr<Ship_component> create_composite(const string& name)
+shared_ptr<Island> create_island(Model& model, const string& name, Point position, double fuel, double production_rate)
+{
+    return make_in_arena<Island>(model, model, name, position, fuel, production_rate);
+}
+
+shared_ptr<Ship_component> create_composite(Model& model, const string& name)
 {
-    return make_shared<Ship_composite>(name);
+    return make_in_arena<Ship_composite>(model, name);
 }
\ No newline at end of file
@@ -1,9 +1,14 @@
 #include "Ship_composite.h"
+#include "Checkpoint.h"
 #include "Model.h"
 #include "Island.h"
+#include "Logger.h"
+#include "Ship.h"
+#include "Thread_pool.h"
 #include "Utility.h"
 #include <iostream>
 #include <map>
+#include <vector>
 
 using namespace std;
 
@@ -25,40 +30,23 @@ void Ship_composite::remove_component(shared_ptr<Ship_component> ship_component)
         throw Error("This Ship_composite does not contain the Ship_component!");
 }
 
-// Find Ship_composite from ship_components
-shared_ptr<Ship_component> Ship_composite::find_ship_composite(const string& name)
+// Call visit for every Ship_component in ship_components, all the way down,
+// each group before what it holds
+void Ship_composite::visit_members(const Member_visitor& visit) const
 {
-    if (name == composite_name)
-        return shared_from_this();
-
     for (const auto& pair : ship_components) {
-        shared_ptr<Ship_component> ptr = pair.second->find_ship_composite(name);
-        if (ptr)
-            return ptr;
+        visit(pair.second, composite_name);
+        pair.second->visit_members(visit);
     }
-    return nullptr;
 }
 
-// Find Ship_composite and remove it
-bool Ship_composite::find_and_remove_ship_composite(const string& name)
+// Add this Ship_composite and its Ship_components to a checkpoint's groups,
+// under the group at index parent (-1 for a top group)
+void Ship_composite::save_group(Checkpoint_writer& writer, int parent) const
 {
-    if (ship_components.erase(name) == 1)
-        return true;
+    int group = writer.add_group(composite_name, parent);
     for (const auto& pair : ship_components)
-        if (pair.second->find_and_remove_ship_composite(name))
-            return true;
-    return false;
-}
-
-// Return a bool indicating if a Ship exists in ship_components
-bool Ship_composite::check_if_ship_exists(const string& ship) const
-{
-    for (const auto& pair : ship_components) {
-        bool exists = pair.second->check_if_ship_exists(ship);
-        if (exists)
-            return true;
-    }
-    return false;
+        pair.second->save_group(writer, group);
 }
 
 // Describe ship_components
@@ -93,137 +81,140 @@ string Ship_composite::get_name() const
 // Start moving to a destination position at a speed
 void Ship_composite::set_destination_position_and_speed(Point destination_position, double speed)
 {
-    for (const auto& pair : ship_components) {
-        try {
-            pair.second->set_destination_position_and_speed(destination_position, speed);
-        } catch (Error&) {
-        }
-    }
+    give_command([speed](const Ship& ship) { return ship.check_move(speed); },
+        [destination_position, speed](Ship& ship) {
+            return ship.try_set_destination_position_and_speed(destination_position, speed);
+        });
 }
 // Start moving to a destination Island at a speed
 void Ship_composite::set_destination_island_and_speed(shared_ptr<Island> destination_island, double speed)
 {
-    for (const auto& pair : ship_components) {
-        try {
-            pair.second->set_destination_island_and_speed(destination_island, speed);
-        } catch (Error&) {
-        }
-    }
+    give_command([speed](const Ship& ship) { return ship.check_move(speed); },
+        [&destination_island, speed](Ship& ship) {
+            return ship.try_set_destination_island_and_speed(destination_island, speed);
+        });
 }
 // Start moving on a course and speed
 void Ship_composite::set_course_and_speed(double course, double speed)
 {
-    for (const auto& pair : ship_components) {
-        try {
-            pair.second->set_course_and_speed(course, speed);
-        } catch (Error&) {
-        }
-    }
+    give_command([speed](const Ship& ship) { return ship.check_move(speed); },
+        [course, speed](Ship& ship) { return ship.try_set_course_and_speed(course, speed); });
 }
 // Stop moving
 void Ship_composite::stop()
 {
-    for (const auto& pair : ship_components) {
-        try {
-            pair.second->stop();
-        } catch (Error&) {
-        }
-    }
+    give_command([](const Ship& ship) { return ship.check_stop(); }, [](Ship& ship) { return ship.try_stop(); });
 }
 // dock at an Island - set our position = Island's position,
 void Ship_composite::dock(shared_ptr<Island> island_ptr)
 {
-    for (const auto& pair : ship_components) {
-        try {
-            pair.second->dock(island_ptr);
-        } catch (Error&) {
-        }
-    }
+    give_command([&island_ptr](const Ship& ship) { return ship.check_dock(island_ptr); },
+        [&island_ptr](Ship& ship) { return ship.try_dock(island_ptr); });
 }
 // Refuel - must already be docked at an island; fill takes as much as possible
 void Ship_composite::refuel()
 {
-    for (const auto& pair : ship_components) {
-        try {
-            pair.second->refuel();
-        } catch (Error&) {
-        }
-    }
+    give_command([](const Ship& ship) { return ship.check_refuel(); }, [](Ship& ship) { return ship.try_refuel(); });
 }
 
 // Tell a Chain_ships to chain other Ships in the simulation world
 void Ship_composite::chain_all_ship()
 {
-    for (const auto& pair : ship_components) {
-        try {
-            pair.second->chain_all_ship();
-        } catch (Error&) {
-        }
-    }
+    give_command([](const Ship& ship) { return ship.check_chain_all(); },
+        [](Ship& ship) { return ship.try_chain_all_ship(); });
 }
 
 // Tell Chain_ships to chain a Ship
 void Ship_composite::chain_ship(shared_ptr<Ship> ship_to_chain)
 {
-    for (const auto& pair : ship_components) {
-        try {
-            pair.second->chain_ship(ship_to_chain);
-        } catch (Error&) {
-        }
-    }
+    give_command([&ship_to_chain](const Ship& ship) { return ship.check_chain(ship_to_chain); },
+        [&ship_to_chain](Ship& ship) { return ship.try_chain_ship(ship_to_chain); });
 }
 
 // Tell Chain_ships to unchain a Ship
 void Ship_composite::unchain_ship(shared_ptr<Ship> ship_to_unchain)
 {
-    for (const auto& pair : ship_components) {
-        try {
-            pair.second->unchain_ship(ship_to_unchain);
-        } catch (Error&) {
-        }
-    }
+    give_command([&ship_to_unchain](const Ship& ship) { return ship.check_unchain(ship_to_unchain); },
+        [&ship_to_unchain](Ship& ship) { return ship.try_unchain_ship(ship_to_unchain); });
 }
 
 // Tell Tankers to set their load destination
 void Ship_composite::set_load_destination(shared_ptr<Island> load_destination)
 {
-    for (const auto& pair : ship_components) {
-        try {
-            pair.second->set_load_destination(load_destination);
-        } catch (Error&) {
-        }
-    }
+    give_command([](const Ship& ship) { return ship.check_load_destination(); },
+        [&load_destination](Ship& ship) { return ship.try_set_load_destination(load_destination); });
 }
 
 // Tell Tankers to set their unload destination
 void Ship_composite::set_unload_destination(shared_ptr<Island> unload_destination)
 {
-    for (const auto& pair : ship_components) {
-        try {
-            pair.second->set_unload_destination(unload_destination);
-        } catch (Error&) {
-        }
-    }
+    give_command([](const Ship& ship) { return ship.check_unload_destination(); },
+        [&unload_destination](Ship& ship) { return ship.try_set_unload_destination(unload_destination); });
 }
 
 // Tell Warships to attack a target
 void Ship_composite::attack(shared_ptr<Ship> target)
 {
-    for (const auto& pair : ship_components) {
-        try {
-            pair.second->attack(target);
-        } catch (Error&) {
-        }
-    }
+    give_command([&target](const Ship& ship) { return ship.check_attack(target); },
+        [&target](Ship& ship) { return ship.try_attack(target); });
 }
 
 // Tell Warships to stop attacking
 void Ship_composite::stop_attack()
 {
-    for (const auto& pair : ship_components) {
-        try {
-            pair.second->stop_attack();
-        } catch (Error&) {
+    give_command([](const Ship& ship) { return ship.check_stop_attack(); },
+        [](Ship& ship) { return ship.try_stop_attack(); });
+}
+
+// Return the Ships in this group, all the way down, in the order they are given commands
+vector<shared_ptr<Ship>> Ship_composite::get_ships() const
+{
+    vector<shared_ptr<Ship>> ships;
+    visit_members([&ships](const shared_ptr<Ship_component>& member, const string&) {
+        if (Ship* ship_ptr = member->as_ship())
+            ships.push_back(ship_ptr->shared_from_this());
+    });
+    return ships;
+}
+
+/*
+Give a command to every Ship in the group, all the way down. The Ships are
+first checked with check, if there is one, which must only read the Ship; that
+is split over the Thread_pool. Then give is called for each Ship that passed,
+one at a time and in order, since a command may write messages and change other
+objects; it gives the command with the Ship's try_ function. The Ships that fail
+the check, or the command, are put in last_status with the message; a summary
+is logged at info level, and each failure at warning level.
+*/
+void Ship_composite::give_command(const Check& check, const Give& give)
+{
+    // the group holds on to the Ships while the command is given
+    vector<Ship*> ships;
+    visit_members([&ships](const shared_ptr<Ship_component>& member, const string&) {
+        if (Ship* ship_ptr = member->as_ship())
+            ships.push_back(ship_ptr);
+    });
+    vector<const char*> failures(ships.size(), nullptr);
+    Thread_pool::get_instance().parallel_for(ships.size(), [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i)
+            failures[i] = check(*ships[i]);
+    });
+
+    last_status.num_ships = static_cast<int>(ships.size());
+    last_status.num_carried_out = 0;
+    last_status.failures.clear();
+    for (size_t i = 0; i < ships.size(); ++i) {
+        if (!failures[i])
+            failures[i] = give(*ships[i]);
+        if (!failures[i]) {
+            ++last_status.num_carried_out;
+            continue;
         }
+        last_status.failures.emplace_back(ships[i]->shared_from_this(), failures[i]);
     }
-}
\ No newline at end of file
+
+    LOG(Log_level::info, Log_category::general) << "Group " << composite_name << ": " << last_status.num_carried_out
+                                                << " of " << last_status.num_ships << " Ships carried out the command";
+    for (const auto& failure : last_status.failures)
+        LOG(Log_level::warning, Log_category::general) << failure.first->get_name() << ": " << failure.second;
+}
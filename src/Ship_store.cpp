@@ -0,0 +1,290 @@
+#include "Ship_store.h"
+#include "Kinematics.h"
+#include "Thread_pool.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+using namespace std;
+
+// Add a stopped Ship at position with a full tank and return its index
+int Ship_store::add(Point position, double fuel_, double fuel_consumption_)
+{
+    // the heading for course 0, which every Ship starts on
+    static const Cartesian_vector first_heading = course_unit_vector(0.);
+
+    if (free_indices.empty()) {
+        // a new slot starts at version 1, so that its plan, at version 0, is stale
+        x.push_back(position.x);
+        y.push_back(position.y);
+        course.push_back(0.);
+        speed.push_back(0.);
+        heading_x.push_back(first_heading.delta_x);
+        heading_y.push_back(first_heading.delta_y);
+        fuel.push_back(fuel_);
+        fuel_consumption.push_back(fuel_consumption_);
+        destination_x.push_back(0.);
+        destination_y.push_back(0.);
+        state.push_back(Ship_state::stopped);
+        version.push_back(1);
+        planned_x.push_back(0.);
+        planned_y.push_back(0.);
+        planned_fuel.push_back(0.);
+        planned_speed.push_back(0.);
+        planned_state.push_back(Ship_state::stopped);
+        planned_version.push_back(0);
+        planned_time.push_back(0.);
+        return get_size() - 1;
+    }
+
+    int index = free_indices.back();
+    free_indices.pop_back();
+    x[index] = position.x;
+    y[index] = position.y;
+    course[index] = 0.;
+    speed[index] = 0.;
+    heading_x[index] = first_heading.delta_x;
+    heading_y[index] = first_heading.delta_y;
+    fuel[index] = fuel_;
+    fuel_consumption[index] = fuel_consumption_;
+    destination_x[index] = 0.;
+    destination_y[index] = 0.;
+    state[index] = Ship_state::stopped;
+    // make sure no leftover plan looks current
+    planned_version[index] = version[index]++;
+    return index;
+}
+
+// Give the index back for reuse by a later Ship
+void Ship_store::remove(int index)
+{
+    state[index] = Ship_state::sunk;
+    touch(index);
+    free_indices.push_back(index);
+}
+
+/*** Writers ***/
+void Ship_store::set_position(int index, Point position)
+{
+    x[index] = position.x;
+    y[index] = position.y;
+    touch(index);
+}
+
+void Ship_store::set_course(int index, double course_)
+{
+    course[index] = course_;
+    Cartesian_vector heading = course_unit_vector(course_);
+    heading_x[index] = heading.delta_x;
+    heading_y[index] = heading.delta_y;
+    touch(index);
+}
+
+void Ship_store::set_speed(int index, double speed_)
+{
+    speed[index] = speed_;
+    touch(index);
+}
+
+void Ship_store::set_fuel(int index, double fuel_)
+{
+    fuel[index] = fuel_;
+    touch(index);
+}
+
+void Ship_store::set_destination(int index, Point destination)
+{
+    destination_x[index] = destination.x;
+    destination_y[index] = destination.y;
+    touch(index);
+}
+
+void Ship_store::set_state(int index, Ship_state state_)
+{
+    state[index] = state_;
+    touch(index);
+}
+
+/*** Movement ***/
+// Compute one time unit of movement for every moving Ship and remember it.
+// Only the store's own arrays are touched; the work is split over the Thread_pool.
+void Ship_store::plan_movement()
+{
+    Thread_pool::get_instance().parallel_for(state.size(), [this](size_t begin, size_t end) {
+        plan_movement(static_cast<int>(begin), static_cast<int>(end));
+    });
+}
+
+// Update position, fuel, speed, and state of a moving Ship for one time unit,
+// using the planned movement if it is still current.
+void Ship_store::move(int index)
+{
+    if (planned_version[index] != version[index])
+        plan_movement(index, index + 1);
+
+    x[index] = planned_x[index];
+    y[index] = planned_y[index];
+    fuel[index] = planned_fuel[index];
+    speed[index] = planned_speed[index];
+    state[index] = planned_state[index];
+    touch(index);
+}
+
+// Return the highest speed of any moving Ship, 0 if none is moving
+double Ship_store::get_max_speed() const
+{
+    double max_speed = 0.;
+    for (size_t index = 0; index < state.size(); ++index)
+        if (is_moving_state(state[index]))
+            max_speed = max(max_speed, speed[index]);
+    return max_speed;
+}
+
+// Return how many time units a moving Ship can certainly move and still be
+// moving, with a margin of one for rounding; the largest int if it never stops.
+int Ship_store::get_ticks_until_stop(int index) const
+{
+    if (!is_moving_state(state[index]))
+        return 0;
+
+    // the Ship stops in the first step that needs all its remaining fuel
+    // or reaches its destination
+    double full_distance = speed[index];
+    double full_fuel_required = full_distance * fuel_consumption[index];
+    double steps = numeric_limits<double>::infinity();
+    if (full_fuel_required > 0.)
+        steps = fuel[index] / full_fuel_required;
+    else if (fuel[index] <= 0.)
+        return 0;
+
+    if (state[index] == Ship_state::moving_to_position || state[index] == Ship_state::moving_to_island) {
+        double destination_distance = cartesian_distance(
+            Point(x[index], y[index]), Point(destination_x[index], destination_y[index]));
+        if (full_distance > 0.)
+            steps = min(steps, destination_distance / full_distance);
+        else if (destination_distance <= 0.)
+            return 0;
+    }
+
+    if (steps >= numeric_limits<int>::max())
+        return numeric_limits<int>::max();
+    return max(0, static_cast<int>(floor(steps)) - 1);
+}
+
+// Return true if a moving Ship will reach its destination before it runs out of fuel
+bool Ship_store::will_arrive(int index) const
+{
+    if (state[index] != Ship_state::moving_to_position && state[index] != Ship_state::moving_to_island)
+        return false;
+    double destination_distance
+        = cartesian_distance(Point(x[index], y[index]), Point(destination_x[index], destination_y[index]));
+    return destination_distance * fuel_consumption[index] <= fuel[index];
+}
+
+// Move a Ship for ticks time units at once; ticks must not be more than
+// get_ticks_until_stop(index). Each time unit is added on separately, with the
+// same arithmetic as a full step of plan_movement, so the Ship ends up exactly
+// where ticks calls of move() would have put it; multiplying by ticks instead
+// would round differently.
+void Ship_store::advance(int index, int ticks)
+{
+    double time = 1.0;
+    double full_distance = speed[index] * time;
+    double full_fuel_required = full_distance * fuel_consumption[index];
+    double step_x = full_distance * heading_x[index];
+    double step_y = full_distance * heading_y[index];
+    double x_ = x[index], y_ = y[index], fuel_ = fuel[index];
+    for (int tick = 0; tick < ticks; ++tick) {
+        x_ = x_ + step_x;
+        y_ = y_ + step_y;
+        fuel_ = fuel_ - full_fuel_required;
+    }
+    x[index] = x_;
+    y[index] = y_;
+    fuel[index] = fuel_;
+    touch(index);
+}
+
+/*
+Compute the new position of a ship based on how it is moving, its speed, and
+fuel state. If the Ship is going to move for a full time unit (one hour), then
+it will go the "full step" distance. If it can move less than that, e.g. due to
+not enough fuel, it moves for the corresponding time less than 1.0. If it reaches
+its destination, it is placed exactly there.
+
+The first loop decides how long each Ship moves and what happens to its fuel and
+state; advance_positions then moves all of them at once, and the last loop puts
+the Ships that arrive onto their destination.
+*/
+void Ship_store::plan_movement(int begin, int end)
+{
+    for (int i = begin; i < end; ++i) {
+        planned_x[i] = x[i];
+        planned_y[i] = y[i];
+        planned_fuel[i] = fuel[i];
+        planned_speed[i] = speed[i];
+        planned_state[i] = state[i];
+        planned_time[i] = 0.;
+        planned_version[i] = version[i];
+
+        if (!is_moving_state(state[i]))
+            continue;
+
+        double time = 1.0;  // "full step" time
+        // get full step distance we can move on this time step
+        double full_distance = speed[i] * time;
+        // get fuel required for full step distance
+        double full_fuel_required = full_distance * fuel_consumption[i];  // tons = nm * tons/nm
+        // how far and how long can we sail in this time period based on the fuel state?
+        double distance_possible, time_possible;
+        if (full_fuel_required <= fuel[i]) {
+            distance_possible = full_distance;
+            time_possible = time;
+        } else {
+            distance_possible = fuel[i] / fuel_consumption[i];  // nm = tons / tons/nm
+            time_possible = (distance_possible / full_distance) * time;
+        }
+
+        // are we are moving to a destination, and is the destination within the distance possible?
+        if (state[i] == Ship_state::moving_to_position || state[i] == Ship_state::moving_to_island) {
+            double destination_distance
+                = cartesian_distance(Point(x[i], y[i]), Point(destination_x[i], destination_y[i]));
+            if (destination_distance <= distance_possible) {
+                // yes, we travel the destination distance, using that much fuel,
+                // and stop there (the position is set below)
+                planned_fuel[i] = fuel[i] - destination_distance * fuel_consumption[i];
+                planned_speed[i] = 0.;
+                planned_state[i] = Ship_state::stopped;
+                continue;
+            }
+        }
+
+        // go as far as we can, stay in the same movement state
+        // simply move for the amount of time possible
+        planned_time[i] = time_possible;
+        // have we used up our fuel?
+        if (full_fuel_required >= fuel[i]) {
+            planned_fuel[i] = 0.0;
+            planned_speed[i] = 0.;
+            planned_state[i] = Ship_state::dead_in_the_water;
+        } else {
+            planned_fuel[i] = fuel[i] - full_fuel_required;
+        }
+    }
+
+    int count = end - begin;
+    advance_positions(&planned_x[begin],
+        &planned_y[begin],
+        &heading_x[begin],
+        &heading_y[begin],
+        &speed[begin],
+        &planned_time[begin],
+        count);
+
+    for (int i = begin; i < end; ++i) {
+        if (state[i] != planned_state[i] && planned_state[i] == Ship_state::stopped) {
+            planned_x[i] = destination_x[i];
+            planned_y[i] = destination_y[i];
+        }
+    }
+}
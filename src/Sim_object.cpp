@@ -1,8 +1,11 @@
 #include "Sim_object.h"
+#include "Model.h"
 #include <iostream>
 
 using namespace std;
 
-Sim_object::Sim_object(const string& name_)
-    : name(name_)
+Sim_object::Sim_object(Model& model_, const string& name_)
+    : model(model_)
+    , id(model_.get_name_id(name_))
+    , name(model_.get_name(id))
 { }
\ No newline at end of file
@@ -0,0 +1,278 @@
+#include "Spatial_grid.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>
+
+using namespace std;
+
+Spatial_grid::Spatial_grid(double cell_size_, const Name_table& names_)
+    : cell_size(cell_size_)
+    , names(&names_)
+    , num_objects(0)
+    , min_cell_x(numeric_limits<int>::max())
+    , max_cell_x(numeric_limits<int>::min())
+    , min_cell_y(numeric_limits<int>::max())
+    , max_cell_y(numeric_limits<int>::min())
+{ }
+
+// Add an object, or move it if it is already in the grid
+void Spatial_grid::insert(Object_id id, Point location)
+{
+    if (contains(id)) {
+        move(id, location);
+        return;
+    }
+    if (size_t(id) >= in_grid.size()) {
+        in_grid.resize(id + 1, false);
+        locations.resize(id + 1);
+    }
+    in_grid[id] = true;
+    locations[id] = location;
+    ++num_objects;
+    add_to_cell(id, location);
+}
+
+// Move an object that is in the grid; do nothing if it is not
+void Spatial_grid::move(Object_id id, Point location)
+{
+    if (!contains(id))
+        return;
+
+    Point old_location = locations[id];
+    locations[id] = location;
+    if (to_cell(old_location.x) == to_cell(location.x) && to_cell(old_location.y) == to_cell(location.y))
+        return;
+
+    remove_from_cell(id, old_location);
+    add_to_cell(id, location);
+}
+
+// Take an object out of the grid; do nothing if it is not there
+void Spatial_grid::remove(Object_id id)
+{
+    if (!contains(id))
+        return;
+
+    remove_from_cell(id, locations[id]);
+    in_grid[id] = false;
+    --num_objects;
+}
+
+// Return the ids of the k objects closest to center, closest first
+vector<Object_id> Spatial_grid::find_nearest(Point center, int k) const
+{
+    // kept sorted closest first
+    vector<pair<double, Object_id>> nearest;
+    if (k <= 0 || num_objects == 0)
+        return {};
+
+    auto closer = [this](const pair<double, Object_id>& a, const pair<double, Object_id>& b) {
+        return is_closer(a.first, a.second, b.first, b.second);
+    };
+    auto consider = [&](Object_id id, Point location) {
+        pair<double, Object_id> candidate(cartesian_distance(center, location), id);
+        if (static_cast<int>(nearest.size()) == k && !closer(candidate, nearest.back()))
+            return;
+        nearest.insert(upper_bound(nearest.begin(), nearest.end(), candidate, closer), candidate);
+        if (static_cast<int>(nearest.size()) > k)
+            nearest.pop_back();
+    };
+
+    int cell_x = to_cell(center.x);
+    int cell_y = to_cell(center.y);
+    int cells_visited = 0;
+    for (int ring = 0;; ++ring) {
+        int ring_cells = ring == 0 ? 1 : 8 * ring;
+        if (ring > 0 && cells_visited + ring_cells > get_size()) {
+            nearest.clear();
+            visit_all(consider);
+            break;
+        }
+        visit_ring(cell_x, cell_y, ring, consider);
+        cells_visited += ring_cells;
+
+        if (past_all_cells(cell_x, cell_y, ring))
+            break;
+        if (static_cast<int>(nearest.size()) == k && nearest.back().first < distance_past_ring(center, ring))
+            break;
+    }
+
+    vector<Object_id> ids;
+    for (const auto& pair : nearest)
+        ids.push_back(pair.second);
+    return ids;
+}
+
+// Return the ids of the objects within radius of center, in name order
+vector<Object_id> Spatial_grid::find_within(Point center, double radius) const
+{
+    vector<Object_id> ids;
+    auto consider = [&](Object_id id, Point location) {
+        if (cartesian_distance(center, location) <= radius)
+            ids.push_back(id);
+    };
+
+    int first_x = max(to_cell(center.x - radius), min_cell_x);
+    int last_x = min(to_cell(center.x + radius), max_cell_x);
+    int first_y = max(to_cell(center.y - radius), min_cell_y);
+    int last_y = min(to_cell(center.y + radius), max_cell_y);
+
+    if (first_x <= last_x && first_y <= last_y) {
+        double box_cells = (double(last_x) - first_x + 1) * (double(last_y) - first_y + 1);
+        if (box_cells > get_size()) {
+            visit_all(consider);
+        } else {
+            for (int x = first_x; x <= last_x; ++x)
+                for (int y = first_y; y <= last_y; ++y)
+                    visit_cell(x, y, consider);
+        }
+    }
+
+    sort(ids.begin(), ids.end(), Name_order{names});
+    return ids;
+}
+
+// Return the id of the closest object to center for which predicate is true,
+// or no_object_id if there is none
+Object_id Spatial_grid::find_nearest_if(Point center, const Predicate& predicate) const
+{
+    Object_id best_id = no_object_id;
+    double best_distance = numeric_limits<double>::max();
+    if (num_objects == 0)
+        return best_id;
+
+    auto consider = [&](Object_id id, Point location) {
+        double distance = cartesian_distance(center, location);
+        if (best_id != no_object_id && !is_closer(distance, id, best_distance, best_id))
+            return;
+        if (!predicate(id, location))
+            return;
+        best_id = id;
+        best_distance = distance;
+    };
+
+    int cell_x = to_cell(center.x);
+    int cell_y = to_cell(center.y);
+    int cells_visited = 0;
+    for (int ring = 0;; ++ring) {
+        int ring_cells = ring == 0 ? 1 : 8 * ring;
+        if (ring > 0 && cells_visited + ring_cells > get_size()) {
+            visit_all(consider);
+            break;
+        }
+        visit_ring(cell_x, cell_y, ring, consider);
+        cells_visited += ring_cells;
+
+        if (past_all_cells(cell_x, cell_y, ring))
+            break;
+        if (best_id != no_object_id && best_distance < distance_past_ring(center, ring))
+            break;
+    }
+
+    return best_id;
+}
+
+/*** Helper Functions ***/
+
+// Coordinates too far out for an int cell number, as the edges of a query with
+// a very large radius can be, are clamped
+int Spatial_grid::to_cell(double coordinate) const
+{
+    const double max_cell = numeric_limits<int>::max() / 2;
+    return static_cast<int>(max(-max_cell, min(floor(coordinate / cell_size), max_cell)));
+}
+
+// The shift is done unsigned, as shifting a negative cell_x is undefined
+Spatial_grid::Cell_key Spatial_grid::make_key(int cell_x, int cell_y)
+{
+    return static_cast<Cell_key>((uint64_t(uint32_t(cell_x)) << 32) | uint32_t(cell_y));
+}
+
+void Spatial_grid::add_to_cell(Object_id id, Point location)
+{
+    int cell_x = to_cell(location.x);
+    int cell_y = to_cell(location.y);
+    cells[make_key(cell_x, cell_y)].push_back(id);
+
+    min_cell_x = min(min_cell_x, cell_x);
+    max_cell_x = max(max_cell_x, cell_x);
+    min_cell_y = min(min_cell_y, cell_y);
+    max_cell_y = max(max_cell_y, cell_y);
+}
+
+void Spatial_grid::remove_from_cell(Object_id id, Point location)
+{
+    auto cell_it = cells.find(make_key(to_cell(location.x), to_cell(location.y)));
+    if (cell_it == cells.end())
+        return;
+
+    vector<Object_id>& ids = cell_it->second;
+    auto it = find(ids.begin(), ids.end(), id);
+    if (it != ids.end()) {
+        swap(*it, ids.back());
+        ids.pop_back();
+    }
+    if (ids.empty())
+        cells.erase(cell_it);
+}
+
+// Call visit(id, location) for each object in the grid
+void Spatial_grid::visit_all(const function<void(Object_id, Point)>& visit) const
+{
+    for (size_t id = 0; id < in_grid.size(); ++id)
+        if (in_grid[id])
+            visit(Object_id(id), locations[id]);
+}
+
+// Call visit(id, location) for each object in the given cell
+void Spatial_grid::visit_cell(int cell_x, int cell_y, const function<void(Object_id, Point)>& visit) const
+{
+    auto cell_it = cells.find(make_key(cell_x, cell_y));
+    if (cell_it == cells.end())
+        return;
+
+    for (Object_id id : cell_it->second)
+        visit(id, locations[id]);
+}
+
+// Call visit(id, location) for each object in the cells on the square ring
+// at distance ring from (cell_x, cell_y); ring 0 is the center cell alone.
+void Spatial_grid::visit_ring(int cell_x, int cell_y, int ring, const function<void(Object_id, Point)>& visit) const
+{
+    if (ring == 0) {
+        visit_cell(cell_x, cell_y, visit);
+        return;
+    }
+
+    // top and bottom rows, then the left and right columns between them
+    for (int x = cell_x - ring; x <= cell_x + ring; ++x) {
+        visit_cell(x, cell_y - ring, visit);
+        visit_cell(x, cell_y + ring, visit);
+    }
+    for (int y = cell_y - ring + 1; y <= cell_y + ring - 1; ++y) {
+        visit_cell(cell_x - ring, y, visit);
+        visit_cell(cell_x + ring, y, visit);
+    }
+}
+
+// The smallest distance from center to anything outside the square of
+// rings 0 through ring around its cell
+double Spatial_grid::distance_past_ring(Point center, int ring) const
+{
+    int cell_x = to_cell(center.x);
+    int cell_y = to_cell(center.y);
+    double left = center.x - (cell_x - ring) * cell_size;
+    double right = (cell_x + ring + 1) * cell_size - center.x;
+    double bottom = center.y - (cell_y - ring) * cell_size;
+    double top = (cell_y + ring + 1) * cell_size - center.y;
+    // allow for rounding in to_cell near a cell boundary
+    return min(min(left, right), min(bottom, top)) - cell_size * 1e-9;
+}
+
+// True if rings beyond ring around (cell_x, cell_y) cannot hold any object
+bool Spatial_grid::past_all_cells(int cell_x, int cell_y, int ring) const
+{
+    return cell_x - ring <= min_cell_x && cell_x + ring >= max_cell_x && cell_y - ring <= min_cell_y
+        && cell_y + ring >= max_cell_y;
+}
@@ -1,13 +1,17 @@
 #include "Tanker.h"
+#include "Checkpoint.h"
 #include "Island.h"
+#include "Logger.h"
+#include "Model.h"
+#include "Profiler.h"
 #include "Utility.h"
 #include <iostream>
 
 using namespace std;
 
 // initialize, the output constructor message
-Tanker::Tanker(const string& name_, Point position_)
-    : Ship(name_, position_, 100, 10, 2, 0)
+Tanker::Tanker(Model& model_, const string& name_, Point position_)
+    : Ship(model_, name_, position_, 100, 10, 2, 0)
     , cargo(0)
     , cargo_capacity(1000)
     , tanker_state(Tanker_state::no_destination)
@@ -41,6 +45,14 @@ void Tanker::set_course_and_speed(double course, double speed)
     Ship::set_course_and_speed(course, speed);
 }
 
+// A Tanker with cargo destinations refuses to move before anything else
+const char* Tanker::check_move(double speed) const
+{
+    if (tanker_state != Tanker_state::no_destination)
+        return "Tanker has cargo destinations!";
+    return Ship::check_move(speed);
+}
+
 // Set the loading and unloading Island destinations
 // if both cargo destination are already set,
 // throw Error("Tanker has cargo destinations!").
@@ -49,15 +61,15 @@ void Tanker::set_course_and_speed(double course, double speed)
 // if both destinations are now set, start the cargo cycle
 void Tanker::set_load_destination(shared_ptr<Island> island_ptr)
 {
-    if (tanker_state != Tanker_state::no_destination)
-        throw Error("Tanker has cargo destinations!");
+    if (const char* failure = check_load_destination())
+        throw Error(failure);
 
     load_destination = island_ptr;
 
     if (load_destination == unload_destination)
         throw Error("Load and unload cargo destinations are the same!");
 
-    cout << get_name() << " will load at " << island_ptr->get_name() << endl;
+    LOG(Log_level::info, Log_category::fuel) << get_name() << " will load at " << island_ptr->get_name();
 
     // If both load_destination and unload_destination
     // are set, start the cargo cycle.
@@ -65,21 +77,32 @@ void Tanker::set_load_destination(shared_ptr<Island> island_ptr)
 }
 void Tanker::set_unload_destination(shared_ptr<Island> island_ptr)
 {
-    if (tanker_state != Tanker_state::no_destination)
-        throw Error("Tanker has cargo destinations!");
+    if (const char* failure = check_unload_destination())
+        throw Error(failure);
 
     unload_destination = island_ptr;
 
     if (load_destination == unload_destination)
         throw Error("Load and unload cargo destinations are the same!");
 
-    cout << get_name() << " will unload at " << island_ptr->get_name() << endl;
+    LOG(Log_level::info, Log_category::fuel) << get_name() << " will unload at " << island_ptr->get_name();
 
     // If both load_destination and unload_destination
     // are set, start the cargo cycle.
     start_cargo_cycle();
 }
 
+// A Tanker with cargo destinations refuses new ones
+const char* Tanker::check_load_destination() const
+{
+    return tanker_state != Tanker_state::no_destination ? "Tanker has cargo destinations!" : nullptr;
+}
+
+const char* Tanker::check_unload_destination() const
+{
+    return tanker_state != Tanker_state::no_destination ? "Tanker has cargo destinations!" : nullptr;
+}
+
 // when told to stop, clear the cargo destinations and stop
 void Tanker::stop()
 {
@@ -87,7 +110,7 @@ void Tanker::stop()
     load_destination = nullptr;
     unload_destination = nullptr;
     tanker_state = Tanker_state::no_destination;
-    cout << get_name() << " now has no cargo destinations" << endl;
+    LOG(Log_level::info, Log_category::fuel) << get_name() << " now has no cargo destinations";
 }
 
 // perform Tanker-specific behavior
@@ -95,6 +118,7 @@ void Tanker::stop()
 // specific states.
 void Tanker::update()
 {
+    PROFILE_SCOPE(Profile_section::update_tanker);
     Ship::update();
     // If it cannot move reset its destination pointers
     // and set its state to no destination.
@@ -102,7 +126,7 @@ void Tanker::update()
         tanker_state = Tanker_state::no_destination;
         load_destination = nullptr;
         unload_destination = nullptr;
-        cout << get_name() << " now has no cargo destinations" << endl;
+        LOG(Log_level::info, Log_category::fuel) << get_name() << " now has no cargo destinations";
         return;
     }
 
@@ -145,7 +169,7 @@ void Tanker::update()
 
         // Otherwise, get fuel_needed from its docked Island.
         cargo += get_docked_Island()->provide_fuel(fuel_needed);
-        cout << get_name() << " now has " << cargo << " of cargo" << endl;
+        LOG(Log_level::info, Log_category::fuel) << get_name() << " now has " << cargo << " of cargo";
         break;
     }
 
@@ -160,10 +184,45 @@ void Tanker::update()
 
         // Otherwise, provide its cargo to its docked Island.
         get_docked_Island()->accept_fuel(cargo);
+        get_model().record_fuel_delivered(cargo);
         cargo = 0.0;
     }
 }
 
+// A Tanker that is loading, unloading, or about to dock must be updated;
+// otherwise it can be advanced like any Ship.
+int Tanker::ticks_until_event() const
+{
+    if (!can_move())
+        return tanker_state == Tanker_state::no_destination ? Ship::ticks_until_event() : 0;
+
+    switch (tanker_state) {
+    case Tanker_state::no_destination:
+        return Ship::ticks_until_event();
+    case Tanker_state::moving_to_loading:
+    case Tanker_state::moving_to_unloading:
+        return is_moving() ? Ship::ticks_until_event() : 0;
+    default:
+        return 0;
+    }
+}
+
+Event_type Tanker::get_event_type() const
+{
+    if (!can_move())
+        return tanker_state == Tanker_state::no_destination ? Ship::get_event_type() : Event_type::state_change;
+
+    switch (tanker_state) {
+    case Tanker_state::no_destination:
+        return Ship::get_event_type();
+    case Tanker_state::moving_to_loading:
+    case Tanker_state::moving_to_unloading:
+        return is_moving() ? Ship::get_event_type() : Event_type::dock_complete;
+    default:
+        return Event_type::refuel_complete;
+    }
+}
+
 // Call Ship::describe() first, and describe this Tanker's
 // specific states.
 void Tanker::describe() const
@@ -191,6 +250,32 @@ void Tanker::describe() const
     }
 }
 
+// Add this Tanker's record to a checkpoint
+void Tanker::save(Checkpoint_writer& writer) const
+{
+    Tanker_record record{};
+    record.ship = make_ship_record(writer);
+    record.cargo = cargo;
+    record.load_destination = writer.get_island_id(load_destination.get());
+    record.unload_destination = writer.get_island_id(unload_destination.get());
+    record.tanker_state = static_cast<uint8_t>(tanker_state);
+    writer.tankers.push_back(record);
+}
+
+// Set this Tanker's state, cargo, and cargo destinations from a checkpoint record
+// Throws Error if the record is not valid.
+void Tanker::restore(const Tanker_record& record, const Checkpoint_reader& reader)
+{
+    if (record.tanker_state > static_cast<uint8_t>(Tanker_state::moving_to_unloading))
+        throw Error("Checkpoint file is damaged!");
+
+    restore_ship_record(record.ship, reader);
+    cargo = record.cargo;
+    load_destination = reader.get_island(record.load_destination);
+    unload_destination = reader.get_island(record.unload_destination);
+    tanker_state = static_cast<Tanker_state>(record.tanker_state);
+}
+
 // If both load_destination and unload_destination are
 // set, change this Tanker's state and information depending
 // on its state.
@@ -0,0 +1,111 @@
+#include "Thread_pool.h"
+#include <algorithm>
+
+using namespace std;
+
+thread_local bool Thread_pool::in_chunk = false;
+
+// Create a pool with the given number of threads, counting the calling thread.
+// A value of 0 means one thread per hardware thread.
+Thread_pool::Thread_pool(unsigned int num_threads)
+    : job_body(nullptr)
+    , job_count(0)
+    , job_chunk_size(1)
+    , next_chunk(0)
+    , chunks_left(0)
+    , job_generation(0)
+    , shutting_down(false)
+{
+    if (num_threads == 0)
+        num_threads = max(1u, thread::hardware_concurrency());
+
+    for (unsigned int i = 1; i < num_threads; ++i)
+        workers.emplace_back(&Thread_pool::worker_loop, this);
+}
+
+Thread_pool::~Thread_pool()
+{
+    {
+        lock_guard<mutex> lock(job_mutex);
+        shutting_down = true;
+    }
+    job_ready.notify_all();
+
+    for (thread& worker : workers)
+        worker.join();
+}
+
+// Call body(begin, end) for disjoint chunks covering [0, count).
+// Chunks may run concurrently, so body must only touch data owned by its chunk.
+void Thread_pool::parallel_for(size_t count, const function<void(size_t, size_t)>& body)
+{
+    if (count == 0)
+        return;
+
+    // Not worth waking anybody up for; or the workers are busy with the chunks
+    // of an outer parallel_for, and waiting for them would deadlock
+    if (workers.empty() || count == 1 || in_chunk) {
+        body(0, count);
+        return;
+    }
+
+    lock_guard<mutex> caller_lock(caller_mutex);
+    unique_lock<mutex> lock(job_mutex);
+
+    // A few chunks per thread so that uneven chunks even out
+    size_t num_chunks = min(count, size_t(get_num_threads()) * 4);
+    job_body = &body;
+    job_count = count;
+    job_chunk_size = (count + num_chunks - 1) / num_chunks;
+    next_chunk = 0;
+    chunks_left = (count + job_chunk_size - 1) / job_chunk_size;
+    ++job_generation;
+    job_ready.notify_all();
+
+    run_chunks(lock);
+
+    job_done.wait(lock, [this] { return chunks_left == 0; });
+    job_body = nullptr;
+}
+
+// Pool shared by the whole program
+Thread_pool& Thread_pool::get_instance()
+{
+    static Thread_pool the_pool;
+    return the_pool;
+}
+
+void Thread_pool::worker_loop()
+{
+    unsigned long seen_generation = 0;
+    unique_lock<mutex> lock(job_mutex);
+    while (true) {
+        job_ready.wait(lock, [&] { return shutting_down || job_generation != seen_generation; });
+        if (shutting_down)
+            return;
+
+        seen_generation = job_generation;
+        run_chunks(lock);
+    }
+}
+
+// Grab and run chunks of the current job until none are left.
+// job_mutex must be held by lock on entry and is held on exit.
+void Thread_pool::run_chunks(unique_lock<mutex>& lock)
+{
+    while (job_body && next_chunk < job_count) {
+        size_t begin = next_chunk;
+        size_t end = min(job_count, begin + job_chunk_size);
+        next_chunk = end;
+        const function<void(size_t, size_t)>* body = job_body;
+
+        lock.unlock();
+        in_chunk = true;
+        (*body)(begin, end);
+        in_chunk = false;
+        lock.lock();
+
+        if (--chunks_left == 0)
+            job_done.notify_all();
+    }
+}
@@ -1,24 +1,63 @@
 #include "Torpedo_boat.h"
+#include "Checkpoint.h"
 #include "Island.h"
+#include "Logger.h"
 #include "Model.h"
+#include "Profiler.h"
+#include "Utility.h"
 #include <iostream>
-#include <limits>
-#include <map>
 
 using namespace std;
 
-Torpedo_boat::Torpedo_boat(const string& name_, Point position_)
-    : Warship(name_, position_, 3, 5.0, 800, 12, 5, 9)
+// Return a Ship's course and speed, with a speed of zero if it is not moving
+static Course_speed get_movement(const Ship& ship)
+{
+    Course_speed course_speed = ship.get_track().get_course_speed();
+    if (!ship.is_moving())
+        course_speed.speed = 0.;
+    return course_speed;
+}
+
+Torpedo_boat::Torpedo_boat(Model& model_, const string& name_, Point position_)
+    : Warship(model_, name_, position_, 3, 5.0, 800, 12, 5, 9)
+    , intercepting(false)
+    , planned_course(0.)
 { }
 
-// When target is out of range this Torpedo_boat can move,
-// set the target's loation as the destination.
+// When target is out of range and this Torpedo_boat can move,
+// head for where it will meet the target.
 void Torpedo_boat::update()
 {
+    PROFILE_SCOPE(Profile_section::update_torpedo_boat);
     Warship::update();
 
-    if (target_out_of_range() && can_move())
-        set_destination_position_and_speed(get_target().lock()->get_location(), get_maximum_speed());
+    if (!target_out_of_range() || !can_move())
+        return;
+
+    // Warship::update has checked that the target is afloat. Keep to the intercept
+    // as long as both this Torpedo_boat and the target are moving as planned.
+    const Ship& target = *get_model().resolve_ship(get_target());
+    Course_speed target_cs = get_movement(target);
+    Track_base track = get_track();
+    if (intercepting && is_moving() && track.get_course() == planned_course
+        && track.get_speed() == get_maximum_speed() && target_cs.course == planned_target_cs.course
+        && target_cs.speed == planned_target_cs.speed)
+        return;
+
+    plan_intercept(target, target_cs);
+}
+
+// Start an attack on a target ship, with a new intercept
+void Torpedo_boat::attack(shared_ptr<Ship> target_ptr_)
+{
+    Warship::attack(target_ptr_);
+    intercepting = false;
+}
+
+void Torpedo_boat::stop_attack()
+{
+    Warship::stop_attack();
+    intercepting = false;
 }
 
 // Describe this Torpedo_boat's state.
@@ -36,25 +75,19 @@ void Torpedo_boat::receive_hit(int hit_force, std::shared_ptr<Ship> attacker_ptr
     if (!can_move())
         return;
 
-    cout << get_name() << " taking evasive action" << endl;
+    LOG(Log_level::info, Log_category::combat) << get_name() << " taking evasive action";
 
     if (is_attacking())
         stop_attack();
 
-    map<string, shared_ptr<Island>> island_map = Model::get_instance().get_island_map();
-
-    shared_ptr<Island> closest_island;
-    double lowest_distance = numeric_limits<double>::max();
+    Point attacker_location = attacker_ptr->get_location();
 
     // Find an Island closest to the attacker. The distance
     // has to be greater than equal to 15nm.
-    for (const auto& pair : island_map) {
-        double distance = cartesian_distance(attacker_ptr->get_location(), pair.second->get_location());
-        if (distance < lowest_distance && distance >= 15) {
-            closest_island = pair.second;
-            lowest_distance = distance;
-        }
-    }
+    shared_ptr<Island> closest_island = get_model().find_nearest_island_if(
+        attacker_location, [&](Object_id, Point location) {
+            return cartesian_distance(attacker_location, location) >= 15;
+        });
 
     // If such an Island was found, set the destination to that
     // Island.
@@ -66,14 +99,62 @@ void Torpedo_boat::receive_hit(int hit_force, std::shared_ptr<Ship> attacker_ptr
         shared_ptr<Island> farthest_island;
 
         // If such an Island was not found, set destination to the an Island
-        // that is farthest from the attacker.
-        for (const auto& pair : island_map) {
-            distance = cartesian_distance(attacker_ptr->get_location(), pair.second->get_location());
+        // that is farthest from the attacker. Every Island is then within 15nm.
+        for (const auto& island : get_model().find_islands_within(attacker_location, 15)) {
+            distance = cartesian_distance(attacker_location, island->get_location());
             if (distance > longest_distance) {
-                farthest_island = pair.second;
+                farthest_island = island;
                 longest_distance = distance;
             }
         }
         set_destination_island_and_speed(farthest_island, get_maximum_speed());
     }
-}
\ No newline at end of file
+}
+// Add this Torpedo_boat's record to a checkpoint
+void Torpedo_boat::save(Checkpoint_writer& writer) const
+{
+    Torpedo_boat_record record{};
+    record.warship = make_warship_record(writer);
+    record.planned_course = planned_course;
+    record.planned_target_course = planned_target_cs.course;
+    record.planned_target_speed = planned_target_cs.speed;
+    record.intercepting = intercepting;
+    writer.torpedo_boats.push_back(record);
+}
+
+// Set this Torpedo_boat's state, target, and intercept from a checkpoint record
+// Throws Error if the record is not valid.
+void Torpedo_boat::restore(const Torpedo_boat_record& record, const Checkpoint_reader& reader)
+{
+    if (record.intercepting > 1)
+        throw Error("Checkpoint file is damaged!");
+
+    Warship::restore(record.warship, reader);
+    intercepting = record.intercepting;
+    planned_course = record.planned_course;
+    planned_target_cs = Course_speed(record.planned_target_course, record.planned_target_speed);
+}
+
+// Head for the point where this Torpedo_boat will meet target moving on target_cs,
+// or for where target is now if it cannot be met
+void Torpedo_boat::plan_intercept(const Ship& target, Course_speed target_cs)
+{
+    Compass_position intercept_cp;
+    double time_to_intercept;
+    if (!compute_intercept(get_maximum_speed(),
+            target_cs,
+            Compass_position(get_location(), target.get_location()),
+            intercept_cp,
+            time_to_intercept)) {
+        set_destination_position_and_speed(target.get_location(), get_maximum_speed());
+        intercepting = false;
+        return;
+    }
+
+    LOG(Log_level::debug, Log_category::combat)
+        << get_name() << " will intercept " << target.get_name() << " in " << time_to_intercept << " hours";
+    set_destination_position_and_speed(get_location() + intercept_cp, get_maximum_speed());
+    intercepting = true;
+    planned_course = get_track().get_course();
+    planned_target_cs = target_cs;
+}
@@ -0,0 +1,400 @@
+#include "Tour_planner.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>
+
+using namespace std;
+
+// A move must make the tour shorter by more than this, in nm, so that rounding cannot make moves go round in circles
+const double min_gain = 1e-9;
+
+// Call visit with each cell of the grid that is r cells across or up and down
+// from the cell at (cell_x, cell_y), and not further either way
+template <typename Visit>
+static void visit_ring(int cell_x, int cell_y, int r, int num_cells_x, int num_cells_y, Visit visit)
+{
+    int low_x = cell_x - r;
+    int high_x = cell_x + r;
+    int low_y = cell_y - r;
+    int high_y = cell_y + r;
+    for (int row = max(low_y, 0); row <= min(high_y, num_cells_y - 1); ++row) {
+        if (row == low_y || row == high_y) {
+            for (int column = max(low_x, 0); column <= min(high_x, num_cells_x - 1); ++column)
+                visit(row * num_cells_x + column);
+        } else {
+            if (low_x >= 0)
+                visit(row * num_cells_x + low_x);
+            if (high_x < num_cells_x)
+                visit(row * num_cells_x + high_x);
+        }
+    }
+}
+
+Tour_planner::Tour_planner()
+    : grid_x(0.)
+    , grid_y(0.)
+    , cell_size(1.)
+    , num_cells_x(0)
+    , num_cells_y(0)
+    , num_neighbours(0)
+    , greedy_length(0.)
+    , length(0.)
+{ }
+
+// Return the indexes of points in the order a short tour that starts and
+// ends at the first of them visits them, the first first
+vector<int> Tour_planner::plan(const vector<Point>& points)
+{
+    int num_points = static_cast<int>(points.size());
+    x.resize(num_points);
+    y.resize(num_points);
+    for (int point = 0; point < num_points; ++point) {
+        x[point] = points[point].x;
+        y[point] = points[point].y;
+    }
+    tour.clear();
+    greedy_length = length = 0.;
+    if (num_points == 0)
+        return tour;
+
+    build_grid();
+    find_neighbours();
+    make_greedy_tour();
+    greedy_length = get_tour_length();
+    // three points or fewer can only go round one way
+    if (num_points > 3)
+        improve_tour();
+    length = get_tour_length();
+    return tour;
+}
+
+/*** Helper Functions ***/
+
+double Tour_planner::distance(int point1, int point2) const
+{
+    double delta_x = x[point1] - x[point2];
+    double delta_y = y[point1] - y[point2];
+    return sqrt(delta_x * delta_x + delta_y * delta_y);
+}
+
+// Return the point after or before point in the tour
+int Tour_planner::next(int point) const
+{
+    int position = positions[point] + 1;
+    return tour[position == static_cast<int>(tour.size()) ? 0 : position];
+}
+
+int Tour_planner::previous(int point) const
+{
+    int position = positions[point];
+    return tour[position == 0 ? int(tour.size()) - 1 : position - 1];
+}
+
+// Return the total length of the tour
+double Tour_planner::get_tour_length() const
+{
+    double total = 0.;
+    for (size_t i = 0; i < tour.size(); ++i)
+        total += distance(tour[i], tour[i + 1 == tour.size() ? 0 : i + 1]);
+    return total;
+}
+
+// Put the points in the grid
+void Tour_planner::build_grid()
+{
+    int num_points = static_cast<int>(x.size());
+    grid_x = *min_element(x.begin(), x.end());
+    grid_y = *min_element(y.begin(), y.end());
+    double width = *max_element(x.begin(), x.end()) - grid_x;
+    double height = *max_element(y.begin(), y.end()) - grid_y;
+
+    // About two points to a cell, and no more cells than that in a row or column either
+    cell_size = max(sqrt(width * height * 2. / num_points), max(width, height) / (2. * num_points));
+    if (cell_size <= 0.)
+        cell_size = 1.;
+    num_cells_x = static_cast<int>(width / cell_size) + 1;
+    num_cells_y = static_cast<int>(height / cell_size) + 1;
+    int num_cells = num_cells_x * num_cells_y;
+
+    // Count the points in each cell, set where each cell's points start, then put them there
+    cell_sizes.assign(num_cells, 0);
+    point_cells.resize(num_points);
+    for (int point = 0; point < num_points; ++point) {
+        point_cells[point] = to_cell_y(y[point]) * num_cells_x + to_cell_x(x[point]);
+        ++cell_sizes[point_cells[point]];
+    }
+    cell_starts.resize(num_cells);
+    int start = 0;
+    for (int cell = 0; cell < num_cells; ++cell) {
+        cell_starts[cell] = start;
+        start += cell_sizes[cell];
+    }
+    cell_points.resize(num_points);
+    point_slots.resize(num_points);
+    vector<int> cell_next(cell_starts);
+    for (int point = 0; point < num_points; ++point) {
+        point_slots[point] = cell_next[point_cells[point]]++;
+        cell_points[point_slots[point]] = point;
+    }
+}
+
+// Return the column or row of the grid that holds a coordinate
+int Tour_planner::to_cell_x(double coordinate) const
+{
+    return min(static_cast<int>((coordinate - grid_x) / cell_size), num_cells_x - 1);
+}
+
+int Tour_planner::to_cell_y(double coordinate) const
+{
+    return min(static_cast<int>((coordinate - grid_y) / cell_size), num_cells_y - 1);
+}
+
+// Find the nearest neighbours of every point
+void Tour_planner::find_neighbours()
+{
+    int num_points = static_cast<int>(x.size());
+    num_neighbours = min(max_neighbours, num_points - 1);
+    neighbours.resize(size_t(num_points) * num_neighbours);
+    neighbour_distances.resize(neighbours.size());
+    int max_ring = max(num_cells_x, num_cells_y);
+
+    // the nearest found so far, nearest first, and of two as near the one with the lower index
+    vector<pair<double, int>> nearest;
+    for (int point = 0; point < num_points && num_neighbours > 0; ++point) {
+        nearest.clear();
+        int cell_x = to_cell_x(x[point]);
+        int cell_y = to_cell_y(y[point]);
+        // a point in the next ring is at least r cells away
+        for (int r = 0; r <= max_ring; ++r) {
+            visit_ring(cell_x, cell_y, r, num_cells_x, num_cells_y, [&](int cell) {
+                for (int slot = cell_starts[cell]; slot < cell_starts[cell] + cell_sizes[cell]; ++slot) {
+                    int other = cell_points[slot];
+                    if (other == point)
+                        continue;
+                    pair<double, int> candidate(distance(point, other), other);
+                    if (int(nearest.size()) == num_neighbours && !(candidate < nearest.back()))
+                        continue;
+                    nearest.insert(upper_bound(nearest.begin(), nearest.end(), candidate), candidate);
+                    if (int(nearest.size()) > num_neighbours)
+                        nearest.pop_back();
+                }
+            });
+            if (int(nearest.size()) == num_neighbours && nearest.back().first < r * cell_size)
+                break;
+        }
+        for (int k = 0; k < num_neighbours; ++k) {
+            neighbours[size_t(point) * num_neighbours + k] = nearest[k].second;
+            neighbour_distances[size_t(point) * num_neighbours + k] = nearest[k].first;
+        }
+    }
+}
+
+// Make the greedy tour
+void Tour_planner::make_greedy_tour()
+{
+    int num_points = static_cast<int>(x.size());
+    tour.clear();
+    tour.reserve(num_points);
+    int point = 0;
+    remove_from_grid(point);
+    tour.push_back(point);
+    while (int(tour.size()) < num_points) {
+        point = find_nearest_unvisited(point);
+        remove_from_grid(point);
+        tour.push_back(point);
+    }
+}
+
+// Return the point not yet in the greedy tour that is nearest to point,
+// the one with the lower index of two as near
+int Tour_planner::find_nearest_unvisited(int point) const
+{
+    int nearest = -1;
+    double nearest_distance = numeric_limits<double>::max();
+    int cell_x = to_cell_x(x[point]);
+    int cell_y = to_cell_y(y[point]);
+    int max_ring = max(num_cells_x, num_cells_y);
+    for (int r = 0; r <= max_ring; ++r) {
+        visit_ring(cell_x, cell_y, r, num_cells_x, num_cells_y, [&](int cell) {
+            for (int slot = cell_starts[cell]; slot < cell_starts[cell] + cell_sizes[cell]; ++slot) {
+                int other = cell_points[slot];
+                double other_distance = distance(point, other);
+                if (other_distance < nearest_distance || (other_distance == nearest_distance && other < nearest)) {
+                    nearest = other;
+                    nearest_distance = other_distance;
+                }
+            }
+        });
+        if (nearest >= 0 && nearest_distance < r * cell_size)
+            break;
+    }
+    return nearest;
+}
+
+// Take a point that has been put in the greedy tour out of its cell
+void Tour_planner::remove_from_grid(int point)
+{
+    int cell = point_cells[point];
+    int last_slot = cell_starts[cell] + --cell_sizes[cell];
+    int last_point = cell_points[last_slot];
+    swap(cell_points[point_slots[point]], cell_points[last_slot]);
+    swap(point_slots[point], point_slots[last_point]);
+}
+
+// Apply 2-opt and Or-opt moves until none makes the tour shorter
+void Tour_planner::improve_tour()
+{
+    int num_points = static_cast<int>(tour.size());
+    positions.resize(num_points);
+    for (int position = 0; position < num_points; ++position)
+        positions[tour[position]] = position;
+
+    queue.assign(tour.begin(), tour.end());
+    queued.assign(num_points, true);
+    while (!queue.empty()) {
+        int point = queue.front();
+        queue.pop_front();
+        queued[point] = false;
+        // the points whose edges a move changes are queued again, this one among them
+        if (!try_2_opt(point))
+            try_or_opt(point);
+    }
+}
+
+// Look for a 2-opt move, or an Or-opt move, that joins point to one of its
+// neighbours and makes the tour shorter; make the first one found, queue the
+// points whose edges it changed, and return true, or return false if there is none
+bool Tour_planner::try_2_opt(int point)
+{
+    const int* point_neighbours = &neighbours[size_t(point) * num_neighbours];
+    const double* point_neighbour_distances = &neighbour_distances[size_t(point) * num_neighbours];
+    for (bool forward : {true, false}) {
+        // take out the edge from point to its next (or previous) point and the one from
+        // a neighbour to its next (or previous) point; join point to the neighbour
+        int point_next = forward ? next(point) : previous(point);
+        double point_edge = distance(point, point_next);
+        for (int k = 0; k < num_neighbours; ++k) {
+            // a neighbour as far as the edge taken out cannot make the tour shorter
+            double new_edge = point_neighbour_distances[k];
+            if (new_edge >= point_edge)
+                break;
+            int neighbour = point_neighbours[k];
+            int neighbour_next = forward ? next(neighbour) : previous(neighbour);
+            if (neighbour == point_next || neighbour_next == point)
+                continue;
+            double gain = point_edge + distance(neighbour, neighbour_next) - new_edge
+                - distance(point_next, neighbour_next);
+            if (gain <= min_gain)
+                continue;
+
+            // the path from the second point of the first edge to the first point of the second is reversed
+            int edge1 = positions[forward ? point : point_next];
+            int edge2 = positions[forward ? neighbour : neighbour_next];
+            reverse_tour(min(edge1, edge2) + 1, max(edge1, edge2));
+            for (int changed : {point, point_next, neighbour, neighbour_next})
+                enqueue(changed);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool Tour_planner::try_or_opt(int point)
+{
+    int num_points = static_cast<int>(tour.size());
+    int position = positions[point];
+    for (int run_length = 1; run_length <= min(max_run_length, num_points - 2); ++run_length) {
+        // the runs that start or end at point; the first point of the tour stays first
+        for (int first : {position, position - run_length + 1}) {
+            int last = first + run_length - 1;
+            if (first < 1 || last > num_points - 1 || (run_length == 1 && first != position))
+                continue;
+            int run_first = tour[first];
+            int run_last = tour[last];
+            int before = tour[first - 1];
+            int after = tour[last + 1 == num_points ? 0 : last + 1];
+            double removal_gain = distance(before, run_first) + distance(run_last, after) - distance(before, after);
+
+            for (int end : {run_first, run_last}) {
+                int other_end = end == run_first ? run_last : run_first;
+                const int* end_neighbours = &neighbours[size_t(end) * num_neighbours];
+                const double* end_neighbour_distances = &neighbour_distances[size_t(end) * num_neighbours];
+                for (int k = 0; k < num_neighbours; ++k) {
+                    double new_edge = end_neighbour_distances[k];
+                    if (new_edge >= removal_gain)
+                        break;
+                    int neighbour = end_neighbours[k];
+                    if (positions[neighbour] >= first && positions[neighbour] <= last)
+                        continue;
+
+                    // put the run just after the neighbour with end first, or just before it with end last;
+                    // the points next to the neighbour are those once the run is taken out
+                    int neighbour_next = neighbour == before ? after : next(neighbour);
+                    int neighbour_previous = neighbour == after ? before : previous(neighbour);
+                    double after_cost = new_edge + distance(other_end, neighbour_next)
+                        - distance(neighbour, neighbour_next);
+                    double before_cost = new_edge + distance(other_end, neighbour_previous)
+                        - distance(neighbour_previous, neighbour);
+                    bool put_after = after_cost <= before_cost;
+                    if (removal_gain - (put_after ? after_cost : before_cost) <= min_gain)
+                        continue;
+
+                    int new_before = put_after ? neighbour : neighbour_previous;
+                    int new_after = put_after ? neighbour_next : neighbour;
+                    // the run is the other way round if the end that now comes first is its last point
+                    bool reversed = (put_after ? end : other_end) == run_last;
+                    move_run(first, last, new_before, reversed);
+                    for (int changed : {before, after, run_first, run_last, new_before, new_after})
+                        enqueue(changed);
+                    return true;
+                }
+            }
+        }
+    }
+    return false;
+}
+
+// Reverse the part of the tour from position first to position last
+void Tour_planner::reverse_tour(int first, int last)
+{
+    for (; first < last; ++first, --last) {
+        swap(tour[first], tour[last]);
+        positions[tour[first]] = first;
+        positions[tour[last]] = last;
+    }
+    if (first == last)
+        positions[tour[first]] = first;
+}
+
+// Move the run of the tour from position first to position last to just
+// after point, reversing it if reversed
+void Tour_planner::move_run(int first, int last, int point, bool reversed)
+{
+    int run_length = last - first + 1;
+    int point_position = positions[point];
+    int changed_first = first;
+    int changed_last = last;
+    if (point_position > last) {
+        rotate(tour.begin() + first, tour.begin() + last + 1, tour.begin() + point_position + 1);
+        changed_last = point_position;
+        first = point_position - run_length + 1;
+    } else if (point_position < first - 1) {
+        rotate(tour.begin() + point_position + 1, tour.begin() + first, tour.begin() + last + 1);
+        changed_first = point_position + 1;
+        first = point_position + 1;
+    }
+    for (int position = changed_first; position <= changed_last; ++position)
+        positions[tour[position]] = position;
+    if (reversed)
+        reverse_tour(first, first + run_length - 1);
+}
+
+// Put a point in the queue if it is not there
+void Tour_planner::enqueue(int point)
+{
+    if (!queued[point]) {
+        queued[point] = true;
+        queue.push_back(point);
+    }
+}
@@ -1,4 +1,5 @@
 #include "Twod_view.h"
+#include <algorithm>
 #include <cmath>
 
 using namespace std;
@@ -7,82 +8,68 @@ Twod_view::Twod_view(int size_, double scale_, Point origin_)
     : size(size_)
     , scale(scale_)
     , origin(origin_)
+    , grid_valid(false)
+    , outside_dirty(false)
+    , outside_changed(false)
 { }
 
-// Populate a two-dimensional vector
-// and a vector of objects which are outside the view of the map
-void Twod_view::draw()
+// Apply the changes, moving each object that changed cells
+void Twod_view::apply_changes(const View_change* changes, size_t num_changes, const vector<string>& names)
 {
-    vector<vector<string>> twod_map;
-    map<string, Point> object_temp_map = get_object_info_map();
-    object_outside_map.clear();
+    for (size_t i = 0; i < num_changes; ++i) {
+        const View_change& change = changes[i];
+        bool was_located = size_t(change.id) < get_objects().size() && get_objects()[change.id].has_location;
+        Point old_location = was_located ? get_objects()[change.id].location : Point();
+
+        apply_change(change, names);
+        if (!grid_valid)
+            continue;
+
+        const Object_info& object = get_objects()[change.id];
+        // an object that stays in its cell, or outside the map, changes nothing
+        if (was_located && object.has_location && get_cell_index(old_location) == get_cell_index(object.location))
+            continue;
+        if (was_located)
+            remove_from_grid(change.id, object.name, old_location);
+        if (object.has_location)
+            add_to_grid(change.id, object.name, object.location);
+    }
+}
+
+// Bring the text of the dirty rows up to date
+void Twod_view::update_rows()
+{
+    if (!grid_valid)
+        build_grid();
 
-    for (int j = 0; j < size; ++j) {
-        vector<string> oned_map;
-        for (int k = 0; k < size; ++k) {
-            // count keeps track of how many objects are
-            // in the same spot.
-            int count = 0;
-
-            // pushed indicates whether an object is inserted
-            // into the current index or not.
-            bool pushed = false;
-
-            int x, y;
-            auto it = object_temp_map.cbegin();
-
-            while (it != object_temp_map.cend()) {
-                bool inside = get_subscripts(x, y, it->second);
-
-                // Check if x and y from get_subscripts match j and k
-                if (x == k && y == size - j - 1) {
-                    if (count == 0) {
-                        oned_map.push_back(string(it->first.cbegin(), it->first.cbegin() + 2));
-                        ++count;
-                        pushed = true;
-                    }
-                    // If more than one object was pushed into a certain point,
-                    // get rid of whatever is in that point and push "*"
-                    else {
-                        oned_map.pop_back();
-                        oned_map.push_back("*");
-                        ++count;
-                    }
-
-                    object_temp_map.erase(it++);
-                }
-                // If the object is outside the map,
-                // add it to object_outside_map
-                // and then erase it from object_temp_map
-                else if (!inside) {
-                    object_outside_map.push_back(it->first);
-                    object_temp_map.erase(it++);
-                } else
-                    ++it;
-            }
-
-            // If nothing was pushed, push "."
-            if (!pushed)
-                oned_map.push_back(".");
-        }
-        twod_map.push_back(oned_map);
+    changed_rows.clear();
+    for (int row = 0; row < size; ++row) {
+        if (!dirty_rows[row])
+            continue;
+        row_texts[row] = render_row(row);
+        dirty_rows[row] = false;
+        changed_rows.push_back(row);
     }
-    two_dimensional_map = twod_map;
+    outside_changed = outside_dirty;
+    outside_dirty = false;
 }
 
 void Twod_view::set_size(int size_)
 {
     size = size_;
+    grid_valid = false;
 }
 
 void Twod_view::set_scale(double scale_)
 {
     scale = scale_;
+    grid_valid = false;
 }
 
 void Twod_view::set_origin(Point origin_)
 {
     origin = origin_;
+    grid_valid = false;
 }
 
 void Twod_view::set_defaults()
@@ -90,6 +77,83 @@ void Twod_view::set_defaults()
     size = 25;
     scale = 2.0;
     origin = Point(-10, -10);
+    grid_valid = false;
+}
+
+// Build the grid from all the objects, with every row dirty
+void Twod_view::build_grid()
+{
+    grid.assign(size * size * cell_width, '\0');
+    cell_objects.assign(size * size, vector<int>());
+    for (int index = 0; index < size * size; ++index)
+        grid[index * cell_width] = empty_cell;
+    object_outside_map.clear();
+    dirty_rows.assign(size, true);
+    row_texts.assign(size, string());
+    grid_valid = true;
+
+    for (size_t id = 0; id < get_objects().size(); ++id) {
+        const Object_info& object = get_objects()[id];
+        if (object.has_location)
+            add_to_grid(int(id), object.name, object.location);
+    }
+    outside_dirty = true;
+}
+
+// Put an object into the cell for location
+void Twod_view::add_to_grid(int id, const string& name, Point location)
+{
+    int index = get_cell_index(location);
+    if (index == -1) {
+        object_outside_map.insert(name);
+        outside_dirty = true;
+        return;
+    }
+    cell_objects[index].push_back(id);
+    refresh_cell(index);
+}
+
+// Take an object out of the cell for location
+void Twod_view::remove_from_grid(int id, const string& name, Point location)
+{
+    int index = get_cell_index(location);
+    if (index == -1) {
+        object_outside_map.erase(name);
+        outside_dirty = true;
+        return;
+    }
+    vector<int>& ids = cell_objects[index];
+    ids.erase(find(ids.begin(), ids.end(), id));
+    refresh_cell(index);
+}
+
+// Set what the cell with this index shows from the objects in it, and mark its row dirty
+void Twod_view::refresh_cell(int index)
+{
+    const vector<int>& ids = cell_objects[index];
+    char* cell = &grid[index * cell_width];
+    if (ids.empty()) {
+        cell[0] = empty_cell;
+        cell[1] = '\0';
+    } else if (ids.size() == 1) {
+        // a name too short to fill the cell is padded with a blank
+        const string& name = get_objects()[ids.front()].name;
+        cell[0] = name[0];
+        cell[1] = name.size() > 1 ? name[1] : ' ';
+    } else {
+        cell[0] = crowded_cell;
+        cell[1] = '\0';
+    }
+    dirty_rows[index / size] = true;
+}
+
+// Return the index of the cell for location, or -1 if it is outside the grid
+int Twod_view::get_cell_index(Point location) const
+{
+    int x, y;
+    if (!get_subscripts(x, y, location))
+        return -1;
+    return (size - y - 1) * size + x;
 }
 
 // Calculate the cell subscripts corresponding to the supplied location parameter,
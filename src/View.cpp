@@ -1,57 +1,50 @@
 #include "View.h"
 #include "Utility.h"
 #include <string>
+#include <vector>
 
 using namespace std;
 
-// Save the supplied name and location for future use in a draw() call
-// If the name is already present,the new location replaces the previous one.
-void View::update_location(const string& name, Point location)
+// Apply the changes of a tick, which come in the order they were made;
+// names holds the name of every object by id
+void View::apply_changes(const View_change* changes, size_t num_changes, const vector<string>& names)
 {
-    auto pair = object_info_map.insert(make_pair(name, location));
-    if (!pair.second)
-        pair.first->second = location;
+    for (size_t i = 0; i < num_changes; ++i)
+        apply_change(changes[i], names);
 }
 
-// Remove the name and its location; no error if the name is not present.
-void View::update_remove(const string& name)
+// Apply one change
+void View::apply_change(const View_change& change, const vector<string>& names)
 {
-    if (object_info_map.erase(name) == 0)
-        return;
-    ship_info_map.erase(name);
-}
-
-// Update information about a Ship's fuel
-void View::ship_fuel_update(const std::string& name, double fuel)
-{
-    auto iter_bool = ship_info_map.insert(make_pair(name, Ship_info(fuel, 0, 0)));
-
-    // If the Ship already exists, simply update
-    // its information in the map.
-    if (!iter_bool.second)
-        iter_bool.first->second.fuel = fuel;
-}
-
-// Update information about a Ship's course
-void View::ship_course_update(const std::string& name, double course)
-{
-    auto iter_bool = ship_info_map.insert(make_pair(name, Ship_info(0, course, 0)));
+    if (size_t(change.id) >= objects.size())
+        objects.resize(change.id + 1);
+    Object_info& object = objects[change.id];
+    if (!object.has_location && !object.has_ship_info)
+        object.name = names[change.id];
 
-    // If the Ship already exists, simply update
-    // its information in the map.
-    if (!iter_bool.second)
-        iter_bool.first->second.course = course;
-}
+    if (change.dirty_mask & View_change::location_changed) {
+        object.has_location = true;
+        object.location = change.location;
+    }
 
-// Update information about a Ship's speed
-void View::ship_speed_update(const std::string& name, double speed)
-{
-    auto iter_bool = ship_info_map.insert(make_pair(name, Ship_info(0, 0, speed)));
+    if (change.dirty_mask & (View_change::fuel_changed | View_change::course_changed | View_change::speed_changed)) {
+        // Sailing data that has not been given yet starts out as zero
+        if (!object.has_ship_info)
+            object.ship_info = Ship_info(0., 0., 0.);
+        object.has_ship_info = true;
+        if (change.dirty_mask & View_change::fuel_changed)
+            object.ship_info.fuel = change.fuel;
+        if (change.dirty_mask & View_change::course_changed)
+            object.ship_info.course = change.course;
+        if (change.dirty_mask & View_change::speed_changed)
+            object.ship_info.speed = change.speed;
+    }
 
-    // If the Ship already exists, simply update
-    // its information in the map.
-    if (!iter_bool.second)
-        iter_bool.first->second.speed = speed;
+    // An object the View has not been given a location for is not forgotten
+    if ((change.dirty_mask & View_change::gone) && object.has_location) {
+        object.has_location = false;
+        object.has_ship_info = false;
+    }
 }
 
 // Throw an Error because you cannot perform these functions
@@ -73,4 +66,9 @@ void View::set_origin(Point origin_)
 void View::set_defaults()
 {
     throw Error("Cannot set default for this View!");
+}
+
+void View::set_live(bool)
+{
+    throw Error("Cannot set live mode for this View!");
 }
\ No newline at end of file
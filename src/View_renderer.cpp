@@ -0,0 +1,246 @@
+#include "View_renderer.h"
+#include "Profiler.h"
+#include "Utility.h"
+#include <algorithm>
+#include <cassert>
+#include <iostream>
+#include <sstream>
+#include <utility>
+
+using namespace std;
+
+// The thread is started when the first job is put in
+View_renderer::View_renderer()
+    : batch_open(false)
+    , num_names_published(0)
+    , jobs_posted(0)
+    , jobs_done(0)
+    , frame_policy(Frame_policy::block)
+    , max_frames(16)
+    , shutting_down(false)
+{ }
+
+View_renderer::~View_renderer()
+{
+    {
+        lock_guard<mutex> lock(render_mutex);
+        shutting_down = true;
+    }
+    work_ready.notify_one();
+    frame_room.notify_one();
+    if (renderer.joinable())
+        renderer.join();
+}
+
+// Add or remove a View; after attach, only the thread may touch the View
+void View_renderer::attach(shared_ptr<View> view_ptr)
+{
+    unique_lock<mutex> lock(render_mutex);
+    push_command(lock, [this, view_ptr](ostream&) { views.push_back(view_ptr); });
+}
+
+void View_renderer::detach(shared_ptr<View> view_ptr)
+{
+    unique_lock<mutex> lock(render_mutex);
+    push_command(lock, [this, view_ptr](ostream&) { views.erase(find(views.begin(), views.end(), view_ptr)); });
+}
+
+// Hand a batch of changes over to the Views, leaving changes empty;
+// the thread keeps its own copy of the names in names
+void View_renderer::publish(vector<View_change>& changes, const Name_table& names_)
+{
+    if (changes.empty())
+        return;
+
+    unique_lock<mutex> lock(render_mutex);
+    if (batch_open) {
+        merge_into_open_batch(changes);
+        changes.clear();
+    } else {
+        // The Model goes on with the buffer of the last batch applied
+        jobs.emplace_back();
+        jobs.back().changes.swap(changes);
+        changes.swap(spare_changes);
+        ++jobs_posted;
+
+        batch_open = true;
+        const vector<View_change>& batch = jobs.back().changes;
+        for (size_t i = 0; i < batch.size(); ++i) {
+            if (size_t(batch[i].id) >= open_batch_indexes.size())
+                open_batch_indexes.resize(batch[i].id + 1, -1);
+            open_batch_indexes[batch[i].id] = int(i);
+        }
+    }
+
+    vector<string>& new_names = jobs.back().new_names;
+    for (; int(num_names_published) < names_.size(); ++num_names_published)
+        new_names.push_back(names_.get_name(int(num_names_published)));
+
+    if (!renderer.joinable())
+        renderer = thread(&View_renderer::render_loop, this);
+    work_ready.notify_one();
+}
+
+// Have the thread run command after everything put in before. What it
+// writes, formatted as cout is now, is a frame. If it throws an Error,
+// the message is written to the frame instead.
+void View_renderer::post(function<void(ostream&)> command)
+{
+    unique_lock<mutex> lock(render_mutex);
+    push_command(lock, move(command));
+}
+
+// Write the frames that are ready to os; wait for the frames of every
+// command put in so far if wait_all is true or the policy is block
+void View_renderer::write_frames(ostream& os, bool wait_all)
+{
+    unique_lock<mutex> lock(render_mutex);
+    bool wait = wait_all || frame_policy == Frame_policy::block;
+    unsigned long last_job = jobs_posted;
+    bool written = false;
+    while (true) {
+        while (!frames.empty()) {
+            string frame = move(frames.front());
+            frames.pop_front();
+            frame_room.notify_one();
+            lock.unlock();
+            os << frame;
+            written = true;
+            lock.lock();
+        }
+        if (!wait || jobs_done >= last_job)
+            break;
+        progress.wait(lock, [&] { return !frames.empty() || jobs_done >= last_job; });
+    }
+    lock.unlock();
+
+    if (written)
+        os.flush();
+}
+
+// Throws Error if max_frames is not positive
+void View_renderer::set_frame_policy(Frame_policy frame_policy_, int max_frames_)
+{
+    if (max_frames_ <= 0)
+        throw Error("Expected a positive number of frames!");
+
+    {
+        lock_guard<mutex> lock(render_mutex);
+        frame_policy = frame_policy_;
+        max_frames = max_frames_;
+    }
+    frame_room.notify_one();
+}
+
+// Put a command into the queue; render_mutex must be held by lock
+void View_renderer::push_command(unique_lock<mutex>& lock, function<void(ostream&)> command)
+{
+    assert(lock.owns_lock() && lock.mutex() == &render_mutex);
+    (void)lock;
+    if (batch_open)
+        close_batch();
+
+    jobs.emplace_back();
+    Job& job = jobs.back();
+    job.command = move(command);
+    job.flags = cout.flags();
+    job.precision = cout.precision();
+    ++jobs_posted;
+
+    if (!renderer.joinable())
+        renderer = thread(&View_renderer::render_loop, this);
+    work_ready.notify_one();
+}
+
+// Merge the changes into the open batch, one record per object
+void View_renderer::merge_into_open_batch(const vector<View_change>& changes)
+{
+    vector<View_change>& batch = jobs.back().changes;
+    for (const View_change& change : changes) {
+        if (size_t(change.id) >= open_batch_indexes.size())
+            open_batch_indexes.resize(change.id + 1, -1);
+        int& index = open_batch_indexes[change.id];
+
+        // a change after the object went starts a new record, as in the Model
+        if (index == -1 || (batch[index].dirty_mask & View_change::gone)) {
+            index = int(batch.size());
+            batch.push_back(change);
+            continue;
+        }
+
+        View_change& record = batch[index];
+        if (change.dirty_mask & View_change::location_changed)
+            record.location = change.location;
+        if (change.dirty_mask & View_change::fuel_changed)
+            record.fuel = change.fuel;
+        if (change.dirty_mask & View_change::course_changed)
+            record.course = change.course;
+        if (change.dirty_mask & View_change::speed_changed)
+            record.speed = change.speed;
+        record.dirty_mask |= change.dirty_mask;
+    }
+}
+
+// No more changes go into the last batch
+void View_renderer::close_batch()
+{
+    for (const View_change& change : jobs.back().changes)
+        open_batch_indexes[change.id] = -1;
+    batch_open = false;
+}
+
+// Put a frame into the queue as the policy says; render_mutex must be held by lock
+void View_renderer::push_frame(unique_lock<mutex>& lock, string frame)
+{
+    frame_room.wait(lock, [this] {
+        return frames.size() < max_frames || frame_policy == Frame_policy::drop || shutting_down;
+    });
+    while (frames.size() >= max_frames)
+        frames.pop_front();
+    frames.push_back(move(frame));
+}
+
+void View_renderer::render_loop()
+{
+    unique_lock<mutex> lock(render_mutex);
+    while (true) {
+        work_ready.wait(lock, [this] { return shutting_down || !jobs.empty(); });
+        if (shutting_down)
+            return;
+
+        if (batch_open && jobs.size() == 1)
+            close_batch();
+        Job job = move(jobs.front());
+        jobs.pop_front();
+        lock.unlock();
+
+        string frame;
+        if (job.command) {
+            ostringstream os;
+            os.flags(job.flags);
+            os.precision(job.precision);
+            try {
+                job.command(os);
+            } catch (Error& error) {
+                os << error.what() << endl;
+            }
+            frame = os.str();
+        } else {
+            PROFILE_SCOPE(Profile_section::apply_changes);
+            names.insert(names.end(), job.new_names.begin(), job.new_names.end());
+            for (const auto& view_ptr : views)
+                view_ptr->apply_changes(job.changes.data(), job.changes.size(), names);
+        }
+
+        lock.lock();
+        // keep the larger buffer for the Model to fill next
+        if (job.changes.capacity() > spare_changes.capacity()) {
+            job.changes.clear();
+            spare_changes.swap(job.changes);
+        }
+        if (!frame.empty())
+            push_frame(lock, move(frame));
+        ++jobs_done;
+        progress.notify_all();
+    }
+}
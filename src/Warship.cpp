@@ -1,12 +1,15 @@
 #include "Warship.h"
+#include "Checkpoint.h"
 #include "Island.h"
+#include "Logger.h"
 #include "Model.h"
 #include "Utility.h"
 #include <iostream>
 
 using namespace std;
 
-Warship::Warship(const string& name_,
+Warship::Warship(Model& model_,
+    const string& name_,
     Point position_,
     int firepower_,
     double max_range_,
@@ -14,10 +17,11 @@ Warship::Warship(const string& name_,
     double maximum_speed_,
     double fuel_consumption_,
     int resistance_)
-    : Ship(name_, position_, fuel_capacity_, maximum_speed_, fuel_consumption_, resistance_)
+    : Ship(model_, name_, position_, fuel_capacity_, maximum_speed_, fuel_consumption_, resistance_)
     , firepower(firepower_)
     , max_range(max_range_)
     , state(Warship_state::not_attacking)
+    , out_of_range(false)
 { }
 
 // Update the state of the Warship
@@ -32,66 +36,115 @@ void Warship::update()
 
     // If Warship is not afloat or its target is not afloat,
     // stop attacking.
-    if (!target.lock() || !target.lock()->is_afloat()) {
+    Ship* target_ptr = get_model().resolve_ship(target);
+    if (!target_ptr || !target_ptr->is_afloat()) {
         stop_attack();
-        target.reset();
         return;
     }
 
-    cout << get_name() << " is attacking" << endl;
+    LOG(Log_level::info, Log_category::combat) << get_name() << " is attacking";
 
     // If the target is in range, make the target
     // receive_hit with this Warship's firepower.
-    if (cartesian_distance(get_location(), target.lock()->get_location()) <= max_range) {
-        cout << get_name() << " fires" << endl;
-        target.lock()->receive_hit(firepower, shared_from_this());
+    if (cartesian_distance(get_location(), target_ptr->get_location()) <= max_range) {
+        LOG(Log_level::info, Log_category::combat) << get_name() << " fires";
+        target_ptr->receive_hit(firepower, shared_from_this());
         return;
     }
 
     out_of_range = true;
 }
 
+// An attacking Warship fires or checks its range on every update
+int Warship::ticks_until_event() const
+{
+    if (state == Warship_state::attacking)
+        return 0;
+    return Ship::ticks_until_event();
+}
+
+Event_type Warship::get_event_type() const
+{
+    if (state == Warship_state::attacking)
+        return Event_type::target_in_range;
+    return Ship::get_event_type();
+}
+
 // Describe this Warship's state
 void Warship::describe() const
 {
     Ship::describe();
     if (state == Warship_state::attacking) {
-        if (!target.lock() || !target.lock()->is_afloat())
+        Ship* target_ptr = get_model().resolve_ship(target);
+        if (!target_ptr || !target_ptr->is_afloat())
             cout << "Attacking absent ship" << endl;
         else
-            cout << "Attacking " << target.lock()->get_name() << endl;
+            cout << "Attacking " << target_ptr->get_name() << endl;
     }
 }
 
 // Start an attack on a target ship
 void Warship::attack(shared_ptr<Ship> target_ptr_)
+{
+    if (const char* failure = check_attack(target_ptr_))
+        throw Error(failure);
+
+    // Whether this Warship is attacking another target, one that has
+    // sunk, or nothing, set target to target_ptr and set state to attacking.
+    target = get_model().get_handle(*target_ptr_);
+    state = Warship_state::attacking;
+    LOG(Log_level::info, Log_category::combat) << get_name() << " will attack " << target_ptr_->get_name();
+}
+
+void Warship::stop_attack()
+{
+    if (const char* failure = check_stop_attack())
+        throw Error(failure);
+
+    // Change the state and reset target
+    state = Warship_state::not_attacking;
+    target = Object_handle();
+    LOG(Log_level::info, Log_category::combat) << get_name() << " stopping attack";
+}
+
+// A Warship that is sinking cannot attack, nor attack itself or its target again
+const char* Warship::check_attack(shared_ptr<Ship> target_ptr_) const
 {
     if (!is_afloat())
-        throw Error("Cannot attack!");
+        return "Cannot attack!";
 
-    if (target_ptr_ == shared_from_this())
-        throw Error("Cannot attack itself!");
+    if (target_ptr_.get() == this)
+        return "Cannot attack itself!";
 
-    if (target.lock() == target_ptr_)
-        throw Error("Already attacking this target!");
+    if (get_model().resolve_ship(target) == target_ptr_.get())
+        return "Already attacking this target!";
 
-    // If this Warship is already attacking another target or if
-    // this Warship is not attacking, set target to target_ptr
-    // and set state to attacking.
-    if (target.lock() || state == Warship_state::not_attacking) {
-        target = target_ptr_;
-        state = Warship_state::attacking;
-        cout << get_name() << " will attack " << target.lock()->get_name() << endl;
-    }
+    return nullptr;
 }
 
-void Warship::stop_attack()
+const char* Warship::check_stop_attack() const
 {
-    if (state != Warship_state::attacking)
-        throw Error("Was not attacking!");
+    return state == Warship_state::attacking ? nullptr : "Was not attacking!";
+}
 
-    // Change the state and reset target
-    state = Warship_state::not_attacking;
-    target.reset();
-    cout << get_name() << " stopping attack" << endl;
-}
\ No newline at end of file
+// Set this Warship's state and target from a checkpoint record
+// Throws Error if the record is not valid.
+void Warship::restore(const Warship_record& record, const Checkpoint_reader& reader)
+{
+    if (record.attacking > 1)
+        throw Error("Checkpoint file is damaged!");
+
+    restore_ship_record(record.ship, reader);
+    state = record.attacking ? Warship_state::attacking : Warship_state::not_attacking;
+    target = reader.get_ship_handle(record.target);
+}
+
+// Return a checkpoint record of this Warship
+Warship_record Warship::make_warship_record(Checkpoint_writer& writer) const
+{
+    Warship_record record{};
+    record.ship = make_ship_record(writer);
+    record.target = writer.get_ship_id(get_model().resolve_ship(target));
+    record.attacking = state == Warship_state::attacking;
+    return record;
+}
@@ -1,23 +1,115 @@
 #include "Controller.h"
+#include "Monte_carlo.h"
+#include "Profiler.h"
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
 #include <exception>
 
 using namespace std;
 
+// Read a whole non-negative number from arg into value; return false if arg is not one
+static bool read_count(const char* arg, long& value)
+{
+    char* end;
+    value = strtol(arg, &end, 10);
+    return *arg != '\0' && *end == '\0' && value >= 0 && value <= 1000000000;
+}
+
+// Read the arguments after "--monte-carlo" into settings; return false if they are not valid:
+//     <runs> <ticks> [--seed <seed>] [--ships <ships>] [<script> ...]
+static bool read_monte_carlo_arguments(int argc, char* argv[], Monte_carlo_settings& settings)
+{
+    long runs, ticks, value;
+    if (argc < 4 || !read_count(argv[2], runs) || !read_count(argv[3], ticks) || runs == 0)
+        return false;
+    settings.num_runs = static_cast<int>(runs);
+    settings.num_ticks = static_cast<int>(ticks);
+    settings.seed = 1;
+    settings.num_ships = 20;
+
+    for (int i = 4; i < argc; ++i) {
+        if (strcmp(argv[i], "--seed") == 0 || strcmp(argv[i], "--ships") == 0) {
+            if (i + 1 == argc || !read_count(argv[i + 1], value))
+                return false;
+            if (strcmp(argv[i], "--seed") == 0)
+                settings.seed = static_cast<unsigned int>(value);
+            else
+                settings.num_ships = static_cast<int>(value);
+            ++i;
+        } else {
+            settings.scripts.push_back(argv[i]);
+        }
+    }
+    return true;
+}
+
 // The main function creates the Controller object, then tells it to run.
+// With "--script <file>" the commands are run from the file ("-" for standard
+// input) without prompting instead of interactively. With "--monte-carlo" many
+// worlds are run at once instead, and their outcomes summed up (see Monte_carlo.h).
+// With "--trace <file>" first, the profiler's record of the run is written to the
+// file as a Chrome trace at the end (see Profiler.h).
 
-int main()
+int main(int argc, char* argv[])
 {
+    const char* program_name = argv[0];
+    const char* trace_filename = nullptr;
+    if (argc >= 3 && strcmp(argv[1], "--trace") == 0) {
+        trace_filename = argv[2];
+        argc -= 2;
+        argv += 2;
+    }
+
+    const char* script_filename = nullptr;
+    bool monte_carlo = false;
+    Monte_carlo_settings monte_carlo_settings;
+    if (argc == 3 && strcmp(argv[1], "--script") == 0) {
+        script_filename = argv[2];
+    } else if (argc >= 2 && strcmp(argv[1], "--monte-carlo") == 0
+        && read_monte_carlo_arguments(argc, argv, monte_carlo_settings)) {
+        monte_carlo = true;
+    } else if (argc != 1) {
+        cout << "Usage: " << program_name << " [--trace <file>] [--script <file>]" << endl;
+        cout << "       " << program_name
+             << " [--trace <file>] --monte-carlo <runs> <ticks> [--seed <seed>] [--ships <ships>] [<script> ...]"
+             << endl;
+        return 1;
+    }
+
+    if (trace_filename) {
+        if (!profiler_built_in) {
+            cout << "Profiler is not built in!" << endl;
+            return 1;
+        }
+        Profiler::get_instance().set_tracing(true);
+    }
+
     // Set output to show two decimal places
     //	cout << fixed << setprecision(2) << endl;
     cout.setf(ios::fixed, ios::floatfield);
     cout.precision(2);
 
     try {
-        // create the Controller and go
-        Controller controller;
+        if (monte_carlo) {
+            auto start = chrono::steady_clock::now();
+            vector<Run_outcome> outcomes = run_monte_carlo(monte_carlo_settings);
+            chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+            report_monte_carlo(outcomes);
+            cout << "in " << elapsed.count() << " s" << endl;
+        } else {
+            // create the Controller and go
+            Controller controller;
+
+            if (script_filename)
+                controller.run_script(script_filename);
+            else
+                controller.run();
+        }
 
-        controller.run();
+        if (trace_filename)
+            Profiler::get_instance().write_trace(trace_filename);
     }
     // catch all exceptions not handled by Controller
     catch (std::exception& error) {
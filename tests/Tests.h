@@ -0,0 +1,31 @@
+/*
+The tests that simulation_tests runs, one function for each part of the
+simulation they cover. A test calls check for each thing it verifies; a check
+that fails is reported with its message, and the test goes on, so that one run
+shows every failure.
+*/
+
+#ifndef TESTS_H
+#define TESTS_H
+
+#include <string>
+
+// Report message as a failure of the running test if condition is false
+void check(bool condition, const std::string& message);
+
+// advance_positions, in every version, against Track_base::update_position
+void test_kinematics();
+
+// Model::update(num_ticks), skipping over quiet stretches, against one tick at a time
+void test_fast_forward();
+
+// The event mode against the serial mode, at every time and over longer stretches
+void test_event_mode();
+
+// The parallel mode against the serial mode, with enough Ships for several chunks
+void test_parallel_mode();
+
+// Model::screen_cpa against compute_CPA for every pair of Ships
+void test_cpa_screen();
+
+#endif
@@ -0,0 +1,245 @@
+/*
+Tests Model::screen_cpa, and the Cpa_screen under it, against the plain way of
+finding the same pairs: compute_CPA for every pair of Ships, with the time
+limited to the horizon. The worlds are a dense one, where many Ships on random
+courses and speeds, some of them stopped, are crowded into a few miles, and one
+where none of the Ships is moving. Pairs of Ships that are both stationary are
+left out on both sides, as cpa_report documents. The Cpa_screen is also given
+no tracks and a single track, which a Model, always having its first Ships,
+cannot give it. A pair whose closest range is within tolerance of the range is
+not counted either way, since rounding may put it on either side.
+*/
+
+#include "Tests.h"
+#include "Command_reader.h"
+#include "Controller.h"
+#include "Cpa_screen.h"
+#include "Geometry.h"
+#include "Logger.h"
+#include "Model.h"
+#include "Navigation.h"
+#include "Ship.h"
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+// The worlds: the Ships are put in a square of this size, in nm, around its center
+const unsigned int cpa_seed = 1;
+const int dense_ships = 300;
+const int stationary_ships = 100;
+const double square_size = 10.;
+const Point square_center(20., 20.);
+
+// The ranges in nm and times in hours every world is screened with
+const double screen_ranges[] = {0.5, 2., 8.};
+const double screen_hours[] = {0., 0.25, 2.};
+
+// How far the screen's times and ranges may be from compute_CPA's
+const double tolerance = 1e-7;
+
+// A pair's time and range, by the ids of its Ships
+using Pair_map = map<pair<Object_id, Object_id>, pair<double, double>>;
+
+// Switch the Logger off, so that making the worlds writes nothing
+static void switch_logger_off()
+{
+    for (int category = 0; category < num_log_categories; ++category)
+        Logger::get_instance().set_category_enabled(static_cast<Log_category>(category), false);
+}
+
+// Give commands to the Model through a quiet Controller
+static void give(Model& model, const string& commands)
+{
+    Controller controller(model, true);
+    istringstream stream(commands);
+    Stream_reader reader(stream);
+    controller.run_batch(reader);
+}
+
+// Create num_ships Ships at random places in the square, and give each a random
+// course and speed, unless moving is false or it is one of the Ships left stopped
+static void add_ships(Model& model, int num_ships, bool moving)
+{
+    mt19937 generator(cpa_seed);
+    uniform_real_distribution<double> offset(-square_size / 2., square_size / 2.);
+    uniform_real_distribution<double> course(0., 360.);
+    uniform_real_distribution<double> speed(1., 12.);
+    uniform_int_distribution<int> one_in_four(0, 3);
+
+    ostringstream commands;
+    commands.precision(17);
+    for (int i = 0; i < num_ships; ++i) {
+        string name = "C" + to_string(i);
+        commands << "create " << name << " " << (i % 2 ? "Cruiser" : "Torpedo_boat") << " "
+                 << square_center.x + offset(generator) << " " << square_center.y + offset(generator) << "\n";
+        if (moving && one_in_four(generator))
+            commands << name << " course " << course(generator) << " " << speed(generator) << "\n";
+    }
+    give(model, commands.str());
+}
+
+// The course and speed a Ship holds, a speed of zero if it is not moving
+static Course_speed get_course_speed(const Ship& ship)
+{
+    if (!ship.is_moving())
+        return Course_speed(0., 0.);
+    return ship.get_track().get_course_speed();
+}
+
+// Return the time and range of the closest approach of two Ships in the next
+// hours, the plain way; false if both are stationary
+static bool get_closest_approach(const Ship& ship1, const Ship& ship2, double hours, pair<double, double>& result)
+{
+    Course_speed course_speed1 = get_course_speed(ship1);
+    Course_speed course_speed2 = get_course_speed(ship2);
+    if (course_speed1.speed == 0. && course_speed2.speed == 0.)
+        return false;
+
+    Point position1 = ship1.get_location();
+    Point position2 = ship2.get_location();
+    Cartesian_vector relative_motion = course_unit_vector(course_speed2.course) * course_speed2.speed
+        - course_unit_vector(course_speed1.course) * course_speed1.speed;
+    // compute_CPA has no time for tracks that keep the same distance
+    if (relative_motion.delta_x == 0. && relative_motion.delta_y == 0.) {
+        result = make_pair(0., cartesian_distance(position1, position2));
+        return true;
+    }
+
+    double time;
+    Compass_position cpa = compute_CPA(course_speed1, course_speed2, Compass_position(position1, position2), time);
+    if (time <= hours) {
+        result = make_pair(time, cpa.range);
+    } else {
+        Cartesian_vector at_horizon = (position2 - position1) + relative_motion * hours;
+        double range = sqrt(at_horizon.delta_x * at_horizon.delta_x + at_horizon.delta_y * at_horizon.delta_y);
+        result = make_pair(hours, range);
+    }
+    return true;
+}
+
+// Add the pair of ship1 and ship2 to expected if they come within range in the
+// next hours, and to undecided if they come within tolerance of the range
+static void add_expected_pair(const Ship& ship1,
+    const Ship& ship2,
+    double range,
+    double hours,
+    Pair_map& expected,
+    Pair_map& undecided)
+{
+    pair<double, double> approach;
+    if (!get_closest_approach(ship1, ship2, hours, approach))
+        return;
+    auto key = make_pair(ship1.get_id(), ship2.get_id());
+    if (fabs(approach.second - range) <= tolerance)
+        undecided[key] = approach;
+    else if (approach.second < range)
+        expected[key] = approach;
+}
+
+// Check the pairs a screen returned against the expected ones; label says which screen it was
+static void check_pairs(const Model& model,
+    const vector<Cpa_pair>& pairs,
+    const Pair_map& expected,
+    const Pair_map& undecided,
+    const string& label)
+{
+    auto pair_name = [&model](pair<Object_id, Object_id> key) {
+        return model.get_name(key.first) + " and " + model.get_name(key.second);
+    };
+
+    // soonest first, then closest first
+    check(is_sorted(pairs.begin(),
+              pairs.end(),
+              [](const Cpa_pair& pair1, const Cpa_pair& pair2) {
+                  return pair1.time != pair2.time ? pair1.time < pair2.time : pair1.range < pair2.range;
+              }),
+        label + ": the pairs are out of order");
+
+    Pair_map found;
+    for (const Cpa_pair& cpa_pair : pairs) {
+        auto key = make_pair(cpa_pair.id1, cpa_pair.id2);
+        if (!found.emplace(key, make_pair(cpa_pair.time, cpa_pair.range)).second)
+            check(false, label + ": " + pair_name(key) + " found twice");
+        if (undecided.count(key))
+            continue;
+        auto expected_pair = expected.find(key);
+        if (expected_pair == expected.end()) {
+            check(false, label + ": " + pair_name(key) + " found, but they do not come within range");
+            continue;
+        }
+        ostringstream message;
+        message.precision(17);
+        message << label << ": " << pair_name(key) << " pass " << cpa_pair.range << " nm apart in " << cpa_pair.time
+                << " hours, not " << expected_pair->second.second << " nm in " << expected_pair->second.first;
+        check(fabs(cpa_pair.time - expected_pair->second.first) <= tolerance
+                && fabs(cpa_pair.range - expected_pair->second.second) <= tolerance,
+            message.str());
+    }
+    for (const auto& expected_pair : expected)
+        check(found.count(expected_pair.first), label + ": " + pair_name(expected_pair.first) + " not found");
+}
+
+// Screen the Ships of model with every range and time, all of them at once and
+// every tenth one against the rest, and check each screen
+static void check_screens(Model& model, const string& label)
+{
+    vector<shared_ptr<Ship>> ships = model.get_ships();
+    for (double range : screen_ranges) {
+        for (double hours : screen_hours) {
+            ostringstream where;
+            where << label << ", range " << range << ", hours " << hours;
+
+            // in name order, as screen_cpa puts the pairs
+            Pair_map expected, undecided;
+            for (size_t i = 0; i < ships.size(); ++i)
+                for (size_t j = i + 1; j < ships.size(); ++j)
+                    add_expected_pair(*ships[i], *ships[j], range, hours, expected, undecided);
+            check_pairs(model, model.screen_cpa(range, hours), expected, undecided, where.str());
+
+            for (size_t i = 0; i < ships.size(); i += 10) {
+                Pair_map ship_expected, ship_undecided;
+                for (size_t j = 0; j < ships.size(); ++j)
+                    if (j != i)
+                        add_expected_pair(*ships[i], *ships[j], range, hours, ship_expected, ship_undecided);
+                check_pairs(model,
+                    model.screen_cpa(*ships[i], range, hours),
+                    ship_expected,
+                    ship_undecided,
+                    where.str() + ", " + ships[i]->get_name() + " against the rest");
+            }
+        }
+    }
+}
+
+// Model::screen_cpa against compute_CPA for every pair of Ships
+void test_cpa_screen()
+{
+    switch_logger_off();
+
+    Cpa_screen screen;
+    vector<Cpa_pair> pairs;
+    screen.screen(1., 1., pairs);
+    screen.screen_track(0, Point(0., 0.), Cartesian_vector(1., 0.), 1., 1., pairs);
+    check(pairs.empty(), "a screen of no tracks found pairs");
+    screen.add_track(0, Point(0., 0.), Cartesian_vector(1., 0.));
+    screen.screen(1., 1., pairs);
+    screen.screen_track(0, Point(0., 0.), Cartesian_vector(1., 0.), 1., 1., pairs);
+    check(pairs.empty(), "a screen of a single track found pairs");
+
+    Model dense;
+    add_ships(dense, dense_ships, true);
+    check_screens(dense, "dense");
+
+    Model stationary;
+    add_ships(stationary, stationary_ships, false);
+    check(stationary.screen_cpa(square_size, 1.).empty(), "stationary Ships found as pairs");
+    check_screens(stationary, "stationary");
+}
@@ -0,0 +1,133 @@
+/*
+Tests advance_positions, in the vector version this processor runs and in the
+scalar version, against Track_base::update_position, which Ship used to move
+by. The tracks have random positions, courses, speeds and times - a whole tick
+or a part of one, as a fuel-limited step is - along with the courses and
+speeds that are easy to get wrong, in batches of every size that leaves a
+remainder after the vector lanes, starting at an aligned address and not.
+*/
+
+#include "Tests.h"
+#include "Geometry.h"
+#include "Kinematics.h"
+#include "Navigation.h"
+#include "Track_base.h"
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <random>
+#include <sstream>
+#include <vector>
+
+using namespace std;
+
+// How many units in the last place the kernels may differ from update_position:
+// they make the same operations in the same order, so none
+const uint64_t max_ulps = 0;
+
+// The courses and speeds every batch starts with
+const double special_courses[] = {0., 90., 180., 270., 45., 359.99999999, 1e-12};
+const double special_speeds[] = {0., 1e-9, 15., 30.};
+
+// The batch sizes: every remainder after four lanes or two, and larger batches
+const size_t batch_sizes[] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 31, 1000, 1001, 1003};
+
+// Return how many representable doubles apart a and b are
+static uint64_t get_ulps_apart(double a, double b)
+{
+    // map the bits onto unsigned integers in the same order as the doubles, with 0 and -0 the same
+    auto to_ordered = [](double value) {
+        int64_t bits;
+        memcpy(&bits, &value, sizeof bits);
+        int64_t ordered = bits < 0 ? INT64_MIN - bits : bits;
+        return uint64_t(ordered) ^ (uint64_t(1) << 63);
+    };
+    uint64_t ordered_a = to_ordered(a);
+    uint64_t ordered_b = to_ordered(b);
+    return ordered_a > ordered_b ? ordered_a - ordered_b : ordered_b - ordered_a;
+}
+
+struct Batch
+{
+    vector<double> x, y, heading_x, heading_y, speed, time;
+    vector<Point> expected;
+};
+
+// Make a batch of count tracks, offset elements into its arrays
+static Batch make_batch(size_t count, size_t offset, mt19937& generator)
+{
+    uniform_real_distribution<double> position_distribution(-5000., 5000.);
+    uniform_real_distribution<double> course_distribution(0., 360.);
+    uniform_real_distribution<double> speed_distribution(0., 40.);
+    uniform_real_distribution<double> part_distribution(0., 1.);
+
+    Batch batch;
+    for (auto array : {&batch.x, &batch.y, &batch.heading_x, &batch.heading_y, &batch.speed, &batch.time})
+        array->resize(offset + count);
+    for (size_t i = 0; i < count; ++i) {
+        Point position(position_distribution(generator), position_distribution(generator));
+        double course = i < size(special_courses) ? special_courses[i] : course_distribution(generator);
+        double speed = i < size(special_speeds) ? special_speeds[i] : speed_distribution(generator);
+        // every third track moves for only part of the tick
+        double time = i % 3 == 2 ? part_distribution(generator) : 1.;
+
+        Track_base track(position, Course_speed(course, speed));
+        track.update_position(time);
+        batch.expected.push_back(track.get_position());
+
+        Cartesian_vector heading = course_unit_vector(course);
+        batch.x[offset + i] = position.x;
+        batch.y[offset + i] = position.y;
+        batch.heading_x[offset + i] = heading.delta_x;
+        batch.heading_y[offset + i] = heading.delta_y;
+        batch.speed[offset + i] = speed;
+        batch.time[offset + i] = time;
+    }
+    return batch;
+}
+
+// Check a batch moved by version against the positions update_position gives
+static void check_batch(const Batch& batch, size_t offset, const string& version)
+{
+    for (size_t i = 0; i < batch.expected.size(); ++i) {
+        uint64_t ulps_x = get_ulps_apart(batch.x[offset + i], batch.expected[i].x);
+        uint64_t ulps_y = get_ulps_apart(batch.y[offset + i], batch.expected[i].y);
+        ostringstream message;
+        message.precision(17);
+        message << version << " advance_positions, track " << i << " of " << batch.expected.size() << ": ("
+                << batch.x[offset + i] << ", " << batch.y[offset + i] << ") is " << ulps_x << " and " << ulps_y
+                << " ulps from (" << batch.expected[i].x << ", " << batch.expected[i].y << ")";
+        check(ulps_x <= max_ulps && ulps_y <= max_ulps, message.str());
+    }
+}
+
+// advance_positions, in every version, against Track_base::update_position
+void test_kinematics()
+{
+    mt19937 generator(20240611);
+    string vector_version = string("vector (") + get_kinematics_vector_instructions() + ")";
+    for (size_t count : batch_sizes) {
+        for (size_t offset : {0, 1}) {
+            for (int trial = 0; trial < 4; ++trial) {
+                Batch batch = make_batch(count, offset, generator);
+                Batch scalar_batch = batch;
+                advance_positions(batch.x.data() + offset,
+                    batch.y.data() + offset,
+                    batch.heading_x.data() + offset,
+                    batch.heading_y.data() + offset,
+                    batch.speed.data() + offset,
+                    batch.time.data() + offset,
+                    count);
+                check_batch(batch, offset, vector_version);
+                advance_positions_scalar(scalar_batch.x.data() + offset,
+                    scalar_batch.y.data() + offset,
+                    scalar_batch.heading_x.data() + offset,
+                    scalar_batch.heading_y.data() + offset,
+                    scalar_batch.speed.data() + offset,
+                    scalar_batch.time.data() + offset,
+                    count);
+                check_batch(scalar_batch, offset, "scalar");
+            }
+        }
+    }
+}
@@ -0,0 +1,80 @@
+/*
+simulation_tests runs the tests named on its command line, or all of them if
+none is named, and exits with 1 if any check failed. CTest runs each test on
+its own (see CMakeLists.txt).
+*/
+
+#include "Tests.h"
+#include <cstring>
+#include <exception>
+#include <iostream>
+
+using namespace std;
+
+struct Test
+{
+    const char* name;
+    void (*run)();
+};
+
+const Test tests[] = {
+    {"kinematics", test_kinematics},
+    {"fast_forward", test_fast_forward},
+    {"event_mode", test_event_mode},
+    {"parallel_mode", test_parallel_mode},
+    {"cpa_screen", test_cpa_screen},
+};
+
+// Only the first few failures of a test are shown; the rest are just counted
+const int max_failures_shown = 20;
+
+static int num_failures = 0;
+
+// Report message as a failure of the running test if condition is false
+void check(bool condition, const string& message)
+{
+    if (condition)
+        return;
+    if (++num_failures <= max_failures_shown)
+        cout << "    " << message << endl;
+}
+
+// Run a test, and return true if all its checks passed
+static bool run_test(const Test& test)
+{
+    num_failures = 0;
+    try {
+        test.run();
+    } catch (std::exception& error) {
+        check(false, string("exception: ") + error.what());
+    }
+    cout << test.name << ": " << (num_failures ? "FAILED" : "passed");
+    if (num_failures)
+        cout << " (" << num_failures << " failed checks)";
+    cout << endl;
+    return !num_failures;
+}
+
+int main(int argc, char* argv[])
+{
+    bool passed = true;
+    if (argc == 1) {
+        for (const Test& test : tests)
+            passed = run_test(test) && passed;
+        return passed ? 0 : 1;
+    }
+
+    for (int i = 1; i < argc; ++i) {
+        const Test* found = nullptr;
+        for (const Test& test : tests) {
+            if (!strcmp(argv[i], test.name))
+                found = &test;
+        }
+        if (!found) {
+            cout << "Unrecognized test: " << argv[i] << endl;
+            return 1;
+        }
+        passed = run_test(*found) && passed;
+    }
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,447 @@
+/*
+Tests that the ways of running many updates at once - skipping over quiet
+stretches, the event mode, and the parallel mode - leave every object exactly
+as updating one tick at a time in serial mode, the reference behavior, does.
+
+Each scenario is made from a seed: Ships of every type are created near the
+Islands of a new world and given first commands, as in the Monte Carlo driver,
+and more commands are given to random Ships at random times later on. In a
+quiet scenario there are fewer Ships and none attacks or chains another, so
+that there are long stretches in which every Ship only moves steadily. The
+scenario is run one tick at a time in serial mode, recording the state of the
+world after every tick, and then run again the way under test, stopping at
+the times the commands are given and at other times along the way, and its
+state compared there with the reference. The state is every object's
+position, fuel, course, speed, and movement state, compared at full
+precision, along with what each object describes itself as, the Model's
+statistics, and the commands that failed.
+*/
+
+#include "Tests.h"
+#include "Command_reader.h"
+#include "Controller.h"
+#include "Island.h"
+#include "Logger.h"
+#include "Model.h"
+#include "Ship.h"
+#include "Thread_pool.h"
+#include <algorithm>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <random>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// The scenarios; a quiet one has fewer Ships
+const unsigned int first_seed = 1;
+const int num_scenarios = 6;
+const int scenario_ships = 40;
+const int quiet_scenario_ships = 10;
+// At least this many in a parallel scenario, and at least parallel_chunk_ships
+// for each of the chunks the Thread_pool splits the Ships into
+const int parallel_scenario_ships = 200;
+const int parallel_chunk_ships = 4;
+const int num_parallel_scenarios = 2;
+const int scenario_later_commands = 40;
+const int scenario_ticks = 400;
+
+// How far from an Island the Ships are placed, in nm
+const double scenario_spread = 15.;
+
+// The longest stretch a run under test goes without stopping
+const int max_stretch = 60;
+
+// The commands of a scenario, by the time they are given at
+struct Scenario
+{
+    map<int, string> commands;
+};
+
+// The state of an Island or Ship
+struct Object_state
+{
+    string name;
+    double x, y;
+    double fuel;
+    double course, speed;  // 0 for an Island
+    int state;  // for a Ship, sunk, docked, dead_in_the_water, stopped, or moving_on_course for any
+                // movement, as an int; -1 for an Island
+    string description;
+};
+
+// The state of a world
+struct World_state
+{
+    int time;
+    int failed_commands;
+    Model::Statistics statistics;
+    vector<Object_state> objects;  // the Islands, then the Ships, in name order
+};
+
+// A world, driven by a quiet Controller as in the Monte Carlo driver
+struct World
+{
+    Model model;
+    Controller controller;
+    int failed_commands;
+
+    explicit World(Model::Update_mode update_mode)
+        : controller(model, true)
+        , failed_commands(0)
+    {
+        model.set_update_mode(update_mode);
+    }
+
+    void give(const string& commands)
+    {
+        istringstream stream(commands);
+        Stream_reader reader(stream);
+        failed_commands += controller.run_batch(reader);
+    }
+};
+
+// Return the scenario made from seed with num_ships new Ships, a quiet one if quiet
+static Scenario make_scenario(unsigned int seed, bool quiet, int num_ships)
+{
+    static const char* const ship_types[] = {"Cruiser", "Torpedo_boat", "Tanker", "Cruise_ship", "Chain_ship"};
+
+    mt19937 generator(seed);
+    auto pick = [&generator](size_t count) { return uniform_int_distribution<size_t>(0, count - 1)(generator); };
+    uniform_real_distribution<double> offset(-scenario_spread, scenario_spread);
+    uniform_real_distribution<double> course(0., 360.);
+    uniform_real_distribution<double> speed(3., 20.);
+    uniform_int_distribution<int> later_time(1, scenario_ticks - 1);
+
+    Model model;
+    vector<shared_ptr<Island>> islands = model.get_islands();
+    vector<string> ship_names;
+    for (const auto& ship_ptr : model.get_ships())
+        ship_names.push_back(ship_ptr->get_name());
+
+    auto random_position = [&] {
+        Point location = islands[pick(islands.size())]->get_location();
+        ostringstream position;
+        position << location.x + offset(generator) << " " << location.y + offset(generator);
+        return position.str();
+    };
+    auto random_island = [&] { return islands[pick(islands.size())]->get_name(); };
+
+    ostringstream first;
+    vector<pair<string, string>> new_ships;  // name and type
+    for (int i = 0; i < num_ships; ++i) {
+        string name = "R" + to_string(i);
+        string type = ship_types[pick(size(ship_types))];
+        first << "create " << name << " " << type << " " << random_position() << "\n";
+        new_ships.push_back(make_pair(name, type));
+        ship_names.push_back(name);
+    }
+
+    for (const auto& new_ship : new_ships) {
+        const string& name = new_ship.first;
+        const string& type = new_ship.second;
+        if (type == "Tanker") {
+            first << name << " load_at " << random_island() << "\n";
+            first << name << " unload_at " << random_island() << "\n";
+        } else if (type == "Cruise_ship") {
+            first << name << " destination " << random_island() << " " << speed(generator) << "\n";
+        } else if (type == "Chain_ship" && !quiet) {
+            first << name << " chain " << ship_names[pick(ship_names.size())] << "\n";
+        } else if (type != "Chain_ship" && !quiet && pick(2)) {
+            first << name << " attack " << ship_names[pick(ship_names.size())] << "\n";
+        } else if (pick(2)) {
+            first << name << " position " << random_position() << " " << speed(generator) << "\n";
+        } else {
+            first << name << " course " << course(generator) << " " << speed(generator) << "\n";
+        }
+    }
+
+    Scenario scenario;
+    scenario.commands[0] = first.str();
+    for (int i = 0; i < scenario_later_commands; ++i) {
+        ostringstream command;
+        command << ship_names[pick(ship_names.size())];
+        switch (pick(quiet ? 6 : 7)) {
+        case 0:
+            command << " course " << course(generator) << " " << speed(generator);
+            break;
+        case 1:
+            command << " position " << random_position() << " " << speed(generator);
+            break;
+        case 2:
+            command << " destination " << random_island() << " " << speed(generator);
+            break;
+        case 3:
+            command << " stop";
+            break;
+        case 4:
+            command << " dock_at " << random_island();
+            break;
+        case 5:
+            command << " refuel";
+            break;
+        default:
+            command << " attack " << ship_names[pick(ship_names.size())];
+            break;
+        }
+        scenario.commands[later_time(generator)] += command.str() + "\n";
+    }
+    return scenario;
+}
+
+// Return what object describes itself as
+static string get_description(const Sim_object& object)
+{
+    ostringstream description;
+    streambuf* cout_buffer = cout.rdbuf(description.rdbuf());
+    object.describe();
+    cout.rdbuf(cout_buffer);
+    return description.str();
+}
+
+// Return the movement state of a Ship as a number
+static int get_ship_state(const Ship& ship)
+{
+    if (!ship.is_afloat())
+        return static_cast<int>(Ship_state::sunk);
+    if (ship.is_docked())
+        return static_cast<int>(Ship_state::docked);
+    if (ship.is_moving())
+        return static_cast<int>(Ship_state::moving_on_course);
+    if (!ship.can_move())
+        return static_cast<int>(Ship_state::dead_in_the_water);
+    return static_cast<int>(Ship_state::stopped);
+}
+
+static World_state get_state(const World& world)
+{
+    World_state state;
+    state.time = world.model.get_time();
+    state.failed_commands = world.failed_commands;
+    state.statistics = world.model.get_statistics();
+    for (const auto& island : world.model.get_islands()) {
+        Point location = island->get_location();
+        state.objects.push_back(Object_state{
+            island->get_name(), location.x, location.y, island->get_fuel(), 0., 0., -1, get_description(*island)});
+    }
+    for (const auto& ship : world.model.get_ships()) {
+        Point location = ship->get_location();
+        Course_speed course_speed = ship->get_track().get_course_speed();
+        state.objects.push_back(Object_state{ship->get_name(),
+            location.x,
+            location.y,
+            ship->get_fuel(),
+            course_speed.course,
+            course_speed.speed,
+            get_ship_state(*ship),
+            get_description(*ship)});
+    }
+    return state;
+}
+
+// Check that state is the same as expected; label says which run it is from.
+// Returns false at the first difference.
+static bool check_state(const World_state& expected, const World_state& state, const string& label)
+{
+    ostringstream where;
+    where.precision(17);
+    where << label << ", time " << expected.time << ": ";
+
+    auto check_value = [&](bool same, const string& what, double expected_value, double value) {
+        ostringstream message;
+        message.precision(17);
+        message << where.str() << what << " is " << value << ", not " << expected_value;
+        check(same, message.str());
+        return same;
+    };
+
+    if (!check_value(state.time == expected.time, "time", expected.time, state.time)
+        || !check_value(state.failed_commands == expected.failed_commands,
+            "failed commands",
+            expected.failed_commands,
+            state.failed_commands)
+        || !check_value(state.statistics.fuel_delivered == expected.statistics.fuel_delivered,
+            "fuel delivered",
+            expected.statistics.fuel_delivered,
+            state.statistics.fuel_delivered)
+        || !check_value(state.statistics.ships_sunk == expected.statistics.ships_sunk,
+            "ships sunk",
+            expected.statistics.ships_sunk,
+            state.statistics.ships_sunk)
+        || !check_value(state.statistics.cruises_finished == expected.statistics.cruises_finished,
+            "cruises finished",
+            expected.statistics.cruises_finished,
+            state.statistics.cruises_finished)
+        || !check_value(state.statistics.total_cruise_finish_time == expected.statistics.total_cruise_finish_time,
+            "total cruise finish time",
+            double(expected.statistics.total_cruise_finish_time),
+            double(state.statistics.total_cruise_finish_time))
+        || !check_value(
+            state.objects.size() == expected.objects.size(), "objects", expected.objects.size(), state.objects.size()))
+        return false;
+
+    for (size_t i = 0; i < expected.objects.size(); ++i) {
+        const Object_state& e = expected.objects[i];
+        const Object_state& s = state.objects[i];
+        if (s.name != e.name) {
+            check(false, where.str() + "object " + s.name + " where " + e.name + " was expected");
+            return false;
+        }
+        if (!check_value(s.x == e.x, e.name + " x", e.x, s.x) || !check_value(s.y == e.y, e.name + " y", e.y, s.y)
+            || !check_value(s.fuel == e.fuel, e.name + " fuel", e.fuel, s.fuel)
+            || !check_value(s.course == e.course, e.name + " course", e.course, s.course)
+            || !check_value(s.speed == e.speed, e.name + " speed", e.speed, s.speed)
+            || !check_value(s.state == e.state, e.name + " state", e.state, s.state))
+            return false;
+        if (s.description != e.description) {
+            check(false, where.str() + e.name + " describes itself as\n" + s.description + "not\n" + e.description);
+            return false;
+        }
+    }
+    return true;
+}
+
+// Switch the Logger off, as the Monte Carlo driver does, so that the runs write nothing
+static void switch_logger_off()
+{
+    for (int category = 0; category < num_log_categories; ++category)
+        Logger::get_instance().set_category_enabled(static_cast<Log_category>(category), false);
+}
+
+// Run a scenario one tick at a time in serial mode, and return the state of
+// the world after each tick, indexed by time
+static vector<World_state> run_reference(const Scenario& scenario)
+{
+    World world(Model::Update_mode::serial);
+    vector<World_state> states;
+    while (true) {
+        int time = world.model.get_time();
+        states.push_back(get_state(world));
+        if (time == scenario_ticks)
+            return states;
+        auto commands = scenario.commands.find(time);
+        if (commands != scenario.commands.end())
+            world.give(commands->second);
+        world.model.update();
+    }
+}
+
+// Return every time from 0 to scenario_ticks
+static vector<int> get_every_time()
+{
+    vector<int> times(scenario_ticks + 1);
+    for (int time = 0; time <= scenario_ticks; ++time)
+        times[time] = time;
+    return times;
+}
+
+// Return the times a run under test stops at: when commands are given, and after
+// stretches of random length up to max_stretch, ending at scenario_ticks
+static vector<int> get_stops(const Scenario& scenario, unsigned int seed)
+{
+    mt19937 generator(seed);
+    uniform_int_distribution<int> stretch(1, max_stretch);
+    set<int> stops;
+    for (const auto& commands : scenario.commands)
+        stops.insert(commands.first);
+    for (int time = 0; time < scenario_ticks; time += stretch(generator))
+        stops.insert(time);
+    stops.insert(scenario_ticks);
+    return vector<int>(stops.begin(), stops.end());
+}
+
+// Run a scenario in update_mode, going from one stop to the next with one
+// Model::update(num_ticks), or with one Model::update() for each tick if
+// one_tick_at_a_time, and check the state at each stop against the reference
+static void check_run(const Scenario& scenario,
+    const vector<World_state>& reference,
+    const vector<int>& stops,
+    Model::Update_mode update_mode,
+    bool one_tick_at_a_time,
+    const string& label)
+{
+    World world(update_mode);
+    for (int stop : stops) {
+        int ticks = stop - world.model.get_time();
+        if (one_tick_at_a_time) {
+            for (int tick = 0; tick < ticks; ++tick)
+                world.model.update();
+        } else if (ticks > 0) {
+            world.model.update(ticks);
+        }
+        if (!check_state(reference[stop], get_state(world), label))
+            return;
+        auto commands = scenario.commands.find(stop);
+        if (commands != scenario.commands.end())
+            world.give(commands->second);
+    }
+}
+
+// Model::update(num_ticks), skipping over quiet stretches, against one tick at a time
+void test_fast_forward()
+{
+    switch_logger_off();
+    for (unsigned int seed = first_seed; seed < first_seed + num_scenarios; ++seed) {
+        for (bool quiet : {true, false}) {
+            Scenario scenario = make_scenario(seed, quiet, quiet ? quiet_scenario_ships : scenario_ships);
+            vector<World_state> reference = run_reference(scenario);
+            check_run(scenario,
+                reference,
+                get_stops(scenario, seed),
+                Model::Update_mode::serial,
+                false,
+                string("serial go N, ") + (quiet ? "quiet " : "") + "seed " + to_string(seed));
+        }
+    }
+}
+
+// The event mode against the serial mode, at every time and over longer stretches
+void test_event_mode()
+{
+    switch_logger_off();
+    for (unsigned int seed = first_seed; seed < first_seed + num_scenarios; ++seed) {
+        for (bool quiet : {true, false}) {
+            Scenario scenario = make_scenario(seed, quiet, quiet ? quiet_scenario_ships : scenario_ships);
+            vector<World_state> reference = run_reference(scenario);
+            string label = string(quiet ? "quiet " : "") + "seed " + to_string(seed);
+            check_run(scenario, reference, get_every_time(), Model::Update_mode::event, true, "event go, " + label);
+            check_run(scenario,
+                reference,
+                get_stops(scenario, seed),
+                Model::Update_mode::event,
+                false,
+                "event go N, " + label);
+        }
+    }
+}
+
+// The parallel mode against the serial mode, with enough Ships that the movement
+// is planned in several chunks; they only run on more than one thread if the
+// machine has more than one hardware thread
+void test_parallel_mode()
+{
+    switch_logger_off();
+    // Thread_pool::parallel_for makes four chunks for each thread
+    int num_chunks = int(Thread_pool::get_instance().get_num_threads()) * 4;
+    int num_ships = max(parallel_scenario_ships, num_chunks * parallel_chunk_ships);
+    for (unsigned int seed = first_seed; seed < first_seed + num_parallel_scenarios; ++seed) {
+        for (bool quiet : {true, false}) {
+            Scenario scenario = make_scenario(seed, quiet, num_ships);
+            vector<World_state> reference = run_reference(scenario);
+            string label = string(quiet ? "quiet " : "") + "seed " + to_string(seed);
+            check_run(
+                scenario, reference, get_every_time(), Model::Update_mode::parallel, true, "parallel go, " + label);
+            check_run(scenario,
+                reference,
+                get_stops(scenario, seed),
+                Model::Update_mode::parallel,
+                false,
+                "parallel go N, " + label);
+        }
+    }
+}